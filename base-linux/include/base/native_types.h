@@ -84,18 +84,52 @@ namespace Genode {
 	inline bool operator != (Native_thread_id t1, Native_thread_id t2) {
 		return (t1.tid != t2.tid) || (t1.pid != t2.pid); }
 
+	/**
+	 * Acquire resp. release reference to a counted socket descriptor
+	 *
+	 * The descriptor is closed when its last reference is released.
+	 */
+	void cap_dst_ref(int socket);
+	void cap_dst_unref(int socket);
+
 	struct Cap_dst_policy
 	{
 		struct Dst
 		{
 			int socket;
 
+			/**
+			 * True if 'socket' is closed with the last copy of the destination
+			 *
+			 * This is the case for the descriptors of received signal
+			 * contexts. Descriptors of entrypoints stay open.
+			 */
+			bool counted;
+
 			/**
 			 * Default constructor creates invalid destination
 			 */
-			Dst() : socket(-1) { }
+			Dst() : socket(-1), counted(false) { }
+
+			explicit Dst(int socket, bool counted = false)
+			: socket(socket), counted(counted) { if (counted) cap_dst_ref(socket); }
+
+			Dst(Dst const &other) : socket(other.socket), counted(other.counted)
+			{
+				if (counted) cap_dst_ref(socket);
+			}
+
+			Dst &operator = (Dst const &other)
+			{
+				if (other.counted) cap_dst_ref(other.socket);
+				if (counted)       cap_dst_unref(socket);
+
+				socket  = other.socket;
+				counted = other.counted;
+				return *this;
+			}
 
-			explicit Dst(int socket) : socket(socket) { }
+			~Dst() { if (counted) cap_dst_unref(socket); }
 		};
 
 		static bool valid(Dst id) { return id.socket != -1; }
@@ -32,6 +32,7 @@
 #include <base/thread.h>
 #include <base/blocking.h>
 #include <base/env.h>
+#include <cpu/atomic.h>
 #include <linux_cpu_session/linux_cpu_session.h>
 
 /* local includes */
@@ -46,6 +47,47 @@
 using namespace Genode;
 
 
+/**********************************************
+ ** Descriptors of received signal contexts **
+ **********************************************/
+
+/*
+ * Each reception of a signal-context capability installs a new descriptor
+ * of the eventfd of the context. The descriptor is referenced by all copies
+ * of the received capability and closed with the last one. The reference
+ * counters are indexed by descriptor. A counter returns to zero before its
+ * descriptor is closed, so a reused descriptor starts with a zero counter.
+ */
+
+enum { MAX_COUNTED_FDS = 1024 };
+
+static int volatile counted_fd_refs[MAX_COUNTED_FDS];
+
+
+void Genode::cap_dst_ref(int socket)
+{
+	for (;;) {
+		int const old = counted_fd_refs[socket];
+		if (cmpxchg(&counted_fd_refs[socket], old, old + 1))
+			return;
+	}
+}
+
+
+void Genode::cap_dst_unref(int socket)
+{
+	for (;;) {
+		int const old = counted_fd_refs[socket];
+		if (!cmpxchg(&counted_fd_refs[socket], old, old - 1))
+			continue;
+
+		if (old == 1)
+			lx_close(socket);
+		return;
+	}
+}
+
+
 /*****************************
  ** IPC marshalling support **
  *****************************/
@@ -75,8 +117,22 @@ void Ipc_istream::_unmarshal_capability(Native_capability &cap)
 	} else {
 
 		/* construct valid capability */
-		int const socket = _rcv_msg->read_cap();
-		cap = Native_capability(Cap_dst_policy::Dst(socket), local_name);
+		int socket = _rcv_msg->read_cap();
+
+		/*
+		 * Signal-context capabilities have a negative local name. Their
+		 * descriptors are closed with the last copy of the capability.
+		 */
+		bool const counted = local_name < -1 && socket >= 0;
+
+		if (counted && socket >= MAX_COUNTED_FDS) {
+			PERR("descriptor %d of signal context exceeds limit", socket);
+			lx_close(socket);
+			cap = Genode::Native_capability();
+			return;
+		}
+
+		cap = Native_capability(Cap_dst_policy::Dst(socket, counted), local_name);
 	}
 }
 
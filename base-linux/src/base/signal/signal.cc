@@ -0,0 +1,419 @@
+/*
+ * \brief  Linux-specific implementation of the signaling framework
+ * \author Norman Feske
+ * \date   2013-03-13
+ *
+ * On Linux, signals are not routed through core. Each signal context is
+ * backed by an eventfd, which is the destination of the signal-context
+ * capability. Because capabilities are file descriptors on Linux, a
+ * transmitter receives its own descriptor of the eventfd along with the
+ * capability. Submitting a signal adds the number of signals to the
+ * counter of the eventfd, which wakes up the receiving process. The signal
+ * handler thread of the receiving process waits for all eventfds of the
+ * process via epoll. Reading an eventfd returns the accumulated number of
+ * signals and resets the counter. A process that receives a context
+ * capability closes the received descriptor with the last copy of the
+ * capability, see 'ipc.cc'.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/signal.h>
+#include <base/thread.h>
+
+/* Linux includes */
+#include <linux_syscalls.h>
+
+using namespace Genode;
+
+
+enum { LX_EINTR = 4 };
+
+
+/**
+ * Return process-wide epoll instance watching the eventfds of all contexts
+ */
+static int signal_epoll()
+{
+	static int epoll_fd = lx_epoll_create(EPOLL_CLOEXEC);
+	return epoll_fd;
+}
+
+
+/********************************
+ ** Process-wide signal thread **
+ ********************************/
+
+enum { STACK_SIZE = 4*1024*sizeof(addr_t) };
+
+class Signal_handler_thread : Thread<STACK_SIZE>
+{
+	private:
+
+		void entry() { Signal_receiver::dispatch_signals(0); }
+
+	public:
+
+		/**
+		 * Constructor
+		 */
+		Signal_handler_thread() : Thread<STACK_SIZE>("signal handler")
+		{
+			if (signal_epoll() < 0)
+				PERR("could not create epoll instance for signals");
+
+			start();
+		}
+};
+
+
+/**
+ * Return process-wide signal handler thread
+ */
+static Signal_handler_thread *signal_handler_thread()
+{
+	static Signal_handler_thread signal_handler_thread;
+	return &signal_handler_thread;
+}
+
+
+/*****************************
+ ** Signal context registry **
+ *****************************/
+
+namespace Genode {
+
+	/**
+	 * Facility to validate the liveliness of signal contexts
+	 *
+	 * After dissolving a 'Signal_context' from a 'Signal_receiver', the
+	 * signal handler thread may still process an epoll event that refers
+	 * to the context. Hence, we need to check for the liveliness of the
+	 * context before using the pointer delivered with the event.
+	 */
+	class Signal_context_registry
+	{
+		private:
+
+			Lock mutable                        _lock;
+			List<List_element<Signal_context> > _list;
+
+		public:
+
+			void insert(List_element<Signal_context> *le)
+			{
+				Lock::Guard guard(_lock);
+				_list.insert(le);
+			}
+
+			void remove(List_element<Signal_context> *le)
+			{
+				Lock::Guard guard(_lock);
+				_list.remove(le);
+			}
+
+			bool test_and_lock(Signal_context *context) const
+			{
+				Lock::Guard guard(_lock);
+
+				/* search list for context */
+				List_element<Signal_context> *le = _list.first();
+				for ( ; le; le = le->next()) {
+
+					if (context == le->object()) {
+						/* lock object */
+						context->_lock.lock();
+						return true;
+					}
+				}
+				return false;
+			}
+	};
+}
+
+
+/**
+ * Return process-wide registry of registered signal contexts
+ */
+Genode::Signal_context_registry *signal_context_registry()
+{
+	static Signal_context_registry inst;
+	return &inst;
+}
+
+
+/************
+ ** Signal **
+ ************/
+
+void Signal::_dec_ref_and_unlock()
+{
+	if (_data.context) {
+		Lock::Guard lock_guard(_data.context->_lock);
+		_data.context->_ref_cnt--;
+		if (_data.context->_ref_cnt == 0)
+			_data.context->_destroy_lock.unlock();
+	}
+}
+
+
+void Signal::_inc_ref()
+{
+	if (_data.context) {
+		Lock::Guard lock_guard(_data.context->_lock);
+		_data.context->_ref_cnt++;
+	}
+}
+
+
+Signal::Signal(Signal::Data data) : _data(data)
+{
+	if (_data.context) {
+		_data.context->_ref_cnt = 1;
+		_data.context->_destroy_lock.lock();
+	}
+}
+
+
+/************************
+ ** Signal transmitter **
+ ************************/
+
+void Signal_transmitter::submit(unsigned cnt)
+{
+	if (!_context.valid())
+		return;
+
+	/*
+	 * The write fails only if the counter of the eventfd would overflow,
+	 * which cannot happen in practice.
+	 */
+	unsigned long long const value = cnt;
+	lx_write(_context.dst().socket, &value, sizeof(value));
+}
+
+
+/*********************
+ ** Signal receiver **
+ *********************/
+
+void Signal_receiver::_unsynchronized_dissolve(Signal_context *context)
+{
+	int const fd = context->_cap.dst().socket;
+
+	/* stop watching the eventfd */
+	lx_epoll_ctl(signal_epoll(), EPOLL_CTL_DEL, fd, 0);
+
+	/* unregister context from process-wide registry */
+	signal_context_registry()->remove(&context->_registry_le);
+
+	/*
+	 * The signal handler thread may currently read from the eventfd. By
+	 * taking the context lock, we wait until it is done. Afterwards, the
+	 * context cannot be found in the registry anymore. So the descriptor
+	 * can be closed without the risk of a reused descriptor being read
+	 * by the signal handler thread.
+	 */
+	{
+		Lock::Guard lock_guard(context->_lock);
+		lx_close(fd);
+	}
+
+	/* restore default initialization of signal context */
+	context->_receiver = 0;
+	context->_cap      = Signal_context_capability();
+
+	/* remove context from context list */
+	_contexts.remove(&context->_receiver_le);
+}
+
+
+Signal_receiver::Signal_receiver()
+{
+	/* make sure that the process-local signal handler thread is running */
+	signal_handler_thread();
+}
+
+
+Signal_context_capability Signal_receiver::manage(Signal_context *context)
+{
+	if (context->_receiver)
+		throw Context_already_in_use();
+
+	int const fd = lx_eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd < 0) {
+		PERR("could not create eventfd for signal context");
+		return Signal_context_capability();
+	}
+
+	context->_receiver = this;
+
+	Lock::Guard list_lock_guard(_contexts_lock);
+
+	/* insert context into context list */
+	_contexts.insert(&context->_receiver_le);
+
+	/* register context at process-wide registry */
+	signal_context_registry()->insert(&context->_registry_le);
+
+	/*
+	 * The local name tells the IPC framework of a receiving process to
+	 * reference count the received eventfd descriptor. Local names of
+	 * entrypoint capabilities are positive. Signal-context capabilities
+	 * have a negative local name other than -1, which denotes an invalid
+	 * capability. We use the context as imprint.
+	 */
+	unsigned long const tag = 1UL << (sizeof(long)*8 - 1);
+	context->_cap = reinterpret_cap_cast<Signal_context>(
+		Native_capability(Cap_dst_policy::Dst(fd), (long)(tag | (addr_t)context)));
+
+	epoll_event event;
+	event.events   = EPOLLIN;
+	event.data.ptr = context;
+	if (lx_epoll_ctl(signal_epoll(), EPOLL_CTL_ADD, fd, &event) < 0)
+		PERR("could not watch eventfd of signal context");
+
+	return context->_cap;
+}
+
+
+void Signal_receiver::dissolve(Signal_context *context)
+{
+	if (context->_receiver != this)
+		throw Context_not_associated();
+
+	Lock::Guard list_lock_guard(_contexts_lock);
+
+	_unsynchronized_dissolve(context);
+
+	Lock::Guard context_destroy_lock_guard(context->_destroy_lock);
+}
+
+
+bool Signal_receiver::pending()
+{
+	Lock::Guard list_lock_guard(_contexts_lock);
+
+	/* look up the contexts for the pending signal */
+	for (List_element<Signal_context> *le = _contexts.first(); le; le = le->next()) {
+
+		Signal_context *context = le->object();
+
+		Lock::Guard lock_guard(context->_lock);
+
+		if (context->_pending)
+			return true;
+	}
+	return false;
+}
+
+
+Signal Signal_receiver::wait_for_signal()
+{
+	for (;;) {
+
+		/* block until the receiver has received a signal */
+		_signal_available.down();
+
+		Lock::Guard list_lock_guard(_contexts_lock);
+
+		/* look up the contexts for the pending signal */
+		for (List_element<Signal_context> *le = _contexts.first(); le; le = le->next()) {
+
+			Signal_context *context = le->object();
+
+			Lock::Guard lock_guard(context->_lock);
+
+			/* check if context has a pending signal */
+			if (!context->_pending)
+				continue;
+
+			context->_pending = false;
+			Signal::Data result = context->_curr_signal;
+
+			/* invalidate current signal in context */
+			context->_curr_signal = Signal::Data(0, 0);
+
+			if (result.num == 0)
+				PWRN("returning signal with num == 0");
+
+			/* return last received signal */
+			return result;
+		}
+
+		/*
+		 * The context of the signal may have been dissolved after the
+		 * semaphore was increased.
+		 */
+	}
+	return Signal::Data(0, 0); /* unreachable */
+}
+
+
+void Signal_receiver::local_submit(Signal::Data ns)
+{
+	Signal_context *context = ns.context;
+
+	/*
+	 * Replace current signal of the context by signal with accumulated
+	 * counters. In the common case, the current signal is an invalid
+	 * signal with a counter value of zero.
+	 */
+	unsigned num = context->_curr_signal.num + ns.num;
+	context->_curr_signal = Signal::Data(context, num);
+
+	/* wake up the receiver if the context becomes pending */
+	if (!context->_pending) {
+		context->_pending = true;
+		_signal_available.up();
+	}
+}
+
+
+void Signal_receiver::dispatch_signals(Signal_source *)
+{
+	enum { MAX_EVENTS = 16 };
+
+	epoll_event events[MAX_EVENTS];
+
+	for (;;) {
+		int const num_events = lx_epoll_wait(signal_epoll(), events, MAX_EVENTS, -1);
+
+		if (num_events == -LX_EINTR)
+			continue;
+
+		if (num_events < 0) {
+			PERR("waiting for signals failed");
+			return;
+		}
+
+		for (int i = 0; i < num_events; i++) {
+
+			Signal_context *context = (Signal_context *)events[i].data.ptr;
+
+			if (!signal_context_registry()->test_and_lock(context)) {
+				PWRN("encountered dead signal context");
+				continue;
+			}
+
+			/* fetch and reset the number of submitted signals */
+			unsigned long long num = 0;
+			int const ret = lx_read(context->_cap.dst().socket, &num, sizeof(num));
+
+			/* construct and locally submit signal object */
+			if (ret == sizeof(num) && num) {
+				Signal::Data signal(context, (unsigned)num);
+				context->_receiver->local_submit(signal);
+			}
+
+			/* free context lock that was taken by 'test_and_lock' */
+			context->_lock.unlock();
+		}
+	}
+}
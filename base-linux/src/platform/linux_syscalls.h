@@ -92,6 +92,45 @@ inline int lx_dup2(int fd, int to)
 }
 
 
+/********************************************
+ ** Functions used by the signal framework **
+ ********************************************/
+
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+
+
+inline int lx_read(int fd, void *buf, Genode::size_t count)
+{
+	return lx_syscall(SYS_read, fd, buf, count);
+}
+
+
+inline int lx_eventfd(unsigned initval, int flags)
+{
+	return lx_syscall(SYS_eventfd2, initval, flags);
+}
+
+
+inline int lx_epoll_create(int flags)
+{
+	return lx_syscall(SYS_epoll_create1, flags);
+}
+
+
+inline int lx_epoll_ctl(int epfd, int op, int fd, struct epoll_event *event)
+{
+	return lx_syscall(SYS_epoll_ctl, epfd, op, fd, event);
+}
+
+
+inline int lx_epoll_wait(int epfd, struct epoll_event *events, int maxevents,
+                         int timeout)
+{
+	return lx_syscall(SYS_epoll_wait, epfd, events, maxevents, timeout);
+}
+
+
 /*****************************************
  ** Functions used by the IPC framework **
  *****************************************/
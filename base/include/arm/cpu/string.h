@@ -1,5 +1,5 @@
 /*
- * \brief  Cpu specifi memcpy
+ * \brief  Cpu specific memcpy and memset
  * \author Sebastian Sumpf
  * \author Stefan Kalkowski
  * \date   2012-08-02
@@ -51,6 +51,54 @@ namespace Genode
 	
 		return size;
 	}
+
+
+	/**
+	 * Fill memory block
+	 *
+	 * \param dst   destination memory block
+	 * \param c     fill byte
+	 * \param size  number of bytes to fill
+	 *
+	 * \return      Number of bytes not filled, located at the end of the block
+	 */
+	inline size_t memset_cpu(void *dst, int c, size_t size)
+	{
+		unsigned char *d = (unsigned char *)dst;
+
+		/* at least 32 bytes */
+		if (size < 32)
+			return size;
+
+		/* fill to 4 byte alignment */
+		for (; (size_t)d & 0x3; *d++ = c, size--);
+
+		if (size < 32)
+			return size;
+
+		/* replicate fill byte to all bytes of a word */
+		unsigned long const pattern = 0x01010101UL * (unsigned char)c;
+
+		/* fill 32 byte chunks */
+		asm volatile ("mov r3,  %2     \n\t"
+		              "mov r4,  %2     \n\t"
+		              "mov r5,  %2     \n\t"
+		              "mov r6,  %2     \n\t"
+		              "mov r7,  %2     \n\t"
+		              "mov r8,  %2     \n\t"
+		              "mov r9,  %2     \n\t"
+		              "mov r10, %2     \n\t"
+		              "1:              \n\t"
+		              "stmia %0!, {r3 - r10} \n\t"
+		              "sub %1, %1, #32 \n\t"
+		              "cmp %1, #32     \n\t"
+		              "bhs 1b          \n\t"
+		              : "+r" (d), "+r" (size)
+		              : "r" (pattern)
+		              : "r3","r4","r5","r6","r7","r8","r9","r10","cc","memory");
+
+		return size;
+	}
 }
 
 #endif /* _INCLUDE__ARM__CPU__STRING_H_ */
@@ -3,6 +3,15 @@
  * \author Norman Feske
  * \author Alexander Boettcher
  * \date   2006-06-26
+ *
+ * The pool is consulted for each incoming RPC. Hence, looking up an object
+ * must be cheap even if the pool contains many objects. The objects are
+ * distributed over several shards by the hash of their ids. Each shard is
+ * an AVL tree. Lookups traverse the tree without taking a lock and are
+ * validated by a sequence counter incremented by each modification of the
+ * tree. An object removed from a tree may still be visited by concurrent
+ * lookups. So 'remove_locked' returns not before all lookups that may have
+ * seen the object are finished.
  */
 
 /*
@@ -18,6 +27,7 @@
 #include <util/avl_tree.h>
 #include <base/capability.h>
 #include <base/lock.h>
+#include <base/semaphore.h>
 
 namespace Genode {
 
@@ -62,8 +72,8 @@ namespace Genode {
 				private:
 
 					Untyped_capability _cap;
-					short int          _ref;
-					bool               _dead;
+					int volatile       _ref;
+					bool volatile      _dead;
 
 					Lock               _entry_lock;
 
@@ -79,8 +89,13 @@ namespace Genode {
 					void lock()   { _entry_lock.lock(); };
 					void unlock() { _entry_lock.unlock(); };
 
-					void add_ref() { _ref += 1; }
-					void del_ref() { _ref -= 1; }
+					/*
+					 * The reference counter is modified by lookups without
+					 * holding a lock. The atomic operations are full memory
+					 * barriers.
+					 */
+					void add_ref() { __atomic_add_fetch(&_ref, 1, __ATOMIC_SEQ_CST); }
+					void del_ref() { __atomic_sub_fetch(&_ref, 1, __ATOMIC_SEQ_CST); }
 
 					bool is_dead(bool set_dead = false) {
 						return (set_dead ? (_dead = true) : _dead); }
@@ -130,28 +145,217 @@ namespace Genode {
 
 		private:
 
-			Avl_tree<Entry> _tree;
-			Lock            _lock;
+			enum {
+				NUM_SHARDS  = 16,    /* must be a power of two */
+				MAX_DEPTH   = 64,    /* exceeded by inconsistent trees only */
+				MAX_RETRIES = 4,     /* optimistic lookups before locking */
+			};
+
+			/**
+			 * Full memory barrier, also prevents the compiler from caching
+			 * values across the barrier
+			 */
+			static void _barrier() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+			/**
+			 * Order the preceding loads before the following ones
+			 */
+			static void _acquire() { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+
+			/**
+			 * Part of the pool, holding the objects of a range of hash
+			 * values
+			 *
+			 * Lookups announce themselves in one of two reader counters,
+			 * selected by the current epoch. To wait for all lookups that
+			 * may have seen a removed object, 'remove_locked' switches to
+			 * the other epoch and waits until the counter of the previous
+			 * epoch drops to zero. Because lookups never block while being
+			 * counted, this happens quickly.
+			 */
+			struct Shard
+			{
+				Avl_tree<Entry>   tree;
+				Lock              lock;          /* serializes modifications */
+				unsigned volatile seq;           /* odd while modifying tree */
+				unsigned volatile epoch;
+				int      volatile readers[2];
+				int      volatile remover_waiting;
+				Semaphore         grace_period;
+
+				Shard() : seq(0), epoch(0), remover_waiting(0) {
+					readers[0] = readers[1] = 0; }
+
+				unsigned enter()
+				{
+					for (;;) {
+						unsigned const e = epoch & 1;
+						__atomic_add_fetch(&readers[e], 1, __ATOMIC_SEQ_CST);
+
+						/* the epoch may have changed before we were counted */
+						if (e == (epoch & 1))
+							return e;
+
+						leave(e);
+					}
+				}
+
+				void leave(unsigned e)
+				{
+					if (__atomic_sub_fetch(&readers[e], 1, __ATOMIC_SEQ_CST))
+						return;
+
+					/* wake up remover waiting for the last reader */
+					if (remover_waiting && __atomic_exchange_n(&remover_waiting, 0, __ATOMIC_SEQ_CST))
+						grace_period.up();
+				}
+
+				/**
+				 * Wait until all lookups of the current epoch are finished
+				 *
+				 * Must be called with 'lock' held.
+				 */
+				void wait_for_readers()
+				{
+					unsigned const e = epoch & 1;
+					epoch = epoch + 1;
+					_barrier();
+
+					while (readers[e]) {
+						remover_waiting = 1;
+						_barrier();
+
+						/*
+						 * If the last reader left in the meantime, it may have
+						 * missed our flag. Otherwise, it will wake us up.
+						 * A wakeup destined for an earlier call results in
+						 * another iteration.
+						 */
+						if (readers[e])
+							grace_period.down();
+
+						remover_waiting = 0;
+					}
+				}
+
+				void begin_modification() { seq = seq + 1; _barrier(); }
+
+				void end_modification() {
+					__atomic_store_n(&seq, seq + 1, __ATOMIC_RELEASE); }
+
+				/**
+				 * Find object in tree
+				 *
+				 * \param max_depth  maximum number of visited nodes
+				 * \param valid      set to false if 'max_depth' was exceeded
+				 */
+				Entry *find(unsigned long obj_id, unsigned max_depth, bool &valid)
+				{
+					Entry *e = tree.first();
+					for (unsigned depth = 0; e; depth++) {
+
+						if (depth == max_depth) {
+							valid = false;
+							return 0;
+						}
+
+						unsigned long const id = e->_obj_id();
+						if (id == obj_id)
+							return e;
+
+						e = e->child(obj_id > id);
+					}
+					return 0;
+				}
+			};
+
+			Shard _shards[NUM_SHARDS];
+
+			Shard &_shard(unsigned long obj_id)
+			{
+				unsigned const h = (unsigned)obj_id*2654435761U;
+				return _shards[(h >> 16) & (NUM_SHARDS - 1)];
+			}
+
+			/**
+			 * Take reference to object unless it is being removed
+			 */
+			static bool _try_add_ref(Entry *obj)
+			{
+				obj->add_ref();
+				if (!obj->is_dead())
+					return true;
+
+				obj->del_ref();
+				return false;
+			}
+
+			/**
+			 * Look up object without taking a lock
+			 *
+			 * \param found  resulting object with reference taken, or 0
+			 *
+			 * \return  false if the lookup collided with modifications of
+			 *          the tree too often
+			 */
+			bool _lookup_optimistic(Shard &shard, unsigned long obj_id, Entry *&found)
+			{
+				unsigned const e = shard.enter();
+
+				for (unsigned i = 0; i < MAX_RETRIES; i++) {
+
+					unsigned const seq = __atomic_load_n(&shard.seq, __ATOMIC_ACQUIRE);
+					if (seq & 1)
+						continue;
+
+					bool   valid = true;
+					Entry *obj   = shard.find(obj_id, MAX_DEPTH, valid);
+
+					/* the tree was consistent if it was not modified meanwhile */
+					_acquire();
+					if (!valid || seq != shard.seq)
+						continue;
+
+					found = (obj && _try_add_ref(obj)) ? obj : 0;
+					shard.leave(e);
+					return true;
+				}
+
+				shard.leave(e);
+				return false;
+			}
 
 		public:
 
 			void insert(OBJ_TYPE *obj)
 			{
-				Lock::Guard lock_guard(_lock);
-				_tree.insert(obj);
+				Shard &shard = _shard(obj->_obj_id());
+				Lock::Guard lock_guard(shard.lock);
+
+				shard.begin_modification();
+				shard.tree.insert(obj);
+				shard.end_modification();
 			}
 
 			void remove_locked(OBJ_TYPE *obj)
 			{
+				Shard &shard = _shard(obj->_obj_id());
+
 				obj->is_dead(true);
+				_barrier();
 				obj->del_ref();
 
 				while (true) {
 					obj->unlock();
 					{
-						Lock::Guard lock_guard(_lock);
+						Lock::Guard lock_guard(shard.lock);
 						if (obj->is_ref_zero()) {
-							_tree.remove(obj);
+							shard.begin_modification();
+							shard.tree.remove(obj);
+							shard.end_modification();
+
+							/* lookups may still visit the object */
+							shard.wait_for_readers();
 							return;
 						}
 					}
@@ -164,21 +368,23 @@ namespace Genode {
 			 */
 			OBJ_TYPE *lookup_and_lock(addr_t obj_id)
 			{
-				OBJ_TYPE * obj_typed;
-				{
-					Lock::Guard lock_guard(_lock);
-					Entry *obj = _tree.first();
-					if (!obj) return 0;
+				Shard &shard = _shard(obj_id);
+				Entry *obj   = 0;
 
-					obj_typed = (OBJ_TYPE *)obj->find_by_obj_id(obj_id);
-					if (!obj_typed || obj_typed->is_dead())
-						return 0;
+				if (!_lookup_optimistic(shard, obj_id, obj)) {
 
-					obj_typed->add_ref();
+					/* the tree is being modified, wait for the modification */
+					Lock::Guard lock_guard(shard.lock);
+					bool valid = true;
+					obj = shard.find(obj_id, ~0U, valid);
+					if (obj && !_try_add_ref(obj))
+						obj = 0;
 				}
 
-				obj_typed->lock();
-				return obj_typed;
+				if (!obj) return 0;
+
+				obj->lock();
+				return (OBJ_TYPE *)obj;
 			}
 
 			OBJ_TYPE *lookup_and_lock(Untyped_capability cap)
@@ -193,8 +399,12 @@ namespace Genode {
 			 */
 			OBJ_TYPE *first()
 			{
-				Lock::Guard lock_guard(_lock);
-				return (OBJ_TYPE *)_tree.first();
+				for (unsigned i = 0; i < NUM_SHARDS; i++) {
+					Lock::Guard lock_guard(_shards[i].lock);
+					if (Entry *obj = _shards[i].tree.first())
+						return (OBJ_TYPE *)obj;
+				}
+				return 0;
 			}
 	};
 }
@@ -163,6 +163,22 @@ namespace Genode {
 		const unsigned char *c0 = (const unsigned char *)p0;
 		const unsigned char *c1 = (const unsigned char *)p1;
 
+		enum { WORD_MASK = sizeof(unsigned long) - 1 };
+
+		/* skip equal machine words if both blocks have the same alignment */
+		if ((((addr_t)c0 ^ (addr_t)c1) & WORD_MASK) == 0) {
+
+			for (; size && ((addr_t)c0 & WORD_MASK); size--, c0++, c1++)
+				if (*c0 != *c1) return *c0 - *c1;
+
+			for (; size >= sizeof(unsigned long); size -= sizeof(unsigned long),
+			                                      c0 += sizeof(unsigned long),
+			                                      c1 += sizeof(unsigned long))
+				if (*(unsigned long const *)c0 != *(unsigned long const *)c1)
+					break;
+		}
+
+		/* compare remaining bytes, including a word that differs */
 		size_t i;
 		for (i = 0; i < size; i++)
 			if (c0[i] != c1[i]) return c0[i] - c1[i];
@@ -176,7 +192,14 @@ namespace Genode {
 	 */
 	inline void *memset(void *dst, int i, size_t size)
 	{
-		while (size--) ((char *)dst)[size] = i;
+		char *d = (char *)dst;
+
+		/* try cpu specific version first, it leaves a tail unfilled */
+		size_t const left = memset_cpu(dst, i, size);
+		d += size - left;
+
+		for (size = left; size > 0; size--, *d++ = i);
+
 		return dst;
 	}
 
@@ -1,7 +1,14 @@
 /*
- * \brief  Cpu specifi memcpy
+ * \brief  Cpu specific memcpy and memset
  * \author Sebastian Sumpf
  * \date   2012-08-02
+ *
+ * The functions are built upon the string instructions, which are
+ * optimized by the microcode of all recent x86 CPUs. In contrast to SSE or
+ * AVX instructions, they do not touch the FPU state. So they are safe to use
+ * in any program including core and ld.lib.so. Copies that exceed the size
+ * of the caches are performed with non-temporal stores to avoid thrashing
+ * the caches with data that is not accessed soon.
  */
 
 /*
@@ -16,6 +23,39 @@
 
 namespace Genode
 {
+	enum {
+		STRING_CPU_MIN_SIZE     = 64,          /* smaller blocks are handled generically */
+		STRING_CPU_NON_TEMPORAL = 512*1024,    /* copy size for non-temporal stores */
+	};
+
+
+	/**
+	 * Copy machine words using non-temporal stores
+	 *
+	 * 'movnti' is part of SSE2, which is always present on x86_64 but must
+	 * be enabled at compile time for x86_32.
+	 *
+	 * \return  number of words not copied
+	 */
+	inline unsigned long memcpy_cpu_non_temporal(long *d, long const *s,
+	                                             unsigned long words)
+	{
+#if defined(__x86_64__) || defined(__SSE2__)
+		for (; words >= 4; words -= 4, d += 4, s += 4) {
+			long const w0 = s[0], w1 = s[1], w2 = s[2], w3 = s[3];
+			asm volatile ("movnti %1, %0" : "=m" (d[0]) : "r" (w0));
+			asm volatile ("movnti %1, %0" : "=m" (d[1]) : "r" (w1));
+			asm volatile ("movnti %1, %0" : "=m" (d[2]) : "r" (w2));
+			asm volatile ("movnti %1, %0" : "=m" (d[3]) : "r" (w3));
+		}
+
+		/* make non-temporal stores globally visible */
+		asm volatile ("sfence" ::: "memory");
+#endif
+		return words;
+	}
+
+
 	/**
 	 * Copy memory block
 	 *
@@ -25,8 +65,77 @@ namespace Genode
 	 *
 	 * \return      Number of bytes not copied
 	 */
-	inline size_t memcpy_cpu(void *, const void *, size_t size) {
-		return size; }
+	inline size_t memcpy_cpu(void *dst, const void *src, size_t size)
+	{
+		if (size < STRING_CPU_MIN_SIZE)
+			return size;
+
+		char       *d = (char *)dst;
+		char const *s = (char const *)src;
+
+		/* copy up to the word alignment of the destination */
+		size_t head = (size_t)(-(addr_t)d) & (sizeof(long) - 1);
+		size -= head;
+		asm volatile ("rep movsb"
+		              : "+D" (d), "+S" (s), "+c" (head) : : "memory");
+
+		size_t words = size / sizeof(long);
+
+		if (size >= STRING_CPU_NON_TEMPORAL) {
+			size_t const left = memcpy_cpu_non_temporal((long *)d, (long const *)s, words);
+			d += (words - left)*sizeof(long);
+			s += (words - left)*sizeof(long);
+			words = left;
+		}
+
+#ifdef __x86_64__
+		asm volatile ("rep movsq"
+		              : "+D" (d), "+S" (s), "+c" (words) : : "memory");
+#else
+		asm volatile ("rep movsl"
+		              : "+D" (d), "+S" (s), "+c" (words) : : "memory");
+#endif
+
+		return size & (sizeof(long) - 1);
+	}
+
+
+	/**
+	 * Fill memory block
+	 *
+	 * \param dst   destination memory block
+	 * \param c     fill byte
+	 * \param size  number of bytes to fill
+	 *
+	 * \return      Number of bytes not filled, located at the end of the block
+	 */
+	inline size_t memset_cpu(void *dst, int c, size_t size)
+	{
+		if (size < STRING_CPU_MIN_SIZE)
+			return size;
+
+		char *d = (char *)dst;
+
+		/* fill up to the word alignment */
+		size_t head = (size_t)(-(addr_t)d) & (sizeof(long) - 1);
+		size -= head;
+		asm volatile ("rep stosb"
+		              : "+D" (d), "+c" (head) : "a" (c) : "memory");
+
+		/* replicate fill byte to all bytes of a word */
+		unsigned long const pattern = (~0UL / 0xff) * (unsigned char)c;
+
+		size_t words = size / sizeof(long);
+#ifdef __x86_64__
+		asm volatile ("rep stosq"
+		              : "+D" (d), "+c" (words) : "a" (pattern) : "memory");
+#else
+		asm volatile ("rep stosl"
+		              : "+D" (d), "+c" (words) : "a" (pattern) : "memory");
+#endif
+
+		return size & (sizeof(long) - 1);
+	}
 }
 
 #endif /* _INCLUDE__X86__CPU__STRING_H_ */
@@ -0,0 +1,38 @@
+/*
+ * \brief  Trace timestamp
+ * \author Norman Feske
+ * \date   2013-03-22
+ *
+ * The timestamp is the value of the CPU's time-stamp counter. It is meant for
+ * measuring short durations with a low overhead. The conversion to time units
+ * must be calibrated against a timer by the user.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _INCLUDE__X86__TRACE__TIMESTAMP_H_
+#define _INCLUDE__X86__TRACE__TIMESTAMP_H_
+
+#include <base/stdint.h>
+
+namespace Genode {
+
+	namespace Trace {
+
+		typedef uint64_t Timestamp;
+
+		inline Timestamp timestamp()
+		{
+			uint32_t lo, hi;
+			asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+			return (Timestamp)hi << 32 | lo;
+		}
+	}
+}
+
+#endif /* _INCLUDE__X86__TRACE__TIMESTAMP_H_ */
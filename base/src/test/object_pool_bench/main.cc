@@ -0,0 +1,127 @@
+/*
+ * \brief  Dispatch latency depending on the number of RPC objects
+ * \author Norman Feske
+ * \date   2013-03-13
+ *
+ * For each number of objects managed by an entrypoint, the benchmark
+ * measures the object lookup performed for each incoming RPC and the round
+ * trip of an RPC to one of the objects.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/printf.h>
+#include <base/rpc_server.h>
+#include <base/rpc_client.h>
+#include <cap_session/connection.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+enum {
+	STACK_SIZE = 8192,
+	LOOKUPS    = 1000000,   /* number of lookups per measurement */
+	CALLS      = 10000,     /* number of RPCs per measurement */
+};
+
+
+/**
+ * RPC interface without any functionality
+ */
+struct Nop
+{
+	virtual void nop() = 0;
+
+	GENODE_RPC(Rpc_nop, void, nop);
+	GENODE_RPC_INTERFACE(Rpc_nop);
+};
+
+
+struct Nop_client : Rpc_client<Nop>
+{
+	Nop_client(Capability<Nop> cap) : Rpc_client<Nop>(cap) { }
+
+	void nop() { call<Rpc_nop>(); }
+};
+
+
+struct Nop_component : Rpc_object<Nop>
+{
+	void nop() { }
+};
+
+
+/**
+ * Pseudo-random numbers for selecting the target objects
+ */
+static unsigned rnd()
+{
+	static unsigned seed = 93186752;
+	seed = seed*1103515245 + 12345;
+	return seed >> 8;
+}
+
+
+static void measure(Rpc_entrypoint &ep, Timer::Session &timer, unsigned num_objects)
+{
+	Nop_component  **objects = (Nop_component **)
+		env()->heap()->alloc(num_objects*sizeof(Nop_component *));
+	addr_t          *ids     = (addr_t *)
+		env()->heap()->alloc(num_objects*sizeof(addr_t));
+
+	for (unsigned i = 0; i < num_objects; i++) {
+		objects[i] = new (env()->heap()) Nop_component;
+		ids[i]     = ep.manage(objects[i]).local_name();
+	}
+
+	/* lookup as performed by the entrypoint for each incoming RPC */
+	unsigned long start = timer.elapsed_ms();
+	for (unsigned i = 0; i < LOOKUPS; i++) {
+		Object_pool<Rpc_object_base>::Guard
+			obj(ep.lookup_and_lock(ids[rnd() % num_objects]));
+		if (!obj)
+			PERR("lookup of managed object failed");
+	}
+	unsigned long const lookup_ms = timer.elapsed_ms() - start;
+
+	/* RPC round trip */
+	start = timer.elapsed_ms();
+	for (unsigned i = 0; i < CALLS; i++)
+		Nop_client(objects[rnd() % num_objects]->cap()).nop();
+	unsigned long const call_ms = timer.elapsed_ms() - start;
+
+	printf("  %6u objects: lookup %5lu ns, RPC %6lu ns\n", num_objects,
+	       lookup_ms*1000000/LOOKUPS, call_ms*1000000/CALLS);
+
+	for (unsigned i = 0; i < num_objects; i++) {
+		ep.dissolve(objects[i]);
+		destroy(env()->heap(), objects[i]);
+	}
+
+	env()->heap()->free(ids, num_objects*sizeof(addr_t));
+	env()->heap()->free(objects, num_objects*sizeof(Nop_component *));
+}
+
+
+int main(int, char **)
+{
+	printf("--- object-pool benchmark started ---\n");
+
+	static Timer::Connection timer;
+	static Cap_connection    cap;
+	static Rpc_entrypoint    ep(&cap, STACK_SIZE, "nop_ep");
+
+	measure(ep, timer, 10);
+	measure(ep, timer, 1000);
+	measure(ep, timer, 100000);
+
+	printf("--- object-pool benchmark finished ---\n");
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-object_pool_bench
+SRC_CC = main.cc
+LIBS   = base
@@ -0,0 +1,116 @@
+/*
+ * \brief  Latency and cost of signal delivery
+ * \author Norman Feske
+ * \date   2013-03-13
+ *
+ * Two threads pass a signal back and forth. Each thread uses a signal
+ * receiver of its own. The benchmark also measures the cost of submitting
+ * signals that are not waited for.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/printf.h>
+#include <base/signal.h>
+#include <base/thread.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+enum {
+	ROUNDS  = 20000,    /* number of ping-pong round trips */
+	SUBMITS = 100000,   /* number of submitted signals */
+};
+
+
+/**
+ * Thread that answers each signal with a signal
+ */
+class Pong : public Thread<8192>
+{
+	private:
+
+		Signal_receiver           _sig_rec;
+		Signal_context            _sig_ctx;
+		Signal_context_capability _sig_cap;
+		Signal_transmitter        _ping;
+		unsigned const            _rounds;
+
+	public:
+
+		Pong(Signal_context_capability ping, unsigned rounds)
+		:
+			Thread<8192>("pong"),
+			_sig_cap(_sig_rec.manage(&_sig_ctx)), _ping(ping), _rounds(rounds)
+		{ }
+
+		~Pong() { _sig_rec.dissolve(&_sig_ctx); }
+
+		Signal_context_capability cap() const { return _sig_cap; }
+
+		void entry()
+		{
+			for (unsigned i = 0; i < _rounds; i++) {
+				_sig_rec.wait_for_signal();
+				_ping.submit();
+			}
+		}
+};
+
+
+int main(int, char **)
+{
+	printf("--- signal benchmark started ---\n");
+
+	static Timer::Connection timer;
+
+	Signal_receiver                 sig_rec;
+	Signal_context                  sig_ctx;
+	Signal_context_capability const sig_cap = sig_rec.manage(&sig_ctx);
+
+	/* ping-pong between two threads */
+	{
+		Pong pong(sig_cap, ROUNDS);
+		pong.start();
+
+		Signal_transmitter transmitter(pong.cap());
+
+		unsigned long const start = timer.elapsed_ms();
+		for (unsigned i = 0; i < ROUNDS; i++) {
+			transmitter.submit();
+			sig_rec.wait_for_signal();
+		}
+		unsigned long const ms = timer.elapsed_ms() - start;
+
+		pong.join();
+
+		printf("  round trip: %6lu ns\n", ms*1000000/ROUNDS);
+	}
+
+	/* signals submitted without waiting are accumulated at the receiver */
+	{
+		Signal_transmitter transmitter(sig_cap);
+
+		unsigned long const start = timer.elapsed_ms();
+		for (unsigned i = 0; i < SUBMITS; i++)
+			transmitter.submit();
+		unsigned long const ms = timer.elapsed_ms() - start;
+
+		unsigned num = 0;
+		while (num < SUBMITS)
+			num += sig_rec.wait_for_signal().num();
+
+		printf("  submit:     %6lu ns\n", ms*1000000/SUBMITS);
+	}
+
+	sig_rec.dissolve(&sig_ctx);
+
+	printf("--- signal benchmark finished ---\n");
+	return 0;
+}
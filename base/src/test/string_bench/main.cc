@@ -0,0 +1,143 @@
+/*
+ * \brief  Throughput of Genode::memcpy, memset, and memcmp
+ * \author Sebastian Sumpf
+ * \date   2013-03-06
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/printf.h>
+#include <util/string.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+enum {
+	MIN_SIZE    = 16,
+	MAX_SIZE    = 16*1024*1024,
+	BYTES_TOTAL = 256*1024*1024,   /* amount of data processed per size */
+	MAX_OFFSET  = 16,              /* misalignment used for validation */
+};
+
+
+/**
+ * Check results against byte-wise operations for all alignments
+ */
+static bool validate(char *src, char *dst)
+{
+	for (size_t size = 0; size < 300; size += 7)
+		for (unsigned s_off = 0; s_off < MAX_OFFSET; s_off++)
+			for (unsigned d_off = 0; d_off < MAX_OFFSET; d_off++) {
+
+				for (size_t i = 0; i < size + 2*MAX_OFFSET; i++) {
+					src[i] = (char)(i*7 + 1);
+					dst[i] = 0;
+				}
+
+				memcpy(dst + d_off, src + s_off, size);
+
+				for (size_t i = 0; i < size; i++)
+					if (dst[d_off + i] != src[s_off + i]) {
+						PERR("memcpy: size=%zd s_off=%u d_off=%u", size, s_off, d_off);
+						return false;
+					}
+
+				if (dst[d_off + size] != 0 || (d_off && dst[d_off - 1] != 0)) {
+					PERR("memcpy exceeded bounds: size=%zd", size);
+					return false;
+				}
+
+				if (memcmp(dst + d_off, src + s_off, size) != 0) {
+					PERR("memcmp: size=%zd s_off=%u d_off=%u", size, s_off, d_off);
+					return false;
+				}
+
+				if (size) {
+					dst[d_off + size - 1]++;
+					if (memcmp(dst + d_off, src + s_off, size) == 0) {
+						PERR("memcmp missed difference: size=%zd", size);
+						return false;
+					}
+					dst[d_off + size - 1]--;
+				}
+
+				memset(dst + d_off, 0x5a, size);
+
+				for (size_t i = 0; i < size; i++)
+					if (dst[d_off + i] != 0x5a) {
+						PERR("memset: size=%zd d_off=%u", size, d_off);
+						return false;
+					}
+
+				if (dst[d_off + size] != 0) {
+					PERR("memset exceeded bounds: size=%zd", size);
+					return false;
+				}
+			}
+	return true;
+}
+
+
+static void print_rate(char const *op, size_t size, unsigned long ms)
+{
+	unsigned long const kib = BYTES_TOTAL/1024;
+
+	if (ms == 0)
+		printf("  %s size %8zd: too fast to measure\n", op, size);
+	else
+		printf("  %s size %8zd: %6lu MiB/s\n", op, size, kib*1000/1024/ms);
+}
+
+
+int main(int, char **)
+{
+	printf("--- string benchmark started ---\n");
+
+	static Timer::Connection timer;
+
+	char *src = (char *)env()->heap()->alloc(MAX_SIZE + MAX_OFFSET);
+	char *dst = (char *)env()->heap()->alloc(MAX_SIZE + MAX_OFFSET);
+
+	if (!validate(src, dst)) {
+		PERR("validation failed");
+		return -1;
+	}
+	printf("validation succeeded\n");
+
+	/* touch buffers to exclude page faults from the measurement */
+	memset(src, 1, MAX_SIZE);
+	memset(dst, 1, MAX_SIZE);
+
+	for (size_t size = MIN_SIZE; size <= MAX_SIZE; size *= 4) {
+
+		unsigned long const rounds = BYTES_TOTAL / size;
+		unsigned long start;
+		int volatile result = 0;
+
+		start = timer.elapsed_ms();
+		for (unsigned long i = 0; i < rounds; i++)
+			memcpy(dst, src, size);
+		print_rate("memcpy", size, timer.elapsed_ms() - start);
+
+		start = timer.elapsed_ms();
+		for (unsigned long i = 0; i < rounds; i++)
+			memset(dst, (int)i, size);
+		print_rate("memset", size, timer.elapsed_ms() - start);
+
+		memcpy(dst, src, size);
+		start = timer.elapsed_ms();
+		for (unsigned long i = 0; i < rounds; i++)
+			result += memcmp(dst, src, size);
+		print_rate("memcmp", size, timer.elapsed_ms() - start);
+	}
+
+	printf("--- string benchmark finished ---\n");
+	return 0;
+}
@@ -28,6 +28,24 @@
 template <typename CELL>
 class Cell_array
 {
+	public:
+
+		/**
+		 * Scroll operation not yet reflected by the pixel representation
+		 *
+		 * Consecutive scroll operations in the same direction within the
+		 * same region accumulate. The renderer can apply them by moving
+		 * the pixels of the region instead of redrawing all of its lines.
+		 */
+		struct Scroll
+		{
+			int  start, end;  /* scroll region */
+			int  num_lines;   /* 0 if no scroll operation is pending */
+			bool up;
+
+			Scroll() : start(0), end(0), num_lines(0), up(false) { }
+		};
+
 	private:
 
 		unsigned           _num_cols;
@@ -35,6 +53,8 @@ class Cell_array
 		Genode::Allocator *_alloc;
 		CELL             **_array;
 		bool              *_line_dirty;
+		bool             **_cell_dirty;
+		Scroll             _scroll;
 
 		typedef CELL *Char_cell_line;
 
@@ -47,27 +67,70 @@ class Cell_array
 		void _mark_lines_as_dirty(int start, int end)
 		{
 			for (int line = start; line <= end; line++)
-				_line_dirty[line] = true;
+				mark_line_as_dirty(line);
 		}
 
-		void _scroll_vertically(int start, int end, bool up)
+		/**
+		 * Rotate lines of the scroll region by one line
+		 */
+		template <typename T>
+		static void _rotate(T *lines, int start, int end, bool up)
 		{
-			/* rotate lines of the scroll region */
-			Char_cell_line yanked_line = _array[up ? start : end];
+			T yanked_line = lines[up ? start : end];
 
 			if (up) {
 				for (int line = start; line <= end - 1; line++)
-					_array[line] = _array[line + 1];
+					lines[line] = lines[line + 1];
 			} else {
 				for (int line = end; line >= start + 1; line--)
-					_array[line] = _array[line - 1];
+					lines[line] = lines[line - 1];
+			}
+
+			lines[up ? end : start] = yanked_line;
+		}
+
+		void _record_scroll(int start, int end, bool up)
+		{
+			Scroll &s = _scroll;
+
+			if (s.num_lines && s.start == start && s.end == end && s.up == up) {
+				s.num_lines++;
+				return;
 			}
 
-			_clear_line(yanked_line);
+			/*
+			 * A different scroll operation is pending, which cannot be
+			 * combined with the new one. Redraw the affected region instead.
+			 */
+			if (s.num_lines)
+				_mark_lines_as_dirty(s.start, s.end);
+
+			s.start = start, s.end = end, s.up = up, s.num_lines = 1;
+		}
 
-			_array[up ? end: start] = yanked_line;
+		void _scroll_vertically(int start, int end, bool up)
+		{
+			_record_scroll(start, end, up);
+
+			/*
+			 * The dirty state moves along with the lines because the
+			 * pixels of the lines are moved when applying the scroll
+			 * operation.
+			 */
+			_rotate(_array,      start, end, up);
+			_rotate(_cell_dirty, start, end, up);
+			_rotate(_line_dirty, start, end, up);
+
+			_clear_line(_array[up ? end : start]);
+
+			/* the pixels of a region scrolled by its full height are stale */
+			if (_scroll.num_lines > end - start) {
+				_mark_lines_as_dirty(start, end);
+				_scroll.num_lines = 0;
+				return;
+			}
 
-			_mark_lines_as_dirty(start, end);
+			mark_line_as_dirty(up ? end : start);
 		}
 
 	public:
@@ -87,6 +150,13 @@ class Cell_array
 
 			for (unsigned i = 0; i < num_lines; i++)
 				_array[i] = new (alloc) CELL[num_cols];
+
+			_cell_dirty = new (alloc) bool *[num_lines];
+			for (unsigned i = 0; i < num_lines; i++) {
+				_cell_dirty[i] = new (alloc) bool[num_cols];
+				for (unsigned j = 0; j < num_cols; j++)
+					_cell_dirty[i][j] = false;
+			}
 		}
 
 		/* XXX destructor is missing */
@@ -94,6 +164,7 @@ class Cell_array
 		void set_cell(int column, int line, CELL cell)
 		{
 			_array[line][column] = cell;
+			_cell_dirty[line][column] = true;
 			_line_dirty[line] = true;
 		}
 
@@ -102,15 +173,29 @@ class Cell_array
 			return _array[line][column];
 		}
 
+		/**
+		 * Return true if any cell of the line is dirty
+		 */
 		bool line_dirty(int line) { return _line_dirty[line]; }
 
+		bool cell_dirty(int column, int line) { return _cell_dirty[line][column]; }
+
 		void mark_line_as_clean(int line)
 		{
+			if (!_line_dirty[line])
+				return;
+
+			for (unsigned col = 0; col < _num_cols; col++)
+				_cell_dirty[line][col] = false;
+
 			_line_dirty[line] = false;
 		}
 
 		void mark_line_as_dirty(int line)
 		{
+			for (unsigned col = 0; col < _num_cols; col++)
+				_cell_dirty[line][col] = true;
+
 			_line_dirty[line] = true;
 		}
 
@@ -124,6 +209,16 @@ class Cell_array
 			_scroll_vertically(region_start, region_end, false);
 		}
 
+		/**
+		 * Return pending scroll operation
+		 */
+		Scroll const &scroll() const { return _scroll; }
+
+		/**
+		 * Mark pending scroll operation as applied to the pixels
+		 */
+		void mark_scroll_as_done() { _scroll.num_lines = 0; }
+
 		void clear(int region_start, int region_end)
 		{
 			for (int line = region_start; line <= region_end; line++)
@@ -141,8 +236,10 @@ class Cell_array
 			else
 				cell.clear_cursor();
 
-			if (mark_dirty)
+			if (mark_dirty) {
+				_cell_dirty[pos.y][pos.x] = true;
 				_line_dirty[pos.y] = true;
+			}
 		}
 
 		unsigned num_cols()  { return _num_cols; }
@@ -94,8 +94,14 @@ class Char_cell_array_character_screen : public Terminal::Character_screen
 			:
 				cs(cs), old_cursor_pos(cs._cursor_pos)
 			{
-				/* temporarily remove cursor */
-				cs._char_cell_array.cursor(old_cursor_pos, false);
+				/*
+				 * Temporarily remove cursor
+				 *
+				 * The cell is marked as dirty because its pixels may be
+				 * moved by a scroll operation while the cursor is
+				 * removed.
+				 */
+				cs._char_cell_array.cursor(old_cursor_pos, false, true);
 			}
 
 			~Cursor_guard()
@@ -203,6 +209,40 @@ class Char_cell_array_character_screen : public Terminal::Character_screen
 			}
 		}
 
+		void output_run(unsigned char const *s, unsigned len)
+		{
+			while (len) {
+
+				if (_cursor_pos.x >= _boundary.width) {
+					_carriage_return();
+					_line_feed();
+				}
+
+				/* fill the current line with a single cursor update */
+				{
+					Cursor_guard guard(*this);
+
+					unsigned const n = Genode::min(len,
+						(unsigned)(_boundary.width - _cursor_pos.x));
+
+					Char_cell cell(0, Font_face::REGULAR,
+					               _color_index, _inverse, _highlight);
+
+					for (unsigned i = 0; i < n; i++, _cursor_pos.x++) {
+						cell.ascii = s[i];
+						_char_cell_array.set_cell(_cursor_pos.x, _cursor_pos.y, cell);
+					}
+					s   += n;
+					len -= n;
+				}
+
+				if (_cursor_pos.x >= _boundary.width) {
+					_carriage_return();
+					_line_feed();
+				}
+			}
+		}
+
 		void civis()
 		{
 			_cursor_visibility = CURSOR_INVISIBLE;
@@ -264,6 +304,9 @@ class Char_cell_array_character_screen : public Terminal::Character_screen
 
 		void dl(int num_lines)
 		{
+			if (_cursor_pos.y > _region_end)
+				return;
+
 			/* delete number of lines */
 			for (int i = 0; i < num_lines; i++)
 				_char_cell_array.scroll_up(_cursor_pos.y, _region_end);
@@ -25,6 +25,19 @@ namespace Terminal {
 	{
 		virtual void output(Character c) = 0;
 
+		/**
+		 * Output run of printable characters
+		 *
+		 * The decoder passes runs of characters between 0x20 and 0x7e to
+		 * this function. Screens may override it to process the run as a
+		 * whole.
+		 */
+		virtual void output_run(unsigned char const *s, unsigned len)
+		{
+			for (; len--; s++)
+				output(Character(*s));
+		}
+
 
 		/*******************
 		 ** VT Operations **
@@ -39,6 +39,15 @@ namespace Terminal {
 				return (digit(c) >= 0);
 			}
 
+			/**
+			 * Return true if character is output as glyph without
+			 * further interpretation
+			 */
+			static inline bool printable(unsigned char c)
+			{
+				return c >= 0x20 && c < 0x7f;
+			}
+
 			/**
 			 * Return true if number starts with the specified digit
 			 *
@@ -469,6 +478,32 @@ namespace Terminal {
 				 || ((_escape_stack.num_elem() == 7) && _handle_esc_seq_7()))
 					_enter_state_idle();
 			};
+
+			/**
+			 * Insert sequence of characters
+			 *
+			 * Runs of printable characters outside of escape sequences are
+			 * passed to the character screen at once.
+			 */
+			void insert(unsigned char const *s, unsigned len)
+			{
+				while (len) {
+
+					unsigned run = 0;
+					if (_state == STATE_IDLE)
+						for (; run < len && printable(s[run]); run++);
+
+					if (run) {
+						_screen.output_run(s, run);
+						s   += run;
+						len -= run;
+						continue;
+					}
+
+					insert(*s++);
+					len--;
+				}
+			}
 	};
 }
 
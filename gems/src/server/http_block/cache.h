@@ -0,0 +1,417 @@
+/*
+ * \brief  Cache of remote-file content with sequential read-ahead
+ * \author Norman Feske
+ * \date   2013-03-16
+ *
+ * The remote file is cached in chunks of 'CHUNK_SIZE' bytes. Adjacent
+ * chunks missing in the cache are fetched with a single range request. If
+ * the client reads the file sequentially, the chunks following the read
+ * range are fetched in the background by the read-ahead thread. If no free
+ * chunk is left, the least recently used chunk is reused.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <base/lock.h>
+#include <base/printf.h>
+#include <base/semaphore.h>
+#include <base/thread.h>
+#include <util/misc_math.h>
+#include <util/string.h>
+
+/* local includes */
+#include "http.h"
+
+namespace Block {
+
+	class Cache
+	{
+		public:
+
+			enum {
+				CHUNK_SIZE = 64*1024,
+				MAX_RUN    = 16,      /* maximum chunks per range request */
+			};
+
+		private:
+
+			enum {
+				NUM_BUCKETS = 64,     /* must be a power of two */
+				INVALID     = -1,
+			};
+
+			enum State { FREE, LOADING, VALID };
+
+			/**
+			 * Meta data of a chunk
+			 *
+			 * Valid chunks are linked into a hash bucket for the lookup and
+			 * into the LRU list, which starts with the most recently used
+			 * chunk. Loading chunks are in their hash bucket only.
+			 */
+			struct Chunk
+			{
+				Genode::size_t index;  /* chunk number within the file */
+				State          state;
+				int            bucket_next;
+				int            lru_prev, lru_next;
+
+				Chunk() : index(0), state(FREE), bucket_next(INVALID),
+				          lru_prev(INVALID), lru_next(INVALID) { }
+			};
+
+			/**
+			 * Thread that fetches chunks ahead of sequential reads
+			 */
+			class Read_ahead_thread : public Genode::Thread<8192>
+			{
+				private:
+
+					Cache             &_cache;
+					Genode::Lock       _lock;
+					Genode::Semaphore  _sem;
+					Genode::size_t     _first, _count;  /* pending read-ahead */
+
+				public:
+
+					Read_ahead_thread(Cache &cache)
+					: Genode::Thread<8192>("read_ahead"), _cache(cache),
+					  _first(0), _count(0) { }
+
+					/**
+					 * Request read-ahead, replaces a pending request
+					 */
+					void request(Genode::size_t first, Genode::size_t count)
+					{
+						Genode::Lock::Guard guard(_lock);
+						bool const pending = _count;
+						_first = first;
+						_count = count;
+						if (!pending)
+							_sem.up();
+					}
+
+					void entry()
+					{
+						for (;;) {
+							_sem.down();
+
+							Genode::size_t first, count;
+							{
+								Genode::Lock::Guard guard(_lock);
+								first  = _first;
+								count  = _count;
+								_count = 0;
+							}
+
+							/* fetch missing chunks in runs, skip present ones */
+							try {
+								while (count) {
+									Genode::size_t const n =
+										Genode::max(_cache._fetch(first, count, false),
+										            (Genode::size_t)1);
+									first += n;
+									count -= Genode::min(n, count);
+								}
+							} catch (Http::Exception) {
+								PWRN("read-ahead failed");
+							}
+						}
+					}
+			};
+
+			Http              &_http;
+			Genode::Allocator &_alloc;
+			unsigned const     _num_chunks;
+			Genode::size_t const _num_file_chunks;
+			Genode::size_t const _read_ahead;      /* chunks */
+			Chunk             *_chunks;
+			char              *_data;
+
+			Genode::Lock       _lock;
+			int                _buckets[NUM_BUCKETS];
+			int                _lru_first, _lru_last;
+			int                _free_first;        /* chunks freed after errors */
+			unsigned           _num_used;
+			Genode::size_t     _seq_end;           /* end of last read */
+
+			/* threads waiting for a loading chunk */
+			Genode::Semaphore  _loaded_sem;
+			unsigned           _loaded_waiters;
+
+			Read_ahead_thread  _read_ahead_thread;
+
+			static unsigned _hash(Genode::size_t index) {
+				return (index ^ (index >> 6)) & (NUM_BUCKETS - 1); }
+
+			char *_chunk_data(int i) { return _data + (Genode::size_t)i*CHUNK_SIZE; }
+
+			void _lru_remove(int i)
+			{
+				Chunk &c = _chunks[i];
+
+				if (c.lru_prev != INVALID) _chunks[c.lru_prev].lru_next = c.lru_next;
+				else                       _lru_first = c.lru_next;
+
+				if (c.lru_next != INVALID) _chunks[c.lru_next].lru_prev = c.lru_prev;
+				else                       _lru_last = c.lru_prev;
+			}
+
+			void _lru_insert_first(int i)
+			{
+				Chunk &c = _chunks[i];
+
+				c.lru_prev = INVALID;
+				c.lru_next = _lru_first;
+
+				if (_lru_first != INVALID) _chunks[_lru_first].lru_prev = i;
+				else                       _lru_last = i;
+
+				_lru_first = i;
+			}
+
+			void _bucket_remove(int i)
+			{
+				int *link = &_buckets[_hash(_chunks[i].index)];
+				for (; *link != i; link = &_chunks[*link].bucket_next);
+
+				*link = _chunks[i].bucket_next;
+			}
+
+			int _lookup(Genode::size_t index)
+			{
+				int i = _buckets[_hash(index)];
+				for (; i != INVALID && _chunks[i].index != index; i = _chunks[i].bucket_next);
+				return i;
+			}
+
+			/**
+			 * Return unused chunk, evict the least recently used one if needed
+			 *
+			 * \return  chunk, or INVALID if all chunks are loading
+			 */
+			int _alloc_chunk()
+			{
+				if (_free_first != INVALID) {
+					int const i = _free_first;
+					_free_first = _chunks[i].bucket_next;
+					return i;
+				}
+
+				if (_num_used < _num_chunks)
+					return _num_used++;
+
+				int const i = _lru_last;
+				if (i == INVALID)
+					return INVALID;
+
+				_lru_remove(i);
+				_bucket_remove(i);
+				_chunks[i].state = FREE;
+				return i;
+			}
+
+			void _wake_loaded_waiters()
+			{
+				for (; _loaded_waiters; _loaded_waiters--)
+					_loaded_sem.up();
+			}
+
+			/**
+			 * Fetch run of missing chunks starting at 'first'
+			 *
+			 * \param max_count  maximum number of chunks to fetch
+			 * \param wait       block if the first chunk is being loaded
+			 *
+			 * \return  number of chunks fetched, 0 if the first chunk is
+			 *          present or being loaded
+			 *
+			 * \throw Http::Exception
+			 */
+			Genode::size_t _fetch(Genode::size_t first, Genode::size_t max_count, bool wait)
+			{
+				int            slots[MAX_RUN];
+				char          *bufs[MAX_RUN];
+				Genode::size_t count = 0;
+
+				if (first >= _num_file_chunks)
+					return 0;
+
+				max_count = Genode::min(max_count, (Genode::size_t)MAX_RUN);
+				max_count = Genode::min(max_count, _num_file_chunks - first);
+
+				{
+					Genode::Lock::Guard guard(_lock);
+
+					for (; count < max_count; count++) {
+						Genode::size_t const index = first + count;
+						if (_lookup(index) != INVALID)
+							break;
+
+						int const i = _alloc_chunk();
+						if (i == INVALID)
+							break;
+
+						Chunk &c = _chunks[i];
+						c.index       = index;
+						c.state       = LOADING;
+						c.bucket_next = _buckets[_hash(index)];
+						_buckets[_hash(index)] = i;
+
+						slots[count] = i;
+						bufs[count]  = _chunk_data(i);
+					}
+
+					/*
+					 * Nothing to fetch. If the first chunk is being loaded by
+					 * another thread, or all chunks are being loaded, wait
+					 * for a load to complete.
+					 */
+					if (!count) {
+						int const i = _lookup(first);
+						if (!wait || (i != INVALID && _chunks[i].state == VALID))
+							return 0;
+
+						_loaded_waiters++;
+					}
+				}
+
+				if (!count) {
+					_loaded_sem.down();
+					return 0;
+				}
+
+				Genode::size_t const offset = first*CHUNK_SIZE;
+				Genode::size_t const size   = Genode::min(count*CHUNK_SIZE,
+				                                          _http.file_size() - offset);
+				bool failed = false;
+				try {
+					_http.cmd_get(offset, size, bufs, CHUNK_SIZE);
+				} catch (Http::Exception) {
+					failed = true;
+				}
+
+				Genode::Lock::Guard guard(_lock);
+
+				for (Genode::size_t n = 0; n < count; n++) {
+					int const i = slots[n];
+
+					if (failed) {
+						_bucket_remove(i);
+						_chunks[i].state       = FREE;
+						_chunks[i].bucket_next = _free_first;
+						_free_first            = i;
+						continue;
+					}
+
+					_chunks[i].state = VALID;
+					_lru_insert_first(i);
+				}
+
+				_wake_loaded_waiters();
+
+				if (failed)
+					throw Http::Socket_error();
+
+				return count;
+			}
+
+		public:
+
+			/**
+			 * Constructor
+			 *
+			 * \param size        cache size in bytes
+			 * \param read_ahead  number of bytes to fetch ahead of
+			 *                    sequential reads
+			 */
+			Cache(Http &http, Genode::Allocator &alloc,
+			      Genode::size_t size, Genode::size_t read_ahead)
+			:
+				_http(http), _alloc(alloc),
+				_num_chunks(Genode::max(size / CHUNK_SIZE, (Genode::size_t)2*MAX_RUN)),
+				_num_file_chunks((http.file_size() + CHUNK_SIZE - 1) / CHUNK_SIZE),
+				_read_ahead(read_ahead / CHUNK_SIZE),
+				_chunks(new (&alloc) Chunk[_num_chunks]),
+				_data((char *)alloc.alloc((Genode::size_t)_num_chunks*CHUNK_SIZE)),
+				_lru_first(INVALID), _lru_last(INVALID), _free_first(INVALID),
+				_num_used(0),
+				_seq_end(~0UL), _loaded_sem(0), _loaded_waiters(0),
+				_read_ahead_thread(*this)
+			{
+				for (unsigned i = 0; i < NUM_BUCKETS; i++)
+					_buckets[i] = INVALID;
+
+				if (_read_ahead)
+					_read_ahead_thread.start();
+			}
+
+			/**
+			 * Read range of the remote file
+			 *
+			 * \throw Http::Exception
+			 */
+			void read(Genode::size_t offset, Genode::size_t size, char *dst)
+			{
+				if (offset + size > _http.file_size())
+					throw Http::Server_error();
+
+				Genode::size_t const end  = offset + size;
+				Genode::size_t const last = size ? (end - 1) / CHUNK_SIZE : 0;
+
+				bool sequential;
+				{
+					Genode::Lock::Guard guard(_lock);
+					sequential = (offset == _seq_end);
+					_seq_end   = end;
+				}
+
+				while (offset < end) {
+
+					Genode::size_t const index = offset / CHUNK_SIZE;
+
+					{
+						Genode::Lock::Guard guard(_lock);
+
+						int const i = _lookup(index);
+						if (i != INVALID && _chunks[i].state == VALID) {
+
+							Genode::size_t const chunk_offset = offset % CHUNK_SIZE;
+							Genode::size_t const n = Genode::min(end - offset,
+							                                     CHUNK_SIZE - chunk_offset);
+
+							Genode::memcpy(dst, _chunk_data(i) + chunk_offset, n);
+							dst    += n;
+							offset += n;
+
+							/* mark chunk as most recently used */
+							if (i != _lru_first) {
+								_lru_remove(i);
+								_lru_insert_first(i);
+							}
+							continue;
+						}
+					}
+
+					/* fetch the missing chunks of the read range at once */
+					_fetch(index, last - index + 1, true);
+				}
+
+				/* fetch the chunks following a sequential read in the background */
+				if (sequential && _read_ahead && last + 1 < _num_file_chunks)
+					_read_ahead_thread.request(last + 1, _read_ahead);
+			}
+	};
+}
+
+#endif /* _CACHE_H_ */
@@ -34,8 +34,8 @@ enum {
 	HTTP_SUCC_OK      = 200,
 	HTTP_SUCC_PARTIAL = 206,
 
-	/* Size of our local buffer */
-	HTTP_BUF = 2048,
+	/* Size of the local buffer of each connection */
+	HTTP_BUF = 4096,
 };
 
 /* Tokenizer policy */
@@ -50,169 +50,321 @@ struct Scanner_policy_file
 typedef ::Genode::Token<Scanner_policy_file> Http_token;
 
 
-void Http::cmd_head()
+/**
+ * Return true if header line starts with the field 'name'
+ *
+ * Field names are case insensitive.
+ */
+static bool header_field(char const *line, size_t len, char const *name)
 {
-	const char *http_templ = "%s %s HTTP/1.1\r\n"
-	                         "Host: %s\r\n"
-	                         "\r\n";
-
-	int length = snprintf(_http_buf, HTTP_BUF, http_templ, "HEAD", _path, _host);
+	size_t i = 0;
+	for (; name[i]; i++) {
+		if (i >= len)
+			return false;
 
-	if (lwip_write(_fd, _http_buf, length) != length) {
-		PERR("Write error");
-		throw Http::Socket_error();
-	}
-}
+		char c = line[i];
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
 
+		char n = name[i];
+		if (n >= 'A' && n <= 'Z')
+			n += 'a' - 'A';
 
-void Http::connect()
-{
-	_fd = lwip_socket(AF_INET, SOCK_STREAM, 0);
-	if (_fd < 0) {
-		PERR("No socket avaiable");
-		throw Http::Socket_error();
-	}
-
-	if (lwip_connect(_fd, _info->ai_addr, sizeof(*(_info->ai_addr))) < 0) {
-		PERR("Connect failed");
-		throw Http::Socket_error();
+		if (c != n)
+			return false;
 	}
+	return i < len && line[i] == ':';
 }
 
 
-void Http::reconnect(){ lwip_close(_fd); connect(); }
+/**
+ * Persistent connection to the host
+ *
+ * The connection reads from the socket in large chunks. Header data is
+ * parsed from the local buffer, whereas large response bodies are read
+ * directly into their destination.
+ */
+class Http::Connection
+{
+	private:
+
+		struct addrinfo *_info;
+		int              _fd;
+		char             _buf[HTTP_BUF];
+		size_t           _pos, _len;    /* unconsumed data in '_buf' */
+		bool             _reused;       /* response was received before */
+
+		/**
+		 * Read more data from socket into the buffer
+		 */
+		void _fill()
+		{
+			if (_pos) {
+				Genode::memmove(_buf, _buf + _pos, _len - _pos);
+				_len -= _pos;
+				_pos  = 0;
+			}
+
+			if (_len == HTTP_BUF) {
+				PERR("Buffer overflow");
+				throw Http::Socket_error();
+			}
 
+			int part = lwip_read(_fd, _buf + _len, HTTP_BUF - _len);
+			if (part == 0)
+				throw Http::Socket_closed();
+			if (part < 0)
+				throw Http::Socket_error();
 
-void Http::resolve_uri()
-{
-	struct addrinfo *info;
-	if (lwip_getaddrinfo(_host, _port, 0, &info)) {
-		PERR("Error: Host %s not found", _host);
-		throw Http::Uri_error();
-	}
+			_len += part;
+		}
 
-	env()->heap()->alloc(sizeof(struct addrinfo), &_info);
-	Genode::memcpy(_info, info, sizeof(struct addrinfo));
-}
+	public:
 
+		Connection(struct addrinfo *info)
+		: _info(info), _fd(-1), _pos(0), _len(0), _reused(false) { }
 
-Genode::size_t Http::read_header()
-{
-	bool header = true; size_t i = 0;
+		~Connection() { close(); }
 
-	while (header) {
-		if (!lwip_read(_fd, &_http_buf[i], 1))
-			throw Http::Socket_closed();
+		void connect()
+		{
+			_fd = lwip_socket(AF_INET, SOCK_STREAM, 0);
+			if (_fd < 0) {
+				PERR("No socket avaiable");
+				throw Http::Socket_error();
+			}
 
-		/* DEBUG: Genode::printf("%c", _http_buf[i]); */
+			if (lwip_connect(_fd, _info->ai_addr, sizeof(*(_info->ai_addr))) < 0) {
+				PERR("Connect failed");
+				close();
+				throw Http::Socket_error();
+			}
+		}
 
-		if (i >= 3 && _http_buf[i - 3] == '\r' && _http_buf[i - 2] == '\n'
-		 && _http_buf[i - 1] == '\r' && _http_buf[i - 0] == '\n')
-			header = false;
+		void close()
+		{
+			if (_fd >= 0)
+				lwip_close(_fd);
 
-		if (++i >= HTTP_BUF) {
-			PERR("Buffer overflow");
-			throw Http::Socket_error();
+			_fd     = -1;
+			_pos    = _len = 0;
+			_reused = false;
 		}
-	}
 
-	/* scan for status code */
-	Http_token t(_http_buf, i);
-	for (int count = 0;; t = t.next()) {
+		bool connected() const { return _fd >= 0; }
 
-		if (t.type() != Http_token::IDENT)
-			continue;
+		/**
+		 * Return true if a response was received via the connection
+		 *
+		 * The host may close idle persistent connections at any time. A
+		 * request that fails on such a connection is worth a retry.
+		 */
+		bool reused() const { return _reused; }
 
-		if (count) {
-			ascii_to(t.start(), &_http_ret);
-			break;
+		void write(char const *data, int length)
+		{
+			if (lwip_write(_fd, data, length) != length) {
+				PERR("Write error");
+				throw Http::Socket_error();
+			}
 		}
 
-		count++;
-	}
+		/**
+		 * Read HTTP header
+		 *
+		 * \param status          resulting server-status code
+		 * \param content_length  resulting length of the body
+		 * \param close           true if the host closes the connection
+		 *                        after the response
+		 */
+		void read_header(unsigned &status, size_t &content_length, bool &close)
+		{
+			/* search the end of the header, read more data as needed */
+			size_t end = _pos, scanned = _pos;
+			for (;;) {
+				for (; scanned + 3 < _len; scanned++)
+					if (_buf[scanned]     == '\r' && _buf[scanned + 1] == '\n'
+					 && _buf[scanned + 2] == '\r' && _buf[scanned + 3] == '\n')
+						break;
+
+				if (scanned + 3 < _len) {
+					end = scanned + 4;
+					break;
+				}
+
+				size_t const consumed = _pos;
+				_fill();
+				scanned -= consumed;
+			}
+
+			char const * const header = _buf + _pos;
+			size_t       const len    = end - _pos;
+
+			/* scan for status code */
+			status = 0;
+			Http_token t(header, len);
+			for (int count = 0; t; t = t.next()) {
+
+				if (t.type() != Http_token::IDENT)
+					continue;
+
+				if (count) {
+					ascii_to(t.start(), &status);
+					break;
+				}
+
+				count++;
+			}
+
+			/* scan header fields */
+			content_length = 0;
+			close          = false;
+			for (size_t i = 0; i < len; ) {
+
+				char const *line = header + i;
+				size_t line_len = 0;
+				for (; i + line_len < len && line[line_len] != '\n'; line_len++);
+				i += line_len + 1;
+
+				if (header_field(line, line_len, "Content-Length")) {
+					char const *v = line + sizeof("Content-Length");
+					for (; *v == ' '; v++);
+					ascii_to(v, &content_length);
+				}
+
+				if (header_field(line, line_len, "Connection")) {
+					char const *v = line + sizeof("Connection");
+					for (; *v == ' '; v++);
+					close = !Genode::strcmp(v, "close", 5);
+				}
+			}
+
+			_pos    = end;
+			_reused = true;
+		}
 
-	return i;
-}
+		/**
+		 * Read 'size' bytes into buffer
+		 */
+		void read(void *buf, size_t size)
+		{
+			/* take buffered data first */
+			size_t buf_fill = min(size, _len - _pos);
+			Genode::memcpy(buf, _buf + _pos, buf_fill);
+			_pos += buf_fill;
 
+			while (buf_fill < size) {
 
-void Http::get_capacity()
-{
-	cmd_head();
-	size_t  len = read_header();
-	char buf[32];
-	Http_token t(_http_buf, len);
+				int part;
+				if ((part = lwip_read(_fd, (void *)((addr_t)buf + buf_fill),
+				                      size - buf_fill)) <= 0) {
+					PERR("Error: Reading data (%d)", errno);
+					throw Http::Socket_error();
+				}
 
-	bool key = false;
-	while (t) {
+				buf_fill += part;
+			}
 
-		if (t.type() != Http_token::IDENT) {
-			t = t.next();
-			continue;
+			if (verbose)
+				PDBG("Read %zu/%zu", buf_fill, size);
 		}
+};
 
-		if (key) {
-			ascii_to(t.start(), &_size);
 
-			if (verbose)
-				PDBG("File size: %zu bytes", _size);
+Http::Connection *Http::alloc_connection()
+{
+	_free_sem.down();
+
+	Lock::Guard guard(_free_lock);
+	return _free[--_num_free];
+}
 
-			break;
-		}
 
-		t.string(buf, 32);
+void Http::free_connection(Http::Connection *c)
+{
+	{
+		Lock::Guard guard(_free_lock);
+		_free[_num_free++] = c;
+	}
+	_free_sem.up();
+}
 
-		if (!Genode::strcmp(buf, "Content-Length", 32))
-			key = true;
 
-		t = t.next();
+void Http::resolve_uri()
+{
+	struct addrinfo *info;
+	if (lwip_getaddrinfo(_host, _port, 0, &info)) {
+		PERR("Error: Host %s not found", _host);
+		throw Http::Uri_error();
 	}
+
+	env()->heap()->alloc(sizeof(struct addrinfo), &_info);
+	Genode::memcpy(_info, info, sizeof(struct addrinfo));
 }
 
 
-void Http::do_read(void * buf, size_t size)
+void Http::get_capacity()
 {
-	size_t buf_fill = 0;
+	Connection *c = _connections[0];
 
-	while (buf_fill < size) {
+	char buf[HTTP_BUF];
+	const char *http_templ = "%s %s HTTP/1.1\r\n"
+	                         "Host: %s\r\n"
+	                         "\r\n";
 
-		int part;
-		if ((part = lwip_read(_fd, (void *)((addr_t)buf + buf_fill),
-		                      size - buf_fill)) <= 0) {
-			PERR("Error: Reading data (%d)", errno);
-			throw Http::Socket_error();
-		}
+	int length = snprintf(buf, HTTP_BUF, http_templ, "HEAD", _path, _host);
+
+	c->connect();
+	c->write(buf, length);
+
+	unsigned status;
+	bool     close;
+	c->read_header(status, _size, close);
 
-		buf_fill += part;
+	if (status != HTTP_SUCC_OK) {
+		PERR("Error: Server returned %u", status);
+		throw Http::Server_error();
 	}
 
+	if (close)
+		c->close();
+
 	if (verbose)
-		PDBG("Read %zu/%zu", buf_fill, size);
+		PDBG("File size: %zu bytes", _size);
 }
 
 
-Http::Http(char *uri, size_t length) : _port((char *)"80")
+Http::Http(char *uri, size_t length, unsigned connections)
+:
+	_port((char *)"80"),
+	_num_connections(max(1U, min(connections, (unsigned)MAX_CONNECTIONS))),
+	_num_free(0), _free_sem(0)
 {
-	env()->heap()->alloc(HTTP_BUF, &_http_buf);
-
 	/* parse URI */
 	parse_uri(uri, length);
 
 	/* search for host */
 	resolve_uri();
 
-	/* connect to host */
-	connect();
+	/* connections are established on demand */
+	for (unsigned i = 0; i < _num_connections; i++)
+		_connections[i] = new (env()->heap()) Connection(_info);
 
 	/* retrieve file info */
 	get_capacity();
+
+	for (unsigned i = 0; i < _num_connections; i++)
+		free_connection(_connections[i]);
 }
 
 
 Http::~Http()
 {
+	for (unsigned i = 0; i < _num_connections; i++)
+		destroy(env()->heap(), _connections[i]);
+
 	env()->heap()->free(_host, Genode::strlen(_host) + 1);
 	env()->heap()->free(_path, Genode::strlen(_path) + 2);
-	env()->heap()->free(_http_buf, HTTP_BUF);
 	env()->heap()->free(_info, sizeof(struct addrinfo));
 }
 
@@ -251,55 +403,64 @@ void Http::parse_uri(char *uri, size_t length)
 }
 
 
-void Http::cmd_get(size_t file_offset, size_t size, off_t offset)
+void Http::cmd_get(size_t file_offset, size_t size,
+                   char * const *bufs, size_t buf_size)
 {
 	if (verbose)
-		PDBG("Read: offs %zu  size: %zu I/O offs: %lx", file_offset, size, offset);
-
-	while (true) {
+		PDBG("Read: offs %zu  size: %zu", file_offset, size);
 
-		const char *http_templ = "GET %s HTTP/1.1\r\n"
-		                         "Host: %s\r\n"
-		                         "Range: bytes=%lu-%lu\r\n"
-		                         "\r\n";
+	char request[HTTP_BUF];
+	const char *http_templ = "GET %s HTTP/1.1\r\n"
+	                         "Host: %s\r\n"
+	                         "Range: bytes=%lu-%lu\r\n"
+	                         "\r\n";
 
-		int length = snprintf(_http_buf, HTTP_BUF, http_templ, _path, _host,
-		                      file_offset, file_offset + size - 1);
+	int length = snprintf(request, HTTP_BUF, http_templ, _path, _host,
+	                      file_offset, file_offset + size - 1);
 
-		if (lwip_write(_fd, _http_buf, length) < 0) {
+	Connection *c = alloc_connection();
 
-			if (errno == ESHUTDOWN)
-				reconnect();
+	for (unsigned attempt = 0; ; attempt++) {
 
-			if (lwip_write(_fd, _http_buf, length) < 0)
-				throw Http::Socket_error();
-		}
+		/* the host may have closed an idle connection, retry once */
+		bool const retry = c->reused() && attempt == 0;
 
 		try {
-			read_header();
-		} catch (Http::Socket_closed) {
-			reconnect();
-			continue;
-		}
+			if (!c->connected())
+				c->connect();
 
-		if (_http_ret != HTTP_SUCC_PARTIAL) {
-			PERR("Error: Server returned %u", _http_ret);
-			throw Http::Server_error();
-		}
+			c->write(request, length);
 
-		do_read((void *)(_base_addr + offset), size);
-		return;
-	}
-}
+			unsigned status;
+			size_t   content_length;
+			bool     close;
+			c->read_header(status, content_length, close);
 
+			if (status != HTTP_SUCC_PARTIAL || content_length != size) {
+				PERR("Error: Server returned %u (%zu bytes)", status, content_length);
+				c->close();
+				free_connection(c);
+				throw Http::Server_error();
+			}
 
-void __attribute__((constructor)) init()
-{
-	lwip_tcpip_init();
+			for (size_t done = 0; done < size; done += buf_size)
+				c->read(bufs[done / buf_size], min(buf_size, size - done));
+
+			if (close)
+				c->close();
+
+			free_connection(c);
+			return;
 
-	if (lwip_nic_init(0, 0, 0)) {
-		PERR("DHCP failed");
-		throw -1;
+		} catch (Http::Socket_closed) {
+			c->close();
+			if (retry) continue;
+		} catch (Http::Socket_error) {
+			c->close();
+			if (retry) continue;
+		}
+
+		free_connection(c);
+		throw Http::Socket_error();
 	}
 }
-
@@ -14,6 +14,9 @@
 #ifndef _HTTP_H_
 #define _HTTP_H_
 
+#include <base/exception.h>
+#include <base/lock.h>
+#include <base/semaphore.h>
 #include <base/stdint.h>
 
 struct addrinfo;
@@ -24,32 +27,30 @@ class Http
 	typedef Genode::addr_t addr_t;
 	typedef Genode::off_t  off_t;
 
+	public:
+
+		enum { MAX_CONNECTIONS = 8 };
+
 	private:
 
+		class Connection;
+
 		size_t          _size;      /* number of bytes in file */
 		char            *_host;      /* host name */
 		char            *_port;      /* host port */
 		char            *_path;      /* absolute file path on host */
-		char            *_http_buf;  /* internal data buffer */
-		unsigned         _http_ret;  /* HTTP status code */
 		struct addrinfo *_info;      /* Resolved address info for host */
-		int              _fd;        /* Socket file handle */
-		addr_t          _base_addr; /* Address of I/O dataspace */
-
-		/*
-		 * Send 'HEAD' command
-		 */
-		void cmd_head();
-
-		/*
-		 * Connect to host
-		 */
-		void connect();
 
 		/*
-		 * Re-connect to host
+		 * Pool of persistent connections, each connection is used by one
+		 * request at a time
 		 */
-		void reconnect();
+		Connection        *_connections[MAX_CONNECTIONS];
+		unsigned           _num_connections;
+		Connection        *_free[MAX_CONNECTIONS];
+		unsigned           _num_free;
+		Genode::Lock       _free_lock;
+		Genode::Semaphore  _free_sem;
 
 		/*
 		 * Set URI of remote file
@@ -62,26 +63,29 @@ class Http
 		void resolve_uri();
 
 		/*
-		 * Read HTTP header and parse server-status code
+		 * Determine remote-file size
 		 */
-		size_t read_header();
+		void get_capacity();
 
 		/*
-		 * Determine remote-file size
+		 * Take connection from pool, block if all connections are in use
 		 */
-		void get_capacity();
+		Connection *alloc_connection();
 
 		/*
-		 * Read 'size' bytes into buffer
+		 * Return connection to pool
 		 */
-		void do_read(void * buf, size_t size);
+		void free_connection(Connection *c);
 
 	public:
 
 		/*
-		 * Constructor (default block size is 512 Bytes, default host port is 80
+		 * Constructor (default host port is 80)
+		 *
+		 * \param connections  number of connections used for parallel
+		 *                     requests, at most 'MAX_CONNECTIONS'
 		 */
-		Http(char *uri, size_t length);
+		Http(char *uri, size_t length, unsigned connections = 1);
 
 		/*
 		 * Destructor
@@ -96,20 +100,19 @@ class Http
 		size_t file_size() { return _size; }
 
 		/**
-		 * Set base address of I/O dataspace
-		 *
-		 * \param base_addr  Base of dataspace
-		 */
-		void  base_addr(addr_t base_addr) { _base_addr = base_addr; }
-
-		/**
-		 * Send 'GET' command
+		 * Send 'GET' command for a range of the remote file
 		 *
 		 * \param file_offset  Read from offset of remote file
-		 * \param size         Number of byts to transfer
-		 * \param offset       Offset in I/O dataspace
+		 * \param size         Number of bytes to transfer
+		 * \param bufs         Destination buffers of 'buf_size' bytes each,
+		 *                     the data is scattered over the buffers in order
+		 * \param buf_size     Size of each destination buffer
+		 *
+		 * The function may be called by several threads at the same time.
+		 * Each request uses a connection of the pool exclusively.
 		 */
-		void cmd_get(size_t file_offset, size_t size, off_t offset);
+		void cmd_get(size_t file_offset, size_t size,
+		             char * const *bufs, size_t buf_size);
 
 		/* Exceptions */
 		class Exception     : public ::Genode::Exception { };
@@ -19,9 +19,11 @@
 #include <cap_session/connection.h>
 #include <root/component.h>
 #include <os/config.h>
+#include <lwip/genode.h>
 
 /* local includes */
 #include "http.h"
+#include "cache.h"
 
 using namespace Genode;
 
@@ -31,12 +33,18 @@ namespace Block {
 	{
 		private:
 
-			size_t _block_size;
-			Http  *_http;
+			size_t    _block_size;
+			unsigned  _connections;
+			size_t    _cache_size;
+			size_t    _read_ahead;
+			Http     *_http;
+			Cache    *_cache;
 
 		public:
 
-			Http_interface() : _block_size(512), _http(0)  {}
+			Http_interface()
+			: _block_size(512), _connections(4), _cache_size(4*1024*1024),
+			  _read_ahead(512*1024), _http(0), _cache(0) { }
 
 			static Http_interface* obj()
 			{
@@ -51,14 +59,15 @@ namespace Block {
 
 			size_t block_size() { return _block_size; }
 
-			void base_addr(addr_t base_addr)
-			{
-				_http->base_addr(base_addr);
-			}
+			void connections(unsigned connections) { _connections = connections; }
+			unsigned connections() { return _connections; }
+
+			void cache_size(size_t cache_size) { _cache_size = cache_size; }
+			void read_ahead(size_t read_ahead) { _read_ahead = read_ahead; }
 
-			void read(size_t block_nr, size_t block_count, off_t offset)
+			void read(size_t block_nr, size_t block_count, char *dst)
 			{
-				_http->cmd_get(block_nr * _block_size, block_count * _block_size, offset);
+				_cache->read(block_nr * _block_size, block_count * _block_size, dst);
 			}
 
 			size_t block_count()
@@ -68,7 +77,9 @@ namespace Block {
 
 			void uri(char *uri, size_t length)
 			{
-				_http = new(env()->heap()) Http(uri, length);
+				_http  = new(env()->heap()) Http(uri, length, _connections);
+				_cache = new(env()->heap()) Cache(*_http, *env()->heap(),
+				                                  _cache_size, _read_ahead);
 			}
 
 			Http * http_blk() { return _http; }
@@ -78,6 +89,50 @@ namespace Block {
 	{
 		private:
 
+			enum { QUEUE_SIZE = 64, MAX_WORKERS = Http::MAX_CONNECTIONS };
+
+			/**
+			 * Queue of packets between the tx thread and the workers
+			 */
+			class Packet_queue
+			{
+				private:
+
+					Packet_descriptor  _packets[QUEUE_SIZE];
+					unsigned           _head, _tail;
+					Genode::Lock       _lock;
+					Genode::Semaphore  _avail, _space;
+
+				public:
+
+					Packet_queue() : _head(0), _tail(0), _space(QUEUE_SIZE) { }
+
+					void put(Packet_descriptor packet)
+					{
+						_space.down();
+						{
+							Genode::Lock::Guard guard(_lock);
+							_packets[_head++ % QUEUE_SIZE] = packet;
+						}
+						_avail.up();
+					}
+
+					Packet_descriptor get()
+					{
+						_avail.down();
+						Packet_descriptor packet;
+						{
+							Genode::Lock::Guard guard(_lock);
+							packet = _packets[_tail++ % QUEUE_SIZE];
+						}
+						_space.up();
+						return packet;
+					}
+			};
+
+			/**
+			 * Thread that dispatches client packets to the workers
+			 */
 			class Tx_thread : public Genode::Thread<8192>
 			{
 				private:
@@ -87,7 +142,7 @@ namespace Block {
 				public:
 
 					Tx_thread(Session_component *session)
-					: Genode::Thread<8192>("worker"), _session(session) { }
+					: Genode::Thread<8192>("tx"), _session(session) { }
 
 					void entry()
 					{
@@ -114,29 +169,62 @@ namespace Block {
 
 							case Block::Packet_descriptor::READ:
 
-								try {
-									Http_interface::obj()->read(packet.block_number(),
-									                            packet.block_count(),
-									                            packet.offset());
-									packet.succeeded(true);
-								}
-								catch (Http::Socket_error) { PERR("socket error"); }
-								catch (Http::Server_error) { PERR("server error"); }
-
+								/* processed by a worker */
+								_session->queue().put(packet);
 								break;
 
 							case Block::Packet_descriptor::WRITE:
+
+								_session->ack(packet);
 								break;
 
 							default:
 								PWRN("received invalid packet");
 								continue;
 							}
+						}
+					}
+			};
+
+			/**
+			 * Thread that processes read requests
+			 *
+			 * Several workers process requests at the same time, each
+			 * using a connection of its own.
+			 */
+			class Worker : public Genode::Thread<8192>
+			{
+				private:
+
+					Session_component *_session;
+
+				public:
+
+					Worker() : Genode::Thread<8192>("worker"), _session(0) { }
+
+					void session(Session_component *session) { _session = session; }
+
+					void entry()
+					{
+						while (true) {
+
+							Packet_descriptor packet = _session->queue().get();
+
+							char *dst = _session->tx_sink()->packet_content(packet);
+
+							if (dst && packet.size() >= packet.block_count()
+							                            * Http_interface::obj()->block_size()) {
+								try {
+									Http_interface::obj()->read(packet.block_number(),
+									                            packet.block_count(),
+									                            dst);
+									packet.succeeded(true);
+								}
+								catch (Http::Socket_error) { PERR("socket error"); }
+								catch (Http::Server_error) { PERR("server error"); }
+							}
 
-							/* acknowledge packet to the client */
-							if (!tx_sink->ready_to_ack())
-								PDBG("need to wait until ready-for-ack");
-							tx_sink->acknowledge_packet(packet);
+							_session->ack(packet);
 						}
 					}
 			};
@@ -145,6 +233,9 @@ namespace Block {
 
 			Genode::Dataspace_capability _tx_ds;         /* buffer for tx channel */
 			Genode::Semaphore            _startup_sema;  /* thread startup sync */
+			Genode::Lock                 _ack_lock;
+			Packet_queue                 _queue;
+			Worker                       _workers[MAX_WORKERS];
 			Tx_thread                    _tx_thread;
 
 		public:
@@ -159,12 +250,13 @@ namespace Block {
 			: Session_rpc_object(tx_ds, ep), _tx_ds(tx_ds),
 			  _startup_sema(0), _tx_thread(this)
 			{
-				/*
-				 * Map packet stream
-				 */
-				addr_t base = env()->rm_session()->attach(tx_ds);
+				unsigned const num_workers =
+					min(Http_interface::obj()->connections(), (unsigned)MAX_WORKERS);
 
-				Http_interface::obj()->base_addr(base);
+				for (unsigned i = 0; i < max(num_workers, 1U); i++) {
+					_workers[i].session(this);
+					_workers[i].start();
+				}
 
 				_tx_thread.start();
 				_startup_sema.down();
@@ -182,6 +274,22 @@ namespace Block {
 			 * Signal indicating that transmit thread is ready
 			 */
 			void tx_ready() { _startup_sema.up(); }
+
+			Packet_queue &queue() { return _queue; }
+
+			/**
+			 * Acknowledge packet to the client
+			 *
+			 * Called by the tx thread and the workers.
+			 */
+			void ack(Packet_descriptor packet)
+			{
+				Genode::Lock::Guard guard(_ack_lock);
+
+				if (!tx_sink()->ready_to_ack())
+					PDBG("need to wait until ready-for-ack");
+				tx_sink()->acknowledge_packet(packet);
+			}
 	};
 
 	/*
@@ -256,9 +364,22 @@ static void process_config()
 
 		Xml_node file_node = config_node.sub_node(i);
 
-		if (file_node.has_type("uri")) {
-			Block::Http_interface::obj()->uri(file_node.content_addr(), file_node.content_size());
-			uri = true;
+		if (file_node.has_type("connections")) {
+			unsigned connections;
+			file_node.value(&connections);
+			Block::Http_interface::obj()->connections(connections);
+		}
+
+		if (file_node.has_type("cache-size")) {
+			Number_of_bytes cache_size;
+			file_node.value(&cache_size);
+			Block::Http_interface::obj()->cache_size(cache_size);
+		}
+
+		if (file_node.has_type("read-ahead")) {
+			Number_of_bytes read_ahead;
+			file_node.value(&read_ahead);
+			Block::Http_interface::obj()->read_ahead(read_ahead);
 		}
 
 		if (file_node.has_type("block-size")) {
@@ -268,6 +389,17 @@ static void process_config()
 		}
 	}
 
+	/* the URI is processed last because it depends on the other settings */
+	for (unsigned i = 0; i < config_node.num_sub_nodes(); ++i) {
+
+		Xml_node file_node = config_node.sub_node(i);
+
+		if (file_node.has_type("uri")) {
+			Block::Http_interface::obj()->uri(file_node.content_addr(), file_node.content_size());
+			uri = true;
+		}
+	}
+
 	if (!uri)
 		throw Http::Uri_error();
 }
@@ -279,6 +411,13 @@ int main()
 	static Cap_connection cap;
 	static Rpc_entrypoint ep(&cap, STACK_SIZE, "http_block_ep");
 
+	lwip_tcpip_init();
+
+	if (lwip_nic_init(0, 0, 0)) {
+		PERR("DHCP failed");
+		return -1;
+	}
+
 	process_config();
 
 	static Block::Root block_root(&ep, env()->heap());
@@ -0,0 +1,212 @@
+/*
+ * \brief  Cache of pre-rendered glyphs
+ * \author Norman Feske
+ * \date   2013-03-08
+ *
+ * Terminal output uses only a few combinations of characters and colors.
+ * Instead of blending each glyph with its colors whenever a cell is drawn,
+ * the glyphs are rendered once into tiles of the cell size, which are then
+ * copied to the framebuffer. The number of tiles is bounded. If no tile is
+ * left, the least recently used tile is reused.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _GLYPH_CACHE_H_
+#define _GLYPH_CACHE_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+
+/* nitpicker graphic back end */
+#include <nitpicker_gfx/font.h>
+
+
+/**
+ * \param PT  pixel type of the tiles
+ */
+template <typename PT>
+class Glyph_cache
+{
+	public:
+
+		/**
+		 * Properties that determine the pixels of a tile
+		 */
+		struct Key
+		{
+			Font const    *font;
+			unsigned char  ascii;
+			PT             fg, bg;
+
+			Key(Font const *font, unsigned char ascii, PT fg, PT bg)
+			: font(font), ascii(ascii), fg(fg), bg(bg) { }
+
+			bool operator == (Key const &other) const
+			{
+				return font     == other.font
+				    && ascii    == other.ascii
+				    && fg.pixel == other.fg.pixel
+				    && bg.pixel == other.bg.pixel;
+			}
+		};
+
+	private:
+
+		enum {
+			NUM_TILES   = 512,
+			NUM_BUCKETS = 256,   /* must be a power of two */
+			INVALID     = -1,
+		};
+
+		/**
+		 * Meta data of a tile
+		 *
+		 * Used tiles are linked into a hash bucket for the lookup and into
+		 * the LRU list, which starts with the most recently used tile.
+		 */
+		struct Tile
+		{
+			Key key;
+			int bucket_next;
+			int lru_prev, lru_next;
+
+			Tile() : key(0, 0, PT(0, 0, 0), PT(0, 0, 0)),
+			         bucket_next(INVALID), lru_prev(INVALID), lru_next(INVALID) { }
+		};
+
+		Genode::Allocator &_alloc;
+		unsigned const     _tile_w, _tile_h;
+		PT                *_pixels;
+
+		Tile     _tiles[NUM_TILES];
+		int      _buckets[NUM_BUCKETS];
+		int      _lru_first, _lru_last;
+		unsigned _num_used;
+
+		static unsigned _hash(Key const &key)
+		{
+			unsigned long const h = key.ascii
+			                      ^ ((unsigned long)key.fg.pixel*31)
+			                      ^ ((unsigned long)key.bg.pixel*131)
+			                      ^ ((unsigned long)key.font >> 4);
+			return (h ^ (h >> 8)) & (NUM_BUCKETS - 1);
+		}
+
+		void _lru_remove(int i)
+		{
+			Tile &t = _tiles[i];
+
+			if (t.lru_prev != INVALID) _tiles[t.lru_prev].lru_next = t.lru_next;
+			else                       _lru_first = t.lru_next;
+
+			if (t.lru_next != INVALID) _tiles[t.lru_next].lru_prev = t.lru_prev;
+			else                       _lru_last = t.lru_prev;
+		}
+
+		void _lru_insert_first(int i)
+		{
+			Tile &t = _tiles[i];
+
+			t.lru_prev = INVALID;
+			t.lru_next = _lru_first;
+
+			if (_lru_first != INVALID) _tiles[_lru_first].lru_prev = i;
+			else                       _lru_last = i;
+
+			_lru_first = i;
+		}
+
+		void _bucket_remove(int i)
+		{
+			int *link = &_buckets[_hash(_tiles[i].key)];
+			for (; *link != i; link = &_tiles[*link].bucket_next);
+
+			*link = _tiles[i].bucket_next;
+		}
+
+		/**
+		 * Return index of an unused tile, evict one if needed
+		 */
+		int _alloc_tile()
+		{
+			if (_num_used < NUM_TILES)
+				return _num_used++;
+
+			int const i = _lru_last;
+			_lru_remove(i);
+			_bucket_remove(i);
+			return i;
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param tile_w  width of a tile in pixels
+		 * \param tile_h  height of a tile in pixels
+		 */
+		Glyph_cache(Genode::Allocator &alloc, unsigned tile_w, unsigned tile_h)
+		:
+			_alloc(alloc), _tile_w(tile_w), _tile_h(tile_h),
+			_pixels((PT *)alloc.alloc(NUM_TILES*tile_w*tile_h*sizeof(PT))),
+			_lru_first(INVALID), _lru_last(INVALID), _num_used(0)
+		{
+			for (unsigned i = 0; i < NUM_BUCKETS; i++)
+				_buckets[i] = INVALID;
+		}
+
+		~Glyph_cache()
+		{
+			_alloc.free(_pixels, NUM_TILES*_tile_w*_tile_h*sizeof(PT));
+		}
+
+		/**
+		 * Return pixels of the tile for 'key'
+		 *
+		 * \param render  functor called with the key and the tile pixels as
+		 *                arguments if the tile is not cached
+		 */
+		template <typename FN>
+		PT const *tile(Key const &key, FN &render)
+		{
+			int i = _buckets[_hash(key)];
+			for (; i != INVALID && !(_tiles[i].key == key); i = _tiles[i].bucket_next);
+
+			PT *pixels;
+
+			if (i != INVALID) {
+				pixels = _pixels + i*_tile_w*_tile_h;
+
+				/* cache hit, mark tile as most recently used */
+				if (i != _lru_first) {
+					_lru_remove(i);
+					_lru_insert_first(i);
+				}
+				return pixels;
+			}
+
+			i = _alloc_tile();
+			pixels = _pixels + i*_tile_w*_tile_h;
+
+			Tile &t = _tiles[i];
+			t.key         = key;
+			t.bucket_next = _buckets[_hash(key)];
+			_buckets[_hash(key)] = i;
+			_lru_insert_first(i);
+
+			render(key, pixels);
+			return pixels;
+		}
+
+		unsigned tile_w() const { return _tile_w; }
+		unsigned tile_h() const { return _tile_h; }
+};
+
+#endif /* _GLYPH_CACHE_H_ */
@@ -31,11 +31,16 @@
 #include <terminal/keymaps.h>
 #include <terminal/char_cell_array_character_screen.h>
 #include <terminal_session/terminal_session.h>
+#include <terminal_session/bulk_buffer.h>
 
 /* nitpicker graphic back end */
 #include <nitpicker_gfx/font.h>
 #include <nitpicker_gfx/color.h>
 #include <nitpicker_gfx/pixel_rgb565.h>
+#include <nitpicker_gfx/geometry.h>
+
+/* local includes */
+#include "glyph_cache.h"
 
 
 static bool const verbose = false;
@@ -114,8 +119,8 @@ class Font_family
 
 
 template <typename PT>
-inline void draw_glyph(Color                fg_color,
-                       Color                bg_color,
+inline void draw_glyph(PT                   fg_pixel,
+                       PT                   bg_pixel,
                        const unsigned char *glyph_base,
                        unsigned             glyph_width,
                        unsigned             glyph_img_width,
@@ -124,11 +129,9 @@ inline void draw_glyph(Color                fg_color,
                        PT                  *fb_base,
                        unsigned             fb_width)
 {
-	PT fg_pixel(fg_color.r, fg_color.g, fg_color.b);
-	PT bg_pixel(bg_color.r, bg_color.g, bg_color.b);
+	glyph_width = Genode::min(glyph_width, cell_width);
 
-	unsigned const horizontal_gap = cell_width
-	                              - Genode::min(glyph_width, cell_width);
+	unsigned const horizontal_gap = cell_width - glyph_width;
 
 	unsigned const  left_gap = horizontal_gap / 2;
 	unsigned const right_gap = horizontal_gap - left_gap;
@@ -163,16 +166,90 @@ inline void draw_glyph(Color                fg_color,
 }
 
 
+/**
+ * Functor for rendering the tiles of the glyph cache
+ */
 template <typename PT>
-static void convert_char_array_to_pixels(Cell_array<Char_cell> *cell_array,
+struct Render_glyph
+{
+	unsigned const cell_width;
+
+	Render_glyph(unsigned cell_width) : cell_width(cell_width) { }
+
+	void operator () (typename Glyph_cache<PT>::Key const &key, PT *tile)
+	{
+		Font const &font = *key.font;
+
+		draw_glyph<PT>(key.fg, key.bg,
+		               font.img + font.otab[key.ascii], font.wtab[key.ascii],
+		               (unsigned)font.img_w, (unsigned)font.img_h,
+		               cell_width, tile, cell_width);
+	}
+};
+
+
+/**
+ * Apply pending scroll operation of the cell array to the pixels
+ *
+ * \return  framebuffer area changed by the operation
+ */
+template <typename PT>
+static Rect scroll_pixels(Cell_array<Char_cell> *cell_array,
+                          PT                    *fb_base,
+                          unsigned               fb_width,
+                          unsigned               cell_height)
+{
+	Cell_array<Char_cell>::Scroll const scroll = cell_array->scroll();
+	if (!scroll.num_lines)
+		return Rect(Point(), Area());
+
+	cell_array->mark_scroll_as_done();
+
+	/*
+	 * The pixels are moved line by line in the direction of the scroll
+	 * operation. Because the lines are moved by at least one line, source
+	 * and destination of each copy do not overlap.
+	 */
+	unsigned const line_size = fb_width*cell_height;
+	int      const num_moved = scroll.end - scroll.start + 1 - scroll.num_lines;
+
+	for (int i = 0; i < num_moved; i++) {
+
+		int const dst_line = scroll.up ? scroll.start + i
+		                               : scroll.end - i;
+		int const src_line = scroll.up ? dst_line + scroll.num_lines
+		                               : dst_line - scroll.num_lines;
+
+		Genode::memcpy(fb_base + dst_line*line_size,
+		               fb_base + src_line*line_size,
+		               line_size*sizeof(PT));
+	}
+
+	return Rect(Point(0, scroll.start*cell_height),
+	            Area(fb_width, (scroll.end - scroll.start + 1)*cell_height));
+}
+
+
+/**
+ * Draw dirty cells and mark them as clean
+ *
+ * \return  framebuffer area changed by the operation
+ */
+template <typename PT>
+static Rect convert_char_array_to_pixels(Cell_array<Char_cell> *cell_array,
                                          PT                    *fb_base,
                                          unsigned               fb_width,
                                          unsigned               fb_height,
-                                         Font_family const     &font_family)
+                                         Font_family const     &font_family,
+                                         Glyph_cache<PT>       &glyph_cache)
 {
-	Font const &regular_font = *font_family.font(Font_face::REGULAR);
-	unsigned glyph_height = regular_font.img_h,
-	         glyph_step_x = regular_font.wtab['m'];
+	unsigned const cell_width  = glyph_cache.tile_w(),
+	               cell_height = glyph_cache.tile_h();
+
+	Render_glyph<PT> render(cell_width);
+
+	/* initially invalid */
+	Rect dirty = Rect(Point(), Area());
 
 	unsigned y = 0;
 	for (unsigned line = 0; line < cell_array->num_lines(); line++) {
@@ -183,7 +260,11 @@ static void convert_char_array_to_pixels(Cell_array<Char_cell> *cell_array,
 				Genode::printf("convert line %d\n", line);
 
 			unsigned x = 0;
-			for (unsigned column = 0; column < cell_array->num_cols(); column++) {
+			for (unsigned column = 0; column < cell_array->num_cols(); column++, x += cell_width) {
+
+				if (x + cell_width > fb_width) break;
+
+				if (!cell_array->cell_dirty(column, line)) continue;
 
 				Char_cell      cell  = cell_array->get_cell(column, line);
 				Font const    *font  = font_family.font(cell.font_face());
@@ -192,12 +273,6 @@ static void convert_char_array_to_pixels(Cell_array<Char_cell> *cell_array,
 				if (ascii == 0)
 					ascii = ' ';
 
-				unsigned char const *glyph_base  = font->img + font->otab[ascii];
-
-				unsigned glyph_width = regular_font.wtab[ascii];
-
-				if (x + glyph_width >= fb_width) break;
-
 				Color fg_color = foreground_color(cell);
 				Color bg_color = background_color(cell);
 
@@ -206,19 +281,30 @@ static void convert_char_array_to_pixels(Cell_array<Char_cell> *cell_array,
 					bg_color = Color(255, 255, 255);
 				}
 
-				draw_glyph<PT>(fg_color, bg_color,
-				               glyph_base, glyph_width,
-				               (unsigned)font->img_w, (unsigned)font->img_h,
-				               glyph_step_x, fb_base + x, fb_width);
+				typename Glyph_cache<PT>::Key const
+					key(font, ascii, PT(fg_color.r, fg_color.g, fg_color.b),
+					                 PT(bg_color.r, bg_color.g, bg_color.b));
+
+				PT const *src = glyph_cache.tile(key, render);
+				PT       *dst = fb_base + x;
+
+				for (unsigned i = 0; i < cell_height; i++, src += cell_width, dst += fb_width)
+					for (unsigned j = 0; j < cell_width; j++)
+						dst[j] = src[j];
 
-				x += glyph_step_x;
+				Rect const cell_rect(Point(x, y), Area(cell_width, cell_height));
+				dirty = dirty.valid() ? Rect::compound(dirty, cell_rect) : cell_rect;
 			}
+
+			cell_array->mark_line_as_clean(line);
 		}
-		y       += glyph_height;
-		fb_base += fb_width*glyph_height;
+		y       += cell_height;
+		fb_base += fb_width*cell_height;
 
-		if (y + glyph_height > fb_height) break;
+		if (y + cell_height > fb_height) break;
 	}
+
+	return dirty;
 }
 
 
@@ -290,6 +376,48 @@ namespace Terminal {
 
 			Font_family const               *_font_family;
 
+			Glyph_cache<Pixel_rgb565>        _glyph_cache;
+
+			/*
+			 * Ring buffer for bulk writes, consumed by the main thread
+			 */
+			Genode::Attached_ram_dataspace                _bulk_ds;
+			Bulk_buffer                                   _bulk;
+			Genode::Signal_transmitter                    _bulk_space_avail;
+			Genode::Signal_dispatcher<Session_component> _bulk_dispatcher;
+
+			/**
+			 * Called by signal dispatcher, executed in the context of the
+			 * main thread
+			 */
+			void _consume_bulk(unsigned)
+			{
+				Genode::Lock::Guard guard(_lock);
+
+				do {
+					_drain_bulk();
+				} while (!_bulk.block_consumer());
+			}
+
+			/**
+			 * Decode all data of the bulk buffer, called with '_lock' held
+			 */
+			void _drain_bulk()
+			{
+				for (;;) {
+					Genode::size_t    len  = 0;
+					char const * const data = _bulk.read(len);
+					if (!len)
+						break;
+
+					_decoder.insert((unsigned char const *)data, len);
+					_bulk.consume(len);
+
+					if (_bulk.producer_blocked())
+						_bulk_space_avail.submit();
+				}
+			}
+
 			/**
 			 * Initialize framebuffer-related attributes
 			 */
@@ -311,6 +439,8 @@ namespace Terminal {
 			Session_component(Read_buffer             *read_buffer,
 			                  Framebuffer::Session    *framebuffer,
 			                  Genode::size_t           io_buffer_size,
+			                  Genode::size_t           bulk_buffer_size,
+			                  Genode::Signal_receiver &sig_rec,
 			                  Flush_callback_registry &flush_callback_registry,
 			                  Font_family const       &font_family)
 			:
@@ -333,7 +463,11 @@ namespace Terminal {
 				_char_cell_array_character_screen(_char_cell_array),
 				_decoder(_char_cell_array_character_screen),
 
-				_font_family(&font_family)
+				_font_family(&font_family),
+				_glyph_cache(*Genode::env()->heap(), _char_width, _char_height),
+				_bulk_ds(Genode::env()->ram_session(), bulk_buffer_size),
+				_bulk(_bulk_ds.local_addr<void>(), _bulk_ds.size()),
+				_bulk_dispatcher(sig_rec, *this, &Session_component::_consume_bulk)
 			{
 				using namespace Genode;
 
@@ -344,6 +478,8 @@ namespace Terminal {
 
 				framebuffer->refresh(0, 0, _fb_mode.width(), _fb_mode.height());
 
+				_bulk.init();
+
 				_flush_callback_registry.add(this);
 			}
 
@@ -356,29 +492,25 @@ namespace Terminal {
 			{
 				Genode::Lock::Guard guard(_lock);
 
-				convert_char_array_to_pixels<Pixel_rgb565>(&_char_cell_array,
-				                                           (Pixel_rgb565 *)_fb_addr,
-				                                           _fb_mode.width(),
-				                                           _fb_mode.height(),
-				                                          *_font_family);
+				Pixel_rgb565 * const fb_base = (Pixel_rgb565 *)_fb_addr;
 
-				
-				int first_dirty_line =  10000,
-				    last_dirty_line  = -10000;
+				Rect const scrolled =
+					scroll_pixels(&_char_cell_array, fb_base,
+					              _fb_mode.width(), _char_height);
 
-				for (int line = 0; line < (int)_char_cell_array.num_lines(); line++) {
-					if (!_char_cell_array.line_dirty(line)) continue;
+				Rect const drawn =
+					convert_char_array_to_pixels(&_char_cell_array, fb_base,
+					                             _fb_mode.width(),
+					                             _fb_mode.height(),
+					                            *_font_family, _glyph_cache);
 
-					first_dirty_line = Genode::min(line, first_dirty_line);
-					last_dirty_line  = Genode::max(line, last_dirty_line);
+				Rect dirty = scrolled.valid() && drawn.valid()
+				           ? Rect::compound(scrolled, drawn)
+				           : (scrolled.valid() ? scrolled : drawn);
 
-					_char_cell_array.mark_line_as_clean(line);
-				}
-
-				int num_dirty_lines = last_dirty_line - first_dirty_line + 1;
-
-				_framebuffer->refresh(0, first_dirty_line*_char_height,
-				                      _fb_mode.width(), num_dirty_lines*_char_height);
+				if (dirty.valid())
+					_framebuffer->refresh(dirty.x1(), dirty.y1(),
+					                      dirty.w(), dirty.h());
 			}
 
 
@@ -407,15 +539,19 @@ namespace Terminal {
 			{
 				Genode::Lock::Guard guard(_lock);
 
+				/* keep the order with data written via the bulk buffer */
+				_drain_bulk();
+
 				unsigned char *src = _io_buffer.local_addr<unsigned char>();
 
-				for (unsigned i = 0; i < num_bytes; i++) {
-					if (verbose)
+				num_bytes = Genode::min(num_bytes, _io_buffer.size());
+
+				if (verbose)
+					for (unsigned i = 0; i < num_bytes; i++)
 						Genode::printf("%c (%d)\n", src[i], (int)src[i]);
 
-					/* submit character to sequence decoder */
-					_decoder.insert(src[i]);
-				}
+				/* submit characters to sequence decoder */
+				_decoder.insert(src, num_bytes);
 			}
 
 			Genode::Dataspace_capability _dataspace()
@@ -438,6 +574,16 @@ namespace Terminal {
 				_read_buffer->sigh(cap);
 			}
 
+			Genode::Dataspace_capability _bulk_dataspace() { return _bulk_ds.cap(); }
+
+			Genode::Signal_context_capability _bulk_data_avail_cap() {
+				return _bulk_dispatcher; }
+
+			void bulk_space_avail_sigh(Genode::Signal_context_capability cap)
+			{
+				_bulk_space_avail.context(cap);
+			}
+
 			Genode::size_t read(void *buf, Genode::size_t)  { return 0; }
 			Genode::size_t write(void const *buf, Genode::size_t) { return 0; }
 	};
@@ -449,6 +595,7 @@ namespace Terminal {
 
 			Read_buffer             *_read_buffer;
 			Framebuffer::Session    *_framebuffer;
+			Genode::Signal_receiver &_sig_rec;
 			Flush_callback_registry &_flush_callback_registry;
 			Font_family const       &_font_family;
 
@@ -463,10 +610,15 @@ namespace Terminal {
 				 */
 				Genode::size_t io_buffer_size = 4096;
 
+				/* ring buffer for writing without an RPC per chunk */
+				Genode::size_t bulk_buffer_size = 64*1024;
+
 				Session_component *session =
 					new (md_alloc()) Session_component(_read_buffer,
 					                                   _framebuffer,
 					                                   io_buffer_size,
+					                                   bulk_buffer_size,
+					                                   _sig_rec,
 					                                   _flush_callback_registry,
 					                                   _font_family);
 				return session;
@@ -481,11 +633,13 @@ namespace Terminal {
 			               Genode::Allocator       *md_alloc,
 			               Read_buffer             *read_buffer,
 			               Framebuffer::Session    *framebuffer,
+			               Genode::Signal_receiver &sig_rec,
 			               Flush_callback_registry &flush_callback_registry,
 			               Font_family const       &font_family)
 			:
 				Genode::Root_component<Session_component>(ep, md_alloc),
 				_read_buffer(read_buffer), _framebuffer(framebuffer),
+				_sig_rec(sig_rec),
 				_flush_callback_registry(flush_callback_registry),
 				_font_family(font_family)
 			{ }
@@ -564,10 +718,17 @@ int main(int, char **)
 
 	static Terminal::Flush_callback_registry flush_callback_registry;
 
+	/*
+	 * The main thread handles the periodic timer signal and the signals
+	 * announcing new data in the bulk buffers of the sessions
+	 */
+	static Signal_receiver sig_rec;
+	static Signal_context  timer_ctx;
+
 	/* create root interface for service */
 	static Terminal::Root_component root(&ep, &sliced_heap,
 	                                     &read_buffer, &framebuffer,
-	                                     flush_callback_registry,
+	                                     sig_rec, flush_callback_registry,
 	                                     font_family);
 
 	/* announce service at our parent */
@@ -598,18 +759,26 @@ int main(int, char **)
 	static Terminal::Scancode_tracker
 		scancode_tracker(keymap, shift, altgr, Terminal::control);
 
+	enum { PASSED_MSECS = 10 };
+	timer.sigh(sig_rec.manage(&timer_ctx));
+	timer.trigger_periodic(PASSED_MSECS*1000);
+
 	while (1) {
 
-		flush_callback_registry.flush();
+		Signal sig = sig_rec.wait_for_signal();
 
-		while (!input.is_pending()) {
-			enum { PASSED_MSECS = 10 };
-			timer.msleep(PASSED_MSECS);
+		/* consume data written to the bulk buffer of a session */
+		if (sig.context() != &timer_ctx) {
+			static_cast<Signal_dispatcher_base *>(sig.context())->dispatch(sig.num());
+			continue;
+		}
+
+		flush_callback_registry.flush();
 
-			flush_callback_registry.flush();
+		if (!input.is_pending()) {
 
 			if (scancode_tracker.valid()) {
-				repeat_cnt -= PASSED_MSECS;
+				repeat_cnt -= PASSED_MSECS*sig.num();
 
 				if (repeat_cnt < 0) {
 
@@ -620,6 +789,7 @@ int main(int, char **)
 					repeat_cnt = repeat_rate;
 				}
 			}
+			continue;
 		}
 
 		unsigned num_events = input.flush();
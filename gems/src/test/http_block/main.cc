@@ -0,0 +1,421 @@
+/*
+ * \brief  Test of the HTTP back end of http_block via lwIP loopback
+ * \author Norman Feske
+ * \date   2013-03-16
+ *
+ * A local stand-in server provides a synthetic file via HTTP/1.1 with
+ * support for range requests and persistent connections. Each response is
+ * delayed to model the latency of a remote server. The test reads the file
+ * through the cache of http_block, sequentially and by several threads at
+ * random offsets, validates the content, and reports the throughput and
+ * the number of requests seen by the server.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/printf.h>
+#include <base/semaphore.h>
+#include <base/snprintf.h>
+#include <base/thread.h>
+#include <timer_session/connection.h>
+#include <lwip/genode.h>
+
+extern "C" {
+#include <lwip/sockets.h>
+}
+
+/* http_block includes */
+#include <http.h>
+#include <cache.h>
+
+using namespace Genode;
+
+enum {
+	PORT       = 8080,
+	FILE_SIZE  = 16*1024*1024,
+	LATENCY_MS = 2,
+	BLOCK_SIZE = 4096,
+};
+
+
+static char content(size_t offset) { return (char)((offset*13) >> 2); }
+
+
+/*************************
+ ** Stand-in web server **
+ *************************/
+
+static Lock     requests_lock;
+static unsigned requests;
+
+
+/**
+ * Thread serving one persistent connection at a time
+ */
+class Handler : public Thread<16384>
+{
+	private:
+
+		enum { BUF_SIZE = 2048 };
+
+		Semaphore _sem;
+		int       _fd;
+		bool      _busy;
+		char      _buf[BUF_SIZE];
+		size_t    _len;
+
+		Timer::Connection _timer;
+
+		/**
+		 * Read next request header into the buffer
+		 *
+		 * \return  length of the header, 0 if the connection was closed
+		 */
+		size_t _read_request()
+		{
+			for (;;) {
+				for (size_t i = 0; i + 3 < _len; i++)
+					if (!Genode::strcmp(_buf + i, "\r\n\r\n", 4))
+						return i + 4;
+
+				if (_len == BUF_SIZE)
+					return 0;
+
+				int n = lwip_read(_fd, _buf + _len, BUF_SIZE - _len);
+				if (n <= 0)
+					return 0;
+
+				_len += n;
+			}
+		}
+
+		bool _write(char const *data, size_t len)
+		{
+			while (len) {
+				int n = lwip_write(_fd, data, len);
+				if (n <= 0)
+					return false;
+
+				data += n;
+				len  -= n;
+			}
+			return true;
+		}
+
+		/**
+		 * Answer request
+		 *
+		 * \return  false if the connection must be closed
+		 */
+		bool _serve(size_t header_len)
+		{
+			char response[256];
+
+			_timer.msleep(LATENCY_MS);
+
+			{
+				Lock::Guard guard(requests_lock);
+				requests++;
+			}
+
+			if (!Genode::strcmp(_buf, "HEAD ", 5)) {
+				int len = snprintf(response, sizeof(response),
+				                   "HTTP/1.1 200 OK\r\n"
+				                   "Content-Length: %u\r\n\r\n", FILE_SIZE);
+				return _write(response, len);
+			}
+
+			/* find range */
+			unsigned long first = 0, last = FILE_SIZE - 1;
+			for (size_t i = 0; i + 13 < header_len; i++)
+				if (!Genode::strcmp(_buf + i, "Range: bytes=", 13)) {
+					char const *s = _buf + i + 13;
+					s += ascii_to(s, &first);
+					ascii_to(s + 1, &last);
+					break;
+				}
+
+			if (Genode::strcmp(_buf, "GET ", 4) || first > last || last >= FILE_SIZE) {
+				int len = snprintf(response, sizeof(response),
+				                   "HTTP/1.1 416 Requested Range Not Satisfiable\r\n"
+				                   "Content-Length: 0\r\n\r\n");
+				_write(response, len);
+				return false;
+			}
+
+			int len = snprintf(response, sizeof(response),
+			                   "HTTP/1.1 206 Partial Content\r\n"
+			                   "Content-Length: %lu\r\n\r\n", last - first + 1);
+			if (!_write(response, len))
+				return false;
+
+			/* send body in pieces */
+			char body[1024];
+			for (unsigned long offset = first; offset <= last; ) {
+				size_t n = min(sizeof(body), (size_t)(last - offset + 1));
+				for (size_t i = 0; i < n; i++)
+					body[i] = content(offset + i);
+
+				if (!_write(body, n))
+					return false;
+
+				offset += n;
+			}
+			return true;
+		}
+
+	public:
+
+		Handler() : Thread<16384>("handler"), _fd(-1), _busy(false), _len(0) { }
+
+		bool busy() const { return _busy; }
+
+		void serve(int fd)
+		{
+			_fd   = fd;
+			_busy = true;
+			_sem.up();
+		}
+
+		void entry()
+		{
+			for (;;) {
+				_sem.down();
+
+				_len = 0;
+				for (size_t header_len; (header_len = _read_request()); ) {
+
+					bool const keep_alive = _serve(header_len);
+
+					/* keep data of pipelined requests */
+					memmove(_buf, _buf + header_len, _len - header_len);
+					_len -= header_len;
+
+					if (!keep_alive)
+						break;
+				}
+
+				lwip_close(_fd);
+				_busy = false;
+			}
+		}
+};
+
+
+class Server : public Thread<8192>
+{
+	private:
+
+		enum { MAX_HANDLERS = Http::MAX_CONNECTIONS + 1 };
+
+		Handler   _handlers[MAX_HANDLERS];
+		Semaphore _ready;
+
+	public:
+
+		Server() : Thread<8192>("server") { }
+
+		void entry()
+		{
+			for (unsigned i = 0; i < MAX_HANDLERS; i++)
+				_handlers[i].start();
+
+			int s = lwip_socket(AF_INET, SOCK_STREAM, 0);
+
+			struct sockaddr_in addr;
+			addr.sin_family      = AF_INET;
+			addr.sin_port        = htons(PORT);
+			addr.sin_addr.s_addr = INADDR_ANY;
+
+			if (lwip_bind(s, (struct sockaddr *)&addr, sizeof(addr))
+			 || lwip_listen(s, MAX_HANDLERS)) {
+				PERR("could not set up server socket");
+				return;
+			}
+
+			_ready.up();
+
+			for (;;) {
+				struct sockaddr client_addr;
+				socklen_t len = sizeof(client_addr);
+				int fd = lwip_accept(s, &client_addr, &len);
+				if (fd < 0)
+					continue;
+
+				unsigned i = 0;
+				for (; i < MAX_HANDLERS && _handlers[i].busy(); i++);
+
+				if (i == MAX_HANDLERS) {
+					PERR("no handler left");
+					lwip_close(fd);
+					continue;
+				}
+				_handlers[i].serve(fd);
+			}
+		}
+
+		void wait_until_ready() { _ready.down(); }
+};
+
+
+/************
+ ** Client **
+ ************/
+
+static Timer::Connection timer;
+
+
+static bool valid(size_t offset, char const *buf, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		if (buf[i] != content(offset + i)) {
+			PERR("unexpected content at offset %zu", offset + i);
+			return false;
+		}
+	return true;
+}
+
+
+static void reset_requests()
+{
+	Lock::Guard guard(requests_lock);
+	requests = 0;
+}
+
+
+static void report(char const *name, size_t bytes, unsigned long start)
+{
+	unsigned long const ms = max(timer.elapsed_ms() - start, 1UL);
+	printf("%s: %zu KiB in %lu ms (%lu KiB/s), %u requests\n",
+	       name, bytes/1024, ms, (bytes/1024)*1000/ms, requests);
+}
+
+
+/**
+ * Thread reading blocks at pseudo-random offsets
+ */
+class Random_reader : public Thread<16384>
+{
+	private:
+
+		Block::Cache &_cache;
+		unsigned      _seed;
+		unsigned      _num_blocks;
+		Semaphore     _done;
+		char          _buf[BLOCK_SIZE];
+
+	public:
+
+		bool failed;
+
+		Random_reader(Block::Cache &cache, unsigned seed, unsigned num_blocks)
+		:
+			Thread<16384>("reader"), _cache(cache), _seed(seed),
+			_num_blocks(num_blocks), failed(false)
+		{ }
+
+		void entry()
+		{
+			for (unsigned i = 0; i < _num_blocks; i++) {
+				_seed = _seed*1103515245 + 12345;
+				size_t const offset = ((_seed >> 8) % (FILE_SIZE / BLOCK_SIZE))*BLOCK_SIZE;
+
+				try {
+					_cache.read(offset, BLOCK_SIZE, _buf);
+					if (!valid(offset, _buf, BLOCK_SIZE))
+						failed = true;
+				} catch (Http::Exception) {
+					failed = true;
+				}
+			}
+			_done.up();
+		}
+
+		void wait() { _done.down(); }
+};
+
+
+/**
+ * Read file sequentially and at random offsets
+ *
+ * \return  true on success
+ */
+static bool test(char const *name, unsigned connections, size_t read_ahead)
+{
+	printf("--- %s: %u connections, %zu KiB read-ahead ---\n",
+	       name, connections, read_ahead/1024);
+
+	/*
+	 * The back end is not destructed because the read-ahead thread of the
+	 * cache cannot be stopped.
+	 */
+	static char uri[] = "http://127.0.0.1:8080/disk.img";
+	Http &http = *new (env()->heap()) Http(uri, sizeof(uri) - 1, connections);
+
+	if (http.file_size() != FILE_SIZE) {
+		PERR("unexpected file size %zu", http.file_size());
+		return false;
+	}
+
+	Block::Cache &cache = *new (env()->heap())
+		Block::Cache(http, *env()->heap(), 4*1024*1024, read_ahead);
+
+	/* sequential reads */
+	reset_requests();
+	unsigned long start = timer.elapsed_ms();
+
+	static char buf[BLOCK_SIZE];
+	for (size_t offset = 0; offset < FILE_SIZE; offset += BLOCK_SIZE) {
+		cache.read(offset, BLOCK_SIZE, buf);
+		if (!valid(offset, buf, BLOCK_SIZE))
+			return false;
+	}
+	report("sequential", FILE_SIZE, start);
+
+	/* parallel random reads */
+	enum { NUM_BLOCKS = 256 };
+	reset_requests();
+	start = timer.elapsed_ms();
+
+	Random_reader *readers[Http::MAX_CONNECTIONS];
+	for (unsigned i = 0; i < connections; i++) {
+		readers[i] = new (env()->heap()) Random_reader(cache, i + 1, NUM_BLOCKS);
+		readers[i]->start();
+	}
+
+	bool failed = false;
+	for (unsigned i = 0; i < connections; i++) {
+		readers[i]->wait();
+		failed |= readers[i]->failed;
+	}
+	report("random", connections*NUM_BLOCKS*BLOCK_SIZE, start);
+
+	/* the threads are not destructed because they cannot be joined */
+	return !failed;
+}
+
+
+int main(int, char **)
+{
+	lwip_tcpip_init();
+
+	static Server server;
+	server.start();
+	server.wait_until_ready();
+
+	if (!test("single connection", 1, 0)
+	 || !test("parallel connections", 4, 1024*1024)) {
+		PERR("test failed");
+		return -1;
+	}
+
+	printf("--- http_block test finished ---\n");
+	return 0;
+}
@@ -0,0 +1,6 @@
+TARGET   = test-http_block
+SRC_CC   = main.cc http.cc
+LIBS     = lwip libc
+INC_DIR += $(REP_DIR)/src/server/http_block
+
+vpath http.cc $(REP_DIR)/src/server/http_block
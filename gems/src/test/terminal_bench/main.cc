@@ -0,0 +1,169 @@
+/*
+ * \brief  Throughput of the terminal escape-sequence decoder
+ * \author Norman Feske
+ * \date   2013-03-08
+ *
+ * The benchmark feeds generated text through 'Terminal::Decoder' into a
+ * character screen of the size of a 1024x768 terminal, one character at a
+ * time and in chunks as received via the bulk buffer of a terminal session.
+ * Between frames, the dirty cells are collected the same way as done by the
+ * terminal server. Besides the throughput, the number of cells to redraw is
+ * reported.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/printf.h>
+#include <util/misc_math.h>
+#include <util/string.h>
+#include <timer_session/connection.h>
+
+/* terminal includes */
+#include <terminal/decoder.h>
+#include <terminal/char_cell_array_character_screen.h>
+
+using namespace Genode;
+
+enum {
+	COLUMNS    = 128,
+	LINES      = 48,
+	TEXT_SIZE  = 16*1024*1024,  /* number of bytes fed to the decoder */
+	FRAME_SIZE = 4096,          /* bytes written between two flushes */
+};
+
+
+/**
+ * Pseudo-random numbers for generating the text
+ */
+static unsigned rnd()
+{
+	static unsigned seed = 93186752;
+	seed = seed*1103515245 + 12345;
+	return seed >> 8;
+}
+
+
+/**
+ * Generate text that resembles the log output of a build
+ *
+ * \param colored  insert color escape sequences
+ */
+static void generate_text(char *dst, size_t size, bool colored)
+{
+	static char const *words[] = {
+		"COMPILE", "LINK", "gcc", "-O2", "-Wall", "main.cc", "genode",
+		"include", "src/lib/libc", "warning:", "unused", "variable", "done" };
+
+	enum { NUM_WORDS = sizeof(words)/sizeof(words[0]) };
+
+	size_t pos = 0;
+	while (pos + 64 < size) {
+
+		if (colored && rnd() % 4 == 0) {
+			char const *seq = rnd() % 2 ? "\033[32m" : "\033[0m";
+			size_t const len = strlen(seq);
+			memcpy(dst + pos, seq, len);
+			pos += len;
+		}
+
+		char const *word = words[rnd() % NUM_WORDS];
+		size_t const len = strlen(word);
+		memcpy(dst + pos, word, len);
+		pos += len;
+
+		dst[pos++] = rnd() % 8 ? ' ' : '\n';
+	}
+
+	for (; pos < size; pos++)
+		dst[pos] = '\n';
+}
+
+
+/**
+ * Collect dirty cells as done by the terminal server
+ *
+ * \return  number of dirty cells
+ */
+static unsigned long flush(Cell_array<Char_cell> &cells)
+{
+	unsigned long num_cells = 0;
+
+	cells.mark_scroll_as_done();
+
+	for (unsigned line = 0; line < cells.num_lines(); line++) {
+
+		if (!cells.line_dirty(line))
+			continue;
+
+		for (unsigned column = 0; column < cells.num_cols(); column++)
+			if (cells.cell_dirty(column, line))
+				num_cells++;
+
+		cells.mark_line_as_clean(line);
+	}
+	return num_cells;
+}
+
+
+/**
+ * \param bulk  pass a frame at once to the decoder
+ */
+static void measure(Timer::Session &timer, char const *name, bool colored,
+                    bool bulk)
+{
+	char *text = (char *)env()->heap()->alloc(TEXT_SIZE);
+	generate_text(text, TEXT_SIZE, colored);
+
+	Cell_array<Char_cell>            cells(COLUMNS, LINES, env()->heap());
+	Char_cell_array_character_screen screen(cells);
+	Terminal::Decoder                decoder(screen);
+
+	unsigned long num_cells  = 0;
+	unsigned long num_frames = 0;
+
+	unsigned long const start = timer.elapsed_ms();
+
+	for (size_t pos = 0; pos < TEXT_SIZE; pos += FRAME_SIZE, num_frames++) {
+
+		size_t const end = min(pos + FRAME_SIZE, (size_t)TEXT_SIZE);
+
+		if (bulk)
+			decoder.insert((unsigned char const *)text + pos, end - pos);
+		else
+			for (size_t i = pos; i < end; i++)
+				decoder.insert(text[i]);
+
+		num_cells += flush(cells);
+	}
+
+	unsigned long const ms = max(timer.elapsed_ms() - start, 1UL);
+
+	printf("  %s: %4lu KiB/s, %lu of %u cells redrawn per frame\n",
+	       name, (TEXT_SIZE/1024)*1000/ms, num_cells/num_frames,
+	       COLUMNS*LINES);
+
+	env()->heap()->free(text, TEXT_SIZE);
+}
+
+
+int main(int, char **)
+{
+	static Timer::Connection timer;
+
+	printf("--- terminal benchmark started ---\n");
+
+	measure(timer, "plain text,   single", false, false);
+	measure(timer, "plain text,   bulk  ", false, true);
+	measure(timer, "colored text, single", true,  false);
+	measure(timer, "colored text, bulk  ", true,  true);
+
+	printf("--- terminal benchmark finished ---\n");
+	return 0;
+}
@@ -15,7 +15,7 @@
 #ifndef _LIBC_PLUGIN__FD_ALLOC_H_
 #define _LIBC_PLUGIN__FD_ALLOC_H_
 
-#include <base/allocator_avl.h>
+#include <base/lock.h>
 #include <base/printf.h>
 #include <os/path.h>
 
@@ -60,8 +60,30 @@ namespace Libc {
 	};
 
 
-	class File_descriptor_allocator : Allocator_avl_tpl<File_descriptor>
+	/**
+	 * Table of file descriptors
+	 *
+	 * The file descriptors are kept in chunks of 'CHUNK_SIZE' entries. The
+	 * chunks are allocated on demand and never freed. So looking up a file
+	 * descriptor is a plain array access that takes no lock. The lowest free
+	 * file descriptor is found via a bitmap of used file descriptors.
+	 */
+	class File_descriptor_allocator
 	{
+		private:
+
+			enum {
+				CHUNK_SIZE = 64,
+				NUM_CHUNKS = MAX_NUM_FDS / CHUNK_SIZE,
+				WORD_BITS  = sizeof(unsigned long)*8,
+				NUM_WORDS  = MAX_NUM_FDS / WORD_BITS,
+			};
+
+			Genode::Lock     _lock;                /* serializes 'alloc' and 'free' */
+			File_descriptor *_chunks[NUM_CHUNKS];
+			unsigned long    _used[NUM_WORDS];     /* bitmap of used fds */
+			unsigned long    _full;                /* bitmap of full '_used' words */
+
 		public:
 
 			/**
@@ -71,6 +93,9 @@ namespace Libc {
 
 			/**
 			 * Allocate file descriptor
+			 *
+			 * If 'libc_fd' is 'ANY_FD', the lowest free file descriptor
+			 * is allocated.
 			 */
 			File_descriptor *alloc(Plugin *plugin, Plugin_context *context, int libc_fd = -1);
 
@@ -79,6 +104,11 @@ namespace Libc {
 			 */
 			void free(File_descriptor *fdo);
 
+			/**
+			 * Look up file descriptor
+			 *
+			 * \return  file descriptor, or 0 if 'libc_fd' is not allocated
+			 */
 			File_descriptor *find_by_libc_fd(int libc_fd);
 	};
 
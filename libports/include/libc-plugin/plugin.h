@@ -44,6 +44,12 @@ namespace Libc {
 
 			virtual int priority();
 
+			/**
+			 * Return name used for referring to the plugin in the mount
+			 * table, or 0 if the plugin cannot be mounted
+			 */
+			virtual char const *name();
+
 			virtual bool supports_execve(char const *filename, char *const argv[],
 			                             char *const envp[]);
 			virtual bool supports_mkdir(const char *path, mode_t mode);
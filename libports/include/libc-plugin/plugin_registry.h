@@ -15,18 +15,81 @@
 #ifndef _LIBC_PLUGIN__PLUGIN_REGISTRY_H_
 #define _LIBC_PLUGIN__PLUGIN_REGISTRY_H_
 
+#include <base/lock.h>
 #include <util/list.h>
 
 #include <libc-plugin/plugin.h>
 
 namespace Libc {
 
+	class Mount_table;
+
+	/**
+	 * Registry of plugins, selects the plugin for a libc call
+	 *
+	 * Path-based calls are dispatched via the mount table if the path is
+	 * covered by a mount point configured in the '<libc>' config node:
+	 *
+	 * ! <libc statistics="yes">
+	 * !   <mount path="/dev/terminal" plugin="terminal"/>
+	 * !   <mount path="/"             plugin="fs"/>
+	 * ! </libc>
+	 *
+	 * All other calls are dispatched to the plugin with the highest
+	 * priority that supports the call. If 'statistics' is enabled, the
+	 * number of dispatched calls per plugin is printed at exit.
+	 */
 	class Plugin_registry : public List<Plugin>
 	{
 		public:
-		
+
+			enum Operation { EXECVE, FREEADDRINFO, GETADDRINFO, MKDIR, OPEN,
+			                 PIPE, READLINK, RENAME, SOCKET, STAT, SYMLINK,
+			                 UNLINK, NUM_OPERATIONS };
+
+		private:
+
+			enum { MAX_PLUGINS = 16 };
+
+			struct Statistics
+			{
+				Plugin        *plugin;
+				unsigned long  dispatches[NUM_OPERATIONS];
+				unsigned long  mounted;    /* dispatches via mount table */
+			};
+
+			Genode::Lock   _lock;
+			bool           _configured;
+			bool           _statistics_enabled;
+			Mount_table   *_mount_table;
+			Statistics     _statistics[MAX_PLUGINS];
+			unsigned long  _predicate_calls;
+
+			void _configure();
+
+			/**
+			 * Return plugin of the mount point covering 'path', or 0
+			 */
+			Plugin *_mounted_plugin(char const *path);
+
+			void _count(Plugin *plugin, Operation op, bool mounted);
+
+		public:
+
+			Plugin_registry();
+
+			/**
+			 * Unregister plugin
+			 */
+			void remove(Plugin *plugin);
+
+			/**
+			 * Print number of dispatched calls per plugin
+			 */
+			void dump_statistics();
+
 			Plugin *get_plugin_for_execve(char const *filename, char *const argv[],
-		                                  char *const envp[]);
+			                              char *const envp[]);
 			Plugin *get_plugin_for_freeaddrinfo(struct addrinfo *res);
 			Plugin *get_plugin_for_getaddrinfo(const char *node, const char *service,
 			                                   const struct addrinfo *hints,
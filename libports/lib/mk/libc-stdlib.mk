@@ -1,6 +1,9 @@
 LIBC_STDLIB_DIR = $(LIBC_DIR)/libc/stdlib
 FILTER_OUT = exit.c atexit.c malloc.c
 
+# process spawning is provided by libc plugins such as 'libc_noux'
+FILTER_OUT += system.c
+
 #SRC_C = $(notdir $(wildcard $(LIBC_STDLIB_DIR)/*.c))
 SRC_C = $(filter-out $(FILTER_OUT),$(notdir $(wildcard $(LIBC_STDLIB_DIR)/*.c)))
 
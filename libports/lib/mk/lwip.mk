@@ -9,7 +9,7 @@ include $(REP_DIR)/ports/lwip.inc
 LWIP_DIR = $(REP_DIR)/contrib/$(LWIP)
 
 # Genode platform files
-SRC_CC   = nic.cc printf.cc sys_arch.cc
+SRC_CC   = nic.cc printf.cc sys_arch.cc timer.cc
 
 # Core files
 SRC_C    = init.c mem.c memp.c netif.c pbuf.c stats.c udp.c raw.c sys.c \
@@ -25,7 +25,7 @@ SRC_C   += err.c api_lib.c api_msg.c netbuf.c netdb.c netifapi.c sockets.c \
 # Network interface files
 SRC_C   += etharp.c
 
-LIBS     = alarm libc timed_semaphore
+LIBS     = libc
 
 D_OPTS   = ERRNO
 D_OPTS  := $(addprefix -D,$(D_OPTS))
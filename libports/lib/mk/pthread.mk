@@ -1,5 +1,9 @@
 SRC_CC = semaphore.cc \
-         thread.cc
+         thread.cc \
+         mutex.cc \
+         cond.cc \
+         rwlock.cc \
+         key.cc
 
 LIBS  += libc
 
@@ -25,6 +25,17 @@ using namespace Genode;
 
 static bool const verbose = false;
 
+enum {
+	TX_BUF_SIZE   = 512*1024,
+
+	/*
+	 * Number of cached sectors. FatFs reads the FAT and directories one
+	 * sector at a time, so single-sector transfers are cached.
+	 */
+	CACHE_ENTRIES = 64,
+	MAX_BLK_SIZE  = 4096,
+};
+
 static Genode::Allocator_avl _block_alloc(Genode::env()->heap());
 static Block::Connection *_block_connection;
 static size_t _blk_size = 0;
@@ -32,6 +43,225 @@ static size_t _blk_cnt  = 0;
 static Block::Session::Tx::Source *_source;
 
 
+/**
+ * Cache of single sectors with least-recently-used replacement
+ */
+class Sector_cache
+{
+	private:
+
+		struct Entry
+		{
+			bool          valid;
+			DWORD         sector;
+			unsigned long used;    /* time of last access */
+			BYTE          data[MAX_BLK_SIZE];
+		};
+
+		Entry         _entries[CACHE_ENTRIES];
+		unsigned long _now;
+
+	public:
+
+		Sector_cache() : _now(0)
+		{
+			for (unsigned i = 0; i < CACHE_ENTRIES; i++)
+				_entries[i].valid = false;
+		}
+
+		/**
+		 * Copy cached sector to 'buff'
+		 *
+		 * \return  true if the sector was cached
+		 */
+		bool read(DWORD sector, BYTE *buff)
+		{
+			for (unsigned i = 0; i < CACHE_ENTRIES; i++) {
+				Entry &e = _entries[i];
+				if (!e.valid || e.sector != sector)
+					continue;
+
+				e.used = ++_now;
+				memcpy(buff, e.data, _blk_size);
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		 * Insert sector, replacing the least recently used one
+		 */
+		void insert(DWORD sector, BYTE const *data)
+		{
+			Entry *victim = &_entries[0];
+			for (unsigned i = 0; i < CACHE_ENTRIES; i++) {
+				Entry &e = _entries[i];
+
+				if (e.valid && e.sector == sector) {
+					victim = &e;
+					break;
+				}
+
+				if (!e.valid || (victim->valid && e.used < victim->used))
+					victim = &e;
+			}
+
+			victim->valid  = true;
+			victim->sector = sector;
+			victim->used   = ++_now;
+			memcpy(victim->data, data, _blk_size);
+		}
+
+		/**
+		 * Update cached sectors of a write request
+		 */
+		void update(DWORD sector, BYTE const *data, BYTE count)
+		{
+			for (unsigned i = 0; i < CACHE_ENTRIES; i++) {
+				Entry &e = _entries[i];
+				if (e.valid && e.sector >= sector && e.sector < sector + count)
+					memcpy(e.data, data + (e.sector - sector)*_blk_size, _blk_size);
+			}
+		}
+};
+
+
+static Sector_cache *sector_cache()
+{
+	static Sector_cache cache;
+	return &cache;
+}
+
+
+/**
+ * Read-ahead of the sectors following a multi-sector read
+ *
+ * FatFs reads whole sectors of a cluster directly into the caller's buffer.
+ * When a file is read sequentially, the next read request usually continues
+ * at the following sectors. Those are requested from the block device
+ * while FatFs and the client process the current data.
+ */
+class Read_ahead
+{
+	private:
+
+		bool                     _pending;  /* packet submitted */
+		bool                     _acked;    /* acknowledgement received */
+		Block::Packet_descriptor _packet;
+
+		void _wait()
+		{
+			if (_pending && !_acked) {
+				_packet = _source->get_acked_packet();
+				_acked  = true;
+			}
+		}
+
+	public:
+
+		Read_ahead() : _pending(false), _acked(false) { }
+
+		/**
+		 * Return true if 'packet' is the acknowledged read-ahead packet
+		 */
+		bool acked(Block::Packet_descriptor packet)
+		{
+			if (!_pending || _acked || packet.offset() != _packet.offset())
+				return false;
+
+			_packet = packet;
+			_acked  = true;
+			return true;
+		}
+
+		/**
+		 * Wait for a pending read-ahead and discard it
+		 */
+		void discard()
+		{
+			if (!_pending)
+				return;
+
+			_wait();
+			_source->release_packet(_packet);
+			_pending = _acked = false;
+		}
+
+		/**
+		 * Request 'count' sectors starting at 'sector'
+		 */
+		void request(DWORD sector, BYTE count)
+		{
+			discard();
+
+			if (sector + count > _blk_cnt)
+				return;
+
+			try {
+				_packet = Block::Packet_descriptor(
+					_source->alloc_packet(count*_blk_size),
+					Block::Packet_descriptor::READ, sector, count);
+			} catch (Block::Session::Tx::Source::Packet_alloc_failed) {
+				return;
+			}
+
+			_source->submit_packet(_packet);
+			_pending = true;
+		}
+
+		/**
+		 * Copy sectors from the read-ahead to 'buff'
+		 *
+		 * \return  true if the read-ahead covered the sectors
+		 */
+		bool read(DWORD sector, BYTE *buff, BYTE count)
+		{
+			if (!_pending)
+				return false;
+
+			DWORD const first = _packet.block_number();
+			if (sector < first || sector + count > first + _packet.block_count())
+				return false;
+
+			_wait();
+
+			bool const ok = _packet.succeeded();
+			if (ok)
+				memcpy(buff, _source->packet_content(_packet)
+				             + (sector - first)*_blk_size, count*_blk_size);
+
+			_source->release_packet(_packet);
+			_pending = _acked = false;
+			return ok;
+		}
+};
+
+
+static Read_ahead *read_ahead()
+{
+	static Read_ahead read_ahead;
+	return &read_ahead;
+}
+
+
+/**
+ * Submit packet and wait for its acknowledgement
+ *
+ * An acknowledgement of the read-ahead packet that arrives in the meantime
+ * is kept by the read-ahead.
+ */
+static Block::Packet_descriptor transfer(Block::Packet_descriptor p)
+{
+	_source->submit_packet(p);
+
+	for (;;) {
+		Block::Packet_descriptor acked = _source->get_acked_packet();
+		if (!read_ahead()->acked(acked))
+			return acked;
+	}
+}
+
+
 extern "C" DSTATUS disk_initialize (BYTE drv)
 {
 	static bool initialized = false;
@@ -50,7 +280,8 @@ extern "C" DSTATUS disk_initialize (BYTE drv)
 	}
 
 	try {
-		_block_connection = new (Genode::env()->heap()) Block::Connection(&_block_alloc);
+		_block_connection = new (Genode::env()->heap())
+			Block::Connection(&_block_alloc, TX_BUF_SIZE);
 	} catch(...) {
 		PERR("could not open block connection");
 		return STA_NOINIT;
@@ -61,6 +292,12 @@ extern "C" DSTATUS disk_initialize (BYTE drv)
 	Block::Session::Operations  ops;
 	_block_connection->info(&_blk_cnt, &_blk_size, &ops);
 
+	if (_blk_size > MAX_BLK_SIZE) {
+		PERR("Block size %zu is not supported", _blk_size);
+		destroy(env()->heap(), _block_connection);
+		return STA_NOINIT;
+	}
+
 	/* check for read- and write-capability */
 	if (!ops.supported(Block::Packet_descriptor::READ)) {
 		PERR("Block device not readable!");
@@ -103,11 +340,18 @@ extern "C" DRESULT disk_read(BYTE drv, BYTE *buff, DWORD sector, BYTE count)
 		return RES_ERROR;
 	}
 
+	if (count == 1 && sector_cache()->read(sector, buff))
+		return RES_OK;
+
+	if (read_ahead()->read(sector, buff, count)) {
+		read_ahead()->request(sector + count, count);
+		return RES_OK;
+	}
+
 	/* allocate packet-descriptor for reading */
-	Block::Packet_descriptor p(_source->alloc_packet(_blk_size),
+	Block::Packet_descriptor p(_source->alloc_packet(count * _blk_size),
 	                           Block::Packet_descriptor::READ, sector, count);
-	_source->submit_packet(p);
-	p = _source->get_acked_packet();
+	p = transfer(p);
 
 	/* check for success of operation */
 	if (!p.succeeded()) {
@@ -126,6 +370,12 @@ extern "C" DRESULT disk_read(BYTE drv, BYTE *buff, DWORD sector, BYTE count)
 #endif
 
 	_source->release_packet(p);
+
+	if (count == 1)
+		sector_cache()->insert(sector, buff);
+	else
+		read_ahead()->request(sector + count, count);
+
 	return RES_OK;
 }
 
@@ -142,14 +392,16 @@ extern "C" DRESULT disk_write(BYTE drv, const BYTE *buff, DWORD sector, BYTE cou
 		return RES_ERROR;
 	}
 
+	/* the read-ahead may cover the written sectors */
+	read_ahead()->discard();
+
 	/* allocate packet-descriptor for writing */
-	Block::Packet_descriptor p(_source->alloc_packet(_blk_size),
+	Block::Packet_descriptor p(_source->alloc_packet(count * _blk_size),
 	                           Block::Packet_descriptor::WRITE, sector, count);
 
 	memcpy(_source->packet_content(p), buff, count * _blk_size);
 
-	_source->submit_packet(p);
-	p = _source->get_acked_packet();
+	p = transfer(p);
 
 	/* check for success of operation */
 	if (!p.succeeded()) {
@@ -158,6 +410,8 @@ extern "C" DRESULT disk_write(BYTE drv, const BYTE *buff, DWORD sector, BYTE cou
 		return RES_ERROR;
 	}
 
+	sector_cache()->update(sector, buff, count);
+
 	_source->release_packet(p);
 	return RES_OK;
 }
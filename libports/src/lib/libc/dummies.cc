@@ -96,6 +96,29 @@ DUMMY(-1, __nsdefaultsrc)
 DUMMY(-1, _nsdispatch)
 DUMMY(-1, _openat)
 DUMMY(-1, pathconf)
+DUMMY(-1, pclose)
+DUMMY( 0, popen)
+DUMMY(ENOSYS, posix_spawn)
+DUMMY(ENOSYS, posix_spawnp)
+DUMMY(ENOSYS, posix_spawn_file_actions_addclose)
+DUMMY(ENOSYS, posix_spawn_file_actions_adddup2)
+DUMMY(ENOSYS, posix_spawn_file_actions_addopen)
+DUMMY(ENOSYS, posix_spawn_file_actions_destroy)
+DUMMY(ENOSYS, posix_spawn_file_actions_init)
+DUMMY(ENOSYS, posix_spawnattr_destroy)
+DUMMY(ENOSYS, posix_spawnattr_getflags)
+DUMMY(ENOSYS, posix_spawnattr_getpgroup)
+DUMMY(ENOSYS, posix_spawnattr_getschedparam)
+DUMMY(ENOSYS, posix_spawnattr_getschedpolicy)
+DUMMY(ENOSYS, posix_spawnattr_getsigdefault)
+DUMMY(ENOSYS, posix_spawnattr_getsigmask)
+DUMMY(ENOSYS, posix_spawnattr_init)
+DUMMY(ENOSYS, posix_spawnattr_setflags)
+DUMMY(ENOSYS, posix_spawnattr_setpgroup)
+DUMMY(ENOSYS, posix_spawnattr_setschedparam)
+DUMMY(ENOSYS, posix_spawnattr_setschedpolicy)
+DUMMY(ENOSYS, posix_spawnattr_setsigdefault)
+DUMMY(ENOSYS, posix_spawnattr_setsigmask)
 DUMMY(-1, pthread_create)
 DUMMY(-1, regcomp)
 DUMMY(-1, regexec)
@@ -134,6 +157,7 @@ DUMMY(-1, socketpair)
 DUMMY(-1, stat)
 DUMMY(-1, statfs)
 DUMMY( 0, sync)
+DUMMY(-1, system)
 DUMMY(-1, __test_sse)
 DUMMY(-1, truncate)
 DUMMY( 0, umask)
@@ -33,10 +33,10 @@ using namespace Libc;
 using namespace Genode;
 
 
-File_descriptor_allocator::File_descriptor_allocator()
-: Allocator_avl_tpl<File_descriptor>(Genode::env()->heap())
+File_descriptor_allocator::File_descriptor_allocator() : _full(0)
 {
-	add_range(0, MAX_NUM_FDS);
+	Genode::memset(_chunks, 0, sizeof(_chunks));
+	Genode::memset(_used,   0, sizeof(_used));
 }
 
 
@@ -44,39 +44,83 @@ File_descriptor *File_descriptor_allocator::alloc(Plugin *plugin,
                                                   Plugin_context *context,
                                                   int libc_fd)
 {
-	/* we use addresses returned by the allocator as file descriptors */
-	addr_t addr = (libc_fd == ANY_FD ? ANY_FD : libc_fd);
-
-	/* allocate fresh fd if the default value for 'libc_fd' was specified */
-	bool alloc_ok = false;
-	if (addr == ANY_FD) 
-		alloc_ok = Allocator_avl_base::alloc(1, reinterpret_cast<void**>(&addr));
-	else
-		alloc_ok = (Allocator_avl_base::alloc_addr(1, addr).is_ok());
-
-	if (!alloc_ok) {
+	Lock::Guard guard(_lock);
+
+	int fd = libc_fd;
+
+	/* allocate lowest free fd if the default value for 'libc_fd' was specified */
+	if (fd == ANY_FD) {
+
+		/* '__builtin_ctzl' is undefined for 0, so check for free bits first */
+		unsigned long const all_full = NUM_WORDS < WORD_BITS
+		                             ? (1UL << NUM_WORDS) - 1 : ~0UL;
+		if (_full != all_full) {
+			unsigned const word = __builtin_ctzl(~_full);
+			if (_used[word] != ~0UL)
+				fd = word*WORD_BITS + __builtin_ctzl(~_used[word]);
+		}
+	} else if (fd >= 0 && fd < MAX_NUM_FDS
+	        && (_used[fd / WORD_BITS] & (1UL << (fd % WORD_BITS))))
+		fd = ANY_FD;
+
+	if (fd < 0 || fd >= MAX_NUM_FDS) {
 		PERR("could not allocate libc_fd %d%s",
 		     libc_fd, libc_fd == ANY_FD ? " (any)" : "");
 		return 0;
 	}
 
-	File_descriptor *fdo = metadata((void*)addr);
-	fdo->libc_fd = (int)addr;
+	File_descriptor *chunk = _chunks[fd / CHUNK_SIZE];
+	if (!chunk) {
+		if (!env()->heap()->alloc(CHUNK_SIZE*sizeof(File_descriptor), &chunk)) {
+			PERR("could not allocate libc_fd %d", fd);
+			return 0;
+		}
+		Genode::memset(chunk, 0, CHUNK_SIZE*sizeof(File_descriptor));
+		__atomic_store_n(&_chunks[fd / CHUNK_SIZE], chunk, __ATOMIC_RELEASE);
+	}
+
+	File_descriptor *fdo = &chunk[fd % CHUNK_SIZE];
+	fdo->libc_fd = fd;
 	fdo->fd_path = 0;
 	fdo->plugin  = plugin;
 	fdo->context = context;
+
+	/* make the initialized fd visible to 'find_by_libc_fd' */
+	unsigned const word = fd / WORD_BITS;
+	__atomic_store_n(&_used[word], _used[word] | (1UL << (fd % WORD_BITS)),
+	                 __ATOMIC_RELEASE);
+
+	if (_used[word] == ~0UL)
+		_full |= 1UL << word;
+
 	return fdo;
 }
 
 
 void File_descriptor_allocator::free(File_descriptor *fdo)
 {
+	Lock::Guard guard(_lock);
+
 	::free(fdo->fd_path);
-	Allocator_avl_base::free(reinterpret_cast<void*>(fdo->libc_fd));
+	fdo->fd_path = 0;
+
+	unsigned const word = fdo->libc_fd / WORD_BITS;
+	__atomic_store_n(&_used[word], _used[word] & ~(1UL << (fdo->libc_fd % WORD_BITS)),
+	                 __ATOMIC_RELEASE);
+
+	_full &= ~(1UL << word);
 }
 
 
 File_descriptor *File_descriptor_allocator::find_by_libc_fd(int libc_fd)
 {
-	return metadata(reinterpret_cast<void*>(libc_fd));
+	if (libc_fd < 0 || libc_fd >= MAX_NUM_FDS)
+		return 0;
+
+	unsigned long const used = __atomic_load_n(&_used[libc_fd / WORD_BITS],
+	                                           __ATOMIC_ACQUIRE);
+	if (!(used & (1UL << (libc_fd % WORD_BITS))))
+		return 0;
+
+	return &_chunks[libc_fd / CHUNK_SIZE][libc_fd % CHUNK_SIZE];
 }
@@ -0,0 +1,179 @@
+/*
+ * \brief  Mapping of path prefixes to libc plugins
+ * \author Norman Feske
+ * \date   2013-03-17
+ *
+ * The mount table is a trie of path elements. Each node may be a mount
+ * point referring to a plugin by name. A path is dispatched to the plugin
+ * of the deepest mount point that is a prefix of the path.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _LIBC__MOUNT_TABLE_H_
+#define _LIBC__MOUNT_TABLE_H_
+
+/* Genode includes */
+#include <base/printf.h>
+#include <util/string.h>
+
+namespace Libc {
+
+	class Plugin;
+
+	class Mount_table
+	{
+		public:
+
+			enum { MAX_NODES = 64, MAX_NAME_LEN = 32, INVALID = -1 };
+
+			/**
+			 * Trie node, the root node corresponds to the path "/"
+			 */
+			struct Node
+			{
+				char    name[MAX_NAME_LEN];         /* path element */
+				char    plugin_name[MAX_NAME_LEN];  /* empty if no mount point */
+				Plugin *plugin;                     /* resolved plugin */
+				int     first_child, next_sibling;
+
+				bool mount_point() const { return plugin_name[0] != 0; }
+			};
+
+		private:
+
+			Node     _nodes[MAX_NODES];
+			unsigned _num_nodes;
+
+			/**
+			 * Return child of node 'parent' named by the first 'len'
+			 * characters of 'name'
+			 */
+			int _child(int parent, char const *name, Genode::size_t len) const
+			{
+				int i = _nodes[parent].first_child;
+				for (; i != INVALID; i = _nodes[i].next_sibling)
+					if (!Genode::strcmp(_nodes[i].name, name, len)
+					 && _nodes[i].name[len] == 0)
+						return i;
+				return INVALID;
+			}
+
+			int _new_node(char const *name, Genode::size_t len)
+			{
+				if (_num_nodes == MAX_NODES || len >= MAX_NAME_LEN)
+					return INVALID;
+
+				Node &n = _nodes[_num_nodes];
+				Genode::strncpy(n.name, name, len + 1);
+				n.plugin_name[0] = 0;
+				n.plugin         = 0;
+				n.first_child    = INVALID;
+				n.next_sibling   = INVALID;
+				return _num_nodes++;
+			}
+
+			/**
+			 * Return length of the path element at 'path'
+			 */
+			static Genode::size_t _element_len(char const *path)
+			{
+				Genode::size_t len = 0;
+				for (; path[len] && path[len] != '/'; len++);
+				return len;
+			}
+
+		public:
+
+			Mount_table() : _num_nodes(0) { _new_node("", 0); }
+
+			/**
+			 * Add mount point
+			 *
+			 * \param path         absolute path of the mount point
+			 * \param plugin_name  name of the plugin responsible for the
+			 *                     path and all paths below
+			 *
+			 * \return  false if the table is full or a name is too long
+			 */
+			bool insert(char const *path, char const *plugin_name)
+			{
+				if (Genode::strlen(plugin_name) >= MAX_NAME_LEN)
+					return false;
+
+				int node = 0;
+				while (*path) {
+					for (; *path == '/'; path++);
+
+					Genode::size_t const len = _element_len(path);
+					if (!len)
+						break;
+
+					int child = _child(node, path, len);
+					if (child == INVALID) {
+						child = _new_node(path, len);
+						if (child == INVALID)
+							return false;
+
+						_nodes[child].next_sibling = _nodes[node].first_child;
+						_nodes[node].first_child   = child;
+					}
+
+					node  = child;
+					path += len;
+				}
+
+				Genode::strncpy(_nodes[node].plugin_name, plugin_name, MAX_NAME_LEN);
+				_nodes[node].plugin = 0;
+				return true;
+			}
+
+			/**
+			 * Return deepest mount point that is a prefix of 'path'
+			 *
+			 * \return  node, or 0 if no mount point covers the path
+			 */
+			Node *lookup(char const *path)
+			{
+				int node = 0;
+				Node *result = _nodes[0].mount_point() ? &_nodes[0] : 0;
+
+				while (*path) {
+					for (; *path == '/'; path++);
+
+					Genode::size_t const len = _element_len(path);
+					if (!len)
+						break;
+
+					node = _child(node, path, len);
+					if (node == INVALID)
+						break;
+
+					if (_nodes[node].mount_point())
+						result = &_nodes[node];
+
+					path += len;
+				}
+				return result;
+			}
+
+			/**
+			 * Forget resolved plugin, called when the plugin vanishes
+			 */
+			void invalidate(Plugin *plugin)
+			{
+				for (unsigned i = 0; i < _num_nodes; i++)
+					if (_nodes[i].plugin == plugin)
+						_nodes[i].plugin = 0;
+			}
+
+			bool empty() const { return _num_nodes == 1 && !_nodes[0].mount_point(); }
+	};
+}
+
+#endif /* _LIBC__MOUNT_TABLE_H_ */
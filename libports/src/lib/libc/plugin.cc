@@ -42,6 +42,12 @@ int Plugin::priority()
 }
 
 
+char const *Plugin::name()
+{
+	return 0;
+}
+
+
 bool Plugin::supports_execve(char const *filename, char *const argv[],
                              char *const envp[])
 {
@@ -1,6 +1,6 @@
 /*
  * \brief  Plugin registry implementation
- * \author Christian Prochaska 
+ * \author Christian Prochaska
  * \date   2010-01-21
  */
 
@@ -11,8 +11,19 @@
  * under the terms of the GNU General Public License version 2.
  */
 
+/* Genode includes */
+#include <base/env.h>
+#include <base/printf.h>
+#include <os/config.h>
+
+/* libc includes */
+#include <stdlib.h>
+
 #include <libc-plugin/plugin_registry.h>
 
+/* local includes */
+#include "mount_table.h"
+
 namespace Libc {
 
 	Plugin_registry *plugin_registry()
@@ -25,64 +36,252 @@ namespace Libc {
 using namespace Libc;
 
 
-#define GET_PLUGIN_FOR(func_name, ...) \
+static void dump_statistics_at_exit() { plugin_registry()->dump_statistics(); }
+
+
+Plugin_registry::Plugin_registry()
+:
+	_configured(false), _statistics_enabled(false), _mount_table(0),
+	_predicate_calls(0)
+{
+	Genode::memset(_statistics, 0, sizeof(_statistics));
+}
+
+
+/*
+ * The configuration is evaluated on the first dispatch because plugins
+ * register themselves during the construction of static objects.
+ */
+void Plugin_registry::_configure()
+{
+	Genode::Lock::Guard guard(_lock);
+
+	if (_configured)
+		return;
+
+	try {
+		Genode::Xml_node libc_node = Genode::config()->xml_node().sub_node("libc");
+
+		try {
+			char buf[4];
+			libc_node.attribute("statistics").value(buf, sizeof(buf));
+			_statistics_enabled = !Genode::strcmp(buf, "yes");
+		} catch (Genode::Xml_node::Nonexistent_attribute) { }
+
+		Mount_table *mount_table = new (Genode::env()->heap()) Mount_table;
+
+		try {
+			for (Genode::Xml_node mount = libc_node.sub_node("mount"); ;
+			     mount = mount.next("mount")) {
+
+				char path[PATH_MAX], plugin[Mount_table::MAX_NAME_LEN];
+				try {
+					mount.attribute("path").value(path, sizeof(path));
+					mount.attribute("plugin").value(plugin, sizeof(plugin));
+
+					if (!mount_table->insert(path, plugin))
+						PERR("could not mount plugin %s at %s", plugin, path);
+
+				} catch (Genode::Xml_node::Nonexistent_attribute) {
+					PERR("mount node lacks 'path' or 'plugin' attribute");
+				}
+
+				if (mount.is_last("mount"))
+					break;
+			}
+		} catch (Genode::Xml_node::Nonexistent_sub_node) { }
+
+		if (mount_table->empty())
+			destroy(Genode::env()->heap(), mount_table);
+		else
+			_mount_table = mount_table;
+
+	} catch (Genode::Xml_node::Nonexistent_sub_node) {
+	} catch (Genode::Config::Invalid) {
+		/* no or malformed config, use the plugins without a mount table */
+	}
+
+	if (_statistics_enabled)
+		atexit(dump_statistics_at_exit);
+
+	_configured = true;
+}
+
+
+Plugin *Plugin_registry::_mounted_plugin(char const *path)
+{
+	if (!_configured)
+		_configure();
+
+	if (!_mount_table || !path)
+		return 0;
+
+	Genode::Lock::Guard guard(_lock);
+
+	Mount_table::Node *node = _mount_table->lookup(path);
+	if (!node)
+		return 0;
+
+	/* resolve plugin name on first use */
+	if (!node->plugin) {
+		for (Plugin *plugin = first(); plugin; plugin = plugin->next())
+			if (plugin->name() && !Genode::strcmp(plugin->name(), node->plugin_name))
+				node->plugin = plugin;
+
+		if (!node->plugin)
+			PERR("no plugin named '%s' for path %s", node->plugin_name, path);
+	}
+	return node->plugin;
+}
+
+
+void Plugin_registry::_count(Plugin *plugin, Operation op, bool mounted)
+{
+	if (!_statistics_enabled || !plugin)
+		return;
+
+	Genode::Lock::Guard guard(_lock);
+
+	for (unsigned i = 0; i < MAX_PLUGINS; i++) {
+		Statistics &s = _statistics[i];
+
+		if (s.plugin && s.plugin != plugin)
+			continue;
+
+		s.plugin = plugin;
+		s.dispatches[op]++;
+		if (mounted)
+			s.mounted++;
+		return;
+	}
+}
+
+
+void Plugin_registry::remove(Plugin *plugin)
+{
+	Genode::Lock::Guard guard(_lock);
+
+	List<Plugin>::remove(plugin);
+
+	if (_mount_table)
+		_mount_table->invalidate(plugin);
+
+	for (unsigned i = 0; i < MAX_PLUGINS; i++)
+		if (_statistics[i].plugin == plugin)
+			_statistics[i].plugin = 0;
+}
+
+
+void Plugin_registry::dump_statistics()
+{
+	static char const *op_names[NUM_OPERATIONS] = {
+		"execve", "freeaddrinfo", "getaddrinfo", "mkdir", "open", "pipe",
+		"readlink", "rename", "socket", "stat", "symlink", "unlink" };
+
+	Genode::Lock::Guard guard(_lock);
+
+	PINF("libc plugin dispatch statistics (%lu predicate calls)", _predicate_calls);
+
+	for (unsigned i = 0; i < MAX_PLUGINS; i++) {
+		Statistics const &s = _statistics[i];
+		if (!s.plugin)
+			continue;
+
+		PINF("  plugin %s: %lu calls via mount table",
+		     s.plugin->name() ? s.plugin->name() : "<unnamed>", s.mounted);
+
+		for (unsigned op = 0; op < NUM_OPERATIONS; op++)
+			if (s.dispatches[op])
+				PINF("    %s: %lu", op_names[op], s.dispatches[op]);
+	}
+}
+
+
+#define GET_PLUGIN_FOR(op, func_name, ...) \
 	int highest_priority_found = -1; \
 	Plugin *result = 0; \
 	for (Plugin *plugin = first(); plugin != 0; plugin = plugin->next()) { \
+		if (_statistics_enabled) _predicate_calls++; \
 		if (plugin->supports_##func_name(__VA_ARGS__) && \
 		    (plugin->priority() > highest_priority_found)) { \
 			result = plugin; \
 			highest_priority_found = plugin->priority(); \
 		} \
 	} \
+	_count(result, op, false); \
 	return result;
 
+#define MOUNTED_PLUGIN_FOR(op, path) \
+	if (Plugin *plugin = _mounted_plugin(path)) { \
+		_count(plugin, op, true); \
+		return plugin; \
+	}
+
 Plugin *Plugin_registry::get_plugin_for_execve(char const *filename, char *const argv[],
         char *const envp[]) {
-	GET_PLUGIN_FOR(execve, filename, argv, envp) }
+	MOUNTED_PLUGIN_FOR(EXECVE, filename)
+	GET_PLUGIN_FOR(EXECVE, execve, filename, argv, envp) }
 
 
 Plugin *Plugin_registry::get_plugin_for_freeaddrinfo(struct addrinfo *res) {
-	GET_PLUGIN_FOR(freeaddrinfo, res) }
+	GET_PLUGIN_FOR(FREEADDRINFO, freeaddrinfo, res) }
 
 
 Plugin *Plugin_registry::get_plugin_for_getaddrinfo(const char *node, const char *service,
                                                     const struct addrinfo *hints,
                                                     struct addrinfo **res) {
-	GET_PLUGIN_FOR(getaddrinfo, node, service, hints, res) }
+	GET_PLUGIN_FOR(GETADDRINFO, getaddrinfo, node, service, hints, res) }
 
 
 Plugin *Plugin_registry::get_plugin_for_mkdir(const char *path, mode_t mode) {
-	GET_PLUGIN_FOR(mkdir, path, mode) }
+	MOUNTED_PLUGIN_FOR(MKDIR, path)
+	GET_PLUGIN_FOR(MKDIR, mkdir, path, mode) }
 
 
 Plugin *Plugin_registry::get_plugin_for_open(const char *pathname, int flags) {
-	GET_PLUGIN_FOR(open, pathname, flags) }
+	MOUNTED_PLUGIN_FOR(OPEN, pathname)
+	GET_PLUGIN_FOR(OPEN, open, pathname, flags) }
 
 
 Plugin *Plugin_registry::get_plugin_for_pipe() {
-	GET_PLUGIN_FOR(pipe) }
+	GET_PLUGIN_FOR(PIPE, pipe) }
 
 
 Plugin *Plugin_registry::get_plugin_for_readlink(const char *path, char *buf, size_t bufsiz) {
-	GET_PLUGIN_FOR(readlink, path, buf, bufsiz) }
+	MOUNTED_PLUGIN_FOR(READLINK, path)
+	GET_PLUGIN_FOR(READLINK, readlink, path, buf, bufsiz) }
 
 
+/*
+ * A rename is dispatched via the mount table only if both paths belong to
+ * the same mount point.
+ */
 Plugin *Plugin_registry::get_plugin_for_rename(const char *oldpath, const char *newpath) {
-	GET_PLUGIN_FOR(rename, oldpath, newpath) }
+	Plugin *plugin = _mounted_plugin(oldpath);
+	if (plugin && plugin == _mounted_plugin(newpath)) {
+		_count(plugin, RENAME, true);
+		return plugin;
+	}
+	GET_PLUGIN_FOR(RENAME, rename, oldpath, newpath) }
 
 
 Plugin *Plugin_registry::get_plugin_for_socket(int domain, int type, int protocol) {
-	GET_PLUGIN_FOR(socket, domain, type, protocol) }
+	GET_PLUGIN_FOR(SOCKET, socket, domain, type, protocol) }
 
 
 Plugin *Plugin_registry::get_plugin_for_stat(const char *path, struct stat *) {
-	GET_PLUGIN_FOR(stat, path) }
+	MOUNTED_PLUGIN_FOR(STAT, path)
+	GET_PLUGIN_FOR(STAT, stat, path) }
 
 
+/*
+ * The location of a symlink is 'newpath', 'oldpath' is its content.
+ */
 Plugin *Plugin_registry::get_plugin_for_symlink(const char *oldpath, const char *newpath) {
-	GET_PLUGIN_FOR(symlink, oldpath, newpath) }
+	MOUNTED_PLUGIN_FOR(SYMLINK, newpath)
+	GET_PLUGIN_FOR(SYMLINK, symlink, oldpath, newpath) }
 
 
 Plugin *Plugin_registry::get_plugin_for_unlink(const char *path) {
-	GET_PLUGIN_FOR(unlink, path) }
+	MOUNTED_PLUGIN_FOR(UNLINK, path)
+	GET_PLUGIN_FOR(UNLINK, unlink, path) }
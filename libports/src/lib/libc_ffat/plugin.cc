@@ -188,6 +188,8 @@ class Plugin : public Libc::Plugin
 		 * TODO: decide if the file named <path> shall be handled by this plugin
 		 */
 
+		char const *name() { return "ffat"; }
+
 		bool supports_mkdir(const char *path, mode_t)
 		{
 			if (verbose)
@@ -234,6 +234,8 @@ class Plugin : public Libc::Plugin
 
 		~Plugin() { }
 
+		char const *name() { return "fs"; }
+
 		bool supports_mkdir(const char *path, mode_t)
 		{
 			if (verbose)
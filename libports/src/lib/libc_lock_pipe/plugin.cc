@@ -88,6 +88,8 @@ namespace {
 			 */
 			Plugin();
 
+			char const *name() { return "lock_pipe"; }
+
 			bool supports_pipe();
 			bool supports_select(int nfds,
 			                     fd_set *readfds,
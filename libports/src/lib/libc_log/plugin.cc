@@ -52,6 +52,8 @@ namespace {
 				_stderr(Libc::file_descriptor_allocator()->alloc(this, &_context, 2))
 			{ }
 
+			char const *name() { return "log"; }
+
 			int fcntl(Libc::File_descriptor *fd, int cmd, long arg)
 			{
 				switch (cmd) {
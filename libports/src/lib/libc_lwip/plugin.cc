@@ -159,6 +159,8 @@ struct Plugin : Libc::Plugin
 	 */
 	Plugin();
 
+	char const *name() { return "lwip"; }
+
 	bool supports_freeaddrinfo(struct ::addrinfo *res);
 	bool supports_getaddrinfo(const char *node, const char *service,
 	                          const struct ::addrinfo *hints,
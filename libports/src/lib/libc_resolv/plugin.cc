@@ -58,6 +58,8 @@ namespace {
 			 */
 			Plugin() { }
 
+			char const *name() { return "resolv"; }
+
 			bool supports_freeaddrinfo(struct ::addrinfo *res)
 			{
 				return true;
@@ -75,6 +75,8 @@ namespace {
 			Plugin()
 			{ }
 
+			char const *name() { return "rom"; }
+
 			bool supports_open(const char *path, int flags)
 			{
 				return _probe_rom(&path[1]);
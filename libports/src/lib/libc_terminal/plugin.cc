@@ -144,6 +144,8 @@ namespace {
 			 */
 			Plugin() { }
 
+			char const *name() { return "terminal"; }
+
 			bool supports_stat(const char *path)
 			{
 				return (Genode::strcmp(path, "/dev") == 0) ||
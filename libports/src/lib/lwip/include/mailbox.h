@@ -0,0 +1,212 @@
+/*
+ * \brief  Bounded mailbox used for lwIP's 'sys_mbox_t'
+ * \author Norman Feske
+ * \author Stefan Kalkowski
+ * \date   2009-10-29
+ *
+ * The mailbox is a fixed-size array of slots. Each slot carries a sequence
+ * number that tells producers and consumers whether the slot is ready to be
+ * written or read. Claiming a slot is a single compare-and-exchange on the
+ * head or tail index, so concurrent posters and fetchers never take a lock.
+ * Two semaphores count the occupied and free slots and are used for blocking
+ * only.
+ */
+
+/*
+ * Copyright (C) 2009-2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef __LWIP__INCLUDE__MAILBOX_H__
+#define __LWIP__INCLUDE__MAILBOX_H__
+
+#include <base/allocator.h>
+#include <cpu/atomic.h>
+
+#include <semaphore.h>
+
+namespace Lwip {
+
+	class Mailbox
+	{
+		public:
+
+			typedef Semaphore::Time Time;
+
+			enum { DEFAULT_SIZE = 128 };
+
+		private:
+
+			struct Slot
+			{
+				volatile int  seq;
+				void         *msg;
+			};
+
+			/*
+			 * Keep the indices modified by producers and consumers apart
+			 * from each other to avoid false sharing.
+			 */
+			enum { CACHE_LINE = 64 };
+
+			Genode::Allocator *_alloc;
+			unsigned const     _size;        /* power of two */
+			Slot              *_slots;
+
+			char               _pad0[CACHE_LINE];
+			volatile int       _head;        /* next slot to write */
+			char               _pad1[CACHE_LINE - sizeof(int)];
+			volatile int       _tail;        /* next slot to read */
+			char               _pad2[CACHE_LINE - sizeof(int)];
+
+			Semaphore          _used;        /* number of queued messages */
+			Semaphore          _free;        /* number of free slots */
+
+			static unsigned _round_up(int size)
+			{
+				unsigned s = 2;
+				while ((int)s < size)
+					s <<= 1;
+				return s;
+			}
+
+			/*
+			 * The sequence number of a slot hands over the ownership of the
+			 * message between producer and consumer. Reading it with acquire
+			 * and writing it with release semantics orders the accesses of
+			 * 'msg' on SMP systems with weakly-ordered memory, e.g., ARM.
+			 */
+			static int _seq(Slot const &slot) {
+				return __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE); }
+
+			static void _publish(Slot &slot, int seq) {
+				__atomic_store_n(&slot.seq, seq, __ATOMIC_RELEASE); }
+
+			/*
+			 * The semaphores guarantee that a slot is available. However,
+			 * the slot at the head or tail index may still be in transit by
+			 * another thread that claimed the index but has not updated the
+			 * slot sequence yet. This window is a few instructions long, so
+			 * we just retry.
+			 */
+
+			void _push(void *msg)
+			{
+				for (;;) {
+					int const pos = _head;
+					Slot &slot    = _slots[pos & (_size - 1)];
+					if (_seq(slot) == pos && Genode::cmpxchg(&_head, pos, pos + 1)) {
+						slot.msg = msg;
+						_publish(slot, pos + 1);
+						return;
+					}
+				}
+			}
+
+			void *_pop()
+			{
+				for (;;) {
+					int const pos = _tail;
+					Slot &slot    = _slots[pos & (_size - 1)];
+					if (_seq(slot) == pos + 1 && Genode::cmpxchg(&_tail, pos, pos + 1)) {
+						void *msg = slot.msg;
+						_publish(slot, pos + _size);
+						return msg;
+					}
+				}
+			}
+
+		public:
+
+			/**
+			 * Constructor
+			 *
+			 * \param alloc  allocator used for the slot array
+			 * \param size   minimum number of messages the mailbox can hold,
+			 *               rounded up to the next power of two
+			 *
+			 * \throw Genode::Allocator::Out_of_memory
+			 */
+			Mailbox(Genode::Allocator *alloc, int size)
+			:
+				_alloc(alloc), _size(_round_up(size > 0 ? size : DEFAULT_SIZE)),
+				_slots((Slot *)alloc->alloc(_size*sizeof(Slot))), _head(0), _tail(0),
+				_used(0), _free(_size)
+			{
+				for (unsigned i = 0; i < _size; i++) {
+					_slots[i].seq = i;
+					_slots[i].msg = 0;
+				}
+			}
+
+			~Mailbox() { _alloc->free(_slots, _size*sizeof(Slot)); }
+
+			/**
+			 * Post message, block as long as the mailbox is full
+			 */
+			void post(void *msg)
+			{
+				_free.down();
+				_push(msg);
+				_used.up();
+			}
+
+			/**
+			 * Post message if the mailbox is not full
+			 *
+			 * \return  true on success
+			 */
+			bool try_post(void *msg)
+			{
+				if (!_free.try_down())
+					return false;
+
+				_push(msg);
+				_used.up();
+				return true;
+			}
+
+			/**
+			 * Fetch message
+			 *
+			 * \param timeout  maximum time to block in milliseconds,
+			 *                 0 means blocking without timeout
+			 * \return         milliseconds the caller was blocked or
+			 *                 'Semaphore::TIMEOUT'
+			 */
+			Time fetch(void **msg, Time timeout)
+			{
+				Time const t = _used.down(timeout);
+				if (t == Semaphore::TIMEOUT)
+					return t;
+
+				*msg = _pop();
+				_free.up();
+				return t;
+			}
+
+			/**
+			 * Fetch message if one is available
+			 *
+			 * \return  true if a message was fetched
+			 */
+			bool try_fetch(void **msg)
+			{
+				if (!_used.try_down())
+					return false;
+
+				*msg = _pop();
+				_free.up();
+				return true;
+			}
+
+			/**
+			 * Return true if mailbox is empty
+			 */
+			bool empty() const { return _used.cnt() <= 0; }
+	};
+}
+
+#endif //__LWIP__INCLUDE__MAILBOX_H__
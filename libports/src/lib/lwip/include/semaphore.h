@@ -0,0 +1,207 @@
+/*
+ * \brief  Counting semaphore with lock-free fast path and deadline-based wait
+ * \author Stefan Kalkowski
+ * \date   2009-10-29
+ *
+ * In contrast to 'Genode::Timed_semaphore', 'up' and 'down' do not touch
+ * any lock as long as no thread has to block. Only blocking operations
+ * take the meta lock. Timeouts are registered at the one-shot scheduler
+ * (see 'timer.h') and thereby do not depend on a periodic jiffies thread.
+ */
+
+/*
+ * Copyright (C) 2009-2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef __LWIP__INCLUDE__SEMAPHORE_H__
+#define __LWIP__INCLUDE__SEMAPHORE_H__
+
+#include <base/lock.h>
+#include <util/fifo.h>
+#include <cpu/atomic.h>
+
+#include <timer.h>
+
+namespace Lwip {
+
+	/**
+	 * Atomically add 'value' to 'dest'
+	 *
+	 * \return  value of 'dest' before the addition
+	 */
+	static inline int atomic_add(volatile int *dest, int value)
+	{
+		for (;;) {
+			int const old = *dest;
+			if (Genode::cmpxchg(dest, old, old + value)) {
+				asm volatile ("" : : : "memory");
+				return old;
+			}
+		}
+	}
+
+
+	class Semaphore
+	{
+		public:
+
+			typedef Scheduler::Time Time;
+
+			/**
+			 * Return value of 'down' if the timeout triggered
+			 */
+			static const Time TIMEOUT = ~0UL;
+
+		private:
+
+			/**
+			 * Representation of a thread blocking on the semaphore
+			 */
+			class Waiter : public Genode::Fifo<Waiter>::Element,
+			               public Scheduler::Timeout
+			{
+				private:
+
+					Semaphore    &_sem;
+					Genode::Lock  _lock;
+
+				public:
+
+					bool timed_out;
+
+					Waiter(Semaphore &sem)
+					:
+						_sem(sem), _lock(Genode::Lock::LOCKED), timed_out(false)
+					{ }
+
+					void block()   { _lock.lock(); }
+					void wake_up() { _lock.unlock(); }
+
+					void expired() { _sem._abort(this); }
+			};
+
+			/*
+			 * A positive counter value denotes the number of available
+			 * tokens, a negative value the number of blocked threads.
+			 */
+			volatile int           _cnt;
+			Genode::Lock           _meta_lock;
+			Genode::Fifo<Waiter>   _waiters;
+
+			/**
+			 * Cancel blocking of waiter, called on timeout
+			 */
+			void _abort(Waiter *w)
+			{
+				Genode::Lock::Guard lock_guard(_meta_lock);
+
+				/* the waiter got woken up by 'up' already */
+				if (!w->is_enqueued())
+					return;
+
+				_waiters.remove(w);
+				atomic_add(&_cnt, 1);
+				w->timed_out = true;
+				w->wake_up();
+			}
+
+		public:
+
+			Semaphore(int n = 0) : _cnt(n) { }
+
+			~Semaphore()
+			{
+				/* synchronize destruction with unfinished 'up()' */
+				try { _meta_lock.lock(); } catch (...) { }
+			}
+
+			void up()
+			{
+				/* fast path, nobody is waiting */
+				if (atomic_add(&_cnt, 1) >= 0)
+					return;
+
+				/*
+				 * The blocking thread decremented the counter while holding
+				 * the meta lock and enqueued itself within the same critical
+				 * section. So it is present in the queue once we get the lock.
+				 */
+				Genode::Lock::Guard lock_guard(_meta_lock);
+				Waiter *w = _waiters.dequeue();
+				if (w)
+					w->wake_up();
+			}
+
+			/**
+			 * Try to take a token without blocking
+			 *
+			 * \return  true if a token was acquired
+			 */
+			bool try_down()
+			{
+				for (;;) {
+					int const old = _cnt;
+					if (old <= 0)
+						return false;
+					if (Genode::cmpxchg(&_cnt, old, old - 1)) {
+						asm volatile ("" : : : "memory");
+						return true;
+					}
+				}
+			}
+
+			/**
+			 * Take token, block if none is available
+			 *
+			 * \param timeout  maximum time to block in milliseconds,
+			 *                 0 means blocking without timeout
+			 * \return         milliseconds the caller was blocked, or
+			 *                 'TIMEOUT' if no token could be acquired in time,
+			 *                 always 0 when blocking without timeout
+			 */
+			Time down(Time timeout = 0)
+			{
+				if (try_down())
+					return 0;
+
+				_meta_lock.lock();
+
+				/* token became available in the meantime */
+				if (atomic_add(&_cnt, -1) > 0) {
+					_meta_lock.unlock();
+					return 0;
+				}
+
+				Waiter w(*this);
+				_waiters.enqueue(&w);
+				_meta_lock.unlock();
+
+				/* without timeout, the blocking time is not measured */
+				if (!timeout) {
+					w.block();
+					return 0;
+				}
+
+				Time const start = scheduler()->now();
+
+				scheduler()->schedule_absolute(&w, start + timeout);
+				w.block();
+				scheduler()->discard(&w);
+
+				if (w.timed_out)
+					return TIMEOUT;
+
+				return scheduler()->now() - start;
+			}
+
+			/**
+			 * Return current semaphore counter
+			 */
+			int cnt() const { return _cnt; }
+	};
+}
+
+#endif //__LWIP__INCLUDE__SEMAPHORE_H__
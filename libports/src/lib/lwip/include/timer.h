@@ -2,6 +2,11 @@
  * \brief  Timer thread, which schedules timeouts.
  * \author Stefan Kalkowski
  * \date   2009-10-28
+ *
+ * In contrast to the jiffies-based 'Genode::Timeout_thread', the scheduler
+ * does not tick periodically. It programs a one-shot timeout for the
+ * earliest pending deadline only and stays blocked as long as no timeout
+ * is pending at all.
  */
 
 /*
@@ -14,41 +19,147 @@
 #ifndef __LWIP__INCLUDE__TIMER_H__
 #define __LWIP__INCLUDE__TIMER_H__
 
-#include <os/alarm.h>
 #include <base/thread.h>
-#include <base/sleep.h>
-#include <base/printf.h>
+#include <base/lock.h>
+#include <base/signal.h>
 #include <timer_session/connection.h>
 
 namespace Lwip {
 
-	class Scheduler : public Genode::Thread<4096>,
-	                  public Genode::Alarm_scheduler
+	class Scheduler : public Genode::Thread<8192>
 	{
+		public:
+
+			typedef unsigned long Time;   /* milliseconds */
+
+			/**
+			 * Timeout to be scheduled for an absolute point in time
+			 */
+			class Timeout
+			{
+				private:
+
+					friend class Scheduler;
+
+					Timeout *_next;
+					Time     _deadline;
+					bool     _scheduled;
+
+				public:
+
+					Timeout() : _next(0), _deadline(0), _scheduled(false) { }
+
+					virtual ~Timeout() { }
+
+					/**
+					 * Called by the scheduler thread when the deadline passed
+					 *
+					 * The function is executed with the scheduler lock held.
+					 * Hence, it must not call back into the scheduler.
+					 */
+					virtual void expired() = 0;
+			};
+
 		private:
 
-			Timer::Connection   _timer;
-			Genode::Alarm::Time _curr_time;   /* jiffies value */
+			Timer::Connection         _timer;
+			Genode::Signal_receiver   _sig_rec;
+			Genode::Signal_context    _sig_ctx;
+			Genode::Lock              _lock;
+			Timeout                  *_head;   /* sorted by deadline */
 
-			enum { TIMER_GRANULARITY_MSEC = 1 };
+			/**
+			 * Program one-shot timeout for the head of the queue
+			 *
+			 * Must be called with '_lock' held.
+			 */
+			void _program(Time now)
+			{
+				if (!_head)
+					return;
+
+				Time const delay = _head->_deadline > now
+				                 ? _head->_deadline - now : 1;
+				_timer.trigger_once(delay*1000);
+			}
 
-			void entry()
+			/**
+			 * Dequeue timeout, must be called with '_lock' held
+			 */
+			void _dequeue(Timeout *t)
 			{
-				while (true) {
-					_timer.msleep(TIMER_GRANULARITY_MSEC);
-					Genode::Alarm_scheduler::handle(_curr_time);
-					_curr_time += TIMER_GRANULARITY_MSEC;
-				}
+				if (!t->_scheduled)
+					return;
+
+				if (_head == t)
+					_head = t->_next;
+				else
+					for (Timeout *e = _head; e; e = e->_next)
+						if (e->_next == t) {
+							e->_next = t->_next;
+							break;
+						}
+
+				t->_next      = 0;
+				t->_scheduled = false;
 			}
 
+			void entry();
+
 		public:
 
-			Scheduler() : _curr_time(0) { }
+			Scheduler() : Genode::Thread<8192>("lwip_timeout"), _head(0)
+			{
+				_timer.sigh(_sig_rec.manage(&_sig_ctx));
+				start();
+			}
+
+			/**
+			 * Return current time in milliseconds
+			 */
+			Time now() { return _timer.elapsed_ms(); }
+
+			/**
+			 * Schedule timeout to expire at the absolute 'deadline'
+			 */
+			void schedule_absolute(Timeout *t, Time deadline)
+			{
+				Genode::Lock::Guard lock_guard(_lock);
+
+				_dequeue(t);
+				t->_deadline  = deadline;
+				t->_scheduled = true;
 
-			Genode::Alarm::Time curr_time() { return _curr_time; }
+				/* insert sorted by deadline */
+				Timeout **prev = &_head;
+				while (*prev && (*prev)->_deadline <= deadline)
+					prev = &(*prev)->_next;
+				t->_next = *prev;
+				*prev    = t;
+
+				/* re-program the one-shot timer only if the head changed */
+				if (_head == t)
+					_program(now());
+			}
+
+			/**
+			 * Revoke timeout
+			 *
+			 * After returning from this function, it is guaranteed that
+			 * 'expired()' of the timeout is neither executed nor will be
+			 * executed.
+			 */
+			void discard(Timeout *t)
+			{
+				Genode::Lock::Guard lock_guard(_lock);
+				_dequeue(t);
+			}
 	};
 
 
+	/**
+	 * Return singleton scheduler used for all lwIP timeouts
+	 */
 	extern Scheduler *scheduler();
 }
 
@@ -16,12 +16,12 @@
 #include <base/env.h>
 #include <base/lock.h>
 #include <parent/parent.h>
-#include <os/timed_semaphore.h>
 
 /* LwIP includes */
 #include <lwip/genode.h>
 #include <timer.h>
-#include <ring_buffer.h>
+#include <semaphore.h>
+#include <mailbox.h>
 #include <thread.h>
 #include <verbose.h>
 
@@ -37,10 +37,6 @@ namespace Lwip {
 
 			Mutex() : counter(0), thread((Genode::Thread_base*)-1) {}
 	};
-
-
-	/* LwIP's so called mailboxes map to a ring buffer in our case */
-	typedef Ring_buffer Mailbox;
 }
 
 
@@ -65,11 +61,11 @@ static Lwip::Mutex *global_mutex()
 
 
 /**
- * Returns a timed semaphore used to wait for DHCP to come up.
+ * Returns a semaphore used to wait for DHCP to come up.
  */
-static Genode::Timed_semaphore *dhcp_semaphore()
+static Lwip::Semaphore *dhcp_semaphore()
 {
-	static Genode::Timed_semaphore _sem;
+	static Lwip::Semaphore _sem;
 	return &_sem;
 }
 
@@ -174,9 +170,7 @@ extern "C" {
 				dhcp_start(&netif);
 
 				/* Block until DHCP succeeded or a timeout was triggered */
-				try {
-					dhcp_semaphore()->down(20000);
-				} catch (Genode::Timeout_exception) {
+				if (dhcp_semaphore()->down(20000) == Lwip::Semaphore::TIMEOUT) {
 					PWRN("DHCP timed out!");
 					return 1;
 				}
@@ -213,8 +207,8 @@ extern "C" {
 	err_t sys_sem_new(sys_sem_t* sem, u8_t count)
 	{
 		try {
-			Genode::Timed_semaphore *_sem = new (Genode::env()->heap())
-			                                Genode::Timed_semaphore(count);
+			Lwip::Semaphore *_sem = new (Genode::env()->heap())
+			                        Lwip::Semaphore(count);
 			sem->ptr = _sem;
 			return ERR_OK;
 		} catch (Genode::Allocator::Out_of_memory) {
@@ -237,8 +231,8 @@ extern "C" {
 	void sys_sem_free(sys_sem_t* sem)
 	{
 		try {
-			Genode::Timed_semaphore *_sem =
-				reinterpret_cast<Genode::Timed_semaphore*>(sem->ptr);
+			Lwip::Semaphore *_sem =
+				reinterpret_cast<Lwip::Semaphore*>(sem->ptr);
 			if (_sem)
 				destroy(Genode::env()->heap(), _sem);
 		} catch (...) {
@@ -254,8 +248,8 @@ extern "C" {
 	void sys_sem_signal(sys_sem_t* sem)
 	{
 		try {
-			Genode::Timed_semaphore *_sem =
-				reinterpret_cast<Genode::Timed_semaphore*>(sem->ptr);
+			Lwip::Semaphore *_sem =
+				reinterpret_cast<Lwip::Semaphore*>(sem->ptr);
 			if (!_sem) {
 				//PERR("Invalid semaphore pointer at: %lx", *sem->ptr);
 				return;
@@ -277,8 +271,8 @@ extern "C" {
 	int sys_sem_valid(sys_sem_t* sem)
 	{
 		try {
-			Genode::Timed_semaphore *_sem =
-				reinterpret_cast<Genode::Timed_semaphore*>(sem->ptr);
+			Lwip::Semaphore *_sem =
+				reinterpret_cast<Lwip::Semaphore*>(sem->ptr);
 
 			if (_sem)
 				return 1;
@@ -310,28 +304,14 @@ extern "C" {
 	 */
 	u32_t sys_arch_sem_wait(sys_sem_t* sem, u32_t timeout)
 	{
-		using namespace Genode;
-		try {
-			Timed_semaphore *_sem = reinterpret_cast<Timed_semaphore*>(sem->ptr);
-			if (!_sem) {
-				//PERR("Invalid semaphore pointer at: %lx", *sem->ptr);
-				return EINVAL;
-			}
-
-			/* If no timeout is requested, we have to track the time ourself */
-			if (!timeout) {
-				Alarm::Time starttime = Timeout_thread::alarm_timer()->time();
-				_sem->down();
-				return Timeout_thread::alarm_timer()->time() - starttime;
-			} else {
-				return _sem->down(timeout);
-			}
-		} catch (Timeout_exception) {
-			return SYS_ARCH_TIMEOUT;
-		} catch (...) {
-			PERR("Unknown Exception occured!");
-			return -1;
+		Lwip::Semaphore *_sem = reinterpret_cast<Lwip::Semaphore*>(sem->ptr);
+		if (!_sem) {
+			//PERR("Invalid semaphore pointer at: %lx", *sem->ptr);
+			return EINVAL;
 		}
+
+		Lwip::Semaphore::Time const t = _sem->down(timeout);
+		return t == Lwip::Semaphore::TIMEOUT ? SYS_ARCH_TIMEOUT : t;
 	}
 
 
@@ -376,9 +356,9 @@ extern "C" {
 	 * \return      a new mailbox, or SYS_MBOX_NULL on error.
 	 */
 	err_t sys_mbox_new(sys_mbox_t *mbox, int size) {
-		LWIP_UNUSED_ARG(size);
 		try {
-			Mailbox* _mbox = new (Genode::env()->heap()) Mailbox();
+			Mailbox* _mbox = new (Genode::env()->heap())
+			                 Mailbox(Genode::env()->heap(), size);
 			mbox->ptr = _mbox;
 			return ERR_OK;
 		} catch (Genode::Allocator::Out_of_memory) {
@@ -450,22 +430,14 @@ extern "C" {
 	 */
 	void sys_mbox_post(sys_mbox_t* mbox, void *msg)
 	{
-		while (true) {
-			try {
-				Mailbox* _mbox = reinterpret_cast<Mailbox*>(mbox->ptr);
-				if (!_mbox) {
-					//PERR("Invalid mailbox pointer at %lx", *mbox->ptr);
-					return;
-				}
-				_mbox->add(msg);
-				return;
-			} catch (Mailbox::Overflow) {
-				if (verbose)
-					PWRN("Overflow exception!");
-			} catch (...) {
-				PERR("Unknown Exception occured!");
-			}
+		Mailbox* _mbox = reinterpret_cast<Mailbox*>(mbox->ptr);
+		if (!_mbox) {
+			//PERR("Invalid mailbox pointer at %lx", *mbox->ptr);
+			return;
 		}
+
+		/* blocks as long as the mailbox is full */
+		_mbox->post(msg);
 	}
 
 
@@ -477,20 +449,17 @@ extern "C" {
 	 */
 	err_t sys_mbox_trypost(sys_mbox_t* mbox, void *msg)
 	{
-		try {
-			Mailbox* _mbox = reinterpret_cast<Mailbox*>(mbox->ptr);
-			if (!_mbox) {
-				//PERR("Invalid mailbox pointer at %lx", *mbox->ptr);
-				return EINVAL;
-			}
-			_mbox->add(msg);
-			return ERR_OK;
-		} catch (Mailbox::Overflow) {
-			if (verbose)
-				PWRN("Overflow exception!");
-		} catch (...) {
-			PERR("Unknown Exception occured!");
+		Mailbox* _mbox = reinterpret_cast<Mailbox*>(mbox->ptr);
+		if (!_mbox) {
+			//PERR("Invalid mailbox pointer at %lx", *mbox->ptr);
+			return EINVAL;
 		}
+
+		if (_mbox->try_post(msg))
+			return ERR_OK;
+
+		if (verbose)
+			PWRN("Overflow!");
 		return ERR_MEM;
 	}
 
@@ -511,21 +480,14 @@ extern "C" {
 		if (!mbox)
 			return 0;
 
-		try {
-			Mailbox* _mbox = reinterpret_cast<Mailbox*>(mbox->ptr);
-			if (!_mbox) {
-				//PERR("Invalid mailbox pointer at %lx", *mbox->ptr);
-				return EINVAL;
-			}
-			return _mbox->get(msg, timeout);
-		} catch (Genode::Timeout_exception) {
-			return SYS_ARCH_TIMEOUT;
-		} catch (Genode::Nonblocking_exception) {
-			return SYS_MBOX_EMPTY;
-		} catch (...) {
-			PERR("Unknown Exception occured!");
-			return -1;
+		Mailbox* _mbox = reinterpret_cast<Mailbox*>(mbox->ptr);
+		if (!_mbox) {
+			//PERR("Invalid mailbox pointer at %lx", *mbox->ptr);
+			return EINVAL;
 		}
+
+		Mailbox::Time const t = _mbox->fetch(msg, timeout);
+		return t == Semaphore::TIMEOUT ? SYS_ARCH_TIMEOUT : t;
 	}
 
 
@@ -541,7 +503,14 @@ extern "C" {
 	 */
 	u32_t sys_arch_mbox_tryfetch(sys_mbox_t* mbox, void **msg)
 	{
-		return sys_arch_mbox_fetch(mbox, msg, Mailbox::NO_BLOCK);
+		if (!mbox)
+			return 0;
+
+		Mailbox* _mbox = reinterpret_cast<Mailbox*>(mbox->ptr);
+		if (!_mbox)
+			return EINVAL;
+
+		return _mbox->try_fetch(msg) ? 0 : SYS_MBOX_EMPTY;
 	}
 
 
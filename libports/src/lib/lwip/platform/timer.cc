@@ -0,0 +1,42 @@
+/*
+ * \brief  One-shot timeout scheduler used by the lwIP back end
+ * \author Stefan Kalkowski
+ * \date   2009-10-28
+ */
+
+/*
+ * Copyright (C) 2009-2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* LwIP includes */
+#include <timer.h>
+
+
+void Lwip::Scheduler::entry()
+{
+	while (true) {
+		_sig_rec.wait_for_signal();
+
+		Genode::Lock::Guard lock_guard(_lock);
+
+		/* fire all timeouts whose deadline passed */
+		Time const curr = now();
+		while (_head && _head->_deadline <= curr) {
+			Timeout *t = _head;
+			_dequeue(t);
+			t->expired();
+		}
+
+		_program(curr);
+	}
+}
+
+
+Lwip::Scheduler *Lwip::scheduler()
+{
+	static Scheduler _scheduler;
+	return &_scheduler;
+}
@@ -0,0 +1,268 @@
+/*
+ * \brief  POSIX condition-variable implementation
+ * \author Norman Feske
+ * \date   2013-03-18
+ *
+ * Each waiting thread blocks on a semaphore of its own, which is queued at
+ * the condition variable. Signalling a condition variable without waiters
+ * does not take any lock.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#include <os/timed_semaphore.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+/* local includes */
+#include "thread.h"
+
+using namespace Genode;
+
+extern "C" {
+
+	/*
+	 * This class is named 'struct pthread_cond_attr' because the
+	 * 'pthread_condattr_t' type is defined as 'struct pthread_cond_attr*'
+	 * in '_pthreadtypes.h'
+	 */
+	struct pthread_cond_attr { };
+
+
+	/*
+	 * This class is named 'struct pthread_cond' because the
+	 * 'pthread_cond_t' type is defined as 'struct pthread_cond*' in
+	 * '_pthreadtypes.h'
+	 */
+	struct pthread_cond
+	{
+		struct Waiter
+		{
+			Timed_semaphore sem;
+			Waiter         *next;
+			bool            signalled;
+
+			Waiter() : next(0), signalled(false) { }
+		};
+
+		Lock          _lock;          /* protects the waiter queue */
+		Waiter       *_first, *_last;
+		volatile int  _num_waiters;
+
+		pthread_cond() : _first(0), _last(0), _num_waiters(0) { }
+
+		void _enqueue(Waiter *w)
+		{
+			if (_last) _last->next = w;
+			else       _first      = w;
+
+			_last = w;
+			_num_waiters++;
+		}
+
+		void _remove(Waiter *w)
+		{
+			Waiter *prev = 0;
+			for (Waiter *curr = _first; curr; prev = curr, curr = curr->next) {
+				if (curr != w)
+					continue;
+
+				if (prev) prev->next = w->next;
+				else      _first     = w->next;
+
+				if (_last == w)
+					_last = prev;
+
+				_num_waiters--;
+				return;
+			}
+		}
+
+		/**
+		 * Wait for signal
+		 *
+		 * \param timeout  timeout in milliseconds, 0 for waiting
+		 *                 without timeout
+		 *
+		 * \return  0 on success, or ETIMEDOUT
+		 */
+		int wait(pthread_mutex_t *mutex, Alarm::Time timeout)
+		{
+			Waiter w;
+			{
+				Lock::Guard guard(_lock);
+				_enqueue(&w);
+			}
+
+			pthread_mutex_unlock(mutex);
+
+			int result = 0;
+
+			if (!timeout) {
+				w.sem.down();
+			} else {
+				try {
+					w.sem.down(max(timeout, (Alarm::Time)Timeout_thread::GRANULARITY_MSECS));
+				} catch (Timeout_exception) {
+
+					Lock::Guard guard(_lock);
+
+					/* a signal may have raced with the timeout */
+					if (!w.signalled) {
+						_remove(&w);
+						result = ETIMEDOUT;
+					}
+				}
+			}
+
+			/*
+			 * The signalling thread may still access 'w' after waking us
+			 * up because 'Semaphore::up' releases its meta lock after the
+			 * wakeup. It holds '_lock' until it is done with 'w'. So we
+			 * wait for '_lock' before 'w' goes out of scope.
+			 */
+			{ Lock::Guard guard(_lock); }
+
+			pthread_mutex_lock(mutex);
+			return result;
+		}
+
+		void signal()
+		{
+			if (!_num_waiters)
+				return;
+
+			Lock::Guard guard(_lock);
+
+			Waiter *w = _first;
+			if (!w)
+				return;
+
+			_remove(w);
+			w->signalled = true;
+			w->sem.up();
+		}
+
+		void broadcast()
+		{
+			if (!_num_waiters)
+				return;
+
+			Lock::Guard guard(_lock);
+
+			while (Waiter *w = _first) {
+				_remove(w);
+				w->signalled = true;
+				w->sem.up();
+			}
+		}
+	};
+
+
+	int pthread_condattr_init(pthread_condattr_t *attr)
+	{
+		if (!attr)
+			return EINVAL;
+
+		*attr = new (env()->heap()) pthread_cond_attr;
+		return 0;
+	}
+
+
+	int pthread_condattr_destroy(pthread_condattr_t *attr)
+	{
+		if (!attr || !*attr)
+			return EINVAL;
+
+		destroy(env()->heap(), *attr);
+		*attr = 0;
+		return 0;
+	}
+
+
+	int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *)
+	{
+		if (!cond)
+			return EINVAL;
+
+		*cond = new (env()->heap()) pthread_cond;
+		return 0;
+	}
+
+
+	int pthread_cond_destroy(pthread_cond_t *cond)
+	{
+		if (!cond)
+			return EINVAL;
+
+		/* a statically initialized condition variable may not have been used */
+		if (!*cond)
+			return 0;
+
+		if ((*cond)->_num_waiters)
+			return EBUSY;
+
+		destroy(env()->heap(), *cond);
+		*cond = 0;
+		return 0;
+	}
+
+
+	int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+	{
+		if (!cond || !mutex)
+			return EINVAL;
+
+		return Pthread::object(cond)->wait(mutex, 0);
+	}
+
+
+	int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+	                           const struct timespec *abstime)
+	{
+		if (!cond || !mutex || !abstime)
+			return EINVAL;
+
+		struct timeval now;
+		gettimeofday(&now, 0);
+
+		/* convert absolute time to timeout in milliseconds */
+		long long const ms = (abstime->tv_sec - now.tv_sec)*1000LL
+		                   + (abstime->tv_nsec/1000 - now.tv_usec)/1000;
+		if (ms <= 0)
+			return ETIMEDOUT;
+
+		return Pthread::object(cond)->wait(mutex, ms);
+	}
+
+
+	int pthread_cond_signal(pthread_cond_t *cond)
+	{
+		if (!cond)
+			return EINVAL;
+
+		/* nobody can wait for a condition variable that was never used */
+		if (*cond)
+			(*cond)->signal();
+		return 0;
+	}
+
+
+	int pthread_cond_broadcast(pthread_cond_t *cond)
+	{
+		if (!cond)
+			return EINVAL;
+
+		/* nobody can wait for a condition variable that was never used */
+		if (*cond)
+			(*cond)->broadcast();
+		return 0;
+	}
+}
@@ -0,0 +1,184 @@
+/*
+ * \brief  POSIX thread-specific data
+ * \author Norman Feske
+ * \date   2013-03-18
+ *
+ * The values of the keys are stored in the thread object of threads created
+ * by 'pthread_create'. Other threads, e.g., threads created via the Genode
+ * API, have no such object. Their values are kept in a separate table.
+ * Each creation of a key starts a new generation of the key, which
+ * invalidates the values stored for a deleted key with the same number.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+
+/* local includes */
+#include "thread.h"
+
+using namespace Genode;
+
+
+namespace {
+
+	struct Key
+	{
+		bool      used;
+		unsigned  generation;
+		void    (*destructor)(void *);
+	};
+
+	Key  _keys[PTHREAD_KEYS_MAX];
+	Lock _keys_lock;
+
+	bool valid(pthread_key_t key) { return key >= 0 && key < PTHREAD_KEYS_MAX; }
+
+	/**
+	 * Key values of a thread not created by 'pthread_create'
+	 *
+	 * The end of such a thread is not known, so the entries are never
+	 * freed.
+	 */
+	struct Foreign_key_values : List<Foreign_key_values>::Element
+	{
+		Thread_base * const thread;
+		Pthread::Key_values values;
+
+		Foreign_key_values(Thread_base *thread) : thread(thread) { }
+	};
+
+	Lock                     _foreign_lock;
+	List<Foreign_key_values> _foreign;
+}
+
+
+Pthread::Key_values &Pthread::key_values()
+{
+	Thread_base * const myself = Thread_base::myself();
+
+	/* the main thread is represented by a static pthread object */
+	if (!myself)
+		return pthread_self()->_key_values;
+
+	if (pthread_t thread = lookup(myself))
+		return thread->_key_values;
+
+	Lock::Guard guard(_foreign_lock);
+
+	for (Foreign_key_values *f = _foreign.first(); f; f = f->next())
+		if (f->thread == myself)
+			return f->values;
+
+	Foreign_key_values *f = new (env()->heap()) Foreign_key_values(myself);
+	_foreign.insert(f);
+	return f->values;
+}
+
+
+void Pthread::destruct_key_values()
+{
+	Key_values &values = key_values();
+
+	/*
+	 * A destructor may set values again, which are destructed in the next
+	 * iteration.
+	 */
+	for (unsigned n = 0; n < PTHREAD_DESTRUCTOR_ITERATIONS; n++) {
+
+		bool called = false;
+
+		for (unsigned k = 0; k < PTHREAD_KEYS_MAX; k++) {
+
+			Key_values::Value &v = values.values[k];
+
+			void (*destructor)(void *);
+			{
+				Lock::Guard guard(_keys_lock);
+				bool const current = _keys[k].used
+				                  && _keys[k].generation == v.generation;
+				destructor = current ? _keys[k].destructor : 0;
+			}
+
+			void *value = v.value;
+			v.value = 0;
+
+			if (value && destructor) {
+				destructor(value);
+				called = true;
+			}
+		}
+
+		if (!called)
+			return;
+	}
+}
+
+
+extern "C" {
+
+	int pthread_key_create(pthread_key_t *key, void (*destructor)(void *))
+	{
+		if (!key)
+			return EINVAL;
+
+		Lock::Guard guard(_keys_lock);
+
+		for (unsigned k = 0; k < PTHREAD_KEYS_MAX; k++) {
+			if (_keys[k].used)
+				continue;
+
+			_keys[k].used       = true;
+			_keys[k].destructor = destructor;
+			_keys[k].generation++;
+			*key = k;
+			return 0;
+		}
+		return EAGAIN;
+	}
+
+
+	int pthread_key_delete(pthread_key_t key)
+	{
+		if (!valid(key))
+			return EINVAL;
+
+		Lock::Guard guard(_keys_lock);
+
+		if (!_keys[key].used)
+			return EINVAL;
+
+		_keys[key].used       = false;
+		_keys[key].destructor = 0;
+		return 0;
+	}
+
+
+	int pthread_setspecific(pthread_key_t key, const void *value)
+	{
+		if (!valid(key) || !_keys[key].used)
+			return EINVAL;
+
+		Pthread::Key_values::Value &v = Pthread::key_values().values[key];
+		v.value      = const_cast<void *>(value);
+		v.generation = _keys[key].generation;
+		return 0;
+	}
+
+
+	void *pthread_getspecific(pthread_key_t key)
+	{
+		if (!valid(key))
+			return 0;
+
+		Pthread::Key_values::Value const &v = Pthread::key_values().values[key];
+		return v.generation == _keys[key].generation ? v.value : 0;
+	}
+}
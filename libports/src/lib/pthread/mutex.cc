@@ -0,0 +1,271 @@
+/*
+ * \brief  POSIX mutex implementation
+ * \author Norman Feske
+ * \date   2013-03-18
+ *
+ * An uncontended mutex is acquired and released by a single atomic
+ * operation. Only if the mutex is contended, the threads block on a
+ * semaphore.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#include <base/semaphore.h>
+
+#include <errno.h>
+#include <pthread.h>
+
+/* local includes */
+#include "thread.h"
+
+using namespace Genode;
+
+extern "C" {
+
+	/*
+	 * This class is named 'struct pthread_mutex_attr' because the
+	 * 'pthread_mutexattr_t' type is defined as 'struct pthread_mutex_attr*'
+	 * in '_pthreadtypes.h'
+	 */
+	struct pthread_mutex_attr
+	{
+		int type;
+
+		pthread_mutex_attr() : type(PTHREAD_MUTEX_NORMAL) { }
+	};
+
+
+	/*
+	 * This class is named 'struct pthread_mutex' because the
+	 * 'pthread_mutex_t' type is defined as 'struct pthread_mutex*' in
+	 * '_pthreadtypes.h'
+	 */
+	struct pthread_mutex
+	{
+		enum State { UNLOCKED, LOCKED, CONTENDED };
+
+		/*
+		 * Number of attempts to acquire a contended mutex before blocking
+		 */
+		enum { SPIN_LIMIT = 64 };
+
+		volatile int _state;
+		Semaphore    _sem;       /* blocked threads of a contended mutex */
+		int const    _type;
+		pthread_t    _owner;     /* tracked for error-checking and
+		                            recursive mutexes only */
+		unsigned     _lock_count;
+
+		pthread_mutex(int type = PTHREAD_MUTEX_NORMAL)
+		: _state(UNLOCKED), _type(type), _owner(0), _lock_count(0) { }
+
+		bool try_lock() { return cmpxchg(&_state, UNLOCKED, LOCKED); }
+
+		void lock()
+		{
+			if (try_lock())
+				return;
+
+			/* the owner may release the mutex soon */
+			for (unsigned i = 0; i < SPIN_LIMIT; i++)
+				if (_state == UNLOCKED && try_lock())
+					return;
+
+			/*
+			 * Mark the mutex as contended so that the owner wakes us up
+			 * when releasing the mutex. A wakeup may be left over from a
+			 * previous contention, so we have to re-check the state.
+			 */
+			while (Pthread::swap(&_state, CONTENDED) != UNLOCKED)
+				_sem.down();
+		}
+
+		void unlock()
+		{
+			if (Pthread::swap(&_state, UNLOCKED) == CONTENDED)
+				_sem.up();
+		}
+
+		bool owner_tracked() const { return _type != PTHREAD_MUTEX_NORMAL; }
+	};
+
+
+	int pthread_mutexattr_init(pthread_mutexattr_t *attr)
+	{
+		if (!attr)
+			return EINVAL;
+
+		*attr = new (env()->heap()) pthread_mutex_attr;
+		return 0;
+	}
+
+
+	int pthread_mutexattr_destroy(pthread_mutexattr_t *attr)
+	{
+		if (!attr || !*attr)
+			return EINVAL;
+
+		destroy(env()->heap(), *attr);
+		*attr = 0;
+		return 0;
+	}
+
+
+	int pthread_mutexattr_settype(pthread_mutexattr_t *attr, int type)
+	{
+		if (!attr || !*attr)
+			return EINVAL;
+
+		switch (type) {
+		case PTHREAD_MUTEX_NORMAL:
+		case PTHREAD_MUTEX_ERRORCHECK:
+		case PTHREAD_MUTEX_RECURSIVE:
+			(*attr)->type = type;
+			return 0;
+		default:
+			return EINVAL;
+		}
+	}
+
+
+	int pthread_mutexattr_gettype(pthread_mutexattr_t *attr, int *type)
+	{
+		if (!attr || !*attr || !type)
+			return EINVAL;
+
+		*type = (*attr)->type;
+		return 0;
+	}
+
+
+	int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr)
+	{
+		if (!mutex)
+			return EINVAL;
+
+		int const type = (attr && *attr) ? (*attr)->type : PTHREAD_MUTEX_NORMAL;
+
+		*mutex = new (env()->heap()) pthread_mutex(type);
+		return 0;
+	}
+
+
+	int pthread_mutex_destroy(pthread_mutex_t *mutex)
+	{
+		if (!mutex)
+			return EINVAL;
+
+		/* a statically initialized mutex may not have been used */
+		if (!*mutex)
+			return 0;
+
+		if ((*mutex)->_state != pthread_mutex::UNLOCKED)
+			return EBUSY;
+
+		destroy(env()->heap(), *mutex);
+		*mutex = 0;
+		return 0;
+	}
+
+
+	int pthread_mutex_lock(pthread_mutex_t *mutex)
+	{
+		if (!mutex)
+			return EINVAL;
+
+		pthread_mutex *m = Pthread::object(mutex);
+
+		if (!m->owner_tracked()) {
+			m->lock();
+			return 0;
+		}
+
+		pthread_t const myself = pthread_self();
+		if (m->_owner == myself) {
+			if (m->_type == PTHREAD_MUTEX_ERRORCHECK)
+				return EDEADLK;
+
+			m->_lock_count++;
+			return 0;
+		}
+
+		m->lock();
+		m->_owner      = myself;
+		m->_lock_count = 1;
+		return 0;
+	}
+
+
+	int pthread_mutex_trylock(pthread_mutex_t *mutex)
+	{
+		if (!mutex)
+			return EINVAL;
+
+		pthread_mutex *m = Pthread::object(mutex);
+
+		if (!m->owner_tracked())
+			return m->try_lock() ? 0 : EBUSY;
+
+		pthread_t const myself = pthread_self();
+		if (m->_owner == myself && m->_type == PTHREAD_MUTEX_RECURSIVE) {
+			m->_lock_count++;
+			return 0;
+		}
+
+		if (!m->try_lock())
+			return EBUSY;
+
+		m->_owner      = myself;
+		m->_lock_count = 1;
+		return 0;
+	}
+
+
+	int pthread_mutex_unlock(pthread_mutex_t *mutex)
+	{
+		if (!mutex || !*mutex)
+			return EINVAL;
+
+		pthread_mutex *m = *mutex;
+
+		if (!m->owner_tracked()) {
+			m->unlock();
+			return 0;
+		}
+
+		if (m->_owner != pthread_self())
+			return EPERM;
+
+		if (--m->_lock_count)
+			return 0;
+
+		m->_owner = 0;
+		m->unlock();
+		return 0;
+	}
+
+
+	int pthread_once(pthread_once_t *once, void (*init_routine)(void))
+	{
+		if (!once || !init_routine)
+			return EINVAL;
+
+		if (once->state == PTHREAD_DONE_INIT)
+			return 0;
+
+		pthread_mutex_lock(&once->mutex);
+
+		if (once->state == PTHREAD_NEEDS_INIT) {
+			init_routine();
+			once->state = PTHREAD_DONE_INIT;
+		}
+
+		pthread_mutex_unlock(&once->mutex);
+		return 0;
+	}
+}
@@ -0,0 +1,271 @@
+/*
+ * \brief  POSIX read-write lock implementation
+ * \author Norman Feske
+ * \date   2013-03-18
+ *
+ * As long as there are no blocked threads, read and write locks are
+ * acquired and released by a single atomic operation. Blocked writers take
+ * precedence over new readers.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#include <base/semaphore.h>
+
+#include <errno.h>
+#include <pthread.h>
+
+/* local includes */
+#include "thread.h"
+
+using namespace Genode;
+
+extern "C" {
+
+	/*
+	 * This class is named 'struct pthread_rwlockattr' because the
+	 * 'pthread_rwlockattr_t' type is defined as 'struct pthread_rwlockattr*'
+	 * in '_pthreadtypes.h'
+	 */
+	struct pthread_rwlockattr { };
+
+
+	/*
+	 * This class is named 'struct pthread_rwlock' because the
+	 * 'pthread_rwlock_t' type is defined as 'struct pthread_rwlock*' in
+	 * '_pthreadtypes.h'
+	 */
+	struct pthread_rwlock
+	{
+		enum { WRITER = -1 };
+
+		/* number of readers, or 'WRITER' */
+		volatile int _state;
+
+		/*
+		 * Set while threads are blocked, which disables the lock-free path
+		 * of acquiring the lock
+		 */
+		volatile int _blocked;
+
+		/* the slow path is serialized by '_lock' */
+		Lock      _lock;
+		unsigned  _blocked_readers, _blocked_writers;
+		Semaphore _read_sem, _write_sem;
+
+		pthread_rwlock()
+		: _state(0), _blocked(0), _blocked_readers(0), _blocked_writers(0) { }
+
+		bool _try_read()
+		{
+			for (;;) {
+				int const state = _state;
+				if (state == WRITER)
+					return false;
+				if (cmpxchg(&_state, state, state + 1))
+					return true;
+			}
+		}
+
+		bool _try_write() { return cmpxchg(&_state, 0, WRITER); }
+
+		void _update_blocked() { _blocked = _blocked_readers || _blocked_writers; }
+
+		/**
+		 * Wake up blocked threads that may acquire the lock now
+		 *
+		 * A woken thread is no longer accounted as blocked. It retries to
+		 * acquire the lock and blocks again if it does not succeed.
+		 */
+		void _wake_up()
+		{
+			Lock::Guard guard(_lock);
+
+			if (_blocked_writers) {
+				if (_state == 0) {
+					_blocked_writers--;
+					_write_sem.up();
+				}
+			} else {
+				for (; _blocked_readers; _blocked_readers--)
+					_read_sem.up();
+			}
+			_update_blocked();
+		}
+
+		bool try_read_lock() { return !_blocked && _try_read(); }
+		bool try_write_lock() { return !_blocked && _try_write(); }
+
+		void read_lock()
+		{
+			if (try_read_lock())
+				return;
+
+			_lock.lock();
+			for (;;) {
+				/*
+				 * The flag must be set before retrying so that an unlocking
+				 * thread, which releases the lock concurrently, observes it.
+				 * Without the barrier, the store of '_blocked' could be
+				 * reordered with the load of '_state' in '_try_read'.
+				 */
+				_blocked_readers++;
+				_update_blocked();
+				__sync_synchronize();
+
+				if (!_blocked_writers && _try_read()) {
+					_blocked_readers--;
+					_update_blocked();
+					break;
+				}
+
+				_lock.unlock();
+				_read_sem.down();
+				_lock.lock();
+			}
+			_lock.unlock();
+		}
+
+		void write_lock()
+		{
+			if (try_write_lock())
+				return;
+
+			_lock.lock();
+			for (;;) {
+				_blocked_writers++;
+				_update_blocked();
+				__sync_synchronize();
+
+				if (_try_write()) {
+					_blocked_writers--;
+					_update_blocked();
+					break;
+				}
+
+				_lock.unlock();
+				_write_sem.down();
+				_lock.lock();
+			}
+			_lock.unlock();
+		}
+
+		void unlock()
+		{
+			for (;;) {
+				int const state = _state;
+				int const new_state = (state == WRITER) ? 0 : state - 1;
+				if (cmpxchg(&_state, state, new_state))
+					break;
+			}
+
+			/* pairs with the barrier in the slow paths of the lock functions */
+			__sync_synchronize();
+
+			if (_blocked)
+				_wake_up();
+		}
+	};
+
+
+	int pthread_rwlockattr_init(pthread_rwlockattr_t *attr)
+	{
+		if (!attr)
+			return EINVAL;
+
+		*attr = new (env()->heap()) pthread_rwlockattr;
+		return 0;
+	}
+
+
+	int pthread_rwlockattr_destroy(pthread_rwlockattr_t *attr)
+	{
+		if (!attr || !*attr)
+			return EINVAL;
+
+		destroy(env()->heap(), *attr);
+		*attr = 0;
+		return 0;
+	}
+
+
+	int pthread_rwlock_init(pthread_rwlock_t *rwlock, const pthread_rwlockattr_t *)
+	{
+		if (!rwlock)
+			return EINVAL;
+
+		*rwlock = new (env()->heap()) pthread_rwlock;
+		return 0;
+	}
+
+
+	int pthread_rwlock_destroy(pthread_rwlock_t *rwlock)
+	{
+		if (!rwlock)
+			return EINVAL;
+
+		/* a statically initialized lock may not have been used */
+		if (!*rwlock)
+			return 0;
+
+		if ((*rwlock)->_state || (*rwlock)->_blocked)
+			return EBUSY;
+
+		destroy(env()->heap(), *rwlock);
+		*rwlock = 0;
+		return 0;
+	}
+
+
+	int pthread_rwlock_rdlock(pthread_rwlock_t *rwlock)
+	{
+		if (!rwlock)
+			return EINVAL;
+
+		Pthread::object(rwlock)->read_lock();
+		return 0;
+	}
+
+
+	int pthread_rwlock_tryrdlock(pthread_rwlock_t *rwlock)
+	{
+		if (!rwlock)
+			return EINVAL;
+
+		return Pthread::object(rwlock)->try_read_lock() ? 0 : EBUSY;
+	}
+
+
+	int pthread_rwlock_wrlock(pthread_rwlock_t *rwlock)
+	{
+		if (!rwlock)
+			return EINVAL;
+
+		Pthread::object(rwlock)->write_lock();
+		return 0;
+	}
+
+
+	int pthread_rwlock_trywrlock(pthread_rwlock_t *rwlock)
+	{
+		if (!rwlock)
+			return EINVAL;
+
+		return Pthread::object(rwlock)->try_write_lock() ? 0 : EBUSY;
+	}
+
+
+	int pthread_rwlock_unlock(pthread_rwlock_t *rwlock)
+	{
+		if (!rwlock || !*rwlock || !(*rwlock)->_state)
+			return EINVAL;
+
+		(*rwlock)->unlock();
+		return 0;
+	}
+}
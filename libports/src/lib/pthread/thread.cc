@@ -20,33 +20,33 @@
 #include <errno.h>
 #include <pthread.h>
 
+/* local includes */
+#include "thread.h"
+
 using namespace Genode;
 
-extern "C" {
 
-	enum { STACK_SIZE=64*1024 };
+namespace {
 
-	/*
-	 * This class is named 'struct pthread' because the 'pthread_t' type is
-	 * defined as 'struct pthread*' in '_pthreadtypes.h'
-	 */
-	struct pthread : Thread<STACK_SIZE>
-	{
-		void *(*_start_routine) (void *);
-		void *_arg;
+	/* threads created by 'pthread_create' */
+	Lock          _pthreads_lock;
+	List<pthread> _pthreads;
+}
 
-		pthread(void *(*start_routine) (void *), void *arg)
-		: Thread<STACK_SIZE>("pthread"),
-		  _start_routine(start_routine),
-		  _arg(arg) { }
 
-		void entry()
-		{
-			void *exit_status = _start_routine(_arg);
-			pthread_exit(exit_status);
-		}
-	};
+pthread_t Pthread::lookup(Thread_base *thread)
+{
+	Lock::Guard guard(_pthreads_lock);
 
+	for (pthread_t t = _pthreads.first(); t; t = t->next())
+		if (static_cast<Thread_base *>(t) == thread)
+			return t;
+
+	return 0;
+}
+
+
+extern "C" {
 
 	int pthread_create(pthread_t *thread, const pthread_attr_t *attr,
 	                   void *(*start_routine) (void *), void *arg)
@@ -60,6 +60,11 @@ extern "C" {
 
 		*thread = thread_obj;
 
+		{
+			Lock::Guard guard(_pthreads_lock);
+			_pthreads.insert(thread_obj);
+		}
+
 		thread_obj->start();
 
 		return 0;
@@ -68,6 +73,11 @@ extern "C" {
 
 	int pthread_cancel(pthread_t thread)
 	{
+		{
+			Lock::Guard guard(_pthreads_lock);
+			_pthreads.remove(thread);
+		}
+
 		destroy(env()->heap(), thread);
 		return 0;
 	}
@@ -75,6 +85,7 @@ extern "C" {
 
 	void pthread_exit(void *value_ptr)
 	{
+		Pthread::destruct_key_values();
 		pthread_cancel(pthread_self());
 		sleep_forever();
 	}
@@ -84,10 +95,25 @@ extern "C" {
 	{
 		static struct pthread main_thread(0, 0);
 
-		pthread_t thread = static_cast<pthread_t>(Thread_base::myself());
+		Thread_base * const myself = Thread_base::myself();
 
 		/* the main thread does not have a Genode thread object */
-		return thread ? thread : &main_thread;
+		if (!myself)
+			return &main_thread;
+
+		/*
+		 * A thread not created by 'pthread_create' has no pthread object.
+		 * The returned pointer serves as its identity only and must not be
+		 * dereferenced.
+		 */
+		pthread_t const thread = Pthread::lookup(myself);
+		return thread ? thread : static_cast<pthread_t>(myself);
+	}
+
+
+	int pthread_equal(pthread_t t1, pthread_t t2)
+	{
+		return t1 == t2;
 	}
 
 }
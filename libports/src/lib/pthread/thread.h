@@ -0,0 +1,145 @@
+/*
+ * \brief  POSIX thread object and helpers shared by the pthread library
+ * \author Norman Feske
+ * \date   2013-03-18
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _THREAD_H_
+#define _THREAD_H_
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/lock.h>
+#include <base/thread.h>
+#include <cpu/atomic.h>
+#include <util/list.h>
+#include <util/string.h>
+
+/* libc includes */
+#include <limits.h>
+#include <pthread.h>
+
+namespace Pthread {
+
+	/**
+	 * Values of the thread-specific data keys of one thread
+	 *
+	 * A value is valid only if its generation matches the generation of
+	 * the key.
+	 */
+	struct Key_values
+	{
+		struct Value
+		{
+			void     *value;
+			unsigned  generation;
+		} values[PTHREAD_KEYS_MAX];
+
+		Key_values() { Genode::memset(values, 0, sizeof(values)); }
+	};
+}
+
+
+extern "C" {
+
+	enum { STACK_SIZE=64*1024 };
+
+	/*
+	 * This class is named 'struct pthread' because the 'pthread_t' type is
+	 * defined as 'struct pthread*' in '_pthreadtypes.h'
+	 */
+	struct pthread : Genode::Thread<STACK_SIZE>, Genode::List<pthread>::Element
+	{
+		void *(*_start_routine) (void *);
+		void *_arg;
+
+		Pthread::Key_values _key_values;
+
+		pthread(void *(*start_routine) (void *), void *arg)
+		: Genode::Thread<STACK_SIZE>("pthread"),
+		  _start_routine(start_routine),
+		  _arg(arg)
+		{ }
+
+		void entry()
+		{
+			void *exit_status = _start_routine(_arg);
+			pthread_exit(exit_status);
+		}
+	};
+}
+
+
+namespace Pthread {
+
+	/**
+	 * Atomically replace the value at 'dst'
+	 *
+	 * \return  previous value
+	 */
+	inline int swap(volatile int *dst, int value)
+	{
+		for (;;) {
+			int const old = *dst;
+			if (Genode::cmpxchg(dst, old, value))
+				return old;
+		}
+	}
+
+	/**
+	 * Lock used for the on-demand construction of statically initialized
+	 * objects
+	 */
+	inline Genode::Lock &static_init_lock()
+	{
+		static Genode::Lock lock;
+		return lock;
+	}
+
+	/**
+	 * Return object referred to by 'obj', construct it on first use
+	 *
+	 * The 'PTHREAD_*_INITIALIZER' macros initialize the handles of mutexes,
+	 * condition variables, and read-write locks with 0.
+	 */
+	template <typename T>
+	inline T *object(T * volatile *obj)
+	{
+		if (*obj)
+			return *obj;
+
+		Genode::Lock::Guard guard(static_init_lock());
+		if (!*obj)
+			*obj = new (Genode::env()->heap()) T();
+		return *obj;
+	}
+
+	/**
+	 * Return pthread object of 'thread', or 0 if the thread was not
+	 * created by 'pthread_create'
+	 */
+	pthread_t lookup(Genode::Thread_base *thread);
+
+	/**
+	 * Return values of the thread-specific data keys of the calling thread
+	 *
+	 * Threads not created by 'pthread_create', e.g., threads created via
+	 * the Genode API, have no pthread object. Their values are kept in a
+	 * separate table.
+	 */
+	Key_values &key_values();
+
+	/**
+	 * Run destructors of the thread-specific data of the calling thread
+	 */
+	void destruct_key_values();
+}
+
+#endif /* _THREAD_H_ */
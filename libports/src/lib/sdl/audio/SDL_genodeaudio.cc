@@ -107,7 +107,8 @@ static int GENODEAUD_Available(void)
 static void GENODEAUD_DeleteDevice(SDL_AudioDevice *device)
 {
 	for (int channel = 0; channel < AUDIO_CHANNELS; channel++)
-		destroy(env()->heap(), device->hidden->audio[channel]);
+		if (device->hidden->audio[channel])
+			destroy(env()->heap(), device->hidden->audio[channel]);
 
 	SDL_free(device->hidden);
 	SDL_free(device);
@@ -143,21 +144,7 @@ static SDL_AudioDevice *GENODEAUD_CreateDevice(int devindex)
 
 	_this->free = GENODEAUD_DeleteDevice;
 
-	/* connect to 'Audio_out' service */
-	for (int channel = 0; channel < AUDIO_CHANNELS; channel++) {
-		try {
-			_this->hidden->audio[channel] = new (env()->heap())
-				Audio_out::Connection(channel_names[channel]);
-			_this->hidden->audio[channel]->start();
-		} catch(Genode::Parent::Service_denied) {
-			PERR("Could not connect to 'Audio_out' service.");
-
-			while(--channel > 0)
-				destroy(env()->heap(), _this->hidden->audio[channel]);
-
-			return NULL;
-		}
-	}
+	/* the 'Audio_out' service is connected when the audio format is known */
 
 	Genode::config()->sigh(signal_receiver()->manage(&config_signal_context));
 	read_config();
@@ -208,10 +195,22 @@ static void GENODEAUD_PlayAudio(_THIS)
 		read_config();
 	}
 
-	for (int sample = 0; sample < Audio_out::PERIOD; sample++)
-		for (int channel = 0; channel < AUDIO_CHANNELS; channel++)
-			p[channel]->content()[sample] =
-				volume * (float)(((int16_t*)_this->hidden->mixbuf)[sample * AUDIO_CHANNELS + channel]) / 32768;
+	Audio_out::Stream *stream = _this->hidden->audio[0]->stream();
+	int16_t const     *mixbuf = (int16_t *)_this->hidden->mixbuf;
+	unsigned const     period = stream->period();
+
+	/* the service converts rate and format if it granted our request */
+	if (stream->format() == Audio_out::FORMAT_S16) {
+		for (unsigned sample = 0; sample < period; sample++)
+			for (int channel = 0; channel < AUDIO_CHANNELS; channel++)
+				p[channel]->content_s16()[sample] =
+					volume * mixbuf[sample * AUDIO_CHANNELS + channel];
+	} else {
+		for (unsigned sample = 0; sample < period; sample++)
+			for (int channel = 0; channel < AUDIO_CHANNELS; channel++)
+				p[channel]->content()[sample] =
+					volume * (float)mixbuf[sample * AUDIO_CHANNELS + channel] / 32768;
+	}
 
 	for (int channel = 0; channel < AUDIO_CHANNELS; channel++)
 		_this->hidden->audio[channel]->submit(p[channel]);
@@ -230,6 +229,12 @@ static void GENODEAUD_CloseAudio(_THIS)
 		SDL_FreeAudioMem(_this->hidden->mixbuf);
 		_this->hidden->mixbuf = NULL;
 	}
+
+	for (int channel = 0; channel < AUDIO_CHANNELS; channel++)
+		if (_this->hidden->audio[channel]) {
+			destroy(env()->heap(), _this->hidden->audio[channel]);
+			_this->hidden->audio[channel] = 0;
+		}
 }
 
 
@@ -240,10 +245,36 @@ static int GENODEAUD_OpenAudio(_THIS, SDL_AudioSpec *spec)
 	PDBG("requested samples = %u", spec->samples);
 	PDBG("requested size = %u", spec->size);
 
+	/*
+	 * Connect to 'Audio_out' service, requesting the sample rate of the
+	 * application. If the service does not support the rate, SDL converts
+	 * the audio to the granted rate.
+	 */
+	for (int channel = 0; channel < AUDIO_CHANNELS; channel++) {
+		try {
+			_this->hidden->audio[channel] = new (env()->heap())
+				Audio_out::Connection(channel_names[channel], true, false,
+				                      Audio_out::PERIOD, spec->freq,
+				                      Audio_out::FORMAT_S16);
+			_this->hidden->audio[channel]->start();
+		} catch(Genode::Parent::Service_denied) {
+			PERR("Could not connect to 'Audio_out' service.");
+
+			while (--channel >= 0) {
+				destroy(env()->heap(), _this->hidden->audio[channel]);
+				_this->hidden->audio[channel] = 0;
+			}
+
+			return(-1);
+		}
+	}
+
+	Audio_out::Stream *stream = _this->hidden->audio[0]->stream();
+
 	spec->channels = AUDIO_CHANNELS;
 	spec->format = AUDIO_S16LSB;
-	spec->freq = Audio_out::SAMPLE_RATE;
-	spec->samples = Audio_out::PERIOD;
+	spec->freq = stream->rate();
+	spec->samples = stream->period();
 	SDL_CalculateAudioSpec(spec);
 
 	/* Allocate mixing buffer */
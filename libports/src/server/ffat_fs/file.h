@@ -45,7 +45,13 @@ namespace File_system {
 				if (seek_offset == (seek_off_t)(~0))
 					seek_offset = _ffat_fil.fsize;
 
-				FRESULT res = f_lseek(&_ffat_fil, seek_offset);
+				/*
+				 * Seeking flushes and invalidates the sector buffer of the
+				 * file, which is needless for sequential access.
+				 */
+				FRESULT res = FR_OK;
+				if (seek_offset != _ffat_fil.fptr)
+					res = f_lseek(&_ffat_fil, seek_offset);
 
 				switch(res) {
 					case FR_OK:
@@ -111,7 +117,9 @@ namespace File_system {
 				if (seek_offset == (seek_off_t)(~0))
 					seek_offset = _ffat_fil.fsize;
 
-				FRESULT res = f_lseek(&_ffat_fil, seek_offset);
+				FRESULT res = FR_OK;
+				if (seek_offset != _ffat_fil.fptr)
+					res = f_lseek(&_ffat_fil, seek_offset);
 
 				switch(res) {
 					case FR_OK:
@@ -0,0 +1,89 @@
+/*
+ * \brief  Overhead of libc calls on file descriptors
+ * \author Norman Feske
+ * \date   2013-03-17
+ *
+ * The benchmark writes and reads one byte via a pipe in a loop. Each call
+ * looks up the file descriptor in the file-descriptor table of the libc.
+ * The loop is executed with only a few open file descriptors and once more
+ * after opening many file descriptors.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <timer_session/connection.h>
+
+/* libc includes */
+#include <stdio.h>
+#include <unistd.h>
+
+enum { ROUNDS = 100000, NUM_PIPES = 400 };
+
+
+static Timer::Connection timer;
+
+
+static int measure(char const *name)
+{
+	int fds[2];
+	if (pipe(fds)) {
+		printf("could not create pipe\n");
+		return -1;
+	}
+
+	char c = 'x';
+
+	unsigned long const start = timer.elapsed_ms();
+
+	for (unsigned i = 0; i < ROUNDS; i++)
+		if (write(fds[1], &c, 1) < 0 || read(fds[0], &c, 1) < 0) {
+			printf("pipe I/O failed\n");
+			return -1;
+		}
+
+	unsigned long const ms = timer.elapsed_ms() - start;
+
+	printf("%s: %u write/read pairs on fds %d/%d in %lu ms (%lu ns per pair)\n",
+	       name, ROUNDS, fds[1], fds[0], ms, (ms*1000000)/ROUNDS);
+
+	close(fds[0]);
+	close(fds[1]);
+	return 0;
+}
+
+
+int main(int, char **)
+{
+	if (measure("few fds"))
+		return -1;
+
+	/* populate the fd table */
+	int fds[NUM_PIPES][2];
+	for (unsigned i = 0; i < NUM_PIPES; i++)
+		if (pipe(fds[i])) {
+			printf("could not create pipe %u\n", i);
+			return -1;
+		}
+
+	if (measure("many fds"))
+		return -1;
+
+	for (unsigned i = 0; i < NUM_PIPES; i++) {
+		close(fds[i][0]);
+		close(fds[i][1]);
+	}
+
+	/* POSIX requires the lowest free fd to be used */
+	int lowest[2];
+	pipe(lowest);
+	printf("lowest free fds after closing: %d/%d\n", lowest[0], lowest[1]);
+
+	printf("--- libc fd benchmark finished ---\n");
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-libc_fd_bench
+SRC_CC = main.cc
+LIBS   = libc libc_log libc_lock_pipe
@@ -0,0 +1,130 @@
+/*
+ * \brief  Sequential throughput of a file system
+ * \author Norman Feske
+ * \date   2013-03-21
+ *
+ * The benchmark writes a file via the libc_fs plugin, reads it back with
+ * different request sizes, and checks the content.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <timer_session/connection.h>
+
+/* libc includes */
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+enum {
+	FILE_SIZE  = 8*1024*1024,
+	MAX_CHUNK  = 64*1024,
+};
+
+static char const *file_name = "/bench.dat";
+
+static Timer::Connection timer;
+
+static char buf[MAX_CHUNK];
+
+
+static void print_result(char const *name, size_t chunk, unsigned long ms)
+{
+	printf("%-5s %2zu KiB chunks: %u KiB in %lu ms (%lu KiB/s)\n",
+	       name, chunk/1024, (unsigned)FILE_SIZE/1024, ms,
+	       ms ? ((unsigned long)FILE_SIZE/1024*1000)/ms : 0);
+}
+
+
+/**
+ * Value of the byte at 'offset' of the file
+ */
+static char pattern(size_t offset) { return (char)(offset*7 + offset/4096); }
+
+
+static int measure_write(size_t chunk)
+{
+	int fd = open(file_name, O_CREAT | O_WRONLY | O_TRUNC, 0666);
+	if (fd < 0) {
+		printf("could not create %s\n", file_name);
+		return -1;
+	}
+
+	unsigned long const start = timer.elapsed_ms();
+
+	for (size_t offset = 0; offset < FILE_SIZE; offset += chunk) {
+
+		for (size_t i = 0; i < chunk; i++)
+			buf[i] = pattern(offset + i);
+
+		if (write(fd, buf, chunk) != (ssize_t)chunk) {
+			printf("write of %s failed at offset %zu\n", file_name, offset);
+			close(fd);
+			return -1;
+		}
+	}
+
+	close(fd);
+	print_result("write", chunk, timer.elapsed_ms() - start);
+	return 0;
+}
+
+
+static int measure_read(size_t chunk)
+{
+	int fd = open(file_name, O_RDONLY);
+	if (fd < 0) {
+		printf("could not open %s\n", file_name);
+		return -1;
+	}
+
+	unsigned long ms = 0;
+
+	for (size_t offset = 0; offset < FILE_SIZE; offset += chunk) {
+
+		unsigned long const start = timer.elapsed_ms();
+		ssize_t const n = read(fd, buf, chunk);
+		ms += timer.elapsed_ms() - start;
+
+		if (n != (ssize_t)chunk) {
+			printf("read of %s failed at offset %zu\n", file_name, offset);
+			close(fd);
+			return -1;
+		}
+
+		/* the check is not part of the measured time */
+		for (size_t i = 0; i < chunk; i++)
+			if (buf[i] != pattern(offset + i)) {
+				printf("unexpected content at offset %zu\n", offset + i);
+				close(fd);
+				return -1;
+			}
+	}
+
+	close(fd);
+	print_result("read", chunk, ms);
+	return 0;
+}
+
+
+int main(int, char **)
+{
+	printf("--- file-system benchmark started ---\n");
+
+	if (measure_write(MAX_CHUNK)
+	 || measure_read(MAX_CHUNK)
+	 || measure_read(4096)
+	 || measure_read(512))
+		return -1;
+
+	unlink(file_name);
+
+	printf("--- file-system benchmark finished ---\n");
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-libc_fs_bench
+SRC_CC = main.cc
+LIBS   = libc libc_log libc_fs
@@ -0,0 +1,157 @@
+/*
+ * \brief  Socket round-trip latency benchmark using the lwIP loopback device
+ * \author Stefan Kalkowski
+ * \date   2013-03-04
+ *
+ * A client thread sends small messages to an echo server running in the main
+ * thread and waits for each answer before sending the next one. Each round
+ * trip passes the lwIP tcpip thread several times and thereby stresses the
+ * semaphores and mailboxes of the 'sys_arch' back end.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/printf.h>
+#include <base/thread.h>
+#include <timer_session/connection.h>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+enum {
+	PORT        = 8080,
+	ROUNDS      = 10000,
+	MAX_MSG_LEN = 1024,
+};
+
+static unsigned const msg_sizes[] = { 1, 64, 512, MAX_MSG_LEN };
+
+
+static bool transfer(int s, char *buf, size_t len, bool send_data)
+{
+	for (size_t done = 0; done < len; ) {
+		ssize_t n = send_data ? send(s, buf + done, len - done, 0)
+		                      : recv(s, buf + done, len - done, 0);
+		if (n <= 0)
+			return false;
+		done += n;
+	}
+	return true;
+}
+
+
+class Client : public Genode::Thread<8192>
+{
+	private:
+
+		Genode::Lock &_server_ready;
+
+	public:
+
+		Client(Genode::Lock &server_ready)
+		: Genode::Thread<8192>("client"), _server_ready(server_ready) { }
+
+		void entry()
+		{
+			_server_ready.lock();
+
+			int s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+			if (s < 0) {
+				PERR("No socket available!");
+				return;
+			}
+
+			int one = 1;
+			setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+			struct sockaddr_in addr;
+			addr.sin_port        = htons(PORT);
+			addr.sin_family      = AF_INET;
+			addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+			if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+				PERR("Could not connect!");
+				close(s);
+				return;
+			}
+
+			static char buf[MAX_MSG_LEN];
+			Timer::Connection timer;
+
+			for (unsigned i = 0; i < sizeof(msg_sizes)/sizeof(msg_sizes[0]); i++) {
+
+				size_t const len = msg_sizes[i];
+
+				unsigned long const start = timer.elapsed_ms();
+				for (unsigned r = 0; r < ROUNDS; r++)
+					if (!transfer(s, buf, len, true)
+					 || !transfer(s, buf, len, false)) {
+						PERR("round trip %u failed", r);
+						close(s);
+						return;
+					}
+				unsigned long const ms = timer.elapsed_ms() - start;
+
+				Genode::printf("msg size %4u: %u round trips in %lu ms, %lu us/round trip\n",
+				               (unsigned)len, (unsigned)ROUNDS, ms, (ms*1000)/ROUNDS);
+			}
+
+			close(s);
+			Genode::printf("--- lwIP round-trip benchmark finished ---\n");
+		}
+};
+
+
+int main()
+{
+	Genode::Lock server_ready(Genode::Lock::LOCKED);
+	Client client(server_ready);
+	client.start();
+
+	int s = socket(AF_INET, SOCK_STREAM, 0);
+	if (s < 0) {
+		PERR("No socket available!");
+		return -1;
+	}
+
+	struct sockaddr_in in_addr;
+	in_addr.sin_family      = AF_INET;
+	in_addr.sin_port        = htons(PORT);
+	in_addr.sin_addr.s_addr = INADDR_ANY;
+	if (bind(s, (struct sockaddr*)&in_addr, sizeof(in_addr)) || listen(s, 1)) {
+		PERR("bind/listen failed!");
+		return -1;
+	}
+
+	server_ready.unlock();
+
+	struct sockaddr addr;
+	socklen_t len = sizeof(addr);
+	int c = accept(s, &addr, &len);
+	if (c < 0) {
+		PERR("accept failed!");
+		return -1;
+	}
+
+	int one = 1;
+	setsockopt(c, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	/* echo everything until the client closes the connection */
+	static char buf[MAX_MSG_LEN];
+	for (ssize_t n; (n = recv(c, buf, sizeof(buf), 0)) > 0; )
+		if (!transfer(c, buf, n, true))
+			break;
+
+	close(c);
+	close(s);
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-lwip_rtt_bench
+LIBS   = lwip libc libc_lwip_loopback libc_log
+SRC_CC = main.cc
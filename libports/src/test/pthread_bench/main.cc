@@ -0,0 +1,250 @@
+/*
+ * \brief  Overhead of pthread synchronization primitives
+ * \author Norman Feske
+ * \date   2013-03-18
+ *
+ * The benchmark compares pthread mutexes and read-write locks with
+ * 'Genode::Lock', with a single thread and with several threads competing
+ * for the lock. It also measures the round-trip time of a condition-variable
+ * ping-pong between two threads and the cost of accessing thread-specific
+ * data.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/lock.h>
+#include <base/semaphore.h>
+#include <timer_session/connection.h>
+
+/* libc includes */
+#include <pthread.h>
+#include <stdio.h>
+
+enum { ROUNDS = 1000000, MAX_THREADS = 4, PING_PONGS = 10000 };
+
+
+static Timer::Connection timer;
+
+
+static void print_result(char const *name, unsigned threads,
+                         unsigned long ops, unsigned long ms)
+{
+	printf("%-20s %u thread(s): %lu ops in %lu ms (%lu ns per op)\n",
+	       name, threads, ops, ms, ms ? (ms*1000000)/ops : 0);
+}
+
+
+/**
+ * Lock types under test
+ */
+struct Pthread_mutex
+{
+	pthread_mutex_t mutex;
+
+	Pthread_mutex()    { pthread_mutex_init(&mutex, 0); }
+	void lock()        { pthread_mutex_lock(&mutex); }
+	void unlock()      { pthread_mutex_unlock(&mutex); }
+
+	static char const *name() { return "pthread_mutex"; }
+	static bool exclusive()   { return true; }
+};
+
+
+struct Pthread_rwlock_read
+{
+	pthread_rwlock_t rwlock;
+
+	Pthread_rwlock_read() { pthread_rwlock_init(&rwlock, 0); }
+	void lock()           { pthread_rwlock_rdlock(&rwlock); }
+	void unlock()         { pthread_rwlock_unlock(&rwlock); }
+
+	static char const *name() { return "pthread_rwlock (rd)"; }
+	static bool exclusive()   { return false; }
+};
+
+
+struct Genode_lock
+{
+	Genode::Lock l;
+
+	void lock()   { l.lock(); }
+	void unlock() { l.unlock(); }
+
+	static char const *name() { return "Genode::Lock"; }
+	static bool exclusive()   { return true; }
+};
+
+
+/**
+ * Contention benchmark
+ *
+ * With an exclusive lock, each thread increments a shared counter. Readers
+ * only read the counter.
+ */
+template <typename LOCK>
+struct Contention
+{
+	LOCK                   lock;
+	volatile unsigned long counter;
+	unsigned               rounds;
+	Genode::Semaphore      finished;
+
+	Contention(unsigned rounds) : counter(0), rounds(rounds) { }
+
+	static void *entry(void *arg)
+	{
+		Contention *c = static_cast<Contention *>(arg);
+
+		for (unsigned i = 0; i < c->rounds; i++) {
+			c->lock.lock();
+			if (LOCK::exclusive())
+				c->counter++;
+			else
+				(void)c->counter;
+			c->lock.unlock();
+		}
+
+		c->finished.up();
+		return 0;
+	}
+
+	static int measure(unsigned threads)
+	{
+		Contention c(ROUNDS / threads);
+
+		unsigned long const start = timer.elapsed_ms();
+
+		for (unsigned i = 1; i < threads; i++) {
+			pthread_t t;
+			if (pthread_create(&t, 0, entry, &c)) {
+				printf("could not create thread\n");
+				return -1;
+			}
+		}
+
+		/* the main thread participates */
+		entry(&c);
+
+		for (unsigned i = 0; i < threads; i++)
+			c.finished.down();
+
+		print_result(LOCK::name(), threads, c.rounds*threads,
+		             timer.elapsed_ms() - start);
+
+		if (LOCK::exclusive() && c.counter != c.rounds*threads) {
+			printf("%s: lost updates of the counter\n", LOCK::name());
+			return -1;
+		}
+		return 0;
+	}
+};
+
+
+/**
+ * Condition-variable ping-pong between two threads
+ */
+struct Ping_pong
+{
+	pthread_mutex_t   mutex;
+	pthread_cond_t    cond;
+	unsigned          turn;      /* incremented by both threads */
+	Genode::Semaphore finished;
+
+	Ping_pong() : turn(0)
+	{
+		pthread_mutex_init(&mutex, 0);
+		pthread_cond_init(&cond, 0);
+	}
+
+	/**
+	 * Wait for the turns with 'parity' and pass the turn to the peer
+	 */
+	void play(unsigned parity)
+	{
+		pthread_mutex_lock(&mutex);
+		for (unsigned i = 0; i < PING_PONGS; i++) {
+			while ((turn & 1) != parity)
+				pthread_cond_wait(&cond, &mutex);
+
+			turn++;
+			pthread_cond_signal(&cond);
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+
+	static void *pong(void *arg)
+	{
+		Ping_pong *p = static_cast<Ping_pong *>(arg);
+		p->play(1);
+		p->finished.up();
+		return 0;
+	}
+
+	static int measure()
+	{
+		Ping_pong p;
+
+		unsigned long const start = timer.elapsed_ms();
+
+		pthread_t t;
+		if (pthread_create(&t, 0, pong, &p)) {
+			printf("could not create thread\n");
+			return -1;
+		}
+
+		p.play(0);
+		p.finished.down();
+
+		print_result("pthread_cond", 2, PING_PONGS, timer.elapsed_ms() - start);
+		return 0;
+	}
+};
+
+
+static int measure_keys()
+{
+	pthread_key_t key;
+	if (pthread_key_create(&key, 0)) {
+		printf("could not create key\n");
+		return -1;
+	}
+
+	unsigned long const start = timer.elapsed_ms();
+
+	for (unsigned long i = 0; i < ROUNDS; i++)
+		pthread_setspecific(key, (void *)((unsigned long)pthread_getspecific(key) + 1));
+
+	unsigned long const ms = timer.elapsed_ms() - start;
+
+	if ((unsigned long)pthread_getspecific(key) != ROUNDS) {
+		printf("unexpected value of thread-specific data\n");
+		return -1;
+	}
+
+	print_result("pthread_key", 1, ROUNDS, ms);
+	pthread_key_delete(key);
+	return 0;
+}
+
+
+int main(int, char **)
+{
+	for (unsigned threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		if (Contention<Pthread_mutex>::measure(threads)
+		 || Contention<Genode_lock>::measure(threads)
+		 || Contention<Pthread_rwlock_read>::measure(threads))
+			return -1;
+	}
+
+	if (Ping_pong::measure() || measure_keys())
+		return -1;
+
+	printf("--- pthread benchmark finished ---\n");
+	return 0;
+}
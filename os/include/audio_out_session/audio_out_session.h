@@ -22,6 +22,18 @@
  * For example, consumer-oriented 6-channel (5.1) audio uses front
  * left/right/center, rear left/right and lfe.
  *
+ * The number of frames per packet (period) is negotiated at session
+ * creation. The client requests a period via the 'period' session argument,
+ * the server grants a period between 'MIN_PERIOD' and 'PERIOD', which is
+ * available via 'Stream::period()'. Packets always have room for 'PERIOD'
+ * frames but only the first 'Stream::period()' frames are played.
+ *
+ * Sample rate and sample format are negotiated the same way via the 'rate'
+ * and 'format' session arguments. A server that does not support the
+ * requested values grants 'SAMPLE_RATE' and 'FORMAT_F32', which are reported
+ * by 'Stream::rate()' and 'Stream::format()'. Hence, clients must check the
+ * granted values after session creation.
+ *
  * Note: That most components right now only support: "(front) left" and
  * "(front) right".
  */
@@ -40,6 +52,7 @@
 #include <dataspace/capability.h>
 #include <base/rpc.h>
 #include <session/session.h>
+#include <util/string.h>
 
 
 namespace Audio_out {
@@ -49,10 +62,35 @@ namespace Audio_out {
 
 	enum {
 		QUEUE_SIZE  = 16,            /* buffer queue size */
-		PERIOD      = 2048,          /* samples per period */
+		PERIOD      = 2048,          /* maximum samples per period */
+		MIN_PERIOD  = 128,           /* minimum samples per period */
 		SAMPLE_RATE = 44100,
 		SAMPLE_SIZE = sizeof(float),
 	};
+
+	/**
+	 * Sample formats
+	 *
+	 * 'FORMAT_F32' samples are in the range [-1, 1], 'FORMAT_S16' samples
+	 * are signed 16-bit integers in host byte order.
+	 */
+	enum Format { FORMAT_F32 = 0, FORMAT_S16 = 1 };
+
+	/**
+	 * Return name of sample format as used for the 'format' session argument
+	 */
+	inline char const *format_name(Format format)
+	{
+		return format == FORMAT_S16 ? "s16" : "f32";
+	}
+
+	/**
+	 * Return sample format for name, unknown names yield 'FORMAT_F32'
+	 */
+	inline Format format_from_name(char const *name)
+	{
+		return Genode::strcmp(name, "s16") ? FORMAT_F32 : FORMAT_S16;
+	}
 }
 
 
@@ -89,7 +127,7 @@ class Audio_out::Packet
 			Genode::memcpy(_data, data, (samples > PERIOD ? PERIOD : samples) * SAMPLE_SIZE);
 
 			if (samples < PERIOD)
-				Genode::memset(data + samples, 0, (PERIOD - samples) * SAMPLE_SIZE);
+				Genode::memset(_data + samples, 0, (PERIOD - samples) * SAMPLE_SIZE);
 		}
 
 		/**
@@ -99,6 +137,13 @@ class Audio_out::Packet
 		 */
 		float *content() { return _data; }
 
+		/**
+		 * Get content of a stream with 'FORMAT_S16'
+		 *
+		 * \return  pointer to frame data
+		 */
+		short *content_s16() { return (short *)_data; }
+
 		/**
 		 * Play state
 		 *
@@ -153,6 +198,9 @@ class Audio_out::Stream
 
 		unsigned  _pos;             /* current playback position */
 		unsigned  _tail;            /* tail pointer used for allocations */
+		unsigned  _period;          /* granted period, 0 means 'PERIOD' */
+		unsigned  _rate;            /* granted rate, 0 means 'SAMPLE_RATE' */
+		Format    _format;          /* granted sample format */
 		Packet    _buf[QUEUE_SIZE]; /* packet queue */
 
 	public:
@@ -169,6 +217,21 @@ class Audio_out::Stream
 		 */
 		unsigned pos() const { return _pos; }
 
+		/**
+		 * Number of frames per packet granted by the server
+		 */
+		unsigned period() const { return _period ? _period : PERIOD; }
+
+		/**
+		 * Sample rate granted by the server
+		 */
+		unsigned rate() const { return _rate ? _rate : SAMPLE_RATE; }
+
+		/**
+		 * Sample format granted by the server
+		 */
+		Format format() const { return _format; }
+
 		/**
 		 * Retrieve next packet for given packet
 		 *
@@ -254,6 +317,21 @@ class Audio_out::Stream
 		 */
 		void pos(unsigned p) { _pos = p; }
 
+		/**
+		 * Set granted period, called at session creation
+		 */
+		void period(unsigned p) { _period = p; }
+
+		/**
+		 * Set granted sample rate, called at session creation
+		 */
+		void rate(unsigned r) { _rate = r; }
+
+		/**
+		 * Set granted sample format, called at session creation
+		 */
+		void format(Format f) { _format = f; }
+
 		/**
 		 * Increment current stream position by one
 		 */
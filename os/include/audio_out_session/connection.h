@@ -35,14 +35,29 @@ struct Audio_out::Connection : Genode::Connection<Session>, Audio_out::Session_c
 	 * \param progress_signal  install progress signal, the client may then
 	 *                         call 'wait_for_progress', which is sent when the
 	 *                         server processed one or more packets
+	 * \param period           requested number of frames per packet, the
+	 *                         granted period is returned by
+	 *                         'stream()->period()'
+	 * \param rate             requested sample rate, see 'stream()->rate()'
+	 * \param format           requested sample format, see
+	 *                         'stream()->format()'
+	 *
+	 * The session quota covers the buffer needed at the server if the
+	 * period differs from the period of the server's output. For sample
+	 * rates other than 'SAMPLE_RATE', it also covers the filter needed for
+	 * the rate conversion.
 	 */
 	Connection(const char *channel,
 	           bool        alloc_signal = true,
-	           bool        progress_signal = false)
+	           bool        progress_signal = false,
+	           unsigned    period = PERIOD,
+	           unsigned    rate = SAMPLE_RATE,
+	           Format      format = FORMAT_F32)
 	:
 		Genode::Connection<Session>(
-			session("ram_quota=%zd, channel=\"%s\"",
-			        2*4096 + sizeof(Stream), channel)),
+			session("ram_quota=%zd, channel=\"%s\", period=%u, rate=%u, format=\"%s\"",
+			        2*4096 + sizeof(Stream)*(rate == SAMPLE_RATE ? 2 : 3),
+			        channel, period, rate, format_name(format))),
 		Session_client(cap(), alloc_signal, progress_signal)
 	{ }
 };
@@ -20,10 +20,13 @@
 #include <cap_session/connection.h>
 #include <base/printf.h>
 #include <base/child.h>
+#include <util/avl_string.h>
 
 /* init includes */
 #include <init/child_config.h>
 #include <init/child_policy.h>
+#include <init/name_registry.h>
+#include <init/route_table.h>
 
 namespace Init {
 
@@ -83,94 +86,6 @@ namespace Init {
 	}
 
 
-	/**
-	 * Return true if service XML node matches the specified service name
-	 */
-	inline bool service_node_matches(Genode::Xml_node service_node, const char *service_name)
-	{
-		if (service_node.has_type("any-service"))
-			return true;
-
-		return service_node.has_type("service")
-		    && service_node.attribute("name").has_value(service_name);
-	}
-
-
-	/**
-	 * Return sub string of label with the leading child name stripped out
-	 *
-	 */
-	inline char const *skip_label_prefix(char const *child_name, char const *label)
-	{
-		Genode::size_t const child_name_len = Genode::strlen(child_name);
-
-		/*
-		 * If the function was called with a valid "label" string, the
-		 * following condition should be always satisfied. See the
-		 * comment in 'service_node_args_condition_satisfied'.
-		 */
-		if (Genode::strcmp(child_name, label, child_name_len) == 0)
-			label += child_name_len;
-
-		/*
-		 * If the original label was empty, the 'Child_policy_enforce_labeling'
-		 * does not append a label separator after the child-name prefix. In
-		 * this case, we resulting label is empty.
-		 */
-		if (*label == 0)
-			return label;
-
-		/*
-		 * Skip label separator. This condition should be always satisfied.
-		 */
-		if (Genode::strcmp(" -> ", label, 4) == 0)
-			return label + 4;
-
-		PWRN("cannot skip label prefix while processing <if-arg>");
-		return label;
-	}
-
-
-	/**
-	 * Check if arguments satisfy the condition specified for the route
-	 */
-	inline bool service_node_args_condition_satisfied(Genode::Xml_node service_node,
-	                                                  const char *args,
-	                                                  char const *child_name)
-	{
-		try {
-			Genode::Xml_node if_arg = service_node.sub_node("if-arg");
-			enum { KEY_MAX_LEN = 64, VALUE_MAX_LEN = 64 };
-			char key[KEY_MAX_LEN];
-			char value[VALUE_MAX_LEN];
-			if_arg.attribute("key").value(key, sizeof(key));
-			if_arg.attribute("value").value(value, sizeof(value));
-
-			char arg_value[VALUE_MAX_LEN];
-			Genode::Arg_string::find_arg(args, key).string(arg_value, sizeof(arg_value), "");
-
-			/*
-			 * Skip child-name prefix if the key is the process "label".
-			 *
-			 * Because 'filter_session_args' is called prior the call of
-			 * 'resolve_session_request' from the 'Child::session' function,
-			 * 'args' contains the filtered arguments, in particular the label
-			 * prefixed with the child's name. For the 'if-args' declaration,
-			 * however, we want to omit specifying this prefix because the
-			 * session route is specific to the named start node anyway. So
-			 * the prefix information is redundant.
-			 */
-			if (Genode::strcmp("label", key) == 0)
-				return Genode::strcmp(value, skip_label_prefix(child_name, arg_value)) == 0;
-
-			return Genode::strcmp(value, arg_value) == 0;
-		} catch (...) { }
-
-		/* if no if-arg node exists, the condition is met */
-		return true;
-	}
-
-
 	/**
 	 * Init-specific representation of a child service
 	 *
@@ -269,27 +184,6 @@ namespace Init {
 	};
 
 
-	/**
-	 * Interface for name database
-	 */
-	struct Name_registry
-	{
-		virtual ~Name_registry() { }
-
-		/**
-		 * Check if specified name is unique
-		 *
-		 * \return false if name already exists
-		 */
-		virtual bool is_unique(const char *name) const = 0;
-
-		/**
-		 * Find server with specified name
-		 */
-		virtual Genode::Server *lookup_server(const char *name) const = 0;
-	};
-
-
 	class Child_registry;
 
 
@@ -308,10 +202,6 @@ namespace Init {
 
 			Genode::List_element<Child> _list_element;
 
-			Genode::Xml_node _start_node;
-
-			Genode::Xml_node _default_route_node;
-
 			Name_registry *_name_registry;
 
 			/**
@@ -355,6 +245,17 @@ namespace Init {
 				}
 			} _name;
 
+			/**
+			 * Node for looking up the child by its name
+			 */
+			struct Name_node : Genode::Avl_string_base
+			{
+				Child &child;
+
+				Name_node(char const *name, Child &child)
+				: Avl_string_base(name), child(child) { }
+			} _name_node;
+
 			/**
 			 * Platform-specific PD-session arguments
 			 */
@@ -426,6 +327,21 @@ namespace Init {
 			Genode::Service_registry *_parent_services;
 			Genode::Service_registry *_child_services;
 
+			/**
+			 * Return route declaration of the start node or the default route
+			 */
+			static Genode::Xml_node _route_node(Genode::Xml_node start_node,
+			                                    Genode::Xml_node default_route_node)
+			{
+				try { return start_node.sub_node("route"); }
+				catch (...) { return default_route_node; }
+			}
+
+			/**
+			 * Session routes, compiled from the route declaration
+			 */
+			Route_table _route_table;
+
 			/**
 			 * Policy helpers
 			 */
@@ -447,10 +363,9 @@ namespace Init {
 			      Genode::Cap_session      *cap_session)
 			:
 				_list_element(this),
-				_start_node(start_node),
-				_default_route_node(default_route_node),
 				_name_registry(name_registry),
 				_name(start_node, name_registry),
+				_name_node(_name.unique, *this),
 				_pd_args(start_node),
 				_resources(start_node, _name.unique, prio_levels_log2),
 				_entrypoint(cap_session, ENTRYPOINT_STACK_SIZE, _name.unique, false),
@@ -461,6 +376,10 @@ namespace Init {
 				       _resources.cpu.cap(), _resources.rm.cap(), &_entrypoint, this),
 				_parent_services(parent_services),
 				_child_services(child_services),
+				_route_table(*Genode::env()->heap(),
+				             _route_node(start_node, default_route_node),
+				             _name.unique, *parent_services, *child_services,
+				             *name_registry),
 				_labeling_policy(_name.unique),
 				_priority_policy(_resources.prio_levels_log2, _resources.priority),
 				_config_policy("config", _config.dataspace(), &_entrypoint),
@@ -535,79 +454,7 @@ namespace Init {
 				if ((service = _binary_policy.resolve_session_request(service_name, args)))
 					return service;
 
-				try {
-					Genode::Xml_node route_node = _default_route_node;
-					try {
-						route_node = _start_node.sub_node("route"); }
-					catch (...) { }
-					Genode::Xml_node service_node = route_node.sub_node();
-
-					for (; ; service_node = service_node.next()) {
-
-						bool service_wildcard = service_node.has_type("any-service");
-
-						if (!service_node_matches(service_node, service_name))
-							continue;
-
-						if (!service_node_args_condition_satisfied(service_node, args, name()))
-							continue;
-
-						Genode::Xml_node target = service_node.sub_node();
-						for (; ; target = target.next()) {
-
-							if (target.has_type("parent")) {
-								service = _parent_services->find(service_name);
-								if (service)
-									return service;
-
-								if (!service_wildcard) {
-									PWRN("%s: service lookup for \"%s\" at parent failed", name(), service_name);
-									return 0;
-								}
-							}
-
-							if (target.has_type("child")) {
-								char server_name[Name::MAX_NAME_LEN];
-								server_name[0] = 0;
-								target.attribute("name").value(server_name, sizeof(server_name));
-
-								Genode::Server *server = _name_registry->lookup_server(server_name);
-								if (!server)
-									PWRN("%s: invalid route to non-existing server \"%s\"", name(), server_name);
-
-								service = _child_services->find(service_name, server);
-								if (service)
-									return service;
-
-								if (!service_wildcard) {
-									PWRN("%s: lookup to child service \"%s\" failed", name(), service_name);
-									return 0;
-								}
-							}
-
-							if (target.has_type("any-child")) {
-								if (_child_services->is_ambiguous(service_name)) {
-									PERR("%s: ambiguous routes to service \"%s\"", name(), service_name);
-									return 0;
-								}
-								service = _child_services->find(service_name);
-								if (service)
-									return service;
-
-								if (!service_wildcard) {
-									PWRN("%s: lookup for service \"%s\" failed", name(), service_name);
-									return 0;
-								}
-							}
-
-							if (target.is_last())
-								break;
-						}
-					}
-				} catch (...) {
-					PWRN("%s: no route to service \"%s\"", name(), service_name);
-				}
-				return service;
+				return _route_table.resolve(service_name, args);
 			}
 
 			void filter_session_args(const char *service,
@@ -0,0 +1,42 @@
+/*
+ * \brief  Interface for looking up the children of init by name
+ * \author Norman Feske
+ * \date   2013-03-15
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _INCLUDE__INIT__NAME_REGISTRY_H_
+#define _INCLUDE__INIT__NAME_REGISTRY_H_
+
+#include <base/service.h>
+
+namespace Init {
+
+	/**
+	 * Interface for name database
+	 */
+	struct Name_registry
+	{
+		virtual ~Name_registry() { }
+
+		/**
+		 * Check if specified name is unique
+		 *
+		 * \return false if name already exists
+		 */
+		virtual bool is_unique(const char *name) const = 0;
+
+		/**
+		 * Find server with specified name
+		 */
+		virtual Genode::Server *lookup_server(const char *name) const = 0;
+	};
+}
+
+#endif /* _INCLUDE__INIT__NAME_REGISTRY_H_ */
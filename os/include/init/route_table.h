@@ -0,0 +1,502 @@
+/*
+ * \brief  Compiled session routes of a child of init
+ * \author Norman Feske
+ * \date   2013-03-15
+ *
+ * Without a compiled route table, each session request of a child walks
+ * the XML route declaration of the child, matches the service nodes by
+ * name, and evaluates their '<if-arg>' conditions. The route table is
+ * compiled from the route declaration once when the child is created,
+ * which happens whenever init (re-)loads its config. For each service
+ * name, the table holds the applicable rules in the order of their
+ * declaration, including the '<any-service>' rules. The service found for
+ * a request is remembered unless the rules for the service depend on the
+ * session arguments.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _INCLUDE__INIT__ROUTE_TABLE_H_
+#define _INCLUDE__INIT__ROUTE_TABLE_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <base/printf.h>
+#include <base/service.h>
+#include <util/arg_string.h>
+#include <util/noncopyable.h>
+#include <util/xml_node.h>
+
+/* init includes */
+#include <init/name_registry.h>
+
+namespace Init {
+
+	/**
+	 * Return sub string of label with the leading child name stripped out
+	 *
+	 */
+	inline char const *skip_label_prefix(char const *child_name, char const *label)
+	{
+		Genode::size_t const child_name_len = Genode::strlen(child_name);
+
+		/*
+		 * If the function was called with a valid "label" string, the
+		 * following condition should be always satisfied. See the
+		 * comment in 'Route_table::Rule::condition_satisfied'.
+		 */
+		if (Genode::strcmp(child_name, label, child_name_len) == 0)
+			label += child_name_len;
+
+		/*
+		 * If the original label was empty, the 'Child_policy_enforce_labeling'
+		 * does not append a label separator after the child-name prefix. In
+		 * this case, we resulting label is empty.
+		 */
+		if (*label == 0)
+			return label;
+
+		/*
+		 * Skip label separator. This condition should be always satisfied.
+		 */
+		if (Genode::strcmp(" -> ", label, 4) == 0)
+			return label + 4;
+
+		PWRN("cannot skip label prefix while processing <if-arg>");
+		return label;
+	}
+
+
+	class Route_table : Genode::Noncopyable
+	{
+		private:
+
+			enum {
+				NAME_MAX_LEN   = Genode::Service::MAX_NAME_LEN,
+				SERVER_MAX_LEN = 64,
+				KEY_MAX_LEN    = 64,
+				VALUE_MAX_LEN  = 64,
+				NUM_BUCKETS    = 16,
+			};
+
+			/**
+			 * Target of a route as declared by a sub node of a rule
+			 */
+			struct Target
+			{
+				/*
+				 * A 'child' node without name is invalid. As the lookup
+				 * cannot be continued, it ends without result.
+				 */
+				enum Type { PARENT, CHILD, ANY_CHILD, INVALID };
+
+				Type type;
+				char server_name[SERVER_MAX_LEN];
+			};
+
+			/**
+			 * Rule as declared by a 'service' or 'any-service' node
+			 */
+			struct Rule
+			{
+				bool     any_service;
+				char     service_name[NAME_MAX_LEN];
+
+				/* condition declared by the 'if-arg' node */
+				bool     has_condition;
+				bool     label_key;
+				char     key[KEY_MAX_LEN];
+				char     value[VALUE_MAX_LEN];
+
+				Target  *targets;
+				unsigned num_targets, max_targets;
+
+				/*
+				 * A rule without targets or a 'service' node without
+				 * name ends the lookup without result.
+				 */
+				bool     dead_end;
+
+				/**
+				 * Check if arguments satisfy the condition of the rule
+				 */
+				bool condition_satisfied(char const *args, char const *child_name) const
+				{
+					if (!has_condition)
+						return true;
+
+					char arg_value[VALUE_MAX_LEN];
+					Genode::Arg_string::find_arg(args, key).string(arg_value, sizeof(arg_value), "");
+
+					/*
+					 * Skip child-name prefix if the key is the process "label".
+					 *
+					 * Because 'filter_session_args' is called prior the call of
+					 * 'resolve_session_request' from the 'Child::session' function,
+					 * 'args' contains the filtered arguments, in particular the label
+					 * prefixed with the child's name. For the 'if-args' declaration,
+					 * however, we want to omit specifying this prefix because the
+					 * session route is specific to the named start node anyway. So
+					 * the prefix information is redundant.
+					 */
+					if (label_key)
+						return Genode::strcmp(value, skip_label_prefix(child_name, arg_value)) == 0;
+
+					return Genode::strcmp(value, arg_value) == 0;
+				}
+			};
+
+			/**
+			 * Rules applicable to a service, in the order of declaration
+			 */
+			struct Entry
+			{
+				Entry           *next;          /* next entry of hash bucket */
+				char             service_name[NAME_MAX_LEN];
+				unsigned        *rules;         /* indices into '_rules'     */
+				unsigned         num_rules;
+				bool             owns_rules;
+				bool             conditional;   /* rules depend on args      */
+				Genode::Service *service;       /* remembered lookup result  */
+
+				Entry(char const *name, unsigned *rules, unsigned num_rules,
+				      bool owns_rules, bool conditional)
+				:
+					next(0), rules(rules), num_rules(num_rules),
+					owns_rules(owns_rules), conditional(conditional), service(0)
+				{
+					Genode::strncpy(service_name, name, sizeof(service_name));
+				}
+			};
+
+			Genode::Allocator         &_alloc;
+			char const                *_child_name;
+			Genode::Service_registry  &_parent_services;
+			Genode::Service_registry  &_child_services;
+			Name_registry const       &_name_registry;
+
+			Rule     *_rules;
+			unsigned  _num_rules, _max_rules;
+			Entry    *_buckets[NUM_BUCKETS];
+
+			/* rules applicable to services not named by any rule */
+			Entry    *_wildcard;
+
+			static unsigned _hash(char const *name)
+			{
+				unsigned h = 0;
+				for (; *name; name++)
+					h = h*31 + *name;
+				return h % NUM_BUCKETS;
+			}
+
+			Entry *_lookup(char const *service_name)
+			{
+				Entry *e = _buckets[_hash(service_name)];
+				for (; e && Genode::strcmp(e->service_name, service_name); e = e->next);
+				return e;
+			}
+
+			void _insert(Entry *e)
+			{
+				Entry *&head = _buckets[_hash(e->service_name)];
+				e->next = head;
+				head    = e;
+			}
+
+			/**
+			 * Create entry holding the rules applicable to a service
+			 *
+			 * \param service_name  name of service or 0 for collecting
+			 *                      the 'any-service' rules only
+			 */
+			Entry *_create_entry(char const *service_name)
+			{
+				unsigned *rules = _num_rules
+				                ? (unsigned *)_alloc.alloc(_num_rules*sizeof(unsigned)) : 0;
+				unsigned num_rules   = 0;
+				bool     conditional = false;
+
+				for (unsigned i = 0; i < _num_rules; i++) {
+
+					Rule const &rule = _rules[i];
+					if (!rule.any_service
+					 && (!service_name || Genode::strcmp(rule.service_name, service_name)))
+						continue;
+
+					rules[num_rules++] = i;
+					conditional |= rule.has_condition;
+				}
+				return new (&_alloc) Entry(service_name ? service_name : "", rules,
+				                           num_rules, true, conditional);
+			}
+
+			void _destroy_entry(Entry *e)
+			{
+				if (e->owns_rules && e->rules)
+					_alloc.free(e->rules, _num_rules*sizeof(unsigned));
+
+				destroy(&_alloc, e);
+			}
+
+			void _compile_targets(Rule &rule, Genode::Xml_node service_node)
+			{
+				using namespace Genode;
+
+				rule.max_targets = service_node.num_sub_nodes();
+				if (rule.max_targets)
+					rule.targets = (Target *)_alloc.alloc(rule.max_targets*sizeof(Target));
+
+				for (Xml_node node = service_node.sub_node(); ; node = node.next()) {
+
+					Target &target = rule.targets[rule.num_targets];
+					target.server_name[0] = 0;
+
+					if (node.has_type("parent")) {
+						target.type = Target::PARENT;
+						rule.num_targets++;
+					}
+
+					if (node.has_type("child")) {
+						target.type = Target::CHILD;
+						try {
+							node.attribute("name").value(target.server_name,
+							                             sizeof(target.server_name));
+						} catch (Xml_node::Nonexistent_attribute) {
+							target.type = Target::INVALID; }
+						rule.num_targets++;
+					}
+
+					if (node.has_type("any-child")) {
+						target.type = Target::ANY_CHILD;
+						rule.num_targets++;
+					}
+
+					if (node.is_last())
+						break;
+				}
+			}
+
+			void _compile_rule(Genode::Xml_node service_node)
+			{
+				using namespace Genode;
+
+				Rule &rule = _rules[_num_rules++];
+
+				rule.any_service     = service_node.has_type("any-service");
+				rule.service_name[0] = 0;
+				rule.has_condition   = false;
+				rule.label_key       = false;
+				rule.targets         = 0;
+				rule.num_targets     = 0;
+				rule.max_targets     = 0;
+				rule.dead_end        = false;
+
+				if (!rule.any_service) {
+					try {
+						service_node.attribute("name").value(rule.service_name,
+						                                     sizeof(rule.service_name));
+					} catch (Xml_node::Nonexistent_attribute) {
+						rule.any_service = true;
+						rule.dead_end    = true;
+						return;
+					}
+				}
+
+				/* a malformed condition is always satisfied */
+				try {
+					Xml_node if_arg = service_node.sub_node("if-arg");
+					if_arg.attribute("key").value(rule.key, sizeof(rule.key));
+					if_arg.attribute("value").value(rule.value, sizeof(rule.value));
+					rule.has_condition = true;
+					rule.label_key     = Genode::strcmp("label", rule.key) == 0;
+				} catch (...) { }
+
+				try { _compile_targets(rule, service_node); }
+				catch (Xml_node::Nonexistent_sub_node) { rule.dead_end = true; }
+			}
+
+			/**
+			 * Remember result of a lookup if it does not depend on args
+			 */
+			Genode::Service *_remember(char const *service_name, Entry *entry,
+			                           Genode::Service *service)
+			{
+				if (entry ? entry->conditional : _wildcard->conditional)
+					return service;
+
+				if (!entry) {
+					entry = new (&_alloc) Entry(service_name, _wildcard->rules,
+					                            _wildcard->num_rules, false, false);
+					_insert(entry);
+				}
+				entry->service = service;
+				return service;
+			}
+
+		public:
+
+			/**
+			 * Constructor
+			 *
+			 * \param alloc       allocator for the compiled rules
+			 * \param route_node  route declaration of the child
+			 * \param child_name  name of the child, must outlive the table
+			 */
+			Route_table(Genode::Allocator        &alloc,
+			            Genode::Xml_node          route_node,
+			            char const               *child_name,
+			            Genode::Service_registry &parent_services,
+			            Genode::Service_registry &child_services,
+			            Name_registry const      &name_registry)
+			:
+				_alloc(alloc), _child_name(child_name),
+				_parent_services(parent_services), _child_services(child_services),
+				_name_registry(name_registry),
+				_rules(0), _num_rules(0), _max_rules(route_node.num_sub_nodes()),
+				_wildcard(0)
+			{
+				using namespace Genode;
+
+				for (unsigned i = 0; i < NUM_BUCKETS; i++)
+					_buckets[i] = 0;
+
+				if (_max_rules)
+					_rules = (Rule *)_alloc.alloc(_max_rules*sizeof(Rule));
+
+				try {
+					for (Xml_node node = route_node.sub_node(); ; node = node.next()) {
+
+						if (node.has_type("service") || node.has_type("any-service"))
+							_compile_rule(node);
+
+						if (node.is_last())
+							break;
+					}
+				} catch (Xml_node::Nonexistent_sub_node) { }
+
+				_wildcard = _create_entry(0);
+
+				/* create entries for all services named by a rule */
+				for (unsigned i = 0; i < _num_rules; i++)
+					if (!_rules[i].any_service && !_lookup(_rules[i].service_name))
+						_insert(_create_entry(_rules[i].service_name));
+			}
+
+			~Route_table()
+			{
+				for (unsigned i = 0; i < NUM_BUCKETS; i++)
+					while (Entry *e = _buckets[i]) {
+						_buckets[i] = e->next;
+						_destroy_entry(e);
+					}
+
+				_destroy_entry(_wildcard);
+
+				for (unsigned i = 0; i < _num_rules; i++)
+					if (_rules[i].targets)
+						_alloc.free(_rules[i].targets, _rules[i].max_targets*sizeof(Target));
+
+				if (_rules)
+					_alloc.free(_rules, _max_rules*sizeof(Rule));
+			}
+
+			/**
+			 * Look up service for a session request
+			 *
+			 * \return  service, or 0 if the request cannot be routed
+			 */
+			Genode::Service *resolve(char const *service_name, char const *args)
+			{
+				using namespace Genode;
+
+				Entry *entry = _lookup(service_name);
+				if (entry && entry->service)
+					return entry->service;
+
+				Entry const &rules = entry ? *entry : *_wildcard;
+
+				for (unsigned i = 0; i < rules.num_rules; i++) {
+
+					Rule const &rule = _rules[rules.rules[i]];
+
+					if (!rule.condition_satisfied(args, _child_name))
+						continue;
+
+					if (rule.dead_end)
+						break;
+
+					bool const service_wildcard = rule.any_service;
+
+					for (unsigned j = 0; j < rule.num_targets; j++) {
+
+						Target const &target = rule.targets[j];
+						Service *service = 0;
+
+						switch (target.type) {
+
+						case Target::PARENT:
+
+							service = _parent_services.find(service_name);
+							if (service)
+								return _remember(service_name, entry, service);
+
+							if (!service_wildcard) {
+								PWRN("%s: service lookup for \"%s\" at parent failed", _child_name, service_name);
+								return 0;
+							}
+							break;
+
+						case Target::CHILD:
+							{
+								Server *server = _name_registry.lookup_server(target.server_name);
+								if (!server)
+									PWRN("%s: invalid route to non-existing server \"%s\"", _child_name, target.server_name);
+
+								service = _child_services.find(service_name, server);
+								if (service)
+									return _remember(service_name, entry, service);
+
+								if (!service_wildcard) {
+									PWRN("%s: lookup to child service \"%s\" failed", _child_name, service_name);
+									return 0;
+								}
+							}
+							break;
+
+						case Target::ANY_CHILD:
+
+							if (_child_services.is_ambiguous(service_name)) {
+								PERR("%s: ambiguous routes to service \"%s\"", _child_name, service_name);
+								return 0;
+							}
+							service = _child_services.find(service_name);
+							if (service)
+								return _remember(service_name, entry, service);
+
+							if (!service_wildcard) {
+								PWRN("%s: lookup for service \"%s\" failed", _child_name, service_name);
+								return 0;
+							}
+							break;
+
+						case Target::INVALID:
+
+							PWRN("%s: no route to service \"%s\"", _child_name, service_name);
+							return 0;
+						}
+					}
+				}
+
+				PWRN("%s: no route to service \"%s\"", _child_name, service_name);
+				return 0;
+			}
+	};
+}
+
+#endif /* _INCLUDE__INIT__ROUTE_TABLE_H_ */
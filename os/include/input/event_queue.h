@@ -24,13 +24,18 @@
  * We expect the client to fetch events circa each 10ms. The PS/2 driver queues
  * up to 255 events, which should be enough. Normally, PS/2 generates not more
  * than 16Kbit/s, which would correspond to ca. 66 mouse events per 10ms.
+ *
+ * Events may be added by several threads, e.g., by the keyboard and mouse
+ * IRQ handlers of the PS/2 driver, but are fetched by a single thread.
  */
 class Event_queue
 {
 	private:
 
-		bool                           _enabled;
-		Ring_buffer<Input::Event, 512> _ev_queue;
+		typedef Blocking_ring_buffer<Mpsc_ring_buffer<Input::Event, 512> > Queue;
+
+		bool  _enabled;
+		Queue _ev_queue;
 
 	public:
 
@@ -43,11 +48,8 @@ class Event_queue
 		{
 			if (!_enabled) return;
 
-			try {
-				_ev_queue.add(e);
-			} catch (Ring_buffer<Input::Event, 512>::Overflow) {
+			if (!_ev_queue.add(e))
 				PWRN("event buffer overflow");
-			}
 		}
 
 		Input::Event get()
@@ -16,6 +16,7 @@
 
 #include <blit/blit.h>
 #include "canvas.h"
+#include "pixel_row.h"
 
 
 template <typename PT>
@@ -66,11 +67,10 @@ class Chunky_canvas : public Canvas
 			if (!clipped.valid()) return;
 
 			PT pix(color.r, color.g, color.b);
-			PT *dst, *dst_line = _addr + _size.w()*clipped.y1() + clipped.x1();
+			PT *dst_line = _addr + _size.w()*clipped.y1() + clipped.x1();
 
-			for (int w, h = clipped.h() ; h--; dst_line += _size.w())
-				for (dst = dst_line, w = clipped.w(); w--; dst++)
-					*dst = pix;
+			for (int h = clipped.h() ; h--; dst_line += _size.w())
+				Pixel_row<PT>::fill(dst_line, pix, clipped.w());
 
 			_flush_pixels(clipped);
 		}
@@ -153,9 +153,7 @@ class Chunky_canvas : public Canvas
 
 			PT mix_pixel(mix_color.r, mix_color.g, mix_color.b);
 
-			int i, j;
-			PT *s, *d;
-			unsigned char *a;
+			int j;
 
 			switch (mode) {
 
@@ -176,23 +174,19 @@ class Chunky_canvas : public Canvas
 				 * Copy texture with alpha blending
 				 */
 				for (j = clipped.h(); j--; src += src_w, alpha += src_w, dst += dst_w)
-					for (i = clipped.w(), s = src, a = alpha, d = dst; i--; s++, d++, a++)
-						if (*a)
-							*d = PT::mix(*d, *s, *a);
+					Pixel_row<PT>::mix(dst, src, alpha, clipped.w());
 				break;
 
 			case MIXED:
 
 				for (j = clipped.h(); j--; src += src_w, dst += dst_w)
-					for (i = clipped.w(), s = src, d = dst; i--; s++, d++)
-						*d = PT::avr(mix_pixel, *s);
+					Pixel_row<PT>::avr(dst, src, mix_pixel, clipped.w());
 				break;
 
 			case MASKED:
 
 				for (j = clipped.h(); j--; src += src_w, dst += dst_w)
-					for (i = clipped.w(), s = src, d = dst; i--; s++, d++)
-						if (s->pixel) *d = *s;
+					Pixel_row<PT>::copy_masked(dst, src, clipped.w());
 				break;
 			}
 
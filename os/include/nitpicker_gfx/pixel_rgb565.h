@@ -15,6 +15,7 @@
 #define _INCLUDE__NITPICKER_GFX__PIXEL_RGB565_H_
 
 #include "pixel_rgb.h"
+#include "pixel_row.h"
 
 typedef Pixel_rgb<unsigned short, 0xf800, 8, 0x07e0, 3, 0x001f, -3> Pixel_rgb565;
 
@@ -53,4 +54,95 @@ inline Pixel_rgb565 Pixel_rgb565::mix(Pixel_rgb565 p1, Pixel_rgb565 p2, int alph
 	return res;
 }
 
+
+/**
+ * Vectorized row operations for the RGB565 pixel format
+ *
+ * The results are identical to those of 'Pixel_row_scalar'.
+ */
+template <>
+struct Pixel_row<Pixel_rgb565> : Pixel_row_scalar<Pixel_rgb565>
+{
+	typedef Pixel_rgb565        PT;
+	typedef Pixel_vector        V;
+	typedef Pixel_vector::U16   U16;
+	typedef Pixel_vector::U32   U32;
+
+	/**
+	 * Vectorized version of 'Pixel_rgb565::blend'
+	 *
+	 * The channels are multiplied separately to keep the intermediate
+	 * products within 16 bits.
+	 */
+	static inline U16 blend(U16 src, U16 alpha)
+	{
+		U16 const m5 = V::splat<U16>((unsigned short)0x1f);
+		U16 const a5 = alpha >> 3;
+
+		U16 const r = (((a5    * (src >> 11))       >> 5) & m5) << 11;
+		U16 const g = (((alpha * ((src >> 6) & m5)) >> 8) & m5) << 6;
+		U16 const b =  ((a5    * (src & m5))        >> 5) & m5;
+
+		return r | g | b;
+	}
+
+	static void fill(PT *dst, PT pix, int n) {
+		V::fill(dst, pix.pixel, n); }
+
+	static void mix(PT *dst, PT const *src, unsigned char const *alpha, int n)
+	{
+		enum { LANES = V::U16_LANES };
+
+		for (; n >= LANES; n -= LANES, dst += LANES, src += LANES, alpha += LANES) {
+
+			/* skip fully transparent pixels */
+			if (!V::any(alpha, LANES))
+				continue;
+
+			U16 const a = V::widen(alpha);
+			U16 const d = V::load<U16>(dst);
+			U16 const m = V::alpha_mask(a);
+
+			/* see 'Pixel_rgb565::mix' for the rationale behind 264 */
+			U16 const res = blend(d, V::splat<U16>((unsigned short)264) - a)
+			              + blend(V::load<U16>(src), a);
+
+			V::store(dst, (res & m) | (d & ~m));
+		}
+
+		Pixel_row_scalar<PT>::mix(dst, src, alpha, n);
+	}
+
+	static void avr(PT *dst, PT const *src, PT pix, int n)
+	{
+		enum { LANES = V::U16_LANES };
+
+		U16 const mask = V::splat<U16>((unsigned short)0xf7df);
+		U16 const p    = (V::splat<U16>(pix.pixel) & mask) >> 1;
+
+		for (; n >= LANES; n -= LANES, dst += LANES, src += LANES)
+			V::store(dst, p + ((V::load<U16>(src) & mask) >> 1));
+
+		Pixel_row_scalar<PT>::avr(dst, src, pix, n);
+	}
+
+	static void copy_masked(PT *dst, PT const *src, int n)
+	{
+		enum { LANES = V::U16_LANES };
+
+		U16 const zero = V::splat<U16>((unsigned short)0);
+
+		for (; n >= LANES; n -= LANES, dst += LANES, src += LANES) {
+			U16 const s = V::load<U16>(src);
+
+			/* all bits set for lanes with non-zero source pixels */
+			U16 const m = zero - ((s | (zero - s)) >> 15);
+
+			V::store(dst, (s & m) | (V::load<U16>(dst) & ~m));
+		}
+
+		Pixel_row_scalar<PT>::copy_masked(dst, src, n);
+	}
+};
+
 #endif /* _INCLUDE__NITPICKER_GFX__PIXEL_RGB565_H_ */
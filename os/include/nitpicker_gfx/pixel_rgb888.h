@@ -0,0 +1,157 @@
+/*
+ * \brief  Template specializations for the RGB888 pixel format
+ * \author Norman Feske
+ * \date   2013-03-06
+ *
+ * Each pixel is stored in a 32-bit word. The most significant byte is
+ * unused.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _INCLUDE__NITPICKER_GFX__PIXEL_RGB888_H_
+#define _INCLUDE__NITPICKER_GFX__PIXEL_RGB888_H_
+
+#include "pixel_rgb.h"
+#include "pixel_row.h"
+
+typedef Pixel_rgb<unsigned int, 0xff0000, 16, 0x00ff00, 8, 0x0000ff, 0> Pixel_rgb888;
+
+
+template <>
+inline Pixel_rgb888 Pixel_rgb888::avr(Pixel_rgb888 p1, Pixel_rgb888 p2)
+{
+	Pixel_rgb888 res;
+	res.pixel = ((p1.pixel&0xfefefe)>>1) + ((p2.pixel&0xfefefe)>>1);
+	return res;
+}
+
+
+template <>
+inline Pixel_rgb888 Pixel_rgb888::blend(Pixel_rgb888 src, int alpha)
+{
+	Pixel_rgb888 res;
+	res.pixel = ((((unsigned)alpha * (src.pixel & 0xff00ff)) >> 8) & 0xff00ff)
+	          | ((((unsigned)alpha * (src.pixel & 0x00ff00)) >> 8) & 0x00ff00);
+	return res;
+}
+
+
+template <>
+inline Pixel_rgb888 Pixel_rgb888::mix(Pixel_rgb888 p1, Pixel_rgb888 p2, int alpha)
+{
+	Pixel_rgb888 res;
+
+	/*
+	 * With 8 bits per channel, the weights add up to 256 without
+	 * overflowing a channel.
+	 */
+	res.pixel = blend(p1, 256 - alpha).pixel + blend(p2, alpha).pixel;
+	return res;
+}
+
+
+/**
+ * Vectorized row operations for the RGB888 pixel format
+ *
+ * The results are identical to those of 'Pixel_row_scalar'.
+ */
+template <>
+struct Pixel_row<Pixel_rgb888> : Pixel_row_scalar<Pixel_rgb888>
+{
+	typedef Pixel_rgb888      PT;
+	typedef Pixel_vector      V;
+	typedef Pixel_vector::U16 U16;
+	typedef Pixel_vector::U32 U32;
+
+	/**
+	 * Vectorized version of 'Pixel_rgb888::blend'
+	 *
+	 * The alpha value of each pixel is expected in both 16-bit halves of
+	 * its lane. Each 16-bit lane holds one channel during the
+	 * multiplication.
+	 */
+	static inline U32 blend(U32 src, U16 alpha)
+	{
+		U16 const m8 = V::splat<U16>((unsigned short)0xff);
+
+		U16 const rb = (U16)(src & V::splat<U32>(0xff00ffU));
+		U16 const g  = (U16)((src >> 8) & V::splat<U32>(0xffU));
+
+		return (U32)(((alpha * rb) >> 8) & m8)
+		     | ((U32)(((alpha * g) >> 8) & m8) << 8);
+	}
+
+	static void fill(PT *dst, PT pix, int n) {
+		V::fill(dst, pix.pixel, n); }
+
+	static void mix(PT *dst, PT const *src, unsigned char const *alpha, int n)
+	{
+		enum { LANES = V::U32_LANES };
+
+		/*
+		 * Without SIMD support, a vector holds only a single pixel. In
+		 * this case, the scalar version is faster.
+		 */
+		if (LANES == 1) {
+			Pixel_row_scalar<PT>::mix(dst, src, alpha, n);
+			return;
+		}
+
+		for (; n >= LANES; n -= LANES, dst += LANES, src += LANES, alpha += LANES) {
+
+			/* skip fully transparent pixels */
+			if (!V::any(alpha, LANES))
+				continue;
+
+			U16 const a = V::widen_pairs(alpha);
+			U32 const d = V::load<U32>(dst);
+			U32 const m = (U32)V::alpha_mask(a);
+
+			U32 const res = blend(d, V::splat<U16>((unsigned short)256) - a)
+			              + blend(V::load<U32>(src), a);
+
+			V::store(dst, (res & m) | (d & ~m));
+		}
+
+		Pixel_row_scalar<PT>::mix(dst, src, alpha, n);
+	}
+
+	static void avr(PT *dst, PT const *src, PT pix, int n)
+	{
+		enum { LANES = V::U32_LANES };
+
+		U32 const mask = V::splat<U32>(0xfefefeU);
+		U32 const p    = (V::splat<U32>(pix.pixel) & mask) >> 1;
+
+		for (; n >= LANES; n -= LANES, dst += LANES, src += LANES)
+			V::store(dst, p + ((V::load<U32>(src) & mask) >> 1));
+
+		Pixel_row_scalar<PT>::avr(dst, src, pix, n);
+	}
+
+	static void copy_masked(PT *dst, PT const *src, int n)
+	{
+		enum { LANES = V::U32_LANES };
+
+		U32 const zero = V::splat<U32>(0U);
+
+		for (; n >= LANES; n -= LANES, dst += LANES, src += LANES) {
+			U32 const s = V::load<U32>(src);
+
+			/* all bits set for lanes with non-zero source pixels */
+			U32 const m = zero - ((s | (zero - s)) >> 31);
+
+			V::store(dst, (s & m) | (V::load<U32>(dst) & ~m));
+		}
+
+		Pixel_row_scalar<PT>::copy_masked(dst, src, n);
+	}
+};
+
+#endif /* _INCLUDE__NITPICKER_GFX__PIXEL_RGB888_H_ */
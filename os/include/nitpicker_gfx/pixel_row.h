@@ -0,0 +1,220 @@
+/*
+ * \brief  Operations on rows of pixels
+ * \author Norman Feske
+ * \date   2013-03-06
+ *
+ * The canvas performs its drawing operations row by row. The generic
+ * implementation of the row operations processes one pixel at a time.
+ * Pixel formats can specialize 'Pixel_row' to process several pixels per
+ * step using the vector extensions of the compiler. Depending on the
+ * target, the compiler translates those to SSE2 or NEON instructions.
+ * Without SIMD support, a vector degrades to a 32-bit word.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _INCLUDE__NITPICKER_GFX__PIXEL_ROW_H_
+#define _INCLUDE__NITPICKER_GFX__PIXEL_ROW_H_
+
+/**
+ * Reference implementation of the row operations
+ *
+ * \param PT  pixel type
+ */
+template <typename PT>
+struct Pixel_row_scalar
+{
+	/**
+	 * Set 'n' pixels to 'pix'
+	 */
+	static void fill(PT *dst, PT pix, int n)
+	{
+		for (; n-- > 0; dst++)
+			*dst = pix;
+	}
+
+	/**
+	 * Mix source pixels into destination according to the alpha values
+	 */
+	static void mix(PT *dst, PT const *src, unsigned char const *alpha, int n)
+	{
+		for (; n-- > 0; dst++, src++, alpha++)
+			if (*alpha)
+				*dst = PT::mix(*dst, *src, *alpha);
+	}
+
+	/**
+	 * Store average of source pixels and 'pix' to destination
+	 */
+	static void avr(PT *dst, PT const *src, PT pix, int n)
+	{
+		for (; n-- > 0; dst++, src++)
+			*dst = PT::avr(pix, *src);
+	}
+
+	/**
+	 * Copy source pixels except for those with the value 0
+	 */
+	static void copy_masked(PT *dst, PT const *src, int n)
+	{
+		for (; n-- > 0; dst++, src++)
+			if (src->pixel)
+				*dst = *src;
+	}
+};
+
+
+/**
+ * Row operations used by the canvas
+ *
+ * Pixel formats specialize this template to provide vectorized versions.
+ */
+template <typename PT>
+struct Pixel_row : Pixel_row_scalar<PT> { };
+
+
+/**
+ * Vector types and helpers used by the 'Pixel_row' specializations
+ */
+struct Pixel_vector
+{
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+	enum { SIZE = 16 };
+#else
+	enum { SIZE = 4 };
+#endif
+
+	/*
+	 * Blending is performed on 16-bit lanes because SSE2 and NEON
+	 * provide no multiplication of 32-bit lanes.
+	 */
+	typedef unsigned short U16 __attribute__((vector_size(SIZE)));
+	typedef unsigned int   U32 __attribute__((vector_size(SIZE)));
+
+	enum {
+		U16_LANES = SIZE/sizeof(unsigned short),
+		U32_LANES = SIZE/sizeof(unsigned int),
+	};
+
+	/*
+	 * Load 8-bit values into the lanes of a 16-bit or 32-bit vector
+	 *
+	 * The initializers are spelled out per vector size because the
+	 * compiler recognizes them as zero-extending loads.
+	 */
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+	static inline U16 widen(unsigned char const *s)
+	{
+		U16 v = { s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7] };
+		return v;
+	}
+
+	static inline U32 widen32(unsigned char const *s)
+	{
+		U32 v = { s[0], s[1], s[2], s[3] };
+		return v;
+	}
+#else
+	static inline U16 widen(unsigned char const *s)
+	{
+		U16 v = { s[0], s[1] };
+		return v;
+	}
+
+	static inline U32 widen32(unsigned char const *s)
+	{
+		U32 v = { s[0] };
+		return v;
+	}
+#endif
+
+	/*
+	 * Pixel buffers are not guaranteed to be aligned to the vector size.
+	 * The compiler turns the fixed-size copies into unaligned vector
+	 * loads and stores.
+	 */
+	template <typename V>
+	static inline V load(void const *src)
+	{
+		V v;
+		__builtin_memcpy(&v, src, sizeof(V));
+		return v;
+	}
+
+	template <typename V>
+	static inline void store(void *dst, V v) {
+		__builtin_memcpy(dst, &v, sizeof(V)); }
+
+	/**
+	 * Return vector with all lanes set to 'value'
+	 */
+	template <typename V, typename T>
+	static inline V splat(T value)
+	{
+		union { V v; T t[sizeof(V)/sizeof(T)]; } u;
+		for (unsigned i = 0; i < sizeof(V)/sizeof(T); i++)
+			u.t[i] = value;
+		return u.v;
+	}
+
+	/**
+	 * Load 8-bit values into both halves of the lanes of a 32-bit vector
+	 */
+	static inline U16 widen_pairs(unsigned char const *src)
+	{
+		U32 const v = widen32(src);
+		return (U16)(v | (v << 16));
+	}
+
+	/**
+	 * Return true if any of the 'n' bytes at 'src' is not zero
+	 */
+	static inline bool any(unsigned char const *src, unsigned n)
+	{
+		for (; n >= sizeof(unsigned); n -= sizeof(unsigned), src += sizeof(unsigned)) {
+			unsigned v;
+			__builtin_memcpy(&v, src, sizeof(v));
+			if (v) return true;
+		}
+
+		for (; n; n--, src++)
+			if (*src) return true;
+
+		return false;
+	}
+
+	/**
+	 * Return lane mask with all bits set for non-zero alpha values
+	 *
+	 * The mask is computed arithmetically because vector comparisons are
+	 * not supported by all compiler versions we use.
+	 */
+	static inline U16 alpha_mask(U16 alpha) {
+		return splat<U16>((unsigned short)0)
+		     - ((alpha + splat<U16>((unsigned short)255)) >> 8); }
+
+	/**
+	 * Set 'n' values of type 'T' to 'value'
+	 */
+	template <typename T>
+	static inline void fill(void *dst, T value, int n)
+	{
+		U32 const v = splat<U32>((unsigned)value*(0xffffffffU/(T)~0));
+
+		enum { LANES = SIZE/sizeof(T) };
+
+		T *d = (T *)dst;
+		for (; n >= LANES; n -= LANES, d += LANES)
+			store(d, v);
+
+		for (; n-- > 0; d++)
+			*d = value;
+	}
+};
+
+#endif /* _INCLUDE__NITPICKER_GFX__PIXEL_ROW_H_ */
@@ -15,6 +15,7 @@
 #define _INCLUDE__OS__CONFIG_H_
 
 #include <util/xml_node.h>
+#include <base/env.h>
 #include <dataspace/client.h>
 #include <rom_session/connection.h>
 #include <base/exception.h>
@@ -27,15 +28,48 @@ namespace Genode {
 
 			Rom_connection       _config_rom;
 			Dataspace_capability _config_ds;
+			Xml_index           *_config_index;
 			Xml_node             _config_xml;
 
-			Xml_node _config_xml_node()
+			/*
+			 * The config is traversed repeatedly, e.g., by init for each
+			 * session request or by servers for each 'Session_policy'.
+			 * Hence, we index the config data once it is obtained.
+			 *
+			 * The index is returned via 'index', or 0 if there is no
+			 * config data. On error, the config data is released again.
+			 */
+			static Xml_node _config_xml_node(Dataspace_capability ds,
+			                                 Xml_index **index)
 			{
-				if (_config_ds.valid())
-					return Xml_node(env()->rm_session()->attach(_config_ds),
-					                Genode::Dataspace_client(_config_ds).size());
-				else
+				*index = 0;
+
+				if (!ds.valid())
 					return Xml_node("<config/>");
+
+				char const * const addr = env()->rm_session()->attach(ds);
+				size_t       const size = Genode::Dataspace_client(ds).size();
+
+				*index = new (env()->heap()) Xml_index(*env()->heap(), addr, size);
+				try {
+					return Xml_node(**index);
+				} catch (Genode::Xml_node::Invalid_syntax) {
+					_release(*index);
+					*index = 0;
+					throw;
+				}
+			}
+
+			/**
+			 * Detach config data and destroy its index
+			 */
+			static void _release(Xml_index *index)
+			{
+				if (!index)
+					return;
+
+				env()->rm_session()->detach(index->addr());
+				destroy(env()->heap(), index);
 			}
 
 		public:
@@ -51,7 +85,8 @@ namespace Genode {
 			Config() :
 				_config_rom("config"),
 				_config_ds(_config_rom.dataspace()),
-				_config_xml(_config_xml_node())
+				_config_index(0),
+				_config_xml(_config_xml_node(_config_ds, &_config_index))
 			{ }
 
 			Xml_node xml_node() { return _config_xml; }
@@ -71,20 +106,28 @@ namespace Genode {
 			 */
 			void reload()
 			{
+				/* re-acquire dataspace from ROM session */
+				Dataspace_capability const ds = _config_rom.dataspace();
+
+				/*
+				 * Index the new config data before releasing the old one.
+				 * If the new config is malformed, the current 'Xml_node'
+				 * and its index stay intact.
+				 */
+				Xml_index *index = 0;
+				Xml_node   xml("<config/>");
 				try {
-					/* re-acquire dataspace from ROM session */
-					if (_config_ds.valid())
-						env()->rm_session()->detach(_config_xml.addr());
-
-					_config_ds = _config_rom.dataspace();
-
-					/* re-initialize XML node with new config data */
-					_config_xml = _config_xml_node();
-
+					xml = _config_xml_node(ds, &index);
 				} catch (Genode::Xml_node::Invalid_syntax) {
 					PERR("Config file has invalid syntax");
 					throw Invalid();
 				}
+
+				_release(_config_index);
+
+				_config_ds    = ds;
+				_config_index = index;
+				_config_xml   = xml;
 			}
 	};
 
@@ -2,6 +2,12 @@
  * \brief  Ring buffer
  * \author Norman Feske
  * \date   2007-09-28
+ *
+ * Besides the generic 'Ring_buffer', this file provides lock-free variants
+ * for a single consumer. They synchronize producer and consumer via the
+ * head and tail indices only. The indices are located in different cache
+ * lines so that producer and consumer do not contend for the same cache
+ * line. The number of slots must be a power of two.
  */
 
 /*
@@ -17,6 +23,7 @@
 #include <base/semaphore.h>
 #include <base/exception.h>
 #include <util/string.h>
+#include <cpu/atomic.h>
 
 /**
  * Ring buffer template
@@ -92,4 +99,338 @@ class Ring_buffer
 		bool empty() { return _tail == _head; }
 };
 
+
+namespace Ring_buffer_atomic {
+
+	enum { CACHE_LINE_SIZE = 64 };
+
+	/*
+	 * Acquire and release semantics suffice for publishing the slots.
+	 * The compiler translates them to plain loads and stores on x86 and
+	 * adds the needed barriers on ARM.
+	 */
+	inline unsigned load_acquire(unsigned volatile const *p) {
+		return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+	inline void store_release(unsigned volatile *p, unsigned v) {
+		__atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+	/**
+	 * Order preceding stores before following loads
+	 */
+	inline void full_barrier() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+	/**
+	 * Index padded to a full cache line
+	 */
+	struct Index
+	{
+		unsigned volatile value;
+		char _pad[CACHE_LINE_SIZE - sizeof(unsigned)];
+
+		Index() : value(0) { }
+	};
+
+	/**
+	 * Compile-time check for the number of slots
+	 */
+	template <unsigned SIZE>
+	struct Power_of_two { typedef char Check[(SIZE & (SIZE - 1)) ? -1 : 1]; };
+}
+
+
+/**
+ * Lock-free ring buffer for a single producer and a single consumer
+ *
+ * \param ET          element type
+ * \param QUEUE_SIZE  number of element slots, must be a power of two
+ *
+ * In contrast to 'Ring_buffer', all slots can be used and the functions
+ * never block. The head index is written by the producer only, the tail
+ * index by the consumer only.
+ */
+template <typename ET, unsigned QUEUE_SIZE>
+class Spsc_ring_buffer
+{
+	private:
+
+		typedef typename Ring_buffer_atomic::Power_of_two<QUEUE_SIZE>::Check Size_check;
+
+		enum { MASK = QUEUE_SIZE - 1 };
+
+		Ring_buffer_atomic::Index _head;
+		Ring_buffer_atomic::Index _tail;
+
+		ET _queue[QUEUE_SIZE];
+
+	public:
+
+		typedef ET Element;
+
+		/**
+		 * Place up to 'n' elements into the ring buffer
+		 *
+		 * \return  number of added elements
+		 */
+		unsigned add(ET const *src, unsigned n)
+		{
+			using namespace Ring_buffer_atomic;
+
+			unsigned const head = _head.value;
+			unsigned const free = QUEUE_SIZE - (head - load_acquire(&_tail.value));
+
+			n = Genode::min(n, free);
+			for (unsigned i = 0; i < n; i++)
+				_queue[(head + i) & MASK] = src[i];
+
+			store_release(&_head.value, head + n);
+			return n;
+		}
+
+		/**
+		 * Place element into ring buffer
+		 *
+		 * \return  false if the ring buffer is full
+		 */
+		bool add(ET const &e) { return add(&e, 1) == 1; }
+
+		/**
+		 * Take up to 'n' elements from the ring buffer
+		 *
+		 * \return  number of elements taken
+		 */
+		unsigned get(ET *dst, unsigned n)
+		{
+			using namespace Ring_buffer_atomic;
+
+			unsigned const tail = _tail.value;
+
+			n = Genode::min(n, load_acquire(&_head.value) - tail);
+			for (unsigned i = 0; i < n; i++)
+				dst[i] = _queue[(tail + i) & MASK];
+
+			store_release(&_tail.value, tail + n);
+			return n;
+		}
+
+		/**
+		 * Take element from ring buffer
+		 *
+		 * \return  false if the ring buffer is empty
+		 */
+		bool get(ET &e) { return get(&e, 1) == 1; }
+
+		bool empty() const {
+			return Ring_buffer_atomic::load_acquire(&_head.value) == _tail.value; }
+};
+
+
+/**
+ * Lock-free ring buffer for multiple producers and a single consumer
+ *
+ * \param ET          element type
+ * \param QUEUE_SIZE  number of element slots, must be a power of two
+ *
+ * Producers reserve slots by advancing the head index atomically. Because
+ * the producers fill their slots concurrently, each slot carries a sequence
+ * number that marks it as filled. The consumer takes elements in order and
+ * stops at the first slot that is reserved but not filled yet.
+ */
+template <typename ET, unsigned QUEUE_SIZE>
+class Mpsc_ring_buffer
+{
+	private:
+
+		typedef typename Ring_buffer_atomic::Power_of_two<QUEUE_SIZE>::Check Size_check;
+
+		enum { MASK = QUEUE_SIZE - 1 };
+
+		struct Slot
+		{
+			unsigned volatile seq;  /* index of the filled element plus 1 */
+			ET                element;
+
+			Slot() : seq(0) { }
+		};
+
+		Ring_buffer_atomic::Index _head;
+		Ring_buffer_atomic::Index _tail;
+
+		Slot _queue[QUEUE_SIZE];
+
+	public:
+
+		typedef ET Element;
+
+		/**
+		 * Place up to 'n' elements into the ring buffer
+		 *
+		 * \return  number of added elements
+		 */
+		unsigned add(ET const *src, unsigned n)
+		{
+			using namespace Ring_buffer_atomic;
+
+			/* reserve slots */
+			unsigned head;
+			for (;;) {
+				head = _head.value;
+
+				unsigned const free = QUEUE_SIZE - (head - load_acquire(&_tail.value));
+				n = Genode::min(n, free);
+				if (!n)
+					return 0;
+
+				if (Genode::cmpxchg((int volatile *)&_head.value, head, head + n))
+					break;
+			}
+
+			/* fill reserved slots */
+			for (unsigned i = 0; i < n; i++) {
+				Slot &slot = _queue[(head + i) & MASK];
+				slot.element = src[i];
+				store_release(&slot.seq, head + i + 1);
+			}
+			return n;
+		}
+
+		/**
+		 * Place element into ring buffer
+		 *
+		 * \return  false if the ring buffer is full
+		 */
+		bool add(ET const &e) { return add(&e, 1) == 1; }
+
+		/**
+		 * Take up to 'n' elements from the ring buffer
+		 *
+		 * \return  number of elements taken
+		 */
+		unsigned get(ET *dst, unsigned n)
+		{
+			using namespace Ring_buffer_atomic;
+
+			unsigned const tail = _tail.value;
+
+			unsigned i = 0;
+			for (; i < n; i++) {
+				Slot const &slot = _queue[(tail + i) & MASK];
+				if (load_acquire(&slot.seq) != tail + i + 1)
+					break;
+
+				dst[i] = slot.element;
+			}
+
+			store_release(&_tail.value, tail + i);
+			return i;
+		}
+
+		/**
+		 * Take element from ring buffer
+		 *
+		 * \return  false if the ring buffer is empty
+		 */
+		bool get(ET &e) { return get(&e, 1) == 1; }
+
+		bool empty() const
+		{
+			unsigned const tail = _tail.value;
+			return Ring_buffer_atomic::load_acquire(&_queue[tail & MASK].seq) != tail + 1;
+		}
+};
+
+
+/**
+ * Wrapper for lock-free ring buffers with a blocking consumer
+ *
+ * \param RING  'Spsc_ring_buffer' or 'Mpsc_ring_buffer' type
+ *
+ * A producer wakes up the consumer only if the consumer found the ring
+ * buffer empty and is about to block. As long as the consumer keeps up, no
+ * semaphore operations are performed.
+ */
+template <typename RING>
+class Blocking_ring_buffer
+{
+	private:
+
+		typedef typename RING::Element ET;
+
+		RING              _ring;
+		Genode::Semaphore _sem;
+		int volatile      _consumer_waiting;
+
+		void _wakeup()
+		{
+			Ring_buffer_atomic::full_barrier();
+			if (_consumer_waiting && Genode::cmpxchg(&_consumer_waiting, 1, 0))
+				_sem.up();
+		}
+
+		void _wait()
+		{
+			_consumer_waiting = 1;
+			Ring_buffer_atomic::full_barrier();
+
+			/*
+			 * If the ring buffer is still empty, a producer will see the
+			 * flag after adding an element. Otherwise, a producer may have
+			 * woken us up already, which results in a spurious wakeup later.
+			 */
+			if (_ring.empty())
+				_sem.down();
+
+			_consumer_waiting = 0;
+		}
+
+	public:
+
+		Blocking_ring_buffer() : _consumer_waiting(0) { }
+
+		/**
+		 * Place up to 'n' elements into the ring buffer
+		 *
+		 * \return  number of added elements
+		 */
+		unsigned add(ET const *src, unsigned n)
+		{
+			n = _ring.add(src, n);
+			if (n)
+				_wakeup();
+			return n;
+		}
+
+		/**
+		 * Place element into ring buffer
+		 *
+		 * \return  false if the ring buffer is full
+		 */
+		bool add(ET const &e) { return add(&e, 1) == 1; }
+
+		/**
+		 * Take up to 'n' elements, block until at least one is available
+		 *
+		 * \return  number of elements taken
+		 */
+		unsigned get(ET *dst, unsigned n)
+		{
+			unsigned num;
+			while (!(num = _ring.get(dst, n)))
+				_wait();
+			return num;
+		}
+
+		/**
+		 * Take element from ring buffer, block if the ring buffer is empty
+		 */
+		ET get()
+		{
+			ET e;
+			get(&e, 1);
+			return e;
+		}
+
+		bool empty() const { return _ring.empty(); }
+};
+
 #endif /* _INCLUDE__OS__RING_BUFFER_H_ */
@@ -0,0 +1,234 @@
+/*
+ * \brief  Ring buffer for bulk writes to a terminal session
+ * \author Norman Feske
+ * \date   2013-03-11
+ *
+ * The ring buffer is located in a dataspace shared between the client
+ * (producer) and the server (consumer). Each side wakes up the other one
+ * via a signal, but only if the other side announced that it waits. So
+ * signals are rare as long as both sides are busy.
+ *
+ * The producer and the consumer each must be a single thread.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _INCLUDE__TERMINAL_SESSION__BULK_BUFFER_H_
+#define _INCLUDE__TERMINAL_SESSION__BULK_BUFFER_H_
+
+#include <base/stdint.h>
+#include <util/misc_math.h>
+#include <util/string.h>
+
+namespace Terminal {
+
+	class Bulk_buffer
+	{
+		private:
+
+			/**
+			 * Shared state at the start of the dataspace
+			 *
+			 * The positions are counted in bytes since the creation of the
+			 * buffer. 'head' is written by the producer only, 'tail' is
+			 * written by the consumer only.
+			 */
+			struct Shared
+			{
+				unsigned long volatile head;
+				unsigned long volatile tail;
+				int           volatile consumer_idle;
+				int           volatile producer_blocked;
+			};
+
+			Shared         * const _shared;
+			char           * const _data;
+			Genode::size_t   const _size;
+
+			/**
+			 * Order the preceding memory accesses before the following ones
+			 *
+			 * A full barrier is needed because each side stores its flag
+			 * before loading the position written by the other side.
+			 */
+			static void _barrier() { __sync_synchronize(); }
+
+			/*
+			 * The shared positions cannot be trusted by the consumer.
+			 * Hence, the amount of available data is limited to the size
+			 * of the buffer.
+			 */
+			Genode::size_t _avail() const {
+				return Genode::min((Genode::size_t)(_shared->head - _shared->tail), _size); }
+
+			Genode::size_t _space() const { return _size - _avail(); }
+
+		public:
+
+			/**
+			 * Constructor
+			 *
+			 * \param base  local address of the shared dataspace
+			 * \param size  size of the shared dataspace
+			 */
+			Bulk_buffer(void *base, Genode::size_t size)
+			:
+				_shared((Shared *)base),
+				_data((char *)base + sizeof(Shared)),
+				_size(size - sizeof(Shared))
+			{ }
+
+			/**
+			 * Initialize shared state, called by the consumer
+			 */
+			void init()
+			{
+				_shared->head             = 0;
+				_shared->tail             = 0;
+				_shared->consumer_idle    = 1;
+				_shared->producer_blocked = 0;
+			}
+
+
+			/************************
+			 ** Producer interface **
+			 ************************/
+
+			/**
+			 * Append data to the buffer
+			 *
+			 * \return  number of bytes written, 0 if the buffer is full
+			 */
+			Genode::size_t write(void const *src, Genode::size_t len)
+			{
+				len = Genode::min(len, _space());
+
+				Genode::size_t const pos   = _shared->head % _size;
+				Genode::size_t const first = Genode::min(len, _size - pos);
+
+				Genode::memcpy(_data + pos, src, first);
+				Genode::memcpy(_data, (char const *)src + first, len - first);
+
+				/* make data visible before the new head */
+				_barrier();
+				_shared->head = _shared->head + len;
+				return len;
+			}
+
+			/**
+			 * Return true if the consumer must be woken up by a signal
+			 *
+			 * Called by the producer after writing data.
+			 */
+			bool consumer_idle()
+			{
+				_barrier();
+				if (!_shared->consumer_idle)
+					return false;
+
+				_shared->consumer_idle = 0;
+				return true;
+			}
+
+			/**
+			 * Return true if the consumer consumed all data
+			 */
+			bool drained() const
+			{
+				_barrier();
+				return _avail() == 0;
+			}
+
+			/**
+			 * Return number of bytes the buffer can hold
+			 */
+			Genode::size_t capacity() const { return _size; }
+
+			/**
+			 * Announce that the producer waits for free space
+			 *
+			 * \param min_space  number of free bytes the producer waits for
+			 *
+			 * \return  false if enough space became available in the
+			 *          meantime, true if the producer must wait for a
+			 *          signal
+			 */
+			bool block_producer(Genode::size_t min_space = 1)
+			{
+				_shared->producer_blocked = 1;
+				_barrier();
+				if (_space() < min_space)
+					return true;
+
+				_shared->producer_blocked = 0;
+				return false;
+			}
+
+
+			/************************
+			 ** Consumer interface **
+			 ************************/
+
+			/**
+			 * Return pointer to contiguous block of available data
+			 *
+			 * \param len  resulting size of the block, 0 if the buffer is
+			 *             empty
+			 */
+			char const *read(Genode::size_t &len) const
+			{
+				Genode::size_t const pos = _shared->tail % _size;
+				len = Genode::min(_avail(), _size - pos);
+				return _data + pos;
+			}
+
+			/**
+			 * Release data returned by 'read'
+			 */
+			void consume(Genode::size_t len)
+			{
+				/* finish reading the data before releasing the space */
+				_barrier();
+				_shared->tail = _shared->tail + len;
+			}
+
+			/**
+			 * Return true if the producer must be woken up by a signal
+			 *
+			 * Called by the consumer after consuming data.
+			 */
+			bool producer_blocked()
+			{
+				_barrier();
+				if (!_shared->producer_blocked)
+					return false;
+
+				_shared->producer_blocked = 0;
+				return true;
+			}
+
+			/**
+			 * Announce that the consumer waits for data
+			 *
+			 * \return  false if data became available in the meantime,
+			 *          true if the consumer must wait for a signal
+			 */
+			bool block_consumer()
+			{
+				_shared->consumer_idle = 1;
+				_barrier();
+				if (!_avail())
+					return true;
+
+				_shared->consumer_idle = 0;
+				return false;
+			}
+	};
+}
+
+#endif /* _INCLUDE__TERMINAL_SESSION__BULK_BUFFER_H_ */
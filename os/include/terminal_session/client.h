@@ -22,6 +22,7 @@
 #include <base/rpc_client.h>
 
 #include <terminal_session/terminal_session.h>
+#include <terminal_session/bulk_buffer.h>
 
 namespace Terminal {
 
@@ -55,14 +56,99 @@ namespace Terminal {
 
 			Io_buffer _io_buffer;
 
+			/**
+			 * Producer side of the bulk-write ring buffer
+			 */
+			struct Bulk_writer
+			{
+				char                       *base;
+				Bulk_buffer                 buffer;
+				Genode::Signal_transmitter  data_avail;
+				Genode::Signal_receiver     space_avail;
+				Genode::Signal_context      space_avail_ctx;
+
+				Bulk_writer(Genode::Dataspace_capability      ds_cap,
+				            Genode::Signal_context_capability data_avail_cap)
+				:
+					base(Genode::env()->rm_session()->attach(ds_cap)),
+					buffer(base, ds_cap.call<Genode::Dataspace::Rpc_size>()),
+					data_avail(data_avail_cap)
+				{ }
+
+				~Bulk_writer()
+				{
+					space_avail.dissolve(&space_avail_ctx);
+					Genode::env()->rm_session()->detach(base);
+				}
+
+				void write(char const *src, Genode::size_t num_bytes)
+				{
+					while (num_bytes) {
+
+						Genode::size_t const n = buffer.write(src, num_bytes);
+
+						src       += n;
+						num_bytes -= n;
+
+						if (n) {
+							if (buffer.consumer_idle())
+								data_avail.submit();
+							continue;
+						}
+
+						/* buffer is full, wait until the server consumed data */
+						if (buffer.block_producer())
+							space_avail.wait_for_signal();
+					}
+				}
+			};
+
+			/**
+			 * Bulk writer, or 0 if the server does not support the bulk mode
+			 */
+			Bulk_writer *_bulk_writer;
+
+			Bulk_writer *_init_bulk_writer()
+			{
+				using namespace Genode;
+
+				Dataspace_capability ds_cap = call<Rpc_bulk_dataspace>();
+				if (!ds_cap.valid())
+					return 0;
+
+				Bulk_writer *writer = new (env()->heap())
+					Bulk_writer(ds_cap, call<Rpc_bulk_data_avail_cap>());
+
+				call<Rpc_bulk_space_avail_sigh>(writer->space_avail.manage(&writer->space_avail_ctx));
+				return writer;
+			}
+
 		public:
 
 			Session_client(Genode::Capability<Session> cap)
 			:
 				Genode::Rpc_client<Session>(cap),
-				_io_buffer(call<Rpc_dataspace>())
+				_io_buffer(call<Rpc_dataspace>()),
+				_bulk_writer(_init_bulk_writer())
 			{ }
 
+			~Session_client()
+			{
+				if (!_bulk_writer)
+					return;
+
+				/*
+				 * Data that was not consumed yet would get lost with the
+				 * session. A write RPC makes the server consume the buffer.
+				 * In contrast to waiting for the space-available signal, the
+				 * RPC does not block forever if the server is gone.
+				 */
+				if (!_bulk_writer->buffer.drained())
+					try { call<Rpc_write>(0); } catch (...) { }
+
+				Genode::destroy(Genode::env()->heap(), _bulk_writer);
+			}
+
 			Size size() { return call<Rpc_size>(); }
 
 			bool avail() { return call<Rpc_avail>(); }
@@ -85,6 +171,11 @@ namespace Terminal {
 			{
 				Genode::Lock::Guard _guard(_io_buffer.lock);
 
+				if (_bulk_writer) {
+					_bulk_writer->write((char const *)buf, num_bytes);
+					return num_bytes;
+				}
+
 				Genode::size_t     written_bytes = 0;
 				char const * const src           = (char const *)buf;
 
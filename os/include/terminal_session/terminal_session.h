@@ -83,6 +83,41 @@ namespace Terminal {
 		virtual void read_avail_sigh(Genode::Signal_context_capability cap) = 0;
 
 
+		/*
+		 * Bulk mode
+		 *
+		 * Servers may provide a ring buffer for writing data without an RPC
+		 * per chunk (see 'terminal_session/bulk_buffer.h'). The client
+		 * signals the availability of new data to the context returned by
+		 * '_bulk_data_avail_cap'. The server signals the availability of
+		 * free space to the handler registered via 'bulk_space_avail_sigh'.
+		 *
+		 * The bulk mode is optional. The default implementations denote
+		 * that the server does not support it. In this case, the client
+		 * writes via the I/O buffer.
+		 */
+
+		/**
+		 * Return dataspace containing the bulk-write ring buffer
+		 *
+		 * \return  invalid capability if the bulk mode is not supported
+		 */
+		virtual Genode::Dataspace_capability _bulk_dataspace() {
+			return Genode::Dataspace_capability(); }
+
+		/**
+		 * Return signal context used to announce new data in the ring buffer
+		 */
+		virtual Genode::Signal_context_capability _bulk_data_avail_cap() {
+			return Genode::Signal_context_capability(); }
+
+		/**
+		 * Register signal handler to be informed about free space in the
+		 * ring buffer
+		 */
+		virtual void bulk_space_avail_sigh(Genode::Signal_context_capability) { }
+
+
 		/*******************
 		 ** RPC interface **
 		 *******************/
@@ -94,10 +129,14 @@ namespace Terminal {
 		GENODE_RPC(Rpc_connected_sigh, void, connected_sigh, Genode::Signal_context_capability);
 		GENODE_RPC(Rpc_read_avail_sigh, void, read_avail_sigh, Genode::Signal_context_capability);
 		GENODE_RPC(Rpc_dataspace, Genode::Dataspace_capability, _dataspace);
+		GENODE_RPC(Rpc_bulk_dataspace, Genode::Dataspace_capability, _bulk_dataspace);
+		GENODE_RPC(Rpc_bulk_data_avail_cap, Genode::Signal_context_capability, _bulk_data_avail_cap);
+		GENODE_RPC(Rpc_bulk_space_avail_sigh, void, bulk_space_avail_sigh, Genode::Signal_context_capability);
 
 		GENODE_RPC_INTERFACE(Rpc_size, Rpc_avail, Rpc_read, Rpc_write,
 		                     Rpc_connected_sigh, Rpc_read_avail_sigh,
-		                     Rpc_dataspace);
+		                     Rpc_dataspace, Rpc_bulk_dataspace,
+		                     Rpc_bulk_data_avail_cap, Rpc_bulk_space_avail_sigh);
 	};
 }
 
@@ -16,9 +16,147 @@
 
 #include <util/token.h>
 #include <base/exception.h>
+#include <base/allocator.h>
 
 namespace Genode {
 
+	class Xml_node;
+
+	/**
+	 * Index of the nodes of an XML buffer
+	 *
+	 * Without an index, 'Xml_node' tokenizes the XML data over and over,
+	 * e.g., for each access of a sub node, the following node, or an
+	 * attribute. The index is created by parsing the XML data once. It
+	 * records the positions of all nodes and attributes and the links
+	 * between the nodes. An 'Xml_node' created from an index uses the index
+	 * for traversing the XML structure, which makes each step independent
+	 * from the size of the XML data. The results are the same as for an
+	 * 'Xml_node' created from the plain XML data.
+	 *
+	 * The index does not copy the XML data. Hence, the XML data must stay
+	 * unmodified as long as the index exists. Nodes obtained via the index
+	 * must not be used after the destruction of the index.
+	 */
+	class Xml_index
+	{
+		public:
+
+			/**
+			 * Positions of a node, relative to the start of the XML data
+			 */
+			struct Node
+			{
+				size_t   start;          /* start tag                     */
+				size_t   name;           /* name within the start tag     */
+				size_t   name_len;
+				size_t   content;        /* token after the start tag     */
+				size_t   end;            /* end tag                       */
+				size_t   end_name;       /* name within the end tag       */
+				size_t   after;          /* token after the end tag       */
+				int      first_child;    /* index of first sub node or -1 */
+				int      next;           /* index of next node or -1      */
+				unsigned num_sub_nodes;
+				unsigned first_attr;     /* index of first attribute      */
+				unsigned num_attrs;
+				bool     empty;          /* empty-element tag             */
+			};
+
+			/**
+			 * Positions of an attribute, relative to the start of the XML data
+			 */
+			struct Attr
+			{
+				size_t name;
+				size_t name_len;
+				size_t value;
+			};
+
+		private:
+
+			enum { MAX_DEPTH = 64, INITIAL_CAPACITY = 32 };
+
+			Allocator  &_alloc;
+			char const *_addr;
+			size_t      _max_len;
+			Node       *_nodes;
+			unsigned    _num_nodes, _nodes_capacity;
+			Attr       *_attrs;
+			unsigned    _num_attrs, _attrs_capacity;
+			bool        _valid;
+
+			/**
+			 * Make room for one more element in 'array'
+			 *
+			 * \return  false if the allocation of a larger array failed
+			 */
+			template <typename T>
+			bool _grow(T *&array, unsigned num, unsigned &capacity)
+			{
+				if (num < capacity)
+					return true;
+
+				unsigned const new_capacity = capacity ? 2*capacity
+				                                       : (unsigned)INITIAL_CAPACITY;
+				T *new_array = 0;
+				if (!_alloc.alloc(new_capacity*sizeof(T), &new_array))
+					return false;
+
+				if (array) {
+					memcpy(new_array, array, capacity*sizeof(T));
+					_alloc.free(array, capacity*sizeof(T));
+				}
+				array    = new_array;
+				capacity = new_capacity;
+				return true;
+			}
+
+			/**
+			 * Parse XML data and populate the index
+			 *
+			 * \return  false if the XML data is not indexable
+			 */
+			bool _build();
+
+			size_t _offset(char const *at) const { return at - _addr; }
+
+		public:
+
+			/**
+			 * Constructor
+			 *
+			 * \param alloc    allocator used for the index data
+			 * \param addr     XML data
+			 * \param max_len  length of XML data in characters
+			 *
+			 * If the XML data cannot be indexed, e.g., because of a syntax
+			 * error or a nesting depth of more than 'MAX_DEPTH' levels, the
+			 * index is marked as invalid. An 'Xml_node' created from an
+			 * invalid index operates on the plain XML data.
+			 */
+			Xml_index(Allocator &alloc, char const *addr, size_t max_len = ~0UL)
+			:
+				_alloc(alloc), _addr(addr), _max_len(max_len),
+				_nodes(0), _num_nodes(0), _nodes_capacity(0),
+				_attrs(0), _num_attrs(0), _attrs_capacity(0),
+				_valid(_build())
+			{ }
+
+			~Xml_index()
+			{
+				if (_nodes) _alloc.free(_nodes, _nodes_capacity*sizeof(Node));
+				if (_attrs) _alloc.free(_attrs, _attrs_capacity*sizeof(Attr));
+			}
+
+			bool        valid()   const { return _valid; }
+			char const *addr()    const { return _addr; }
+			size_t      max_len() const { return _max_len; }
+
+			Node const &node(int idx)      const { return _nodes[idx]; }
+			Attr const &attr(unsigned idx) const { return _attrs[idx]; }
+	};
+
+
 	/**
 	 * Representation of an XML node
 	 */
@@ -42,6 +180,8 @@ namespace Genode {
 		 */
 		class Tag;
 
+		friend class Xml_index;
+
 		public:
 
 			/*********************
@@ -75,6 +215,7 @@ namespace Genode {
 					 * explicit friendship to 'Tag'.
 					 */
 					friend class Tag;
+					friend class Xml_index;
 
 					/**
 					 * Constructor
@@ -93,6 +234,11 @@ namespace Genode {
 							throw Invalid_syntax();
 					}
 
+					/**
+					 * Constructor used for attributes found via an index
+					 */
+					Attribute(Token name, Token value) : _name(name), _value(value) { }
+
 					/**
 					 * Return token following the attribute declaration
 					 */
@@ -251,6 +397,12 @@ namespace Genode {
 						_type  = supposed_type;
 					}
 
+					/**
+					 * Constructor used for tags found via an index
+					 */
+					Tag(Token token, Token name, Type type)
+					: _token(token), _name(name), _type(type) { }
+
 					/**
 					 * Default constructor produces invalid Tag
 					 */
@@ -365,6 +517,9 @@ namespace Genode {
 			Tag         _start_tag;
 			Tag         _end_tag;
 
+			Xml_index const *_index;      /* index or 0 if not indexed */
+			int              _index_node; /* node within '_index'      */
+
 			/**
 			 * Search for end tag of XML node and initialize '_num_sub_nodes'
 			 *
@@ -474,6 +629,87 @@ namespace Genode {
 				return Xml_node(at, _max_len - (at - addr()));
 			}
 
+			Xml_index::Node const &_node() const { return _index->node(_index_node); }
+
+			/**
+			 * Return tag located at the specified offsets of the indexed data
+			 */
+			static Tag _indexed_tag(Xml_index const &index, size_t at,
+			                        size_t name, Tag::Type type)
+			{
+				return Tag(Token(index.addr() + at,   index.max_len() - at),
+				           Token(index.addr() + name, index.max_len() - name),
+				           type);
+			}
+
+			/**
+			 * Constructor for a node found via an index
+			 *
+			 * \param addr  offset of the node's begin within the XML data,
+			 *              which may precede the start tag by whitespace
+			 *              and comments
+			 */
+			Xml_node(Xml_index const &index, int node, size_t addr)
+			:
+				_addr(index.addr() + addr),
+				_max_len(index.max_len() - addr),
+				_num_sub_nodes(index.node(node).num_sub_nodes),
+				_start_tag(_indexed_tag(index, index.node(node).start,
+				                        index.node(node).name,
+				                        index.node(node).empty ? Tag::EMPTY
+				                                               : Tag::START)),
+				_end_tag(index.node(node).empty
+				         ? _start_tag
+				         : _indexed_tag(index, index.node(node).end,
+				                        index.node(node).end_name, Tag::END)),
+				_index(&index), _index_node(node)
+			{ }
+
+			/**
+			 * Look up sub node via the index
+			 *
+			 * \param idx   number of matching sub nodes to skip
+			 * \param type  type of the sub node, or 0 for matching any type
+			 *
+			 * Like the traversal of the plain XML data, the lookup starts
+			 * at the content of the node. For an empty-element tag, this
+			 * is the token following the tag.
+			 */
+			Xml_node _indexed_sub_node(unsigned idx, char const *type) const
+			{
+				Xml_index::Node const &node = _node();
+
+				int    curr = node.empty ? node.next : node.first_child;
+				size_t addr = node.content;
+
+				while (curr >= 0) {
+
+					Xml_index::Node const &n = _index->node(curr);
+
+					bool const match = !type
+					                || (strlen(type) == n.name_len
+					                 && !strcmp(type, _index->addr() + n.name, n.name_len));
+
+					if (match && idx-- == 0)
+						return Xml_node(*_index, curr, addr);
+
+					curr = n.next;
+					if (curr >= 0)
+						addr = _index->node(curr).start;
+				}
+				throw Nonexistent_sub_node();
+			}
+
+			/**
+			 * Return attribute at the specified position of the index
+			 */
+			Attribute _indexed_attribute(unsigned idx) const
+			{
+				Xml_index::Attr const &a = _index->attr(idx);
+				return Attribute(Token(_index->addr() + a.name,  _index->max_len() - a.name),
+				                 Token(_index->addr() + a.value, _index->max_len() - a.value));
+			}
+
 		public:
 
 			/**
@@ -488,7 +724,8 @@ namespace Genode {
 				_max_len(max_len),
 				_num_sub_nodes(0),
 				_start_tag(eat_whitespaces_and_comments(Token(addr, max_len))),
-				_end_tag(_init_end_tag())
+				_end_tag(_init_end_tag()),
+				_index(0), _index_node(-1)
 			{
 				/* check validity of XML node */
 				if (_start_tag.type() == Tag::EMPTY) return;
@@ -497,6 +734,27 @@ namespace Genode {
 				throw Invalid_syntax();
 			}
 
+			/**
+			 * Constructor
+			 *
+			 * Create the top-level node of the XML data of 'index'. The
+			 * node and all nodes obtained from it use the index. If the
+			 * index is invalid, the node is created from the XML data.
+			 *
+			 * \throw Invalid_syntax
+			 */
+			Xml_node(Xml_index const &index) :
+				_addr(index.addr()),
+				_max_len(index.max_len()),
+				_num_sub_nodes(0),
+				_index(0), _index_node(-1)
+			{
+				if (index.valid())
+					*this = Xml_node(index, 0, 0);
+				else
+					*this = Xml_node(index.addr(), index.max_len());
+			}
+
 			/**
 			 * Request type name of XML node as null-terminated string
 			 */
@@ -537,7 +795,13 @@ namespace Genode {
 			/**
 			 * Return size of node including start and end tags
 			 */
-			size_t size() const { return _end_tag.next_token().start() - addr(); }
+			size_t size() const
+			{
+				if (_index)
+					return _index->addr() + _node().after - addr();
+
+				return _end_tag.next_token().start() - addr();
+			}
 
 			/**
 			 * Return begin of node content as an opaque string
@@ -546,7 +810,13 @@ namespace Genode {
 			 * points directly into a sub range of the unmodified Xml_node
 			 * address range.
 			 */
-			char *content_addr() const { return _start_tag.next_token().start(); }
+			char *content_addr() const
+			{
+				if (_index)
+					return (char *)_index->addr() + _node().content;
+
+				return _start_tag.next_token().start();
+			}
 
 			/**
 			 * Return size of node content
@@ -571,6 +841,14 @@ namespace Genode {
 			 */
 			Xml_node next() const
 			{
+				if (_index) {
+					int const next = _node().next;
+					if (next < 0)
+						throw Nonexistent_sub_node();
+
+					return Xml_node(*_index, next, _index->node(next).start);
+				}
+
 				Token after_node = _end_tag.next_token();
 				after_node = eat_whitespaces_and_comments(after_node);
 				try { return _sub_node(after_node.start()); }
@@ -608,6 +886,9 @@ namespace Genode {
 			 */
 			Xml_node sub_node(unsigned idx = 0U) const
 			{
+				if (_index)
+					return _indexed_sub_node(idx, 0);
+
 				/* look up node at specified index */
 				try {
 					Xml_node curr_node = _sub_node(content_addr());
@@ -626,6 +907,9 @@ namespace Genode {
 			 */
 			Xml_node sub_node(const char *type) const
 			{
+				if (_index)
+					return _indexed_sub_node(0, type);
+
 				/* search for sub node of specified type */
 				try {
 					Xml_node curr_node = _sub_node(content_addr());
@@ -647,6 +931,13 @@ namespace Genode {
 			 */
 			Attribute attribute(unsigned idx) const
 			{
+				if (_index) {
+					if (idx >= _node().num_attrs)
+						throw Nonexistent_attribute();
+
+					return _indexed_attribute(_node().first_attr + idx);
+				}
+
 				/* get first attribute of the node */
 				Attribute a = _start_tag.attribute();
 
@@ -666,12 +957,161 @@ namespace Genode {
 			 */
 			Attribute attribute(const char *type) const
 			{
+				if (_index) {
+					size_t const len = strlen(type);
+					Xml_index::Node const &node = _node();
+
+					for (unsigned i = 0; i < node.num_attrs; i++) {
+						Xml_index::Attr const &a = _index->attr(node.first_attr + i);
+						if (a.name_len == len && !strcmp(type, _index->addr() + a.name, len))
+							return _indexed_attribute(node.first_attr + i);
+					}
+					throw Nonexistent_attribute();
+				}
+
 				/* iterate, beginning with the first attribute of the node */
 				for (Attribute a = _start_tag.attribute(); ; a = a.next())
 					if (a.has_type(type))
 						return a;
 			}
 	};
+
+
+	inline bool Xml_index::_build()
+	{
+		typedef Xml_node::Token   Token;
+		typedef Xml_node::Tag     Tag;
+		typedef Xml_node::Comment Comment;
+
+		/*
+		 * For each depth level of the current path, we keep track of the
+		 * last node and of the position where a following node must start.
+		 * As for the traversal of the plain XML data, nodes are linked only
+		 * if they are separated by nothing but whitespace and comments.
+		 */
+		int    open[MAX_DEPTH];
+		int    last[MAX_DEPTH + 1];
+		size_t link_from[MAX_DEPTH + 1];
+
+		unsigned depth = 0;
+		last[0] = -1;
+		link_from[0] = 0;
+
+		try {
+			Token t(_addr, _max_len);
+
+			while (t.type() != Token::END) {
+
+				/* eat XML comment */
+				Comment comment(t);
+				if (comment.valid()) {
+					t = comment.next_token();
+					continue;
+				}
+
+				/* skip all tokens that are no tags */
+				Tag tag(t);
+				if (tag.type() == Tag::INVALID) {
+					t = t.next();
+					continue;
+				}
+
+				/* continue with the token after the current tag */
+				t = tag.next_token();
+
+				if (tag.type() == Tag::END) {
+
+					/* ignore end tags following the top-level nodes */
+					if (depth == 0)
+						continue;
+
+					Node &node = _nodes[open[--depth]];
+
+					/* on mismatch of start tag and end tag, give up */
+					if (node.name_len != tag.name().len()
+					 || strcmp(_addr + node.name, tag.name().start(), node.name_len))
+						return false;
+
+					node.end      = _offset(tag.token().start());
+					node.end_name = _offset(tag.name().start());
+					node.after    = _offset(t.start());
+
+					last[depth]      = open[depth];
+					link_from[depth] = node.after;
+					continue;
+				}
+
+				if (depth == MAX_DEPTH
+				 || !_grow(_nodes, _num_nodes, _nodes_capacity))
+					return false;
+
+				int const idx = _num_nodes++;
+				Node &node = _nodes[idx];
+
+				node.start         = _offset(tag.token().start());
+				node.name          = _offset(tag.name().start());
+				node.name_len      = tag.name().len();
+				node.content       = _offset(t.start());
+				node.first_child   = -1;
+				node.next          = -1;
+				node.num_sub_nodes = 0;
+				node.first_attr    = _num_attrs;
+				node.num_attrs     = 0;
+				node.empty         = (tag.type() == Tag::EMPTY);
+
+				/* record attributes */
+				try {
+					for (Xml_node::Attribute a = tag.attribute(); ; a = a._next()) {
+
+						if (!_grow(_attrs, _num_attrs, _attrs_capacity))
+							return false;
+
+						Attr &attr = _attrs[_num_attrs++];
+						attr.name     = _offset(a._name.start());
+						attr.name_len = a._name.len();
+						attr.value    = _offset(a._value.start());
+						node.num_attrs++;
+					}
+				} catch (Xml_node::Nonexistent_attribute) { }
+
+				/* link node with its predecessor or its parent */
+				bool const adjacent =
+					Xml_node::eat_whitespaces_and_comments(
+						Token(_addr + link_from[depth], _max_len - link_from[depth])).start()
+					== tag.token().start();
+
+				if (adjacent && last[depth] >= 0)
+					_nodes[last[depth]].next = idx;
+
+				if (adjacent && last[depth] < 0 && depth > 0)
+					_nodes[open[depth - 1]].first_child = idx;
+
+				if (depth > 0)
+					_nodes[open[depth - 1]].num_sub_nodes++;
+
+				if (node.empty) {
+					node.end      = node.start;
+					node.end_name = node.name;
+					node.after    = node.content;
+
+					last[depth]      = idx;
+					link_from[depth] = node.after;
+				} else {
+					open[depth++]    = idx;
+					last[depth]      = -1;
+					link_from[depth] = node.content;
+				}
+			}
+
+			/* the top-level node must be the first token of the XML data */
+			return depth == 0 && _num_nodes > 0
+			    && _nodes[0].start == _offset(Xml_node::eat_whitespaces_and_comments(
+			                                  Token(_addr, _max_len)).start());
+
+		} catch (Xml_node::Invalid_syntax) { }
+
+		return false;
+	}
 }
 
 #endif /* _INCLUDE__UTIL__XML_NODE_H_ */
@@ -18,48 +18,59 @@
 
 static snd_pcm_t *playback_handle;
 
-int audio_drv_init(void)
+int audio_drv_init(unsigned period)
 {
 	unsigned int rate = 44100;
-	int err;
+	int ret = 0;
 	snd_pcm_hw_params_t *hw_params;
 
-	if ((err = snd_pcm_open(&playback_handle, "hw", SND_PCM_STREAM_PLAYBACK, 0)) < 0)
+	if (snd_pcm_open(&playback_handle, "hw", SND_PCM_STREAM_PLAYBACK, 0) < 0) {
+		playback_handle = 0;
 		return -1;
+	}
 
-	if ((err = snd_pcm_hw_params_malloc(&hw_params)) < 0)
+	if (snd_pcm_hw_params_malloc(&hw_params) < 0) {
+		audio_drv_exit();
 		return -2;
+	}
+
+	if (snd_pcm_hw_params_any(playback_handle, hw_params) < 0)
+		ret = -3;
+	else if (snd_pcm_hw_params_set_access(playback_handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED) < 0)
+		ret = -4;
+	else if (snd_pcm_hw_params_set_format(playback_handle, hw_params, SND_PCM_FORMAT_S16_LE) < 0)
+		ret = -5;
+	else if (snd_pcm_hw_params_set_rate(playback_handle, hw_params, rate, 0) < 0)
+		ret = -6;
+	else if (snd_pcm_hw_params_set_channels(playback_handle, hw_params, 2) < 0)
+		ret = -7;
+	else if (snd_pcm_hw_params_set_period_size(playback_handle, hw_params, period, 0) < 0)
+		ret = -8;
+	else if (snd_pcm_hw_params_set_periods(playback_handle, hw_params, 4, 0) < 0)
+		ret = -9;
+	else if (snd_pcm_hw_params(playback_handle, hw_params) < 0)
+		ret = -10;
 
-	if ((err = snd_pcm_hw_params_any(playback_handle, hw_params)) < 0)
-		return -3;
-
-	if ((err = snd_pcm_hw_params_set_access(playback_handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0)
-		return -4;
-
-	if ((err = snd_pcm_hw_params_set_format(playback_handle, hw_params, SND_PCM_FORMAT_S16_LE)) < 0)
-		return -5;
-
-	if ((err = snd_pcm_hw_params_set_rate(playback_handle, hw_params, rate, 0)) < 0)
-		return -6;
-
-	if ((err = snd_pcm_hw_params_set_channels(playback_handle, hw_params, 2)) < 0)
-		return -7;
+	snd_pcm_hw_params_free(hw_params);
 
-	if ((err = snd_pcm_hw_params_set_period_size(playback_handle, hw_params, 2048, 0)) < 0)
-		return -8;
+	if (!ret && snd_pcm_prepare(playback_handle) < 0)
+		ret = -11;
 
-	if ((err = snd_pcm_hw_params_set_periods(playback_handle, hw_params, 4, 0)) < 0)
-		return -9;
+	/* do not keep a half-configured device open */
+	if (ret)
+		audio_drv_exit();
 
-	if ((err = snd_pcm_hw_params(playback_handle, hw_params)) < 0)
-		return -10;
+	return ret;
+}
 
-	snd_pcm_hw_params_free(hw_params);
 
-	if ((err = snd_pcm_prepare(playback_handle)) < 0)
-		return -11;
+void audio_drv_exit(void)
+{
+	if (!playback_handle)
+		return;
 
-	return 0;
+	snd_pcm_close(playback_handle);
+	playback_handle = 0;
 }
 
 
@@ -69,6 +80,9 @@ void audio_drv_adopt_myself() { }
 int audio_drv_play(void *data, int frame_cnt)
 {
 	int err;
+	if (!playback_handle)
+		return -1;
+
 	if ((err = snd_pcm_writei(playback_handle, data, frame_cnt)) != frame_cnt)
 		return err;
 
@@ -78,11 +92,13 @@ int audio_drv_play(void *data, int frame_cnt)
 
 void audio_drv_stop(void)
 {
-	snd_pcm_drop(playback_handle);
+	if (playback_handle)
+		snd_pcm_drop(playback_handle);
 }
 
 
 void audio_drv_start(void)
 {
-	snd_pcm_prepare(playback_handle);
+	if (playback_handle)
+		snd_pcm_prepare(playback_handle);
 }
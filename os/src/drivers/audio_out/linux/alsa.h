@@ -19,7 +19,8 @@
 extern "C" {
 #endif
 
-int audio_drv_init(void);
+int audio_drv_init(unsigned period);
+void audio_drv_exit(void);
 void audio_drv_adopt_myself();
 int audio_drv_play(void *data, int frame_cnt);
 void audio_drv_stop(void);
@@ -39,6 +39,9 @@ namespace Audio_out
 	class  Root;
 	struct Root_policy;
 	static Session_component *channel_acquired[MAX_CHANNELS];
+
+	/* number of frames per ALSA period */
+	static unsigned period = PERIOD;
 };
 
 
@@ -56,6 +59,7 @@ class Audio_out::Session_component : public Audio_out::Session_rpc_object
 			_channel(channel)
 		{
 			Audio_out::channel_acquired[_channel] = this;
+			stream()->period(Audio_out::period);
 		}
 
 		~Session_component()
@@ -151,7 +155,7 @@ class Audio_out::Out : public Thread<1024 * sizeof(addr_t)>
 			/* convert float to S16LE */
 			static short data[2 * PERIOD];
 
-			for (int i = 0; i < 2 * PERIOD; i += 2) {
+			for (unsigned i = 0; i < 2 * period; i += 2) {
 				data[i] = p_left->content()[i / 2] * 32767;
 				data[i + 1] = p_right->content()[i / 2] * 32767;
 			}
@@ -163,7 +167,7 @@ class Audio_out::Out : public Thread<1024 * sizeof(addr_t)>
 				PDBG("play packet");
 
 			/* blocking-write packet to ALSA */
-			while (int err = audio_drv_play(data, PERIOD)) {
+			while (int err = audio_drv_play(data, period)) {
 				if (verbose) PERR("Error %d during playback", err);
 					audio_drv_stop();
 					audio_drv_start();
@@ -239,6 +243,9 @@ class Audio_out::Root : public Audio_out::Root_component
 
 		Signal_context_capability _data_cap;
 
+		/* false if the driver could not be reinitialized for a session */
+		bool _drv_ready;
+
 	protected:
 
 		Session_component *_create_session(const char *args)
@@ -250,6 +257,36 @@ class Audio_out::Root : public Audio_out::Root_component
 			                                             "left");
 			channel_number_from_string(channel_name, &channel_number);
 
+			/*
+			 * The first session determines the period, the session of the
+			 * other channel gets the same period.
+			 */
+			unsigned long requested =
+				Arg_string::find_arg(args, "period").ulong_value(PERIOD);
+			requested = max(min(requested, (unsigned long)PERIOD),
+			                (unsigned long)MIN_PERIOD);
+
+			if (!channel_acquired[LEFT] && !channel_acquired[RIGHT]
+			 && (requested != period || !_drv_ready)) {
+
+				audio_drv_exit();
+				_drv_ready = false;
+
+				if (int err = audio_drv_init(requested)) {
+					PERR("could not set period to %lu frames (%d), keep %u",
+					     requested, err, period);
+
+					if ((err = audio_drv_init(period))) {
+						PERR("could not reinitialize audio driver (%d)", err);
+						throw ::Root::Unavailable();
+					}
+				} else
+					period = requested;
+
+				_drv_ready = true;
+				audio_drv_start();
+			}
+
 			return new (md_alloc())
 				Session_component(channel_number, _data_cap);
 		}
@@ -257,7 +294,8 @@ class Audio_out::Root : public Audio_out::Root_component
 	public:
 
 		Root(Rpc_entrypoint *session_ep, Allocator *md_alloc, Signal_context_capability data_cap)
-		: Root_component(session_ep, md_alloc), _data_cap(data_cap)
+		: Root_component(session_ep, md_alloc), _data_cap(data_cap),
+		  _drv_ready(true)
 		{ }
 };
 
@@ -278,7 +316,7 @@ int main(int argc, char **argv)
 	static Signal_context_capability data_cap(data_recv.manage(&data_context));
 
 	/* init ALSA */
-	int err = audio_drv_init();
+	int err = audio_drv_init(Audio_out::period);
 	if (err) {
 		PERR("audio driver init returned %d", err);
 		return 0;
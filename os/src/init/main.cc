@@ -79,6 +79,24 @@ namespace Init {
 
 	class Child_registry : public Name_registry, Child_list
 	{
+		private:
+
+			/*
+			 * Each session request routed to a child looks up the child by
+			 * its name. With hundreds of children, searching the list
+			 * would take too long.
+			 */
+			Genode::Avl_tree<Genode::Avl_string_base> _names;
+
+			Child *_lookup(const char *name) const
+			{
+				Genode::Avl_string_base *node = _names.first();
+				if (node)
+					node = node->find_by_name(name);
+
+				return node ? &static_cast<Child::Name_node *>(node)->child : 0;
+			}
+
 		public:
 
 			/**
@@ -87,6 +105,7 @@ namespace Init {
 			void insert(Child *child)
 			{
 				Child_list::insert(&child->_list_element);
+				_names.insert(&child->_name_node);
 			}
 
 			/**
@@ -94,6 +113,7 @@ namespace Init {
 			 */
 			void remove(Child *child)
 			{
+				_names.remove(&child->_name_node);
 				Child_list::remove(&child->_list_element);
 			}
 
@@ -120,24 +140,12 @@ namespace Init {
 			 ** Name-registry interface **
 			 *****************************/
 
-			bool is_unique(const char *name) const
-			{
-				Genode::List_element<Child> *curr = first();
-				for (; curr; curr = curr->next())
-					if (curr->object()->has_name(name))
-						return false;
-
-				return true;
-			}
+			bool is_unique(const char *name) const { return !_lookup(name); }
 
 			Genode::Server *lookup_server(const char *name) const
 			{
-				Genode::List_element<Child> *curr = first();
-				for (; curr; curr = curr->next())
-					if (curr->object()->has_name(name))
-						return curr->object()->server();
-
-				return 0;
+				Child *child = _lookup(name);
+				return child ? child->server() : 0;
 			}
 	};
 }
@@ -14,7 +14,15 @@
 #ifndef _LIB__BLIT__BLIT_HELPER_H_
 #define _LIB__BLIT__BLIT_HELPER_H_
 
+/*
+ * On x86_64, SSE2 is always available. On x86_32, we cannot rely on it
+ * and stick to MMX.
+ */
+#ifdef __x86_64__
+#include <sse2.h>
+#else
 #include <mmx.h>
+#endif
 
 
 /**
@@ -62,9 +70,26 @@ static inline void copy_block_32byte(char *src, int src_w,
                                      char *dst, int dst_w,
                                      int w, int h)
 {
-	if (w)
+	if (!w)
+		return;
+
+#ifdef __x86_64__
+	/*
+	 * Bypass the cache for blocks larger than the L2 cache of common
+	 * CPUs if all destination lines are 16-byte aligned, as required by
+	 * 'movntdq'. The MMX variant always uses non-temporal stores.
+	 */
+	enum { STREAM_MIN_BYTES = 256*1024 };
+	if ((long)w*h*32 >= STREAM_MIN_BYTES && !(((long)dst | dst_w) & 15)) {
 		for (int i = h; i--; src += src_w, dst += dst_w)
-			copy_32byte_chunks(src, dst, w);
+			stream_32byte_chunks(src, dst, w);
+		asm volatile ("sfence" : : : "memory");
+		return;
+	}
+#endif
+
+	for (int i = h; i--; src += src_w, dst += dst_w)
+		copy_32byte_chunks(src, dst, w);
 }
 
 #endif /* _LIB__BLIT__BLIT_HELPER_H_ */
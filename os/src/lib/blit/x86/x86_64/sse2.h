@@ -0,0 +1,72 @@
+/*
+ * \brief  SSE2-based blitting support for x86_64
+ * \author Sebastian Sumpf
+ * \date   2013-03-06
+ *
+ * SSE2 is always present on x86_64. In contrast to MMX, the use of the
+ * XMM registers does not require switching the FPU mode via 'emms'.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _SSE2_H_
+#define _SSE2_H_
+
+/**
+ * Copy 32byte chunks via SSE2
+ *
+ * Source and destination do not need to be 16-byte aligned.
+ */
+static inline void copy_32byte_chunks(void *src, void *dst, int size)
+{
+	asm volatile (
+		".align 16                        \n\t"
+		"0:                               \n\t"
+		"movdqu (%0),%%xmm0               \n\t"
+		"movdqu 16(%0),%%xmm1             \n\t"
+		"movdqu %%xmm0,(%1)               \n\t"
+		"movdqu %%xmm1,16(%1)             \n\t"
+		"add    $32, %0                   \n\t"
+		"add    $32, %1                   \n\t"
+		"dec    %2                        \n\t"
+		"jnz    0b                        \n\t"
+		: "+r" (src), "+r" (dst), "+r" (size)
+		:
+		: "xmm0", "xmm1", "memory"
+	);
+}
+
+
+/**
+ * Copy 32byte chunks via SSE2 using non-temporal stores
+ *
+ * The destination must be 16-byte aligned. The stores bypass the cache,
+ * which pays off for large copies, e.g., to the frame buffer, that would
+ * otherwise evict the working set. The caller has to issue an 'sfence'
+ * before the copied data is used.
+ */
+static inline void stream_32byte_chunks(void *src, void *dst, int size)
+{
+	asm volatile (
+		".align 16                        \n\t"
+		"0:                               \n\t"
+		"movdqu (%0),%%xmm0               \n\t"
+		"movdqu 16(%0),%%xmm1             \n\t"
+		"movntdq %%xmm0,(%1)              \n\t"
+		"movntdq %%xmm1,16(%1)            \n\t"
+		"add    $32, %0                   \n\t"
+		"add    $32, %1                   \n\t"
+		"dec    %2                        \n\t"
+		"jnz    0b                        \n\t"
+		: "+r" (src), "+r" (dst), "+r" (size)
+		:
+		: "xmm0", "xmm1", "memory"
+	);
+}
+
+#endif /* _SSE2_H_ */
@@ -0,0 +1,171 @@
+/*
+ * \brief  Latency measurement of block requests
+ * \author Norman Feske
+ * \date   2013-03-22
+ *
+ * Latencies are measured with the time-stamp counter of the CPU, which is
+ * calibrated against the timer once at startup. They are accounted in
+ * histograms with buckets of power-of-two microseconds.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+/* Genode includes */
+#include <base/printf.h>
+#include <timer_session/timer_session.h>
+#include <trace/timestamp.h>
+#include <util/misc_math.h>
+
+namespace Block {
+
+	using Genode::Trace::Timestamp;
+	using Genode::Trace::timestamp;
+
+	class Cycle_clock;
+	class Latency_histogram;
+}
+
+
+/**
+ * Conversion of timestamps to microseconds
+ */
+class Block::Cycle_clock
+{
+	private:
+
+		enum { CALIBRATION_MS = 100 };
+
+		unsigned long _cycles_per_us;
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * Measures the frequency of the time-stamp counter, which takes
+		 * about 'CALIBRATION_MS' milliseconds.
+		 */
+		Cycle_clock(Timer::Session &timer)
+		{
+			/* start at a millisecond boundary */
+			unsigned long const ms = timer.elapsed_ms();
+			while (timer.elapsed_ms() == ms);
+
+			Timestamp     const start    = timestamp();
+			unsigned long const start_ms = timer.elapsed_ms();
+
+			timer.msleep(CALIBRATION_MS);
+
+			unsigned long const elapsed_ms = timer.elapsed_ms() - start_ms;
+			Timestamp     const cycles     = timestamp() - start;
+
+			_cycles_per_us = Genode::max(1UL,
+				(unsigned long)(cycles / (Genode::max(elapsed_ms, 1UL)*1000)));
+		}
+
+		unsigned long cycles_per_us() const { return _cycles_per_us; }
+
+		/**
+		 * Return microseconds between two timestamps
+		 */
+		unsigned long us(Timestamp from, Timestamp to) const {
+			return (unsigned long)((to - from) / _cycles_per_us); }
+};
+
+
+/**
+ * Distribution of latencies
+ *
+ * Bucket 0 counts latencies below one microsecond, bucket 'i' counts
+ * latencies of at least '2^(i-1)' and below '2^i' microseconds.
+ */
+class Block::Latency_histogram
+{
+	private:
+
+		enum { BUCKETS = 28 };
+
+		unsigned long _buckets[BUCKETS];
+		unsigned long _count;
+		unsigned long _sum_us;
+		unsigned long _max_us;
+
+		static unsigned _bucket(unsigned long us)
+		{
+			unsigned i = 0;
+			for (; us && i < BUCKETS - 1; us >>= 1)
+				i++;
+			return i;
+		}
+
+		/**
+		 * Return upper bound of the latencies of the 'percent' fastest
+		 * requests
+		 */
+		unsigned long _percentile(unsigned percent) const
+		{
+			unsigned long const rank = (_count*percent + 99)/100;
+
+			unsigned long n = 0;
+			for (unsigned i = 0; i < BUCKETS; i++) {
+				n += _buckets[i];
+				if (n >= rank)
+					return 1UL << i;
+			}
+			return 1UL << (BUCKETS - 1);
+		}
+
+	public:
+
+		Latency_histogram() { reset(); }
+
+		void reset()
+		{
+			for (unsigned i = 0; i < BUCKETS; i++)
+				_buckets[i] = 0;
+
+			_count = _sum_us = _max_us = 0;
+		}
+
+		void add(unsigned long us)
+		{
+			_buckets[_bucket(us)]++;
+			_count++;
+			_sum_us += us;
+			_max_us  = Genode::max(_max_us, us);
+		}
+
+		unsigned long count()  const { return _count; }
+		unsigned long avg_us() const { return _count ? _sum_us/_count : 0; }
+		unsigned long max_us() const { return _max_us; }
+
+		/**
+		 * Print summary and, if 'buckets' is true, all non-empty buckets
+		 */
+		void print(char const *name, bool buckets = true) const
+		{
+			if (!_count)
+				return;
+
+			Genode::printf("  %s latency: avg %lu us, max %lu us, "
+			               "p50 <%lu us, p99 <%lu us\n", name, avg_us(),
+			               _max_us, _percentile(50), _percentile(99));
+
+			if (!buckets)
+				return;
+
+			for (unsigned i = 0; i < BUCKETS; i++)
+				if (_buckets[i])
+					Genode::printf("    <%lu us: %lu\n", 1UL << i, _buckets[i]);
+		}
+};
+
+#endif /* _LATENCY_H_ */
@@ -0,0 +1,457 @@
+/*
+ * \brief  Pass-through block server that traces the latency of requests
+ * \author Norman Feske
+ * \date   2013-03-22
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/allocator_avl.h>
+#include <base/printf.h>
+#include <base/semaphore.h>
+#include <base/sleep.h>
+#include <block_session/connection.h>
+#include <block_session/rpc_object.h>
+#include <cap_session/connection.h>
+#include <os/config.h>
+#include <root/component.h>
+#include <timer_session/connection.h>
+
+/* local includes */
+#include "latency.h"
+
+using namespace Genode;
+
+
+namespace Block {
+
+	/**
+	 * Configuration
+	 */
+	struct Trace_config
+	{
+		bool          verbose; /* print each request */
+		unsigned long report;  /* print statistics every 'report' requests */
+
+		Trace_config() : verbose(false), report(1000)
+		{
+			try {
+				verbose = config()->xml_node().attribute("verbose").has_value("yes"); }
+			catch (...) { }
+
+			try {
+				config()->xml_node().attribute("report").value(&report); }
+			catch (...) { }
+		}
+	};
+
+
+	static Trace_config const &trace_config()
+	{
+		static Trace_config inst;
+		return inst;
+	}
+
+
+	static Cycle_clock const &cycle_clock()
+	{
+		static Timer::Connection timer;
+		static Cycle_clock       inst(timer);
+		return inst;
+	}
+
+
+	/**
+	 * Statistics of one operation
+	 */
+	struct Op_statistics
+	{
+		unsigned long     requests;
+		unsigned long     blocks;
+		unsigned long     errors;
+		Latency_histogram total;    /* from reception to acknowledgement */
+		Latency_histogram back_end; /* spent in the back end */
+
+		Op_statistics() { reset(); }
+
+		void reset()
+		{
+			requests = blocks = errors = 0;
+			total.reset();
+			back_end.reset();
+		}
+
+		void print(char const *label, char const *op, size_t blk_size) const
+		{
+			if (!requests)
+				return;
+
+			printf("%s: %lu %s requests, %lu KiB, %lu failed\n", label,
+			       requests, op, (blocks*blk_size)/1024, errors);
+			total.print("total");
+			back_end.print("back-end", false);
+		}
+	};
+
+
+	class Session_component : public Session_rpc_object
+	{
+		private:
+
+			enum { MAX_REQUESTS = 64 /* back-end packets in flight */ };
+
+			/**
+			 * Request in flight
+			 */
+			struct Request
+			{
+				bool              used;
+				Packet_descriptor client;   /* client packet */
+				Packet_descriptor back_end; /* back-end packet */
+				Timestamp         received;
+				Timestamp         submitted;
+
+				Request() : used(false) { }
+			};
+
+			/**
+			 * Thread that forwards the client packets to the back end
+			 */
+			class Tx_thread : public Thread<8192>
+			{
+				private:
+
+					Session_component &_session;
+
+				public:
+
+					Tx_thread(Session_component &session)
+					: Thread<8192>("tx"), _session(session) { }
+
+					void entry()
+					{
+						for (;;)
+							_session._forward(_session.tx_sink()->get_packet());
+					}
+			};
+
+			/**
+			 * Thread that processes the acknowledgements of the back end
+			 */
+			class Ack_thread : public Thread<8192>
+			{
+				private:
+
+					Session_component &_session;
+
+				public:
+
+					Ack_thread(Session_component &session)
+					: Thread<8192>("ack"), _session(session) { }
+
+					void entry()
+					{
+						for (;;)
+							_session._complete(_session._blk.tx()->get_acked_packet());
+					}
+			};
+
+			char              _label[64];
+			Allocator_avl     _block_alloc;
+			Connection        _blk;
+			size_t            _blk_count;
+			size_t            _blk_size;
+			Session::Operations _ops;
+
+			/*
+			 * The lock protects the request slots as well as the packet
+			 * allocator and the submit queue of the back-end connection.
+			 * The acknowledgement queue of the back end is accessed by the
+			 * ack thread only.
+			 */
+			Lock              _lock;
+			Request           _requests[MAX_REQUESTS];
+			Semaphore         _request_sem;
+			Semaphore         _alloc_sem;   /* wakes up blocked packet allocations */
+			unsigned          _alloc_waiters;
+
+			Lock              _ack_lock;    /* serializes acks to the client */
+
+			/* statistics, accessed by the ack thread only */
+			Op_statistics     _stats[2];
+			unsigned long     _completed;
+
+			Tx_thread         _tx_thread;
+			Ack_thread        _ack_thread;
+
+			static char const *_op_name(Packet_descriptor::Opcode op) {
+				return op == Packet_descriptor::READ ? "read" : "write"; }
+
+			void _ack(Packet_descriptor packet)
+			{
+				Lock::Guard guard(_ack_lock);
+
+				if (!tx_sink()->ready_to_ack())
+					PDBG("need to wait until ready-for-ack");
+				tx_sink()->acknowledge_packet(packet);
+			}
+
+			void _forward(Packet_descriptor packet)
+			{
+				Timestamp const received = timestamp();
+
+				Packet_descriptor::Opcode const op = packet.operation();
+
+				if (!packet.valid() || (op != Packet_descriptor::READ
+				                     && op != Packet_descriptor::WRITE)) {
+					PWRN("received invalid packet");
+					packet.succeeded(false);
+					_ack(packet);
+					return;
+				}
+
+				size_t const bytes = packet.block_count()*_blk_size;
+
+				/* wait for free request slot */
+				_request_sem.down();
+
+				Packet_descriptor p;
+				for (;;) {
+					{
+						Lock::Guard guard(_lock);
+						try {
+							p = Packet_descriptor(_blk.dma_alloc_packet(bytes), op,
+							                      packet.block_number(),
+							                      packet.block_count());
+							break;
+						} catch (Session::Tx::Source::Packet_alloc_failed) {
+							_alloc_waiters++;
+						}
+					}
+
+					/* block until the ack thread released a packet */
+					_alloc_sem.down();
+				}
+
+				if (op == Packet_descriptor::WRITE)
+					memcpy(_blk.tx()->packet_content(p),
+					       tx_sink()->packet_content(packet), bytes);
+
+				Lock::Guard guard(_lock);
+
+				Request *r = 0;
+				for (unsigned i = 0; !r && i < MAX_REQUESTS; i++)
+					if (!_requests[i].used)
+						r = &_requests[i];
+
+				r->used      = true;
+				r->client    = packet;
+				r->back_end  = p;
+				r->received  = received;
+				r->submitted = timestamp();
+
+				_blk.tx()->submit_packet(p);
+			}
+
+			void _complete(Packet_descriptor p)
+			{
+				Timestamp const acked = timestamp();
+
+				Request *r = 0;
+				{
+					Lock::Guard guard(_lock);
+					for (unsigned i = 0; !r && i < MAX_REQUESTS; i++)
+						if (_requests[i].used
+						 && _requests[i].back_end.offset() == p.offset())
+							r = &_requests[i];
+				}
+
+				if (!r) {
+					PWRN("received acknowledgement of unknown packet");
+					return;
+				}
+
+				Packet_descriptor client = r->client;
+				client.succeeded(p.succeeded());
+
+				if (p.succeeded() && p.operation() == Packet_descriptor::READ)
+					memcpy(tx_sink()->packet_content(client),
+					       _blk.tx()->packet_content(p),
+					       p.block_count()*_blk_size);
+
+				Timestamp const received  = r->received;
+				Timestamp const submitted = r->submitted;
+
+				{
+					Lock::Guard guard(_lock);
+
+					_blk.tx()->release_packet(p);
+					r->used = false;
+
+					/* unblock the tx thread waiting for a packet allocation */
+					if (_alloc_waiters) {
+						_alloc_waiters--;
+						_alloc_sem.up();
+					}
+				}
+				_request_sem.up();
+
+				_ack(client);
+
+				Timestamp const done = timestamp();
+
+				/* account request */
+				Cycle_clock const &clock = cycle_clock();
+				unsigned long const total_us    = clock.us(received, done);
+				unsigned long const back_end_us = clock.us(submitted, acked);
+
+				Op_statistics &stats = _stats[client.operation()];
+				stats.requests++;
+				stats.blocks += client.block_count();
+				if (!client.succeeded())
+					stats.errors++;
+				stats.total.add(total_us);
+				stats.back_end.add(back_end_us);
+
+				if (trace_config().verbose)
+					printf("%s: %s %zu+%zu %s, queued %lu us, back end %lu us, "
+					       "total %lu us\n", _label, _op_name(client.operation()),
+					       client.block_number(), client.block_count(),
+					       client.succeeded() ? "ok" : "failed",
+					       clock.us(received, submitted), back_end_us, total_us);
+
+				unsigned long const report = trace_config().report;
+				if (report && ++_completed % report == 0)
+					_print_statistics();
+			}
+
+			void _print_statistics()
+			{
+				for (unsigned op = 0; op < 2; op++) {
+					_stats[op].print(_label, _op_name((Packet_descriptor::Opcode)op),
+					                 _blk_size);
+					_stats[op].reset();
+				}
+			}
+
+		public:
+
+			/**
+			 * Constructor
+			 *
+			 * \param tx_ds  buffer for the tx channel of the client, the
+			 *               back-end connection uses a buffer of the same
+			 *               size
+			 * \param label  session label, also used for the back-end
+			 *               connection
+			 */
+			Session_component(Dataspace_capability tx_ds, size_t tx_buf_size,
+			                  char const *label, Rpc_entrypoint &ep)
+			:
+				Session_rpc_object(tx_ds, ep),
+				_block_alloc(env()->heap()),
+				_blk(&_block_alloc, tx_buf_size, label),
+				_request_sem(MAX_REQUESTS), _alloc_waiters(0),
+				_completed(0),
+				_tx_thread(*this), _ack_thread(*this)
+			{
+				strncpy(_label, label, sizeof(_label));
+
+				_blk.info(&_blk_count, &_blk_size, &_ops);
+
+				_ack_thread.start();
+				_tx_thread.start();
+			}
+
+			~Session_component() { _print_statistics(); }
+
+
+			/*****************************
+			 ** Block session interface **
+			 *****************************/
+
+			void info(size_t *blk_count, size_t *blk_size, Operations *ops)
+			{
+				*blk_count = _blk_count;
+				*blk_size  = _blk_size;
+				*ops       = _ops;
+			}
+	};
+
+
+	typedef Root_component<Session_component> Root_component;
+
+	/**
+	 * Root component, handling new session requests
+	 */
+	class Root : public Root_component
+	{
+		private:
+
+			Rpc_entrypoint &_ep;
+
+		protected:
+
+			Session_component *_create_session(const char *args)
+			{
+				size_t ram_quota =
+					Arg_string::find_arg(args, "ram_quota"  ).ulong_value(0);
+				size_t tx_buf_size =
+					Arg_string::find_arg(args, "tx_buf_size").ulong_value(0);
+
+				/* delete ram quota by the memory needed for the session */
+				size_t session_size = max((size_t)4096,
+				                          sizeof(Session_component));
+
+				if (ram_quota < session_size)
+					throw Root::Quota_exceeded();
+
+				/*
+				 * Check if donated ram quota suffices for the communication
+				 * buffer. The quota for the back-end connection is paid by
+				 * blk_trace itself.
+				 */
+				if (tx_buf_size > ram_quota - session_size) {
+					PERR("insufficient 'ram_quota', got %zd, need %zd",
+					     ram_quota, tx_buf_size + session_size);
+					throw Root::Quota_exceeded();
+				}
+
+				char label[64];
+				Arg_string::find_arg(args, "label").string(label, sizeof(label),
+				                                           "<unlabeled>");
+
+				return new (md_alloc())
+					Session_component(env()->ram_session()->alloc(tx_buf_size),
+					                  tx_buf_size, label, _ep);
+			}
+
+		public:
+
+			Root(Rpc_entrypoint *session_ep, Allocator *md_alloc)
+			: Root_component(session_ep, md_alloc), _ep(*session_ep) { }
+	};
+}
+
+
+int main()
+{
+	/* calibrate before serving the first request */
+	printf("timestamp counter runs at %lu MHz\n",
+	       Block::cycle_clock().cycles_per_us());
+
+	enum { STACK_SIZE = 8192 };
+	static Cap_connection cap;
+	static Rpc_entrypoint ep(&cap, STACK_SIZE, "blk_trace_ep");
+	static Block::Root block_root(&ep, env()->heap());
+
+	env()->parent()->announce(ep.manage(&block_root));
+	sleep_forever();
+	return 0;
+}
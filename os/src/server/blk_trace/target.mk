@@ -0,0 +1,4 @@
+TARGET   = blk_trace
+SRC_CC   = main.cc
+LIBS     = base
+REQUIRES = x86
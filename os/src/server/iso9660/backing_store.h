@@ -213,6 +213,11 @@ class Backing_store
 		 */
 		Genode::size_t block_size() const { return _block_size; }
 
+		/**
+		 * Return number of blocks of the backing store
+		 */
+		Genode::size_t num_blocks() const { return _num_blocks; }
+
 		/**
 		 * Return block index of specified block
 		 */
@@ -34,8 +34,8 @@ namespace Iso {
 		public:
 
 			enum {
-				MAX_SECTORS = 32, /* max. number sectors that can be read in one
-				                     transaction */
+				TX_BUF_SIZE  = 512*1024, /* size of the packet-stream buffer */
+				MAX_TRANSFER = TX_BUF_SIZE/2, /* max. bytes per transaction */
 			};
 
 			static Block::Connection          *_blk;
@@ -53,23 +53,25 @@ namespace Iso {
 			{
 				Lock::Guard lock_guard(_lock);
 
+				/* number of device blocks per ISO sector */
+				size_t const factor = blk_size() / _blk_size;
+
 				try {
 					_p = Block::Packet_descriptor(
 						_blk->dma_alloc_packet(blk_size() * count),
 						Block::Packet_descriptor::READ,
-						blk_nr * ((float)blk_size() / _blk_size),
-						count * ((float)blk_size() / _blk_size));
+						blk_nr * factor, count * factor);
 					_source->submit_packet(_p);
 					_p = _source->get_acked_packet();
 
 					if (!_p.succeeded()) {
 						PERR("Could not read block %lu", blk_nr);
+						_source->release_packet(_p);
 						throw Io_error();
 					}
 
 				} catch (Block::Session::Tx::Source::Packet_alloc_failed) {
 					PERR("Packet overrun!");
-					_p = _source->get_acked_packet();
 					throw Io_error();
 				}
 			}
@@ -87,10 +89,16 @@ namespace Iso {
 
 			static size_t blk_size() { return 2048; }
 
+			/**
+			 * Return max. number of sectors that can be read in one transaction
+			 */
+			static unsigned long max_sectors() { return MAX_TRANSFER / blk_size(); }
+
 			static unsigned long to_blk(unsigned long bytes) {
 				return ((bytes + blk_size() - 1) & ~(blk_size() - 1)) / blk_size(); }
 	};
 
+
 	/**
 	 * Rock ridge extension (see IEEE P1282)
 	 */
@@ -359,39 +367,183 @@ namespace Iso {
 	}
 
 
-	unsigned long read_file(File_info *info, off_t file_offset, uint32_t length, void *buf_ptr)
+	/**
+	 * Cache of directory sectors
+	 *
+	 * Path lookups traverse the same directories over and over again, e.g.,
+	 * the root directory for each file. The cache keeps copies of the
+	 * least-recently used directory sectors. On a miss, the following sectors
+	 * of the directory extent are read within the same transaction.
+	 */
+	class Directory_cache
 	{
-		uint8_t *buf = (uint8_t *)buf_ptr;
-		if (info->size() <= (size_t)(length + file_offset))
-			length = info->size() - file_offset - 1;
+		public:
+
+			enum {
+				ENTRIES      = 64,
+				MAX_PREFETCH = 16, /* max. number of sectors read on a miss */
+			};
 
-		unsigned long total_blk_count = ((length + (Sector::blk_size() - 1)) &
-		                                 ~((Sector::blk_size()) - 1)) / Sector::blk_size();
-		unsigned long ret = total_blk_count;
-		unsigned long blk_count;
-		unsigned long blk_nr = info->blk_nr() + (file_offset / Sector::blk_size());
+		private:
 
-		if (verbose)
-			PDBG("Read blk %lu count %lu, file_offset: %08lx length %u", blk_nr, total_blk_count, file_offset, length);
+			struct Entry
+			{
+				unsigned long blk_nr;
+				unsigned long last_used;  /* 0 if entry is unused */
+
+				/*
+				 * The zero byte following the sector terminates the
+				 * record list of a completely filled sector.
+				 */
+				uint8_t data[2048 + 1];
+
+				Entry() : blk_nr(0), last_used(0) { data[2048] = 0; }
+			};
+
+			Lock          _lock;
+			Entry         _entries[ENTRIES];
+			unsigned long _now;
+
+			Entry *_lookup(unsigned long blk_nr)
+			{
+				for (unsigned i = 0; i < ENTRIES; i++)
+					if (_entries[i].last_used && _entries[i].blk_nr == blk_nr)
+						return &_entries[i];
+				return 0;
+			}
+
+			Entry *_least_recently_used()
+			{
+				Entry *lru = &_entries[0];
+				for (unsigned i = 1; i < ENTRIES; i++)
+					if (_entries[i].last_used < lru->last_used)
+						lru = &_entries[i];
+				return lru;
+			}
+
+			void _insert(unsigned long blk_nr, void const *data)
+			{
+				Entry *e = _lookup(blk_nr);
+				if (!e)
+					e = _least_recently_used();
+
+				e->blk_nr    = blk_nr;
+				e->last_used = ++_now;
+				memcpy(e->data, data, Sector::blk_size());
+			}
+
+		public:
+
+			Directory_cache() : _now(0) { }
+
+			/**
+			 * Return first directory record of sector
+			 *
+			 * \param blk_nr  sector number
+			 * \param count   number of sectors left in the directory
+			 *                extent, starting at 'blk_nr'
+			 *
+			 * The returned record stays valid until the next call.
+			 */
+			Directory_record *records(unsigned long blk_nr, unsigned long count)
+			{
+				Lock::Guard lock_guard(_lock);
 
-		while ((blk_count = min<unsigned long>(Sector::MAX_SECTORS, total_blk_count))) {
-			Sector sec(blk_nr, blk_count);
+				Entry *e = _lookup(blk_nr);
+				if (!e) {
+					count = min<unsigned long>(count, MAX_PREFETCH);
 
-			total_blk_count -= blk_count;
-			blk_nr          += blk_count;
+					Sector sec(blk_nr, count);
+					uint8_t *data = sec.addr<uint8_t *>();
 
-			unsigned long copy_length = blk_count * Sector::blk_size();
-			memcpy(buf, sec.addr<void *>(), copy_length);
+					/* insert in reverse order to keep the requested sector */
+					for (unsigned long i = count; i > 0; i--)
+						_insert(blk_nr + i - 1, data + (i - 1)*Sector::blk_size());
 
-			length -= copy_length;
-			buf    += copy_length;
+					e = _lookup(blk_nr);
+				}
+
+				e->last_used = ++_now;
+				return reinterpret_cast<Directory_record *>(e->data);
+			}
+	};
+
+
+	static Directory_cache *directory_cache()
+	{
+		static Directory_cache _cache;
+		return &_cache;
+	}
+
+
+	/**
+	 * Copy data to the chunks of a scattered buffer
+	 *
+	 * \param src  source data, or 0 for zero-filling
+	 * \param pos  byte position within the chunks
+	 */
+	static void copy_to_chunks(uint8_t const *src, size_t bytes, size_t pos,
+	                           size_t chunk_size, void * const *chunks)
+	{
+		while (bytes) {
+			size_t const offset = pos % chunk_size;
+			size_t const n      = min(bytes, chunk_size - offset);
+			uint8_t     *dst    = (uint8_t *)chunks[pos / chunk_size] + offset;
+
+			if (src) {
+				memcpy(dst, src, n);
+				src += n;
+			} else
+				memset(dst, 0, n);
+
+			pos   += n;
+			bytes -= n;
+		}
+	}
+
+
+	unsigned long read_file(File_info *info, off_t file_offset,
+	                        size_t chunk_size, void * const *chunks,
+	                        unsigned count)
+	{
+		size_t const length = chunk_size * count;
+
+		/* number of bytes present in the file */
+		size_t const valid = file_offset < (off_t)info->size()
+		                   ? min(length, info->size() - file_offset) : 0;
+
+		unsigned long blk_nr    = info->blk_nr() + (file_offset / Sector::blk_size());
+		unsigned long blk_count = Sector::to_blk(valid);
 
-			/* zero out rest of page */
-			if (!total_blk_count && (blk_count % 2))
-				memset(buf, 0, Sector::blk_size());
+		if (verbose)
+			PDBG("Read blk %lu count %lu, file_offset: %08lx length %zu",
+			     blk_nr, blk_count, file_offset, length);
+
+		/* read the extent using as few transactions as possible */
+		size_t pos = 0;
+		while (blk_count) {
+			unsigned long const n = min(blk_count, Sector::max_sectors());
+			Sector sec(blk_nr, n);
+
+			size_t const bytes = min(n * Sector::blk_size(), valid - pos);
+			copy_to_chunks(sec.addr<uint8_t *>(), bytes, pos, chunk_size, chunks);
+
+			pos       += bytes;
+			blk_nr    += n;
+			blk_count -= n;
 		}
-	
-		return ret * Sector::blk_size();
+
+		/* zero out the part beyond the end of the file */
+		copy_to_chunks(0, length - valid, valid, chunk_size, chunks);
+
+		return valid;
+	}
+
+
+	unsigned long read_file(File_info *info, off_t file_offset, uint32_t length,
+	                        void *buf)
+	{
+		return read_file(info, file_offset, length, &buf, 1);
 	}
 
 
@@ -414,8 +566,15 @@ namespace Iso {
 		char level[PATH_LENGTH];
 
 		Token t(path);
-		Directory_record *dir = root_dir();
-		uint32_t blk_nr = 0, data_length = 0;
+		Directory_record *root = root_dir();
+
+		/*
+		 * Extent of the current directory record, the record itself is not
+		 * kept because its sector may get evicted from the directory cache.
+		 */
+		uint32_t blk_nr      = root->blk_nr();
+		uint32_t data_length = root->data_length();
+		bool     is_dir      = true;
 
 		/* determine block nr and file length on disk, parse directory records */
 		while (t) {
@@ -427,37 +586,33 @@ namespace Iso {
 
 			t.string(level, PATH_LENGTH);
 
-			/* load extent of directory record and search for level */
-			for (unsigned long i = 0; i < Sector::to_blk(dir->data_length()); i++) {
-				Sector sec(dir->blk_nr() + i, 1);
-				Directory_record *tmp = sec.addr<Directory_record *>()->locate(level);
-
-				if (!tmp && i == Sector::to_blk(dir->data_length()) - 1) {
-					PERR("File not found: %s", path);
-					throw File_not_found();
-				}
-
-				if (!tmp) continue;
+			if (!is_dir) {
+				PERR("File not found: %s", path);
+				throw File_not_found();
+			}
 
-				dir = tmp;
+			/* search the sectors of the directory extent for level */
+			unsigned long const sectors = Sector::to_blk(data_length);
+			Directory_record *dir = 0;
+			for (unsigned long i = 0; i < sectors && !dir; i++)
+				dir = directory_cache()->records(blk_nr + i, sectors - i)->locate(level);
 
-				if (verbose)
-					PDBG("Found %s", level);
+			if (!dir) {
+				PERR("File not found: %s", path);
+				throw File_not_found();
+			}
 
-				if (!dir->is_directory()) {
-					blk_nr      = dir->blk_nr();
-					data_length = dir->data_length();
-				}
+			if (verbose)
+				PDBG("Found %s", level);
 
-				break;
-			}
+			blk_nr      = dir->blk_nr();
+			data_length = dir->data_length();
+			is_dir      = dir->is_directory();
 
 			t = t.next();
 		}
 
-		/* Warning: Don't access 'dir' after this point, since the sector is gone */
-
-		if (!blk_nr && !data_length) {
+		if (is_dir) {
 			PERR("File not found: %s", path);
 			throw File_not_found();
 		}
@@ -484,7 +639,7 @@ namespace Iso {
 	void __attribute__((constructor)) init()
 	{
 		static Allocator_avl block_alloc(env()->heap());
-		static Block::Connection _blk(&block_alloc);
+		static Block::Connection _blk(&block_alloc, Sector::TX_BUF_SIZE);
 
 		Sector::_blk    = &_blk;
 		Sector::_source  = _blk.tx();
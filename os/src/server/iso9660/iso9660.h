@@ -75,7 +75,28 @@ namespace Iso {
 	 * \throw Io_error
 	 *
 	 * \return Number of bytes read
+	 *
+	 * The file offset must be a multiple of the sector size. The part of
+	 * the buffer beyond the end of the file is filled with zeros.
 	 */
 	unsigned long read_file(File_info *info, Genode::off_t file_offset,
 	                        Genode::uint32_t length, void *buf);
+
+	/**
+	 * Read consecutive data from ISO into scattered buffers
+	 *
+	 * \param info         File info of file to read the data from
+	 * \param file_offset  Offset in file, multiple of the sector size
+	 * \param chunk_size   Size of each buffer in bytes
+	 * \param chunks       Array of 'count' output buffers
+	 *
+	 * \throw Io_error
+	 *
+	 * \return Number of bytes read
+	 *
+	 * The data is read using as few block transactions as possible.
+	 */
+	unsigned long read_file(File_info *info, Genode::off_t file_offset,
+	                        Genode::size_t chunk_size, void * const *chunks,
+	                        unsigned count);
 }
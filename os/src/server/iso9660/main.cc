@@ -46,6 +46,11 @@ namespace Iso {
 	             public Signal_context,
 	             public Backing_store::User
 	{
+		public:
+
+			enum {
+				MAX_READ_AHEAD = 8, /* max. number of blocks read on a fault */
+			};
 
 		private:
 
@@ -54,17 +59,75 @@ namespace Iso {
 			Signal_receiver          *_receiver;
 			Backing_store            *_backing_store;
 
+			/*
+			 * Bitmap of file blocks currently attached to the managed
+			 * dataspace
+			 */
+			unsigned long             _num_blocks;
+			uint8_t                  *_attached;
+
+			/*
+			 * Read-ahead state, the window grows with each sequential
+			 * fault and shrinks to one block on random access
+			 */
+			unsigned long             _next_block;
+			unsigned                  _window;
+
+			size_t _bitmap_size() const { return (_num_blocks + 7) / 8; }
+
+			bool _is_attached(unsigned long i) const {
+				return _attached[i / 8] & (1 << (i % 8)); }
+
+			void _mark_attached(unsigned long i, bool attached)
+			{
+				if (attached)
+					_attached[i / 8] |=  (1 << (i % 8));
+				else
+					_attached[i / 8] &= ~(1 << (i % 8));
+			}
+
+			void _attach(Backing_store::Block *block, Genode::off_t file_offset)
+			{
+				bool try_again;
+				do {
+					try_again = false;
+					try {
+						_rm->attach_at(_backing_store->dataspace(), file_offset,
+						               _backing_store->block_size(),
+						               _backing_store->offset(block)); }
+
+					catch (Genode::Rm_session::Region_conflict) {
+						PERR("Region conflict - this should not happen"); }
+
+					catch (Genode::Rm_session::Out_of_metadata) {
+
+						/* give up if the error occurred a second time */
+						if (try_again)
+							break;
+
+						PINF("upgrading quota donation for RM session");
+						Genode::env()->parent()->upgrade(_rm->cap(), "ram_quota=32K");
+						try_again = true;
+					}
+				} while (try_again);
+			}
+
 		public:
 
 			File(char *path, Signal_receiver *receiver, Backing_store *backing_store)
 			: File_base(path),
 				_info(Iso::file_info(path)),
 				_receiver(receiver),
-				_backing_store(backing_store)
+				_backing_store(backing_store),
+				_next_block(0), _window(1)
 			{
 				size_t rm_size = align_addr(_info->page_sized(),
 				                            log2(_backing_store->block_size()));
-				
+
+				_num_blocks = rm_size / _backing_store->block_size();
+				_attached   = (uint8_t *)env()->heap()->alloc(_bitmap_size());
+				memset(_attached, 0, _bitmap_size());
+
 				_rm = new(env()->heap()) Rm_connection(0, rm_size);
 				_rm->fault_handler(receiver->manage(this));
 			}
@@ -74,6 +137,7 @@ namespace Iso {
 				_receiver->dissolve(this);
 				_backing_store->flush(this);
 				destroy(env()->heap(), _rm);
+				env()->heap()->free(_attached, _bitmap_size());
 				destroy(env()->heap(), _info);
 			}
 
@@ -93,56 +157,69 @@ namespace Iso {
 				if (state.type == Rm_session::READY)
 					return;
 
-				Backing_store::Block *block = _backing_store->alloc();
+				size_t const block_size = _backing_store->block_size();
+
+				/* file block containing the page-fault address */
+				unsigned long const first = state.addr / block_size;
+
+				if (first >= _num_blocks || _is_attached(first))
+					return;
 
 				/*
-				 * Calculate backing-store-block-aligned file offset from
-				 * page-fault address.
+				 * Grow the read-ahead window on sequential access but keep
+				 * enough backing-store blocks for the other files
 				 */
-				Genode::off_t file_offset = state.addr;
-				file_offset &= ~(_backing_store->block_size() - 1);
+				unsigned const max_window =
+					max(1UL, min((unsigned long)MAX_READ_AHEAD,
+					             _backing_store->num_blocks() / 4));
 
-				/* re-initialize block content */
-				Genode::memset(_backing_store->local_addr(block), 0,
-				               _backing_store->block_size());
+				_window = (first == _next_block) ? min(2*_window, max_window) : 1;
 
-				/* read file content to block */
-				unsigned long bytes = Iso::read_file(_info, file_offset,
-				                                     _backing_store->block_size(),
-				                                     _backing_store->local_addr(block));
+				/* allocate blocks for the unpopulated part of the window */
+				Backing_store::Block *blocks[MAX_READ_AHEAD];
+				void                 *chunks[MAX_READ_AHEAD];
+				unsigned              count = 0;
 
-				if (verbose)
-					PDBG("[%ld] ATTACH: rm=%p, a=%08lx s=%lx",
-					     _backing_store->index(block), _rm, file_offset, bytes);
+				for (; count < _window && first + count < _num_blocks
+				    && !_is_attached(first + count); count++) {
+					blocks[count] = _backing_store->alloc();
+					chunks[count] = _backing_store->local_addr(blocks[count]);
+				}
 
-				bool try_again;
-				do {
-					try_again = false;
-					try {
-						_rm->attach_at(_backing_store->dataspace(), file_offset,
-						               _backing_store->block_size(),
-						               _backing_store->offset(block)); }
+				/* read file content of all blocks with one extent read */
+				Genode::off_t const file_offset = first * block_size;
+				unsigned long bytes = 0;
+				try {
+					bytes = Iso::read_file(_info, file_offset, block_size,
+					                       chunks, count);
+				} catch (Io_error) {
+					PERR("could not read file content at offset 0x%lx",
+					     file_offset);
+
+					/* do not leak stale content of the blocks */
+					for (unsigned i = 0; i < count; i++)
+						memset(chunks[i], 0, block_size);
+				}
 
-					catch (Genode::Rm_session::Region_conflict) {
-						PERR("Region conflict - this should not happen"); }
+				if (verbose)
+					PDBG("[%ld] ATTACH: rm=%p, a=%08lx count=%u s=%lx",
+					     _backing_store->index(blocks[0]), _rm, file_offset,
+					     count, bytes);
 
-					catch (Genode::Rm_session::Out_of_metadata) {
+				for (unsigned i = 0; i < count; i++) {
+					Genode::off_t const offset = file_offset + i*block_size;
 
-						/* give up if the error occurred a second time */
-						if (try_again)
-							break;
+					_attach(blocks[i], offset);
+					_mark_attached(first + i, true);
 
-						PINF("upgrading quota donation for RM session");
-						Genode::env()->parent()->upgrade(_rm->cap(), "ram_quota=32K");
-						try_again = true;
-					}
-				} while (try_again);
+					/*
+					 * Register ourself as user of the block and thereby enable
+					 * future eviction.
+					 */
+					_backing_store->assign(blocks[i], this, offset);
+				}
 
-				/*
-				 * Register ourself as user of the block and thereby enable
-				 * future eviction.
-				 */
-				_backing_store->assign(block, this, file_offset);
+				_next_block = first + count;
 			}
 
 			/**************************
@@ -176,6 +253,7 @@ namespace Iso {
 			void detach_block(Genode::off_t file_offset)
 			{
 				_rm->detach((void *)file_offset);
+				_mark_attached(file_offset / _backing_store->block_size(), false);
 			}
 	};
 
@@ -0,0 +1,63 @@
+/*
+ * \brief  Mixing of audio samples
+ * \author Norman Feske
+ * \date   2013-03-19
+ *
+ * On x86, four samples are processed at once using SSE. The remaining
+ * samples, and all samples on other architectures, are processed one by
+ * one.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _MIX_H_
+#define _MIX_H_
+
+namespace Audio_out {
+
+	/**
+	 * Scale 'n' samples of 'in' by 'gain' and add them to 'out'
+	 *
+	 * \param CLEAR  if true, the samples of 'out' are replaced
+	 *
+	 * The resulting samples are clamped to [-1, 1].
+	 */
+	template <bool CLEAR>
+	inline void mix(float *out, float const *in, float gain, unsigned n)
+	{
+		unsigned i = 0;
+
+#ifdef __SSE__
+		/* packet content is aligned to 4 bytes only */
+		typedef float V  __attribute__((vector_size(16)));
+		typedef float Vu __attribute__((vector_size(16), aligned(4)));
+
+		V const g  = {  gain,  gain,  gain,  gain };
+		V const hi = {  1.0f,  1.0f,  1.0f,  1.0f };
+		V const lo = { -1.0f, -1.0f, -1.0f, -1.0f };
+
+		for (; i + 4 <= n; i += 4) {
+			V v = *(Vu const *)(in + i) * g;
+			if (!CLEAR)
+				v += *(Vu const *)(out + i);
+
+			*(Vu *)(out + i) = __builtin_ia32_minps(__builtin_ia32_maxps(v, lo), hi);
+		}
+#endif
+
+		for (; i < n; i++) {
+			float v = in[i]*gain;
+			if (!CLEAR)
+				v += out[i];
+
+			out[i] = v > 1 ? 1 : (v < -1 ? -1 : v);
+		}
+	}
+}
+
+#endif /* _MIX_H_ */
@@ -6,6 +6,22 @@
  * The mixer impelements the audio session on the server side. For each channel
  * (currently 'left' and 'right' only) it supports multiple client sessions and
  * mixes its input into a single client audio session.
+ *
+ * The period requested from the output is configured by the 'period'
+ * attribute of the config node. Client sessions are granted the period they
+ * request. The samples of each client are scaled by the 'volume' (percent)
+ * of the session policy matching the client:
+ *
+ * ! <config period="256">
+ * !   <policy label="player" volume="50"/>
+ * ! </config>
+ *
+ * Clients may use a sample rate different from the output and 16-bit
+ * samples. Samples in 'FORMAT_S16' are converted while mixing. For sessions
+ * with another sample rate or period, each packet is resampled once when the
+ * mixer takes it from the client. The resampled frames are buffered by the
+ * session's 'Converter' until they are mixed into the output in packets of
+ * the output period.
  */
 
 /*
@@ -22,9 +38,15 @@
 #include <audio_out_session/rpc_object.h>
 #include <audio_out_session/connection.h>
 #include <cap_session/connection.h>
+#include <os/config.h>
+#include <os/session_policy.h>
 #include <root/component.h>
 #include <timer_session/connection.h>
 
+/* local includes */
+#include "mix.h"
+#include "resampler.h"
+
 using namespace Genode;
 
 
@@ -36,6 +58,7 @@ enum Channel_number { LEFT, RIGHT, MAX_CHANNELS };
 namespace Audio_out
 {
 	class Session_elem;
+	class Converter;
 	class Session_component;
 	class Root;
 	class Channel;
@@ -65,14 +88,254 @@ static int channel_number_from_string(const char *name)
 }
 
 
+/**
+ * Return period requested from the output as configured
+ */
+static unsigned config_period()
+{
+	unsigned long period = Audio_out::PERIOD;
+	try {
+		config()->xml_node().attribute("period").value(&period);
+	} catch (...) { }
+
+	return max(min(period, (unsigned long)Audio_out::PERIOD),
+	           (unsigned long)Audio_out::MIN_PERIOD);
+}
+
+
+/**
+ * Return samples of packet in 'FORMAT_F32'
+ *
+ * Samples of other formats are converted into a buffer, which is valid
+ * until the next call.
+ */
+static float const *packet_samples(Audio_out::Stream *stream,
+                                   Audio_out::Packet *packet, unsigned n)
+{
+	if (stream->format() == Audio_out::FORMAT_F32)
+		return packet->content();
+
+	static float buf[Audio_out::PERIOD];
+	short const *in = packet->content_s16();
+	for (unsigned i = 0; i < n; i++)
+		buf[i] = in[i]*(1.0f/32768);
+
+	return buf;
+}
+
+
+/**
+ * Resampling filter as list element
+ */
+struct Filter_elem : List<Filter_elem>::Element
+{
+	Audio_out::Resampler::Filter filter;
+	unsigned                     users;  /* number of sessions using the filter */
+
+	Filter_elem(unsigned rate, unsigned out_rate)
+	: filter(env()->heap(), rate, out_rate), users(0) { }
+
+	/**
+	 * Return memory needed for a filter, accounted to each session using it
+	 */
+	static size_t size(unsigned rate, unsigned out_rate)
+	{
+		return sizeof(Filter_elem)
+		     + Audio_out::Resampler::Filter::coef_size(rate, out_rate);
+	}
+};
+
+
+/*
+ * Sessions are created and destroyed by the entrypoint only. So the list of
+ * filters is not accessed concurrently.
+ */
+static List<Filter_elem> *filters()
+{
+	static List<Filter_elem> inst;
+	return &inst;
+}
+
+
+/**
+ * Return filter for the conversion from 'rate' to 'out_rate'
+ *
+ * Filters are created on first use and shared by all sessions with the same
+ * sample rate. Each call must be paired with a call of 'release_filter'.
+ */
+static Audio_out::Resampler::Filter const &acquire_filter(unsigned rate,
+                                                          unsigned out_rate)
+{
+	Filter_elem *e = filters()->first();
+	for (; e; e = e->next())
+		if (e->filter.in_rate() == rate && e->filter.out_rate() == out_rate)
+			break;
+
+	if (!e) {
+		e = new (env()->heap()) Filter_elem(rate, out_rate);
+		filters()->insert(e);
+	}
+
+	e->users++;
+	return e->filter;
+}
+
+
+/**
+ * Destroy filter when its last user released it
+ */
+static void release_filter(Audio_out::Resampler::Filter const &filter)
+{
+	for (Filter_elem *e = filters()->first(); e; e = e->next()) {
+		if (&e->filter != &filter)
+			continue;
+
+		if (--e->users == 0) {
+			filters()->remove(e);
+			destroy(env()->heap(), e);
+		}
+		return;
+	}
+}
+
+
+/**
+ * Resampled frames of one session
+ *
+ * The frames are buffered in the sample rate of the output. The frame at
+ * '_head' belongs to the output packet at '_out_pos'. '_mixed' is the number
+ * of output packets the frames were mixed into, starting at '_out_pos'.
+ */
+class Audio_out::Converter
+{
+	private:
+
+		enum { CAPACITY = (QUEUE_SIZE - 4)*PERIOD };
+
+		Resampler::Filter const &_filter;
+		Resampler                _resampler;
+
+		unsigned _period;   /* output period */
+		unsigned _limit;    /* maximum number of buffered frames */
+		unsigned _out_pos;  /* output position of the first frame */
+		unsigned _mixed;    /* number of output packets mixed into */
+		unsigned _head;     /* index of the first frame in '_buf' */
+		unsigned _tail;     /* index behind the last frame in '_buf' */
+		float    _buf[CAPACITY];
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param period     output period
+		 * \param in_period  period of the session
+		 */
+		Converter(Resampler::Filter const &filter, unsigned period,
+		          unsigned in_period)
+		:
+			_filter(filter), _resampler(filter), _period(period),
+			_limit(min((unsigned)CAPACITY,
+			           max((QUEUE_SIZE/2)*period,
+			               _resampler.max_output(in_period)
+			               + (QUEUE_SIZE/4)*period)))
+		{
+			reset(0);
+		}
+
+		Resampler::Filter const &filter() const { return _filter; }
+
+		/**
+		 * Discard frames, the next frame belongs to output packet 'out_pos'
+		 */
+		void reset(unsigned out_pos)
+		{
+			_resampler.reset();
+			_out_pos = out_pos;
+			_mixed   = 0;
+			_head    = _tail = 0;
+		}
+
+		/**
+		 * Return true if a packet with 'n' frames can be converted
+		 *
+		 * The limit of half of the queue bounds the latency added by the
+		 * conversion. A packet of a session with a larger period is accepted
+		 * once frames for less than a quarter of the queue are left.
+		 */
+		bool ready(unsigned n) const {
+			return _tail - _head + _resampler.max_output(n) <= _limit; }
+
+		/**
+		 * Append 'n' resampled frames of 'in', requires 'ready(n)'
+		 */
+		void convert(float const *in, unsigned n)
+		{
+			if (_tail + _resampler.max_output(n) > CAPACITY) {
+				memmove(_buf, _buf + _head, (_tail - _head)*sizeof(float));
+				_tail -= _head;
+				_head  = 0;
+			}
+			_tail += _resampler.process(in, n, _buf + _tail);
+		}
+
+		/**
+		 * Return true if frames for the output packet at 'offset' are
+		 * available but were not mixed yet
+		 */
+		bool fresh(unsigned offset) const {
+			return offset == _mixed && _tail - _head >= (offset + 1)*_period; }
+
+		/**
+		 * Return true if the frames for 'offset' were mixed already
+		 */
+		bool mixed(unsigned offset) const { return offset < _mixed; }
+
+		/**
+		 * Return frames for the output packet at 'offset'
+		 */
+		float const *frames(unsigned offset)
+		{
+			if (offset == _mixed)
+				_mixed++;
+
+			return _buf + _head + offset*_period;
+		}
+
+		/**
+		 * Drop the frames of played output packets
+		 *
+		 * If no frames were mixed into a played packet, the session did not
+		 * deliver frames in time. Those packets are skipped without
+		 * dropping frames.
+		 */
+		void advance(unsigned out_pos)
+		{
+			for (; _out_pos != out_pos; _out_pos = (_out_pos + 1) % QUEUE_SIZE) {
+				if (!_mixed)
+					continue;
+
+				_head += _period;
+				_mixed--;
+			}
+		}
+};
+
+
 /**
  * Makes audio a list element
  */
 struct Audio_out::Session_elem : Audio_out::Session_rpc_object,
                                  List<Audio_out::Session_elem>::Element
 {
-	Session_elem(Signal_context_capability data_cap)
-	: Session_rpc_object(data_cap) { }
+	float const gain;
+
+	/* only used if the session's sample rate differs from the output */
+	Converter * const converter;
+
+	Session_elem(Signal_context_capability data_cap, float gain,
+	             Converter *converter)
+	: Session_rpc_object(data_cap), gain(gain), converter(converter) { }
 };
 
 
@@ -90,6 +353,9 @@ class Audio_out::Channel
 		void insert(Session_elem *session) {
 			_list.insert(session); }
 
+		void remove(Session_elem *session) {
+			_list.remove(session); }
+
 		Session_elem *first() {
 			return _list.first();
 		}
@@ -105,6 +371,13 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 
 		Lock _sleep_lock;
 
+		/*
+		 * The lock is held by the mixer thread while it traverses the
+		 * channels. The entrypoint takes it to insert or remove sessions
+		 * and to reset their converters.
+		 */
+		Lock _lock;
+
 		Connection  _left;   /* left output */
 		Connection  _right;  /* right output */
 		Connection *_out[MAX_CHANNELS];
@@ -117,11 +390,16 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 		Mixer()
 		:
 			Thread("mixer"),
-			_sleep_lock(Lock::LOCKED), _left("left", false, true),
-			_right("right", false, true)
+			_sleep_lock(Lock::LOCKED),
+			_left("left", false, true, config_period()),
+			_right("right", false, true, config_period())
 		{
 			_out[LEFT]  = &_left;
 			_out[RIGHT] = &_right;
+
+			if (_left.stream()->period() != _right.stream()->period())
+				PERR("output channels use different periods");
+
 			start();
 		}
 
@@ -144,6 +422,12 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 			if (session->stopped())
 				return;
 
+			/* packets of converted sessions are consumed by '_convert' */
+			if (session->converter) {
+				session->converter->advance(pos);
+				return;
+			}
+
 			Stream *stream = session->stream();
 			bool full = stream->full();
 
@@ -174,23 +458,37 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 			}
 		}
 
-		/* mix one packet */
-		void _mix_packet(Packet *out, Packet *in, bool clear)
+		/* convert all packets of a session that fit into its converter */
+		void _convert(Session_elem *session)
 		{
-			/* when clear is set, set input an zero out remainder */
-			if (clear) {
-				out->content(in->content(), PERIOD);
-			} else {
-				/* mix */
-				for (int i = 0; i < PERIOD; i++) {
-					out->content()[i] += in->content()[i];
-
-					if (out->content()[i] > 1) out->content()[i] = 1;
-					if (out->content()[i] < -1) out->content()[i] = -1;
-				}
+			if (session->stopped())
+				return;
+
+			Stream *stream = session->stream();
+			bool full = stream->full();
+			bool consumed = false;
+
+			for (;;) {
+				Packet  *p = stream->get(stream->pos());
+				unsigned n = stream->period();
+
+				if (!p->valid() || !session->converter->ready(n))
+					break;
+
+				session->converter->convert(packet_samples(stream, p, n), n);
+
+				p->invalidate();
+				p->mark_as_played();
+				stream->increment_position();
+				consumed = true;
 			}
-			/* mark packet as processed */
-			in->invalidate();
+
+			if (!consumed)
+				return;
+
+			session->progress_submit();
+			if (full)
+				session->alloc_submit();
 		}
 
 		/* get packet at offset */
@@ -200,6 +498,48 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 			return s->get(s->pos() + offset);
 		}
 
+		/* return true if the session has frames for 'offset' not mixed yet */
+		bool _fresh(Session_elem *session, unsigned offset)
+		{
+			if (session->converter)
+				return session->converter->fresh(offset);
+
+			return session_packet(session, offset)->valid();
+		}
+
+		/* return true if the session's frames for 'offset' were mixed before */
+		bool _mixed(Session_elem *session, unsigned offset)
+		{
+			if (session->converter)
+				return session->converter->mixed(offset);
+
+			return !session_packet(session, offset)->played();
+		}
+
+		/* mix the frames of one session for 'offset' */
+		void _mix_session(Packet *out, Session_elem *session, unsigned offset,
+		                  bool clear)
+		{
+			unsigned const n = period();
+			float const *in  = 0;
+
+			if (session->converter)
+				in = session->converter->frames(offset);
+			else {
+				Packet *p = session_packet(session, offset);
+				in = packet_samples(session->stream(), p, n);
+
+				/* mark packet as processed */
+				p->invalidate();
+			}
+
+			/* when clear is set, overwrite the output */
+			if (clear)
+				mix<true>(out->content(), in, session->gain, n);
+			else
+				mix<false>(out->content(), in, session->gain, n);
+		}
+
 		/* mix all session of one channel */
 		bool _mix_channel(Channel_number nr, unsigned out_pos, unsigned offset)
 		{
@@ -217,29 +557,29 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 				if (session->stopped())
 					continue;
 
-				Packet *in = session_packet(session, offset);
-
 				/*
 				 * When there already is an out packet, start over and mix
 				 * everything.
 				 */
-				if (in->valid() && out_valid && !mix_all) {
+				if (_fresh(session, offset) && out_valid && !mix_all) {
 					clear   = true;
 					mix_all = true;
 					session = _channels[nr]->first();
-					in = session_packet(session, offset);
+					if (session->stopped())
+						continue;
 				}
 
-				/* skip if packet has been processed or was already played */
-				if ((!in->valid() && !mix_all) || in->played())
+				/* skip if frames have been processed or were already played */
+				bool const fresh = _fresh(session, offset);
+				if (!fresh && !(mix_all && _mixed(session, offset)))
 					continue;
 
-				_mix_packet(out, in, clear);
+				_mix_session(out, session, offset, clear);
 
 				if (verbose)
-					PDBG("mix: ch %u in %u -> out %u all %d o: %u",
-					     nr, session->stream()->packet_position(in),
-					     out_stream->packet_position(out), mix_all, offset);
+					PDBG("mix: ch %u -> out %u all %d fresh %d o: %u",
+					     nr, out_stream->packet_position(out), mix_all,
+					     fresh, offset);
 
 				clear = false;
 			}
@@ -253,6 +593,14 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 			pos[LEFT] = _out[LEFT]->stream()->pos();
 			pos[RIGHT] = _out[RIGHT]->stream()->pos();
 
+			/* take new packets from converted sessions */
+			for (int i = 0; i < MAX_CHANNELS; i++)
+				for (Session_elem *session = _channels[i]->first();
+				     session;
+				     session = session->next())
+					if (session->converter)
+						_convert(session);
+
 			/*
 			 * Look for packets that are valid, mix channels in an alternating
 			 * way.
@@ -285,18 +633,26 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 
 			while (true) {
 
-				if (!_check_active()) {
+				bool active;
+				{
+					Lock::Guard guard(_lock);
+
+					active = _check_active();
+					if (active) {
+						_mix();
+
+						/* advance position of clients */
+						_advance_position();
+					}
+				}
+
+				if (!active) {
 					_stop();
 					_sleep();
 					_start();
 					continue;
 				}
 
-				_mix();
-
-				/* advance position of clients */
-				_advance_position();
-
 				if (!_left.stream()->empty())
 					_wait_for_progress();
 				else
@@ -306,12 +662,35 @@ class Audio_out::Mixer : public Thread<1024 * sizeof(addr_t)>
 
 		void wakeup() { _sleep_lock.unlock(); }
 
+		/**
+		 * Lock protecting the channels against the mixer thread
+		 */
+		Lock &lock() { return _lock; }
+
 		/* sync client position with output position */
-		void sync_pos(Channel_number channel, Stream *stream) {
-			stream->pos(_out[channel]->stream()->pos()); }
+		void sync_pos(Channel_number channel, Session_elem *session)
+		{
+			Lock::Guard guard(_lock);
+
+			unsigned const pos = _out[channel]->stream()->pos();
+
+			session->stream()->pos(pos);
+			if (session->converter)
+				session->converter->reset(pos);
+		}
 
 		void data_recv(Signal_receiver *recv) { _data_recv = recv; }
 
+		/**
+		 * Period granted by the output, used for all client sessions
+		 */
+		unsigned period() { return _left.stream()->period(); }
+
+		/**
+		 * Sample rate of the output
+		 */
+		unsigned rate() { return _left.stream()->rate(); }
+
 		static Mixer *m()
 		{
 			static Mixer _m;
@@ -325,18 +704,55 @@ class Audio_out::Session_component : public Audio_out::Session_elem
 	private:
 
 		Channel_number _channel;
+		Allocator     *_md_alloc;
 
 	public:
 
+		/**
+		 * Constructor
+		 *
+		 * \param converter  converter allocated from 'md_alloc' for sessions
+		 *                   with another sample rate or period than the
+		 *                   output, or 0, its filter is released with the
+		 *                   session
+		 * \param period     period granted to the session
+		 * \param rate       sample rate of the session
+		 */
 		Session_component(Channel_number            channel,
-		                  Signal_context_capability data_cap)
-		: Session_elem(data_cap), _channel(channel) { }
+		                  Signal_context_capability data_cap,
+		                  float                     gain,
+		                  Converter                *converter,
+		                  unsigned                  period,
+		                  unsigned                  rate,
+		                  Format                    format,
+		                  Allocator                *md_alloc)
+		:
+			Session_elem(data_cap, gain, converter),
+			_channel(channel), _md_alloc(md_alloc)
+		{
+			stream()->period(period);
+			stream()->rate(rate);
+			stream()->format(format);
+		}
+
+		~Session_component()
+		{
+			Lock::Guard guard(Mixer::m()->lock());
+
+			_channels[_channel]->remove(this);
+
+			if (converter) {
+				Resampler::Filter const &filter = converter->filter();
+				destroy(_md_alloc, converter);
+				release_filter(filter);
+			}
+		}
 
 		void start()
 		{
 			Session_rpc_object::start();
 			/* sync audio position with mixer */
-			Mixer::m()->sync_pos(_channel, stream());
+			Mixer::m()->sync_pos(_channel, this);
 			Mixer::m()->wakeup();
 		}
 };
@@ -360,7 +776,42 @@ class Audio_out::Root : public Audio_out::Root_component
 		size_t ram_quota =
 		Arg_string::find_arg(args, "ram_quota"  ).ulong_value(0);
 
-		size_t session_size = align_addr(sizeof(Session_component), 12);
+		/*
+		 * Sessions with another sample rate than the output are resampled,
+		 * unsupported rates are replaced by the rate of the output.
+		 */
+		unsigned const out_rate = Mixer::m()->rate();
+		unsigned long rate =
+			Arg_string::find_arg(args, "rate").ulong_value(out_rate);
+
+		if (rate != out_rate && !Resampler::Filter::supported(rate, out_rate)) {
+			PWRN("unsupported sample rate %lu, using %u", rate, out_rate);
+			rate = out_rate;
+		}
+
+		/*
+		 * The requested period is granted. Sessions with another period
+		 * than the output are buffered by a converter like resampled
+		 * sessions.
+		 */
+		unsigned const out_period = Mixer::m()->period();
+		unsigned long period =
+			Arg_string::find_arg(args, "period").ulong_value(out_period);
+		period = max(min(period, (unsigned long)PERIOD),
+		             (unsigned long)MIN_PERIOD);
+
+		bool const convert = rate != out_rate || period != out_period;
+
+		char format_name[8];
+		Arg_string::find_arg(args, "format").string(format_name,
+		                                            sizeof(format_name),
+		                                            "f32");
+		Format const format = format_from_name(format_name);
+
+		/* a shared filter is accounted to each session using it */
+		size_t session_size = align_addr(sizeof(Session_component), 12)
+		                    + (convert ? sizeof(Converter)
+		                               + Filter_elem::size(rate, out_rate) : 0);
 
 		if ((ram_quota < session_size) ||
 		    (sizeof(Stream) > ram_quota - session_size)) {
@@ -373,10 +824,27 @@ class Audio_out::Root : public Audio_out::Root_component
 		if (ch < 0)
 			throw Root::Invalid_args();
 
+		/* volume in percent */
+		unsigned long volume = 100;
+		try {
+			Session_policy policy(args);
+			policy.attribute("volume").value(&volume);
+		} catch (...) { }
+
+		Converter *converter = 0;
+		if (convert)
+			converter = new (md_alloc())
+			            Converter(acquire_filter(rate, out_rate), out_period, period);
+
 		Session_component *session = new (md_alloc())
-		                             Session_component((Channel_number)ch, _data_cap);
+		                             Session_component((Channel_number)ch, _data_cap,
+		                                               volume / 100.0f, converter,
+		                                               period, rate, format,
+		                                               md_alloc());
 
 		PDBG("Added new \"%s\" nr: %u s: %p",channel_name, ch, session);
+
+		Lock::Guard guard(Mixer::m()->lock());
 		_channels[ch]->insert(session);
 		return session;
 	}
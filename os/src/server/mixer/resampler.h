@@ -0,0 +1,278 @@
+/*
+ * \brief  Polyphase sample-rate converter
+ * \author Norman Feske
+ * \date   2013-03-20
+ *
+ * The conversion by the rational factor 'L/M' is done by a windowed-sinc
+ * low-pass filter that is evaluated at the 'L' phases between two input
+ * samples. The coefficients of all phases are computed once per ratio by
+ * 'Resampler::Filter'. Each output sample is the dot product of 'TAPS' input
+ * samples with the coefficients of the current phase. On x86, the dot
+ * product processes four samples at once using SSE.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _RESAMPLER_H_
+#define _RESAMPLER_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <util/string.h>
+#include <audio_out_session/audio_out_session.h>
+
+namespace Audio_out {
+
+	class Resampler;
+
+	/**
+	 * Return dot product of 'n' samples, 'n' must be a multiple of 4
+	 */
+	inline float dot(float const *a, float const *b, unsigned n)
+	{
+#ifdef __SSE__
+		typedef float V  __attribute__((vector_size(16)));
+		typedef float Vu __attribute__((vector_size(16), aligned(4)));
+
+		union { V v; float f[4]; } sum;
+		sum.v = (V){ 0, 0, 0, 0 };
+
+		for (unsigned i = 0; i < n; i += 4)
+			sum.v += *(Vu const *)(a + i) * *(Vu const *)(b + i);
+
+		return (sum.f[0] + sum.f[1]) + (sum.f[2] + sum.f[3]);
+#else
+		float sum = 0;
+		for (unsigned i = 0; i < n; i++)
+			sum += a[i]*b[i];
+
+		return sum;
+#endif
+	}
+}
+
+
+class Audio_out::Resampler
+{
+	public:
+
+		enum {
+			TAPS       = 64,    /* filter length in input samples */
+			MAX_PHASES = 512,   /* limit of the coefficient table */
+			MIN_RATE   = 8000,
+			MAX_RATE   = 96000,
+		};
+
+		/**
+		 * Coefficients for converting 'in_rate' to 'out_rate'
+		 */
+		class Filter
+		{
+			private:
+
+				Genode::Allocator *_alloc;
+
+				unsigned const _in_rate;
+				unsigned const _out_rate;
+				unsigned       _phases;   /* interpolation factor 'L' */
+				unsigned       _step;     /* decimation factor 'M' */
+				float         *_coef;     /* 'TAPS' coefficients per phase */
+
+				static unsigned _gcd(unsigned a, unsigned b) {
+					return b ? _gcd(b, a % b) : a; }
+
+				static double _sin(double x)
+				{
+					double const pi = 3.14159265358979323846;
+
+					/* reduce argument to [-pi, pi] */
+					x -= 2*pi*(long)(x/(2*pi));
+					if (x >  pi) x -= 2*pi;
+					if (x < -pi) x += 2*pi;
+
+					double term = x, sum = x;
+					for (int i = 1; i < 12; i++) {
+						term *= -x*x/((2*i)*(2*i + 1));
+						sum  += term;
+					}
+					return sum;
+				}
+
+				static double _cos(double x) {
+					return _sin(x + 3.14159265358979323846/2); }
+
+				/**
+				 * Low-pass impulse response with Blackman window
+				 *
+				 * \param u   distance from center in input samples
+				 * \param fc  cutoff relative to the input Nyquist frequency
+				 */
+				static double _impulse(double u, double fc)
+				{
+					double const pi   = 3.14159265358979323846;
+					double const half = TAPS/2;
+
+					if (u <= -half || u >= half)
+						return 0;
+
+					double const w = 0.42 + 0.5*_cos(pi*u/half)
+					                      + 0.08*_cos(2*pi*u/half);
+
+					double const x = pi*fc*u;
+					return w*fc*(x == 0 ? 1 : _sin(x)/x);
+				}
+
+			public:
+
+				Filter(Genode::Allocator *alloc, unsigned in_rate,
+				       unsigned out_rate)
+				:
+					_alloc(alloc), _in_rate(in_rate), _out_rate(out_rate),
+					_phases(out_rate/_gcd(in_rate, out_rate)),
+					_step(in_rate/_gcd(in_rate, out_rate)),
+					_coef((float *)alloc->alloc(_phases*TAPS*sizeof(float)))
+				{
+					/*
+					 * Cut off below the lower of both Nyquist frequencies,
+					 * leaving room for the transition band of the filter
+					 */
+					double const fc = 0.92*(out_rate < in_rate
+					                        ? (double)out_rate/in_rate : 1.0);
+
+					/*
+					 * Phase 'p' computes the output sample located 'p/L'
+					 * input samples behind the center of the filter.
+					 */
+					double const center = TAPS/2 - 1;
+					for (unsigned p = 0; p < _phases; p++) {
+						float *c   = _coef + p*TAPS;
+						double sum = 0;
+						for (unsigned k = 0; k < TAPS; k++) {
+							double const h = _impulse(center + (double)p/_phases - k, fc);
+							c[k] = h;
+							sum += h;
+						}
+
+						/* normalize to unity gain at DC */
+						for (unsigned k = 0; k < TAPS; k++)
+							c[k] /= sum;
+					}
+				}
+
+				~Filter() { _alloc->free(_coef, _phases*TAPS*sizeof(float)); }
+
+				/**
+				 * Return size of the coefficients allocated for a filter
+				 */
+				static Genode::size_t coef_size(unsigned in_rate, unsigned out_rate) {
+					return out_rate/_gcd(in_rate, out_rate)*TAPS*sizeof(float); }
+
+				/**
+				 * Return true if conversion between the rates is supported
+				 */
+				static bool supported(unsigned in_rate, unsigned out_rate)
+				{
+					if (in_rate < MIN_RATE || in_rate > MAX_RATE)
+						return false;
+
+					return out_rate/_gcd(in_rate, out_rate) <= MAX_PHASES;
+				}
+
+				unsigned in_rate()  const { return _in_rate; }
+				unsigned out_rate() const { return _out_rate; }
+				unsigned phases()   const { return _phases; }
+				unsigned step()     const { return _step; }
+
+				float const *coef(unsigned phase) const {
+					return _coef + phase*TAPS; }
+		};
+
+	private:
+
+		Filter const &_filter;
+
+		unsigned _phase;              /* current phase */
+		unsigned _pos;                /* start of the next output in '_buf' */
+		unsigned _avail;              /* number of samples in '_buf' */
+		float    _buf[TAPS + PERIOD]; /* history and pending input */
+
+	public:
+
+		Resampler(Filter const &filter) : _filter(filter) { reset(); }
+
+		/**
+		 * Discard history
+		 *
+		 * The history is initialized with silence such that the first output
+		 * sample corresponds to the first input sample.
+		 */
+		void reset()
+		{
+			_phase = 0;
+			_pos   = 0;
+			_avail = TAPS/2 - 1;
+			Genode::memset(_buf, 0, sizeof(_buf));
+		}
+
+		/**
+		 * Return maximum number of output samples for 'n' input samples
+		 */
+		unsigned max_output(unsigned n) const {
+			return (n + 1)*_filter.phases()/_filter.step() + 1; }
+
+		/**
+		 * Convert samples
+		 *
+		 * \param in   input samples
+		 * \param n    number of input samples, at most 'PERIOD'
+		 * \param out  destination with room for 'max_output(n)' samples
+		 *
+		 * \return  number of output samples
+		 *
+		 * If both rates are equal, the samples are copied unfiltered.
+		 */
+		unsigned process(float const *in, unsigned n, float *out)
+		{
+			unsigned const phases = _filter.phases();
+			unsigned const step   = _filter.step();
+
+			if (phases == step) {
+				Genode::memcpy(out, in, n*sizeof(float));
+				return n;
+			}
+
+			Genode::memcpy(_buf + _avail, in, n*sizeof(float));
+			_avail += n;
+
+			unsigned pos = _pos, cnt = 0;
+			while (pos + TAPS <= _avail) {
+				out[cnt++] = dot(_buf + pos, _filter.coef(_phase), TAPS);
+
+				_phase += step;
+				pos    += _phase/phases;
+				_phase %= phases;
+			}
+
+			/*
+			 * Keep the samples needed for the next output. When decimating,
+			 * the next output may start beyond the available samples.
+			 */
+			if (pos < _avail) {
+				Genode::memmove(_buf, _buf + pos, (_avail - pos)*sizeof(float));
+				_avail -= pos;
+				_pos    = 0;
+			} else {
+				_pos   = pos - _avail;
+				_avail = 0;
+			}
+
+			return cnt;
+		}
+};
+
+#endif /* _RESAMPLER_H_ */
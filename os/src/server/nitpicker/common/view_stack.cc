@@ -11,7 +11,9 @@
  * under the terms of the GNU General Public License version 2.
  */
 
+#include <base/env.h>
 #include <base/printf.h>
+#include <util/string.h>
 
 #include "view_stack.h"
 #include "clip_guard.h"
@@ -191,65 +193,109 @@ void View_stack::_place_labels(Rect rect)
 			view->label_pos(Point(x, best.y1()));
 
 			/* refresh old and new label positions */
-			refresh_view(view, view, old);
-			refresh_view(view, view, view->label_rect());
+			refresh_view(view, old);
+			refresh_view(view, view->label_rect());
 		}
 }
 
 
-void View_stack::draw_rec(View *view, View *dst_view, Session *exclude, Rect rect)
+View_stack::~View_stack()
 {
-	Rect clipped;
+	if (_ops)
+		Genode::env()->heap()->free(_ops, _max_ops*sizeof(Draw_op));
+}
 
-	/* find next view that intersects with the current clipping rectangle */
-	for ( ; view && !(clipped = Rect::intersect(_outline(view), rect)).valid(); )
-		view = _next_view(view);
 
-	/* check if we hit the bottom of the view stack */
-	if (!view) return;
+void View_stack::_push(Draw_op const &op)
+{
+	if (_num_ops == _max_ops) {
 
-	Rect top, left, right, bottom;
-	rect.cut(clipped, &top, &left, &right, &bottom);
+		unsigned const new_max = _max_ops ? 2*_max_ops : 64;
 
-	View *next = _next_view(view);
+		Draw_op *new_ops = (Draw_op *)Genode::env()->heap()->alloc(new_max*sizeof(Draw_op));
 
-	/* draw areas at the top/left of the current view */
-	if (next && top.valid())  draw_rec(next, dst_view, exclude, top);
-	if (next && left.valid()) draw_rec(next, dst_view, exclude, left);
+		if (_ops) {
+			Genode::memcpy(new_ops, _ops, _num_ops*sizeof(Draw_op));
+			Genode::env()->heap()->free(_ops, _max_ops*sizeof(Draw_op));
+		}
 
-	/* draw current view */
-	if (!dst_view || (dst_view == view) || view->transparent()) {
+		_ops     = new_ops;
+		_max_ops = new_max;
+	}
 
-		Clip_guard clip_guard(_canvas, clipped);
+	_ops[_num_ops++] = op;
+}
 
-		/* draw background if view is transparent */
-		if (view->session()->uses_alpha())
-			draw_rec(_next_view(view), 0, 0, clipped);
 
-		view->frame(_canvas, _mode);
+void View_stack::draw_views(View *view, Rect rect)
+{
+	/*
+	 * The function may be called recursively by views that draw the
+	 * views behind them, e.g., the mouse cursor. So we only process the
+	 * operations pushed by the current invocation.
+	 */
+	unsigned const base = _num_ops;
+	_push(Draw_op(view, rect, false));
 
-		if (view->session() != exclude)
-			view->draw(_canvas, _mode);
-	}
+	/*
+	 * The areas produced by cutting a view out of a region are disjoint.
+	 * Hence, the order of processing them does not matter. The only
+	 * exception is the background of a transparent view, which must be
+	 * drawn before the view itself. Because the operations are processed
+	 * in LIFO order, the background is pushed after the view.
+	 */
+	while (_num_ops > base) {
+
+		Draw_op op = _ops[--_num_ops];
 
-	/* draw areas at the bottom/right of the current view */
-	if (next &&  right.valid()) draw_rec(next, dst_view, exclude, right);
-	if (next && bottom.valid()) draw_rec(next, dst_view, exclude, bottom);
+		/* draw view */
+		if (op.draw) {
+			Clip_guard clip_guard(_canvas, op.rect);
+
+			op.view->frame(_canvas, _mode);
+			op.view->draw(_canvas, _mode);
+			continue;
+		}
+
+		/* find next view that intersects with the current region */
+		view = op.view;
+		Rect clipped;
+		for ( ; view && !(clipped = Rect::intersect(_outline(view), op.rect)).valid(); )
+			view = _next_view(view);
+
+		/* check if we hit the bottom of the view stack */
+		if (!view) continue;
+
+		View *next = _next_view(view);
+
+		/* areas around the current view are covered by the views below */
+		if (next) {
+			Rect r[4];
+			op.rect.cut(clipped, &r[0], &r[1], &r[2], &r[3]);
+			for (int i = 0; i < 4; i++)
+				if (r[i].valid())
+					_push(Draw_op(next, r[i], false));
+		}
+
+		_push(Draw_op(view, clipped, true));
+
+		/* draw background if view is transparent */
+		if (next && view->session()->uses_alpha())
+			_push(Draw_op(next, clipped, false));
+	}
 }
 
 
-void View_stack::refresh_view(View *view, View *dst_view, Rect rect)
+void View_stack::refresh_view(View *view, Rect rect)
 {
 	if (!view) return;
 
 	/* clip argument agains view outline */
-	rect = Rect::intersect(rect, _outline(view));
-
-	draw_rec(_first_view(), dst_view, 0, rect);
+	mark_as_dirty(Rect::intersect(rect, _outline(view)));
 }
 
 
-void View_stack::viewport(View *view, Rect pos, Point buffer_off, bool do_redraw)
+void View_stack::viewport(View *view, Rect pos, Point buffer_off)
 {
 	Rect old = _outline(view);
 
@@ -262,15 +308,12 @@ void View_stack::viewport(View *view, Rect pos, Point buffer_off, bool do_redraw
 	if (view != _first_view())
 		_place_labels(compound);
 
-	if (!_mode->flat())
-		do_redraw = true;
-
 	/* update area on screen */
-	draw_rec(_first_view(), 0, do_redraw ? 0 : view->session(), compound);
+	mark_as_dirty(compound);
 }
 
 
-void View_stack::stack(View *view, View *neighbor, bool behind, bool do_redraw)
+void View_stack::stack(View *view, View *neighbor, bool behind)
 {
 	_views.remove(view);
 	_views.insert(view, _target_stack_position(neighbor, behind));
@@ -278,7 +321,7 @@ void View_stack::stack(View *view, View *neighbor, bool behind, bool do_redraw)
 	_place_labels(*view);
 
 	/* refresh affected screen area */
-	refresh_view(view, 0, _outline(view));
+	refresh_view(view, _outline(view));
 }
 
 
@@ -286,7 +329,7 @@ void View_stack::title(View *view, const char *title)
 {
 	view->title(title);
 	_place_labels(*view);
-	refresh_view(view, 0, _outline(view));
+	refresh_view(view, _outline(view));
 }
 
 
@@ -323,5 +366,5 @@ void View_stack::remove_view(View *view)
 	_mode->forget(view);
 
 	/* redraw area where the view was visible */
-	draw_rec(_first_view(), 0, 0, rect);
+	mark_as_dirty(rect);
 }
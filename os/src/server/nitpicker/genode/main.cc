@@ -40,6 +40,7 @@
 #include "clip_guard.h"
 #include "mouse_cursor.h"
 #include "chunky_menubar.h"
+#include "dirty_rect.h"
 
 
 /***************
@@ -78,29 +79,38 @@ extern char _binary_default_tff_start;
 Font default_font(&_binary_default_tff_start);
 
 
+/**
+ * Accumulator of screen areas to be flushed to the physical frame buffer
+ */
 class Flush_merger
 {
 	private:
 
-		Rect _to_be_flushed;
+		Dirty_rect _to_be_flushed;
 
-	public:
+		struct Refresh_fn
+		{
+			Framebuffer::Session *framebuffer;
 
-		bool defer;
+			Refresh_fn(Framebuffer::Session *framebuffer)
+			: framebuffer(framebuffer) { }
 
-		Flush_merger() : _to_be_flushed(Point(), Area(-1, -1)), defer(false) { }
+			void operator () (Rect r) {
+				framebuffer->refresh(r.x1(), r.y1(), r.w(), r.h()); }
+		};
 
-		Rect to_be_flushed() { return _to_be_flushed; }
+	public:
+
+		void merge(Rect rect) { _to_be_flushed.mark_as_dirty(rect); }
 
-		void merge(Rect rect)
+		/**
+		 * Flush dirty pixels to physical frame buffer
+		 */
+		void flush(Framebuffer::Session *framebuffer)
 		{
-			if (_to_be_flushed.valid())
-				_to_be_flushed = Rect::compound(_to_be_flushed, rect);
-			else
-				_to_be_flushed = rect;
+			Refresh_fn refresh_fn(framebuffer);
+			_to_be_flushed.flush(refresh_fn);
 		}
-
-		void reset() { _to_be_flushed = Rect(Point(), Area(-1, -1)); }
 };
 
 
@@ -290,11 +300,9 @@ namespace Framebuffer {
 	{
 		private:
 
-			::Buffer             *_buffer;
-			View_stack           *_view_stack;
-			::Session            *_session;
-			Flush_merger         *_flush_merger;
-			Framebuffer::Session *_framebuffer;
+			::Buffer   *_buffer;
+			View_stack *_view_stack;
+			::Session  *_session;
 
 		public:
 
@@ -304,11 +312,9 @@ namespace Framebuffer {
 			 * \param session  Nitpicker session
 			 */
 			Session_component(::Buffer *buffer, View_stack *view_stack,
-			                  ::Session *session, Flush_merger *flush_merger,
-			                  Framebuffer::Session *framebuffer)
+			                  ::Session *session)
 			:
-				_buffer(buffer), _view_stack(view_stack), _session(session),
-				_flush_merger(flush_merger), _framebuffer(framebuffer) { }
+				_buffer(buffer), _view_stack(view_stack), _session(session) { }
 
 			Genode::Dataspace_capability dataspace() { return _buffer->ds_cap(); }
 
@@ -324,16 +330,13 @@ namespace Framebuffer {
 
 			void refresh(int x, int y, int w, int h)
 			{
+				/*
+				 * The affected screen areas are drawn and flushed to the
+				 * physical frame buffer with the next frame. So a burst
+				 * of refresh calls results in drawing each pixel once.
+				 */
 				_view_stack->update_session_views(_session,
 				                                  Rect(Point(x, y), Area(w, h)));
-
-				/* flush dirty pixels to physical frame buffer */
-				if (_flush_merger->defer == false) {
-					Rect r = _flush_merger->to_be_flushed();
-					_framebuffer->refresh(r.x1(), r.y1(), r.w(), r.h());
-					_flush_merger->reset();
-				}
-				_flush_merger->defer = true;
 			}
 	};
 }
@@ -375,8 +378,13 @@ class View_component : public Genode::List<View_component>::Element,
 			/* transpose y position by vertical session offset */
 			y += _view.session()->v_offset();
 
+			/*
+			 * The 'redraw' argument is not needed because the screen
+			 * is updated not before the next frame, which gives the
+			 * client the chance to refresh its buffer.
+			 */
 			_view_stack->viewport(&_view, Rect(Point(x, y), Area(w, h)),
-			                              Point(buf_x, buf_y), redraw);
+			                              Point(buf_x, buf_y));
 			return 0;
 		}
 
@@ -386,7 +394,7 @@ class View_component : public Genode::List<View_component>::Element,
 
 			::View *neighbor_view = nvc ? nvc->view() : 0;
 
-			_view_stack->stack(&_view, neighbor_view, behind, redraw);
+			_view_stack->stack(&_view, neighbor_view, behind);
 			return 0;
 		}
 
@@ -440,8 +448,6 @@ namespace Nitpicker {
 			                  Texture                *texture,
 			                  View_stack             *view_stack,
 			                  Genode::Rpc_entrypoint *ep,
-			                  Flush_merger           *flush_merger,
-			                  Framebuffer::Session   *framebuffer,
 			                  int                     v_offset,
 			                  unsigned char          *input_mask,
 			                  bool                    provides_default_bg,
@@ -449,7 +455,7 @@ namespace Nitpicker {
 			                  bool                    stay_top)
 			:
 				::Session(name, texture, v_offset, color, input_mask, stay_top),
-				_framebuffer_session_component(buffer, view_stack, this, flush_merger, framebuffer),
+				_framebuffer_session_component(buffer, view_stack, this),
 				_ep(ep), _view_stack(view_stack),
 				_framebuffer_session_cap(_ep->manage(&_framebuffer_session_component)),
 				_input_session_cap(_ep->manage(&_input_session_component)),
@@ -554,11 +560,9 @@ namespace Nitpicker {
 	{
 		private:
 
-			Area                  _scr_size;
-			View_stack           *_view_stack;
-			Flush_merger         *_flush_merger;
-			Framebuffer::Session *_framebuffer;
-			int                   _default_v_offset;
+			Area        _scr_size;
+			View_stack *_view_stack;
+			int         _default_v_offset;
 
 		protected:
 
@@ -598,7 +602,7 @@ namespace Nitpicker {
 
 				return new (md_alloc())
 				       Session_component(label_buf, cdt, cdt, _view_stack, ep(),
-				                         _flush_merger, _framebuffer, v_offset,
+				                         v_offset,
 				                         cdt->input_mask_buffer(),
 				                         provides_default_bg, session_color(args),
 				                         stay_top);
@@ -620,16 +624,85 @@ namespace Nitpicker {
 			 */
 			Root(Genode::Rpc_entrypoint *session_ep, Area scr_size,
 			     View_stack *view_stack, Genode::Allocator *md_alloc,
-			     Flush_merger *flush_merger,
-			     Framebuffer::Session *framebuffer, int default_v_offset)
+			     int default_v_offset)
 			:
 				Genode::Root_component<Session_component>(session_ep, md_alloc),
-				_scr_size(scr_size), _view_stack(view_stack), _flush_merger(flush_merger),
-				_framebuffer(framebuffer), _default_v_offset(default_v_offset) { }
+				_scr_size(scr_size), _view_stack(view_stack),
+				_default_v_offset(default_v_offset) { }
 	};
 }
 
 
+/**********************
+ ** Frame statistics **
+ **********************/
+
+/**
+ * Statistics about the drawn frames, printed periodically
+ */
+class Frame_stats
+{
+	private:
+
+		enum { REPORT_INTERVAL_MS = 5000 };
+
+		bool          _enabled;
+		unsigned long _last_report_ms;
+		unsigned long _ticks;      /* number of periodic ticks         */
+		unsigned long _frames;     /* number of ticks that drew pixels */
+		unsigned long _pixels;     /* number of drawn pixels           */
+		unsigned long _draw_ms;    /* accumulated drawing time         */
+		unsigned long _max_ms;     /* longest frame                    */
+
+		void _reset()
+		{
+			_ticks = _frames = _pixels = _draw_ms = _max_ms = 0;
+		}
+
+	public:
+
+		Frame_stats(bool enabled) : _enabled(enabled), _last_report_ms(0)
+		{
+			_reset();
+		}
+
+		bool enabled() const { return _enabled; }
+
+		/**
+		 * Account periodic tick
+		 *
+		 * \param pixels   number of pixels drawn during the tick
+		 * \param draw_ms  time spent for drawing and flushing
+		 * \param now_ms   current time
+		 */
+		void tick(unsigned long pixels, unsigned long draw_ms, unsigned long now_ms)
+		{
+			if (!_enabled) return;
+
+			_ticks++;
+			if (pixels) {
+				_frames++;
+				_pixels  += pixels;
+				_draw_ms += draw_ms;
+				_max_ms   = Genode::max(_max_ms, draw_ms);
+			}
+
+			if (now_ms - _last_report_ms < REPORT_INTERVAL_MS)
+				return;
+
+			Genode::printf("frames: %lu of %lu ticks, %lu pixels/frame, "
+			               "draw time avg=%lu.%02lu ms max=%lu ms\n",
+			               _frames, _ticks, _frames ? _pixels/_frames : 0,
+			               _frames ? _draw_ms/_frames : 0,
+			               _frames ? (_draw_ms*100/_frames) % 100 : 0,
+			               _max_ms);
+
+			_last_report_ms = now_ms;
+			_reset();
+		}
+};
+
+
 /*******************
  ** Input handler **
  *******************/
@@ -654,6 +727,7 @@ class Input_handler_component : public Genode::Rpc_object<Input_handler,
 		Input::Event         *_ev_buf;
 		Framebuffer::Session *_framebuffer;
 		Timer::Session       *_timer;
+		Frame_stats           _frame_stats;
 
 	public:
 
@@ -664,13 +738,14 @@ class Input_handler_component : public Genode::Rpc_object<Input_handler,
 		                        Area mouse_size, Flush_merger *flush_merger,
 		                        Input::Session *input,
 		                        Framebuffer::Session *framebuffer,
-		                        Timer::Session *timer)
+		                        Timer::Session *timer, bool frame_stats)
 		:
 			_user_state(user_state), _mouse_cursor(mouse_cursor),
 			_mouse_size(mouse_size), _flush_merger(flush_merger),
 			_input(input),
 			_ev_buf(Genode::env()->rm_session()->attach(_input->dataspace())),
-			_framebuffer(framebuffer), _timer(timer)
+			_framebuffer(framebuffer), _timer(timer),
+			_frame_stats(frame_stats)
 		{ }
 
 		/**
@@ -764,17 +839,25 @@ class Input_handler_component : public Genode::Rpc_object<Input_handler,
 					if (_mouse_cursor)
 						_user_state->viewport(_mouse_cursor,
 					                      Rect(new_mouse_pos, _mouse_size),
-					                      Point(), true);
+					                      Point());
 				}
 
-				/* flush dirty pixels to physical frame buffer */
-				if (_flush_merger->defer == false) {
-					Rect r = _flush_merger->to_be_flushed();
-					if (r.valid())
-						_framebuffer->refresh(r.x1(), r.y1(), r.w(), r.h());
-					_flush_merger->reset();
+				/*
+				 * Draw the areas that were marked as dirty since the last
+				 * tick and flush them to the physical frame buffer
+				 */
+				bool const stats = _frame_stats.enabled();
+
+				unsigned long const start_ms = stats ? _timer->elapsed_ms() : 0;
+
+				unsigned long const pixels = _user_state->draw_dirty();
+				_flush_merger->flush(_framebuffer);
+
+				/* query the timer only if the statistics are needed */
+				if (stats) {
+					unsigned long const now_ms = _timer->elapsed_ms();
+					_frame_stats.tick(pixels, now_ms - start_ms, now_ms);
 				}
-				_flush_merger->defer = false;
 
 				/*
 				 * In kill mode, we never leave the dispatch function to block
@@ -903,7 +986,6 @@ int main(int argc, char **argv)
 
 	static Nitpicker::Root<PT> np_root(&ep, Area(mode.width(), mode.height()),
 	                                   &user_state, &sliced_heap,
-	                                   &screen, &framebuffer,
 	                                   menubar_height);
 
 	env()->parent()->announce(ep.manage(&np_root));
@@ -918,7 +1000,8 @@ int main(int argc, char **argv)
 	 */
 	static Input_handler_component
 		input_handler(&user_state, &mouse_cursor, mouse_size,
-		              &screen, &input, &framebuffer, &timer);
+		              &screen, &input, &framebuffer, &timer,
+		              read_config_param("frame_stats", false));
 	Capability<Input_handler> input_handler_cap = ep.manage(&input_handler);
 
 	/* start periodic mode of operation */
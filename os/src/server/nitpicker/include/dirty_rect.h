@@ -0,0 +1,130 @@
+/*
+ * \brief  Accumulator of dirty screen areas
+ * \author Norman Feske
+ * \date   2013-03-07
+ *
+ * Screen updates are not drawn immediately but collected until the next
+ * frame is drawn. Overlapping and adjacent rectangles are merged. So the
+ * accumulated rectangles are disjoint and each pixel is drawn at most once
+ * per frame. The number of rectangles is bounded. If no slot is left, the
+ * new rectangle is merged with the one that adds the fewest pixels.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _DIRTY_RECT_H_
+#define _DIRTY_RECT_H_
+
+#include <nitpicker_gfx/geometry.h>
+
+class Dirty_rect
+{
+	public:
+
+		enum { MAX_RECTS = 8 };
+
+	private:
+
+		Rect     _rects[MAX_RECTS];
+		unsigned _num_rects;
+
+		static long _area(Rect r) { return (long)r.w()*r.h(); }
+
+		/**
+		 * Return number of pixels that merging 'r1' and 'r2' adds
+		 *
+		 * The result is negative if the rectangles overlap and the
+		 * compound does not cover more pixels than both rectangles.
+		 */
+		static long _merge_cost(Rect r1, Rect r2) {
+			return _area(Rect::compound(r1, r2)) - _area(r1) - _area(r2); }
+
+		void _remove(unsigned i) { _rects[i] = _rects[--_num_rects]; }
+
+	public:
+
+		Dirty_rect() : _num_rects(0) { }
+
+		/**
+		 * Add rectangle to the dirty area
+		 */
+		void mark_as_dirty(Rect rect)
+		{
+			if (!rect.valid())
+				return;
+
+			for (;;) {
+
+				/*
+				 * Absorb overlapping rectangles to keep the rectangles
+				 * disjoint, and those that can be merged without extra
+				 * cost
+				 */
+				bool merged = false;
+				for (unsigned i = 0; i < _num_rects; )
+					if (Rect::intersect(_rects[i], rect).valid()
+					 || _merge_cost(_rects[i], rect) <= 0) {
+						rect = Rect::compound(_rects[i], rect);
+						_remove(i);
+						merged = true;
+					} else {
+						i++;
+					}
+
+				/* the compound may now overlap other rectangles */
+				if (merged)
+					continue;
+
+				if (_num_rects < MAX_RECTS) {
+					_rects[_num_rects++] = rect;
+					return;
+				}
+
+				/* no free slot, merge with the cheapest rectangle */
+				unsigned best = 0;
+				for (unsigned i = 1; i < _num_rects; i++)
+					if (_merge_cost(_rects[i], rect) < _merge_cost(_rects[best], rect))
+						best = i;
+
+				rect = Rect::compound(_rects[best], rect);
+				_remove(best);
+			}
+		}
+
+		/**
+		 * Return true if nothing was marked as dirty
+		 */
+		bool empty() const { return _num_rects == 0; }
+
+		/**
+		 * Return number of dirty pixels
+		 */
+		unsigned long num_pixels() const
+		{
+			unsigned long sum = 0;
+			for (unsigned i = 0; i < _num_rects; i++)
+				sum += _area(_rects[i]);
+			return sum;
+		}
+
+		/**
+		 * Call functor for each dirty rectangle and reset the dirty area
+		 *
+		 * \param fn  functor called with the rectangle as argument
+		 */
+		template <typename FN>
+		void flush(FN &fn)
+		{
+			for (unsigned i = 0; i < _num_rects; i++)
+				fn(_rects[i]);
+
+			_num_rects = 0;
+		}
+};
+
+#endif
@@ -58,7 +58,7 @@ class Mouse_cursor : public Chunky_texture<PT>, public Session, public View
 			Clip_guard clip_guard(canvas, *this);
 
 			/* draw area behind the mouse cursor */
-			_view_stack->draw_rec(view_stack_next(), 0, 0, *this);
+			_view_stack->draw_views(view_stack_next(), *this);
 
 			/* draw mouse cursor */
 			canvas->draw_texture(this, BLACK, p1(), Canvas::MASKED);
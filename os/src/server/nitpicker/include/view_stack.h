@@ -15,6 +15,7 @@
 #define _VIEW_STACK_H_
 
 #include "view.h"
+#include "dirty_rect.h"
 
 class Session;
 
@@ -26,6 +27,49 @@ class View_stack
 		Mode                  *_mode;
 		List<View_stack_elem>  _views;
 		View                  *_default_background;
+		Dirty_rect             _dirty_rect;
+
+		/**
+		 * Pending operation of the iterative drawing algorithm
+		 *
+		 * A region operation draws all views from 'view' downwards that
+		 * intersect 'rect'. A draw operation draws 'view' clipped to
+		 * 'rect'.
+		 */
+		struct Draw_op
+		{
+			View *view;
+			Rect  rect;
+			bool  draw;
+
+			Draw_op(View *view, Rect rect, bool draw)
+			: view(view), rect(rect), draw(draw) { }
+
+			Draw_op() : view(0), draw(false) { }
+		};
+
+		/*
+		 * Explicit stack of pending operations, replacing the former
+		 * recursion. It grows on demand and is kept for later use.
+		 */
+		Draw_op  *_ops;
+		unsigned  _num_ops;
+		unsigned  _max_ops;
+
+		void _push(Draw_op const &op);
+
+		/**
+		 * Functor used to draw the dirty rectangles
+		 */
+		struct Draw_fn
+		{
+			View_stack *view_stack;
+
+			Draw_fn(View_stack *view_stack) : view_stack(view_stack) { }
+
+			void operator () (Rect rect) {
+				view_stack->draw_views(view_stack->_first_view(), rect); }
+		};
 
 		/**
 		 * Return outline geometry of a view
@@ -67,7 +111,10 @@ class View_stack
 		 * Constructor
 		 */
 		View_stack(Canvas *canvas, Mode *mode) :
-			_canvas(canvas), _mode(mode), _default_background(0) { }
+			_canvas(canvas), _mode(mode), _default_background(0),
+			_ops(0), _num_ops(0), _max_ops(0) { }
+
+		~View_stack();
 
 		/**
 		 * Return size
@@ -75,14 +122,32 @@ class View_stack
 		Area size() { return _canvas->size(); }
 
 		/**
-		 * Draw views in specified area (recursivly)
+		 * Draw views in specified area
+		 *
+		 * \param view  first view of the view stack to consider
+		 */
+		void draw_views(View *view, Rect rect);
+
+		/**
+		 * Mark screen area to be redrawn with the next frame
+		 */
+		void mark_as_dirty(Rect rect) {
+			_dirty_rect.mark_as_dirty(Rect::intersect(rect, Rect(Point(), size()))); }
+
+		/**
+		 * Draw all areas that were marked as dirty
 		 *
-		 * \param view      current view in view stack
-		 * \param dst_view  desired view to draw or NULL
-		 *                  if all views should be drawn
-		 * \param exclude   do not draw views of this session
+		 * \return  number of drawn pixels
 		 */
-		void draw_rec(View *view, View *dst_view, Session *exclude, Rect);
+		unsigned long draw_dirty()
+		{
+			unsigned long const num_pixels = _dirty_rect.num_pixels();
+
+			Draw_fn draw_fn(this);
+			_dirty_rect.flush(draw_fn);
+
+			return num_pixels;
+		}
 
 		/**
 		 * Draw whole view stack
@@ -90,7 +155,7 @@ class View_stack
 		void update_all_views()
 		{
 			_place_labels(Rect(Point(), _canvas->size()));
-			draw_rec(_first_view(), 0, 0, Rect(Point(), _canvas->size()));
+			mark_as_dirty(Rect(Point(), _canvas->size()));
 		}
 
 		/**
@@ -99,11 +164,7 @@ class View_stack
 		 * \param Session *  Session that created the view
 		 * \param Rect       Buffer area to update
 		 *
-		 * Note: For now, we perform an independent view-stack traversal
-		 *       for each view when calling 'refresh_view'. This becomes
-		 *       a potentially high overhead with many views. Having
-		 *       a tailored 'draw_rec_session' function would overcome
-		 *       this problem.
+		 * The affected screen areas are drawn with the next frame.
 		 */
 		void update_session_views(Session *session, Rect rect)
 		{
@@ -119,7 +180,7 @@ class View_stack
 				Point offset = view->p1() + view->buffer_off();
 				Rect r = Rect::intersect(Rect(rect.p1() + offset,
 				                              rect.p2() + offset), *view);
-				refresh_view(view, view, r);
+				refresh_view(view, r);
 			}
 		}
 
@@ -127,20 +188,16 @@ class View_stack
 		 * Refresh area within a view
 		 *
 		 * \param view  view that should be updated on screen
-		 * \param dst   NULL if all views in the specified area should be
-		 *              refreshed or 'view' if the refresh should be limited to
-		 *              the specified view.
 		 */
-		void refresh_view(View *view, View *dst, Rect);
+		void refresh_view(View *view, Rect);
 
 		/**
 		 * Define position and viewport
 		 *
 		 * \param pos         position of view on screen
 		 * \param buffer_off  view offset of displayed buffer
-		 * \param do_redraw   perform screen update immediately
 		 */
-		void viewport(View *view, Rect pos, Point buffer_off, bool do_redraw);
+		void viewport(View *view, Rect pos, Point buffer_off);
 
 		/**
 		 * Insert view at specified position in view stack
@@ -153,8 +210,7 @@ class View_stack
 		 * bottom of the view stack, specify neighbor = 0 and
 		 * behind = false.
 		 */
-		void stack(View *view, View *neighbor = 0, bool behind    = true,
-		                                           bool do_redraw = true);
+		void stack(View *view, View *neighbor = 0, bool behind = true);
 
 		/**
 		 * Set view title
@@ -12,23 +12,24 @@
  */
 #include <base/allocator_avl.h>
 #include <base/semaphore.h>
+#include <base/thread.h>
 #include <block_session/connection.h>
 #include "part_blk.h"
 
 using namespace Genode;
 
-/**
- * Used to block until a packet has been freed
- */
-static Semaphore _alloc_sem(0);
-
 namespace Partition {
 
+	enum {
+		MAX_REQUESTS = 64, /* back-end packets in flight, below the queue size */
+		MAX_JOBS     = 64, /* client packets in flight */
+	};
+
 	size_t _blk_cnt;
 	size_t _blk_size;
 
 	Allocator_avl        _block_alloc(env()->heap());
-	Block::Connection    _blk(&_block_alloc, 4 * MAX_PACKET_SIZE);
+	Block::Connection    _blk(&_block_alloc, 8 * MAX_PACKET_SIZE);
 
 	Partition           *_part_list[MAX_PARTITIONS]; /* contains pointers to valid partittions or 0 */
 
@@ -72,6 +73,12 @@ namespace Partition {
 	} __attribute__((packed));
 
 
+	/**
+	 * Synchronous access to the back end
+	 *
+	 * Used for parsing the partition tables only, before the ack thread
+	 * is started.
+	 */
 	class Sector
 	{
 		private:
@@ -100,10 +107,6 @@ namespace Partition {
 				_blk.tx()->submit_packet(_p);
 				_p = _blk.tx()->get_acked_packet();
 
-				/* unblock clients that possibly wait for packet stream allocations */
-				if (_alloc_sem.cnt() < 0)
-					_alloc_sem.up();
-
 				if (!_p.succeeded()) {
 					PERR("Could not access block %zu", _p.block_number());
 					throw Io_error();
@@ -179,66 +182,308 @@ namespace Partition {
 	}
 
 
-	void init()
+	/*******************************
+	 ** Asynchronous request path **
+	 *******************************/
+
+	/*
+	 * A client packet is forwarded as one or more back-end requests, each
+	 * covering at most 'max_packets()' blocks. The job of a client packet
+	 * is completed when the last of its requests is acknowledged by the
+	 * back end. Back-end acknowledgements are matched to their requests by
+	 * the offset of the back-end packet, which is unique among the packets
+	 * in flight.
+	 */
+
+	/**
+	 * Client packet in flight
+	 */
+	class Job
 	{
-		Block::Session::Operations ops;
+		private:
 
-		/* device info */
-		_blk.info(&_blk_cnt, &_blk_size, &ops);
+			Client                   *_client;
+			Block::Packet_descriptor  _packet;
+			unsigned                  _refs;   /* requests plus submission */
+			bool                      _failed;
 
-		/* read MBR */
-		Sector s(0, 1);
-		s.submit_request();
-		parse_mbr(s.addr<Mbr *>());
+		public:
+
+			void init(Client *client, Block::Packet_descriptor packet)
+			{
+				_client = client;
+				_packet = packet;
+				_refs   = 1;
+				_failed = false;
+			}
+
+			void ref()   { _refs++; }
+			bool unref() { return --_refs == 0; }
+			void fail()  { _failed = true; }
+
+			/**
+			 * Acknowledge client packet and free job
+			 *
+			 * Called after the last reference was dropped.
+			 */
+			void complete();
+	};
+
+
+	/**
+	 * Back-end packet in flight
+	 */
+	struct Request
+	{
+		Job                      *job;
+		Block::Packet_descriptor  packet;  /* back-end packet */
+		char                     *dst;     /* client buffer of read request */
+	};
+
+
+	/*
+	 * The lock protects the request and job slots as well as the packet
+	 * allocator and the submit queue of the back-end connection. The
+	 * acknowledgement queue is accessed by the ack thread only.
+	 */
+	static Lock      _lock;
+	static Request   _requests[MAX_REQUESTS];
+	static Job       _jobs[MAX_JOBS];
+	static Request  *_free_requests[MAX_REQUESTS];
+	static Job      *_free_jobs[MAX_JOBS];
+	static unsigned  _num_free_requests, _num_free_jobs;
+	static Semaphore _request_sem(MAX_REQUESTS);
+	static Semaphore _job_sem(MAX_JOBS);
+
+	/**
+	 * Used to block until a back-end packet has been freed
+	 */
+	static Semaphore _alloc_sem(0);
+	static unsigned  _alloc_waiters;
+
+
+	void Job::complete()
+	{
+		Client *client = _client;
+
+		/* acknowledge packet to the client */
+		_packet.succeeded(!_failed);
+		client->ack(_packet);
+
+		Lock::Guard guard(_lock);
+
+		_free_jobs[_num_free_jobs++] = this;
+		_job_sem.up();
+
+		if (--client->_pending_jobs == 0 && client->_draining)
+			client->_drained.up();
 	}
 
 
-	void _io(unsigned long lba, unsigned long count, uint8_t *buf, bool write)
+	/**
+	 * Submit back-end request for part of a job
+	 *
+	 * \param write  true if the blocks at 'buf' are written to the disk,
+	 *               false if the blocks are read into 'buf'
+	 */
+	static void _submit_request(Job *job, unsigned long lba,
+	                            unsigned long count, char *buf, bool write)
 	{
-		unsigned long bytes;
+		size_t const bytes = count * _blk_size;
 
-		while (count) {
+		Block::Packet_descriptor::Opcode op = write ? Block::Packet_descriptor::WRITE
+		                                            : Block::Packet_descriptor::READ;
 
-			unsigned long curr_count = min<unsigned long>(count, max_packets());
-			bytes                    = curr_count * _blk_size;
-			bool alloc = false;
-			while (!alloc) {
+		/* wait for free request slot */
+		_request_sem.down();
+
+		Block::Packet_descriptor p;
+		for (;;) {
+			{
+				Lock::Guard guard(_lock);
 				try {
-					Sector sec(lba, curr_count, write);
-		
-					if (!write) {
-						sec.submit_request();
-						memcpy(buf, sec.addr<void *>(), bytes);
+					p = Block::Packet_descriptor(_blk.dma_alloc_packet(bytes), op, lba, count);
+					break;
+				} catch (Block::Session::Tx::Source::Packet_alloc_failed) {
+					_alloc_waiters++;
+				}
+			}
+
+			/* block until the ack thread released a packet */
+			_alloc_sem.down();
+		}
+
+		if (write)
+			memcpy(_blk.tx()->packet_content(p), buf, bytes);
+
+		Lock::Guard guard(_lock);
+
+		Request *r = _free_requests[--_num_free_requests];
+		r->job    = job;
+		r->packet = p;
+		r->dst    = write ? 0 : buf;
+		job->ref();
+
+		/* the submit queue cannot be full because of 'MAX_REQUESTS' */
+		_blk.tx()->submit_packet(p);
+	}
+
+
+	/**
+	 * Thread that processes the acknowledgements of the back end
+	 */
+	class Ack_thread : public Thread<8192>
+	{
+		private:
+
+			Request *_lookup(Block::Packet_descriptor p)
+			{
+				for (unsigned i = 0; i < MAX_REQUESTS; i++)
+					if (_requests[i].job && _requests[i].packet.offset() == p.offset())
+						return &_requests[i];
+				return 0;
+			}
+
+		public:
+
+			Ack_thread() : Thread<8192>("ack") { }
+
+			void entry()
+			{
+				for (;;) {
+					Block::Packet_descriptor p = _blk.tx()->get_acked_packet();
+
+					Request *r;
+					{
+						Lock::Guard guard(_lock);
+						r = _lookup(p);
 					}
-					else {
-						memcpy(sec.addr<void *>(), buf, bytes);
-						sec.submit_request();
+
+					if (!r) {
+						PWRN("received acknowledgement of unknown packet");
+						continue;
 					}
 
-					alloc = true;
-				} catch (Block::Session::Tx::Source::Packet_alloc_failed) {
-					/* block */
-					_alloc_sem.down();
+					Job *job = r->job;
+
+					if (!p.succeeded()) {
+						PERR("Could not access block %zu", p.block_number());
+						job->fail();
+					} else if (r->dst) {
+						memcpy(r->dst, _blk.tx()->packet_content(p),
+						       p.block_count() * _blk_size);
+					}
+
+					bool done;
+					{
+						Lock::Guard guard(_lock);
+
+						_blk.tx()->release_packet(p);
+						r->job = 0;
+						_free_requests[_num_free_requests++] = r;
+
+						/* unblock submitters waiting for packet allocations */
+						if (_alloc_waiters) {
+							_alloc_waiters--;
+							_alloc_sem.up();
+						}
+
+						done = job->unref();
+					}
+					_request_sem.up();
+
+					if (done)
+						job->complete();
 				}
 			}
+	};
+
+
+	void submit(Client &client, Partition const &partition,
+	            Block::Packet_descriptor packet)
+	{
+		unsigned long const block_nr = packet.block_number();
+		unsigned long       count    = packet.block_count();
+		char               *buf      = client.packet_content(packet);
+		bool const          write    = packet.operation() == Block::Packet_descriptor::WRITE;
+
+		/* wait for free job slot */
+		_job_sem.down();
+
+		Job *job;
+		{
+			Lock::Guard guard(_lock);
+			job = _free_jobs[--_num_free_jobs];
+			client._pending_jobs++;
+		}
+		job->init(&client, packet);
+
+		if (!buf || packet.size() < count * _blk_size
+		 || block_nr + count > partition._sectors) {
+			PWRN("Io error!");
+			job->fail();
+			count = 0;
+		}
+
+		/* split packet into requests the back end can handle */
+		unsigned long lba = partition._lba + block_nr;
+		while (count) {
+
+			unsigned long curr_count = min<unsigned long>(count, max_packets());
+			_submit_request(job, lba, curr_count, buf, write);
 
 			lba   += curr_count;
 			count -= curr_count;
-			buf   += bytes;
+			buf   += curr_count * _blk_size;
 		}
 
-		/* zero out rest of page */
-		bytes = (count * _blk_size) % 4096;
-		if (bytes)
-			memset(buf, 0, bytes);
+		/* drop submission reference */
+		bool done;
+		{
+			Lock::Guard guard(_lock);
+			done = job->unref();
+		}
+
+		if (done)
+			job->complete();
+	}
+
+
+	void drain(Client &client)
+	{
+		{
+			Lock::Guard guard(_lock);
+			if (client._pending_jobs == 0)
+				return;
+
+			client._draining = true;
+		}
+		client._drained.down();
 	}
 
 
-	void Partition::io(unsigned long block_nr, unsigned long count, void *buf, bool write)
+	void init()
 	{
-		if (block_nr + count > _sectors)
-			throw Io_error();
+		Block::Session::Operations ops;
+
+		/* device info */
+		_blk.info(&_blk_cnt, &_blk_size, &ops);
+
+		/* read MBR */
+		{
+			Sector s(0, 1);
+			s.submit_request();
+			parse_mbr(s.addr<Mbr *>());
+		}
+
+		for (unsigned i = 0; i < MAX_REQUESTS; i++)
+			_free_requests[_num_free_requests++] = &_requests[i];
+
+		for (unsigned i = 0; i < MAX_JOBS; i++)
+			_free_jobs[_num_free_jobs++] = &_jobs[i];
 
-		_io(_lba + block_nr, count, (uint8_t *)buf, write);
+		/* from now on, acknowledgements are processed asynchronously */
+		static Ack_thread ack_thread;
+		ack_thread.start();
 	}
 }
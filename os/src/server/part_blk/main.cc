@@ -46,10 +46,18 @@ namespace Block {
 	}
 
 
-	class Session_component : public Session_rpc_object
+	class Session_component : public Session_rpc_object,
+	                          public Partition::Client
 	{
 		private:
 
+			/**
+			 * Thread that forwards the client packets to the back end
+			 *
+			 * The packets are acknowledged by the back end's ack thread once
+			 * the requests are completed. So many packets of the client can
+			 * be in flight at the same time.
+			 */
 			class Tx_thread : public Genode::Thread<8192>
 			{
 				private:
@@ -78,43 +86,25 @@ namespace Block {
 								continue;
 							}
 
-							packet.succeeded(false);
-							bool write = false;
-
 							switch (packet.operation()) {
 
 							case Block::Packet_descriptor::WRITE:
-								write  = true;
-
 							case Block::Packet_descriptor::READ:
 
-								try {
-									_session->partition()->io(packet.block_number(),
-									                          packet.block_count(),
-									                          tx_sink->packet_content(packet),
-									                          write);
-									packet.succeeded(true);
-								}
-								catch (Partition::Io_error) {
-									PWRN("Io error!");
-								}
+								Partition::submit(*_session, *_session->partition(), packet);
 								break;
 
 							default:
 								PWRN("received invalid packet");
 								continue;
 							}
-
-							/* acknowledge packet to the client */
-							if (!tx_sink->ready_to_ack())
-								PDBG("need to wait until ready-for-ack");
-							tx_sink->acknowledge_packet(packet);
 						}
 					}
 			};
 
 			struct Partition::Partition  *_partition; /* partition belonging to this session */
 			Genode::Dataspace_capability  _tx_ds;     /* buffer for tx channel */
+			Genode::Lock                  _ack_lock;  /* serializes acks of the back end */
 			Tx_thread                     _tx_thread;
 
 		public:
@@ -129,6 +119,12 @@ namespace Block {
 				_tx_thread.start();
 			}
 
+			~Session_component()
+			{
+				/* wait for the back end to complete outstanding requests */
+				Partition::drain(*this);
+			}
+
 			void info(Genode::size_t *blk_count, Genode::size_t *blk_size, Operations *ops)
 			{
 				*blk_count = _partition->_sectors;
@@ -138,6 +134,24 @@ namespace Block {
 			}
 
 			Partition::Partition *partition() { return _partition; }
+
+
+			/*********************************
+			 ** Partition::Client interface **
+			 *********************************/
+
+			char *packet_content(Block::Packet_descriptor packet) {
+				return tx_sink()->packet_content(packet); }
+
+			void ack(Block::Packet_descriptor packet)
+			{
+				Genode::Lock::Guard guard(_ack_lock);
+
+				/* acknowledge packet to the client */
+				if (!tx_sink()->ready_to_ack())
+					PDBG("need to wait until ready-for-ack");
+				tx_sink()->acknowledge_packet(packet);
+			}
 	};
 
 
@@ -15,7 +15,9 @@
 #define _PART_BLK_H_
 
 #include <base/exception.h>
+#include <base/semaphore.h>
 #include <base/stdint.h>
+#include <block_session/block_session.h>
 
 namespace Partition {
 
@@ -32,18 +34,40 @@ namespace Partition {
 
 		Partition(Genode::uint32_t lba, Genode::uint32_t sectors)
 		: _lba(lba), _sectors(sectors) { }
+	};
+
+	/**
+	 * Originator of requests, i.e., a block session
+	 */
+	class Client
+	{
+		private:
+
+			friend void submit(Client &, Partition const &, Block::Packet_descriptor);
+			friend void drain(Client &);
+			friend class Job;
+
+			unsigned          _pending_jobs;
+			bool              _draining;
+			Genode::Semaphore _drained;
+
+		public:
+
+			Client() : _pending_jobs(0), _draining(false) { }
+
+			virtual ~Client() { }
 
-		/**
-		 * Write/read blocks
-		 *
-		 * \param block_nr block number of partition to access
-		 * \param count    number of blocks to read/write
-		 * \param buf      buffer which containing the data to write or which is
-		 *                 filled by reads
-		 * \param write    true for a write operations, false for a read
-		 * \throw Io_error
-		 */
-		void io(unsigned long block_nr, unsigned long count, void *buf, bool write = false);
+			/**
+			 * Return local address of the content of a client packet
+			 *
+			 * \return  address, or 0 if the packet is invalid
+			 */
+			virtual char *packet_content(Block::Packet_descriptor packet) = 0;
+
+			/**
+			 * Acknowledge completed client packet
+			 */
+			virtual void ack(Block::Packet_descriptor packet) = 0;
 	};
 
 	/**
@@ -70,6 +94,27 @@ namespace Partition {
 	 * Returns block size of back end
 	 */
 	Genode::size_t blk_size();
+
+	/**
+	 * Forward read or write packet of a client to the back end
+	 *
+	 * \param client     originator of the packet
+	 * \param partition  partition accessed by the client
+	 * \param packet     client packet with a block number relative to
+	 *                   the partition
+	 *
+	 * The function returns as soon as the packet is submitted to the back
+	 * end. Once the back end completed the request, the packet is
+	 * acknowledged via 'client.ack'. The function blocks only if the
+	 * maximum number of requests is in flight.
+	 */
+	void submit(Client &client, Partition const &partition,
+	            Block::Packet_descriptor packet);
+
+	/**
+	 * Wait until all requests of the client are completed
+	 */
+	void drain(Client &client);
 }
 
 #endif /* _PART_BLK_H_ */
@@ -41,6 +41,7 @@ namespace Block {
 					addr_t             _dev_addr; /* rom-file address */
 					size_t             _dev_size; /* rom-file size */
 					size_t             _blk_size; /* block size */
+					bool               _writeable;
 
 				public:
 
@@ -50,11 +51,13 @@ namespace Block {
 					Tx_thread(Session_component *session,
 					          addr_t             dev_addr,
 					          size_t             dev_size,
-					          size_t             blk_size)
+					          size_t             blk_size,
+					          bool               writeable)
 					: _session(session),
 					  _dev_addr(dev_addr),
 					  _dev_size(dev_size),
-					  _blk_size(blk_size) { }
+					  _blk_size(blk_size),
+					  _writeable(writeable) { }
 
 					/**
 					 * Thread's entry function.
@@ -102,8 +105,17 @@ namespace Block {
 								}
 							case Block::Packet_descriptor::WRITE:
 								{
-									PWRN("write attempt on read-only device");
-									packet.succeeded(false);
+									if (!_writeable) {
+										PWRN("write attempt on read-only device");
+										packet.succeeded(false);
+										break;
+									}
+
+									/* copy packet payload to the RAM copy of the file */
+									memcpy((void*)(_dev_addr + offset),
+										   tx_sink->packet_content(packet),
+										   size);
+									packet.succeeded(true);
 									break;
 								}
 							default:
@@ -129,6 +141,7 @@ namespace Block {
 			Tx_thread            _tx_thread;     /* thread handling block requests */
 			size_t               _block_count;   /* count of blocks of this session */
 			size_t               _block_size;    /* size of a block */
+			bool                 _writeable;
 
 		public:
 
@@ -138,17 +151,20 @@ namespace Block {
 			 * \param tx_buf_size  buffer size for tx channel
 			 * \param dev_addr     address of attached file
 			 * \param dev_size     size of attached file
+			 * \param writeable    true if the file was copied to RAM
 			 */
 			Session_component(size_t tx_buf_size,
 			                  addr_t dev_addr,
 			                  size_t dev_size,
 			                  size_t blk_size,
+			                  bool   writeable,
 			                  Genode::Rpc_entrypoint &ep)
 			: Session_rpc_object(env()->ram_session()->alloc(tx_buf_size), ep),
 			  _startup_sema(0),
-			  _tx_thread(this, dev_addr, dev_size, blk_size),
+			  _tx_thread(this, dev_addr, dev_size, blk_size, writeable),
 			  _block_count(dev_size / blk_size),
-			  _block_size(blk_size)
+			  _block_size(blk_size),
+			  _writeable(writeable)
 			{
 				_tx_thread.start();
 
@@ -171,6 +187,8 @@ namespace Block {
 				*blk_count = _block_count;
 				*blk_size  = _block_size;
 				ops->set_operation(Block::Packet_descriptor::READ);
+				if (_writeable)
+					ops->set_operation(Block::Packet_descriptor::WRITE);
 			}
 	};
 
@@ -186,8 +204,27 @@ namespace Block {
 			addr_t                  _file_addr; /* start address of attached file */
 			size_t                  _file_sz;   /* file size */
 			size_t                  _blk_sz;    /* block size */
+			bool                    _writeable; /* file copied to RAM */
 			Genode::Rpc_entrypoint &_channel_ep;
 
+			/**
+			 * Return RAM dataspace with a copy of the file
+			 */
+			static Dataspace_capability _ram_copy(Dataspace_capability file_cap)
+			{
+				size_t const size = Dataspace_client(file_cap).size();
+
+				Dataspace_capability ram_cap = env()->ram_session()->alloc(size);
+
+				void *src = env()->rm_session()->attach(file_cap);
+				void *dst = env()->rm_session()->attach(ram_cap);
+				memcpy(dst, src, size);
+				env()->rm_session()->detach(dst);
+				env()->rm_session()->detach(src);
+
+				return ram_cap;
+			}
+
 		protected:
 
 			Session_component *_create_session(const char *args)
@@ -208,7 +245,8 @@ namespace Block {
 					throw Root::Quota_exceeded();
 				}
 				return new (md_alloc())
-					Session_component(tx_buf_size, _file_addr, _file_sz, _blk_sz, _channel_ep);
+					Session_component(tx_buf_size, _file_addr, _file_sz, _blk_sz,
+					                  _writeable, _channel_ep);
 			}
 
 		public:
@@ -219,14 +257,18 @@ namespace Block {
 			 * \param session_ep  session entrypoint
 			 * \param md_alloc    meta-data allocator
 			 * \param file_cap    capabilty of file to use as block-device
+			 * \param writeable   if true, the file is copied to RAM, which
+			 *                    takes the writes
 			 */
 			Root(Rpc_entrypoint *session_ep, Allocator *md_alloc,
-			     Dataspace_capability file_cap, size_t blk_size)
+			     Dataspace_capability file_cap, size_t blk_size,
+			     bool writeable)
 			: Root_component<Session_component>(session_ep, md_alloc),
-			  _file_cap(file_cap),
-			  _file_addr(env()->rm_session()->attach(file_cap)),
-			  _file_sz(Dataspace_client(file_cap).size()),
+			  _file_cap(writeable ? _ram_copy(file_cap) : file_cap),
+			  _file_addr(env()->rm_session()->attach(_file_cap)),
+			  _file_sz(Dataspace_client(_file_cap).size()),
 			  _blk_sz(blk_size),
+			  _writeable(writeable),
 			  _channel_ep(*session_ep) { }
 
 			~Root() { env()->rm_session()->detach((void*)_file_addr); }
@@ -238,13 +280,19 @@ namespace Block {
  * Get name of the file we want to provide as block device,
  * and the block_size.
  */
-static void process_config(char *file, size_t size, size_t *blk_size)
+static void process_config(char *file, size_t size, size_t *blk_size,
+                           bool *writeable)
 {
 	try {
 		config()->xml_node().attribute("file").value(file, size);
 		config()->xml_node().attribute("block_size").value(blk_size);
 	}
 	catch (...) { }
+
+	try {
+		*writeable = config()->xml_node().attribute("writeable").has_value("yes");
+	}
+	catch (...) { }
 }
 
 
@@ -252,17 +300,20 @@ int main()
 {
 	static char   file[64];
 	static size_t block_size = 512;
+	static bool   writeable  = false;
 
-	process_config(file, sizeof(file), &block_size);
+	process_config(file, sizeof(file), &block_size, &writeable);
 
-	PINF("Using file=%s as device with block size %zx.", file, block_size);
+	PINF("Using file=%s as %sdevice with block size %zx.", file,
+	     writeable ? "writeable " : "", block_size);
 
 	try {
 		enum { STACK_SIZE = 8192 };
 		static Cap_connection cap;
 		static Rpc_entrypoint ep(&cap, STACK_SIZE, "rom_loop_ep");
 		static Rom_connection rom(file);
-		static Block::Root blk_root(&ep, env()->heap(), rom.dataspace(), block_size);
+		static Block::Root blk_root(&ep, env()->heap(), rom.dataspace(), block_size,
+		                            writeable);
 
 		env()->parent()->announce(ep.manage(&blk_root));
 
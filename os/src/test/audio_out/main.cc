@@ -34,8 +34,6 @@ static const bool verbose = false;
 enum {
 	CHN_CNT      = 2,                      /* number of channels */
 	FRAME_SIZE   = sizeof(float),
-	PERIOD_CSIZE = FRAME_SIZE * PERIOD,    /* size of channel packet (bytes) */
-	PERIOD_FSIZE = CHN_CNT * PERIOD_CSIZE, /* size of period in file (bytes) */
 };
 
 
@@ -87,20 +85,24 @@ class Track : Thread<8192>
 			for (int i = 0; i < CHN_CNT; ++i)
 				_audio_out[i]->start();
 
+			/* period granted by the server and its size in the file */
+			size_t const period       = _audio_out[0]->stream()->period();
+			size_t const period_fsize = CHN_CNT * FRAME_SIZE * period;
+
 			while (1) {
 
 				for (size_t offset = 0, cnt = 1;
 				     offset < file_size;
-				     offset += PERIOD_FSIZE, ++cnt) {
+				     offset += period_fsize, ++cnt) {
 
 					/*
 					 * The current chunk (in number of frames of one channel)
 					 * is the size of the period except at the end of the
 					 * file.
 					 */
-					size_t chunk = (offset + PERIOD_FSIZE > file_size)
+					size_t chunk = (offset + period_fsize > file_size)
 					               ? (file_size - offset) / CHN_CNT / FRAME_SIZE
-					               : PERIOD;
+					               : period;
 
 					Packet *p[CHN_CNT];
 					while (1)
@@ -123,10 +125,10 @@ class Track : Thread<8192>
 							p[i]->content()[c / 2] = content[c + i];
 
 					/* handle last packet gracefully */
-					if (chunk < PERIOD) {
+					if (chunk < period) {
 						for (int i = 0; i < CHN_CNT; ++i)
 							memset(p[i]->content() + chunk,
-							       0, PERIOD_CSIZE - FRAME_SIZE * chunk);
+							       0, FRAME_SIZE * (period - chunk));
 					}
 
 					if (verbose)
@@ -0,0 +1,373 @@
+/*
+ * \brief  Block-session benchmark
+ * \author Norman Feske
+ * \date   2013-03-22
+ *
+ * The benchmark runs a sequence of workloads against a block session and
+ * reports the number of requests per second, the bandwidth, and the
+ * distribution of the request latencies of each workload. A workload is
+ * configured by a 'workload' node with the following attributes:
+ *
+ * 'name'           name printed with the results
+ * 'pattern'        'sequential' (default) or 'random' block numbers
+ * 'operation'      'read' (default), 'write', or 'mixed'
+ * 'write_percent'  share of writes of a mixed workload, default 50
+ * 'packet_size'    bytes per request, default 4K
+ * 'in_flight'      number of requests in flight (queue depth), default 1
+ * 'size'           total number of bytes transferred, default 8M
+ *
+ * Without workload nodes, a set of read-only workloads is run. Note that
+ * write workloads overwrite the content of the block device.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/allocator_avl.h>
+#include <base/printf.h>
+#include <base/sleep.h>
+#include <block_session/connection.h>
+#include <os/config.h>
+#include <timer_session/connection.h>
+#include <util/string.h>
+
+/* blk_trace includes */
+#include <latency.h>
+
+using namespace Genode;
+
+enum {
+	MAX_WORKLOADS = 16,
+	MAX_IN_FLIGHT = 64,
+	NAME_LEN      = 32,
+	MAX_BLK_SIZE  = 4096, /* block size assumed for sizing the packet buffer */
+};
+
+
+struct Workload
+{
+	char     name[NAME_LEN];
+	bool     random;
+	unsigned write_percent;
+	size_t   packet_size;
+	unsigned in_flight;
+	size_t   size;
+
+	Workload() { }
+
+	Workload(char const *name, bool random, size_t packet_size,
+	         unsigned in_flight)
+	:
+		random(random), write_percent(0), packet_size(packet_size),
+		in_flight(in_flight), size(8*1024*1024)
+	{
+		strncpy(this->name, name, sizeof(this->name));
+	}
+
+	Workload(Xml_node node)
+	:
+		random(false), write_percent(0), packet_size(4096), in_flight(1),
+		size(8*1024*1024)
+	{
+		strncpy(name, "<unnamed>", sizeof(name));
+		try { node.attribute("name").value(name, sizeof(name)); } catch (...) { }
+
+		try { random = node.attribute("pattern").has_value("random"); }
+		catch (...) { }
+
+		try {
+			Xml_node::Attribute op = node.attribute("operation");
+			if (op.has_value("write"))
+				write_percent = 100;
+			if (op.has_value("mixed")) {
+				write_percent = 50;
+				try { node.attribute("write_percent").value(&write_percent); }
+				catch (...) { }
+				write_percent = min(write_percent, 100U);
+			}
+		} catch (...) { }
+
+		Number_of_bytes bytes;
+		try {
+			node.attribute("packet_size").value(&bytes);
+			packet_size = bytes;
+		} catch (...) { }
+
+		try {
+			node.attribute("size").value(&bytes);
+			size = bytes;
+		} catch (...) { }
+
+		try { node.attribute("in_flight").value(&in_flight); } catch (...) { }
+		in_flight = max(1U, min(in_flight, (unsigned)MAX_IN_FLIGHT));
+	}
+
+	char const *operation() const
+	{
+		return write_percent == 0   ? "read"  :
+		       write_percent == 100 ? "write" : "mixed";
+	}
+
+	/**
+	 * Return size of the packet buffer needed by the workload
+	 *
+	 * The block size is not known before the session is opened. A request
+	 * covers at least one block, so a 'packet_size' below the block size
+	 * is accounted with 'MAX_BLK_SIZE'.
+	 */
+	size_t buffer_size() const
+	{
+		return request_buffer_size(max(packet_size, (size_t)MAX_BLK_SIZE));
+	}
+
+	/**
+	 * Return size of the packet buffer needed for requests of 'bytes'
+	 */
+	size_t request_buffer_size(size_t bytes) const
+	{
+		/* packets are aligned to 2 KiB */
+		return in_flight*align_addr(bytes, 11);
+	}
+};
+
+
+static unsigned read_workloads(Workload *workloads)
+{
+	unsigned n = 0;
+	try {
+		Xml_node node = config()->xml_node().sub_node("workload");
+		for (; n < MAX_WORKLOADS; node = node.next("workload"))
+			workloads[n++] = Workload(node);
+	} catch (...) { }
+
+	if (n)
+		return n;
+
+	workloads[n++] = Workload("sequential read",  false, 64*1024, 8);
+	workloads[n++] = Workload("random read",      true,  4096,    1);
+	workloads[n++] = Workload("random read qd8",  true,  4096,    8);
+	return n;
+}
+
+
+/**
+ * Pseudo-random numbers (xorshift)
+ */
+class Random
+{
+	private:
+
+		uint32_t _state;
+
+	public:
+
+		Random(uint32_t seed) : _state(seed ? seed : 1) { }
+
+		uint32_t next()
+		{
+			_state ^= _state << 13;
+			_state ^= _state >> 17;
+			_state ^= _state << 5;
+			return _state;
+		}
+};
+
+
+class Bench
+{
+	private:
+
+		Block::Connection          &_blk;
+		Block::Session::Tx::Source &_tx;
+		Block::Cycle_clock const   &_clock;
+		size_t const                _buf_size;
+		size_t                      _blk_count;
+		size_t                      _blk_size;
+		Block::Session::Operations  _ops;
+		Random                      _random;
+
+		/**
+		 * Request in flight
+		 */
+		struct Slot
+		{
+			bool                     used;
+			Block::Packet_descriptor packet;
+			Block::Timestamp         submitted;
+		};
+
+		Slot _slots[MAX_IN_FLIGHT];
+
+		Slot *_free_slot()
+		{
+			for (unsigned i = 0; i < MAX_IN_FLIGHT; i++)
+				if (!_slots[i].used)
+					return &_slots[i];
+			return 0;
+		}
+
+		Slot *_lookup(Block::Packet_descriptor p)
+		{
+			for (unsigned i = 0; i < MAX_IN_FLIGHT; i++)
+				if (_slots[i].used && _slots[i].packet.offset() == p.offset())
+					return &_slots[i];
+			return 0;
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param buf_size  size of the packet buffer of 'blk' available
+		 *                  to the workloads
+		 */
+		Bench(Block::Connection &blk, size_t buf_size,
+		      Block::Cycle_clock const &clock, uint32_t seed)
+		:
+			_blk(blk), _tx(*blk.tx()), _clock(clock), _buf_size(buf_size),
+			_random(seed)
+		{
+			_blk.info(&_blk_count, &_blk_size, &_ops);
+
+			for (unsigned i = 0; i < MAX_IN_FLIGHT; i++)
+				_slots[i].used = false;
+
+			printf("block device with %zu blocks of %zu bytes%s\n", _blk_count,
+			       _blk_size,
+			       _ops.supported(Block::Packet_descriptor::WRITE)
+			       ? "" : ", read-only");
+		}
+
+		void run(Workload const &w)
+		{
+			unsigned long const per_req  = max(w.packet_size/_blk_size, (size_t)1);
+			unsigned long const requests = max(w.size/(per_req*_blk_size), (size_t)1);
+			unsigned long const slots    = _blk_count/per_req;
+
+			printf("%s: %s %s, %lu requests of %lu KiB, %u in flight\n", w.name,
+			       w.random ? "random" : "sequential", w.operation(),
+			       requests, (per_req*_blk_size)/1024, w.in_flight);
+
+			if (!slots) {
+				PERR("%s: requests exceed the device size", w.name);
+				return;
+			}
+
+			if (w.request_buffer_size(per_req*_blk_size) > _buf_size) {
+				PERR("%s: blocks of %zu bytes exceed the packet buffer",
+				     w.name, _blk_size);
+				return;
+			}
+
+			if (w.write_percent && !_ops.supported(Block::Packet_descriptor::WRITE)) {
+				PERR("%s: device does not support writing", w.name);
+				return;
+			}
+
+			Block::Latency_histogram latency;
+
+			unsigned long submitted = 0, completed = 0, errors = 0;
+			unsigned long next_blk  = 0;
+			unsigned      pending   = 0;
+
+			Block::Timestamp const start = Block::timestamp();
+
+			while (completed < requests) {
+
+				/* keep the queue filled */
+				while (pending < w.in_flight && submitted < requests) {
+
+					unsigned long blk_nr;
+					if (w.random)
+						blk_nr = (_random.next() % slots)*per_req;
+					else {
+						if (next_blk + per_req > _blk_count)
+							next_blk = 0;
+						blk_nr    = next_blk;
+						next_blk += per_req;
+					}
+
+					bool const write = _random.next() % 100 < w.write_percent;
+
+					Slot *s = _free_slot();
+					s->packet = Block::Packet_descriptor(
+						_blk.dma_alloc_packet(per_req*_blk_size),
+						write ? Block::Packet_descriptor::WRITE
+						      : Block::Packet_descriptor::READ,
+						blk_nr, per_req);
+					s->used      = true;
+					s->submitted = Block::timestamp();
+
+					_tx.submit_packet(s->packet);
+					submitted++;
+					pending++;
+				}
+
+				Block::Packet_descriptor p = _tx.get_acked_packet();
+				Block::Timestamp const acked = Block::timestamp();
+
+				Slot *s = _lookup(p);
+				if (!s) {
+					PERR("received acknowledgement of unknown packet");
+					continue;
+				}
+
+				latency.add(_clock.us(s->submitted, acked));
+				if (!p.succeeded())
+					errors++;
+
+				s->used = false;
+				_tx.release_packet(p);
+				pending--;
+				completed++;
+			}
+
+			unsigned long long const us =
+				max(_clock.us(start, Block::timestamp()), 1UL);
+			unsigned long long const kib =
+				((unsigned long long)requests*per_req*_blk_size)/1024;
+
+			printf("  %llu us, %llu IOPS, %llu KiB/s, %lu failed\n", us,
+			       (requests*1000000ULL)/us, (kib*1000000ULL)/us, errors);
+			latency.print("request");
+		}
+};
+
+
+int main(int, char **)
+{
+	printf("--- block benchmark started ---\n");
+
+	static Workload workloads[MAX_WORKLOADS];
+	unsigned const num_workloads = read_workloads(workloads);
+
+	/* size the packet buffer for the most demanding workload */
+	size_t tx_buf_size = 0;
+	for (unsigned i = 0; i < num_workloads; i++)
+		tx_buf_size = max(tx_buf_size, workloads[i].buffer_size());
+
+	unsigned long seed = 1;
+	try { config()->xml_node().attribute("seed").value(&seed); }
+	catch (...) { }
+
+	static Timer::Connection  timer;
+	static Block::Cycle_clock clock(timer);
+
+	static Allocator_avl      block_alloc(env()->heap());
+	static Block::Connection  blk(&block_alloc, tx_buf_size + 4096);
+
+	static Bench bench(blk, tx_buf_size, clock, seed);
+
+	for (unsigned i = 0; i < num_workloads; i++)
+		bench.run(workloads[i]);
+
+	printf("--- block benchmark finished ---\n");
+	sleep_forever();
+	return 0;
+}
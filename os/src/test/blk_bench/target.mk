@@ -0,0 +1,5 @@
+TARGET   = test-blk_bench
+SRC_CC   = main.cc
+LIBS     = base
+INC_DIR += $(REP_DIR)/src/server/blk_trace
+REQUIRES = x86
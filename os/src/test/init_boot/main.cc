@@ -0,0 +1,36 @@
+/*
+ * \brief  Minimal child for measuring the boot time of large scenarios
+ * \author Norman Feske
+ * \date   2013-03-15
+ *
+ * The program opens a few sessions, each of which is routed by init, and
+ * reports the time since the start of the timer service.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/printf.h>
+#include <base/sleep.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+
+int main(int, char **)
+{
+	/* the LOG session is opened by the first message */
+	printf("started\n");
+
+	static Timer::Connection timer;
+
+	printf("ready at %lu ms\n", timer.elapsed_ms());
+
+	sleep_forever();
+	return 0;
+}
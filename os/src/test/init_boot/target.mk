@@ -0,0 +1,3 @@
+TARGET = test-init_boot
+SRC_CC = main.cc
+LIBS   = base
@@ -0,0 +1,265 @@
+/*
+ * \brief  Latency and CPU cost of the audio mixer
+ * \author Norman Feske
+ * \date   2013-03-19
+ *
+ * The benchmark opens 'STREAMS' stereo sessions at the mixer, which all use
+ * the period given by the 'period' attribute of the config node. Every
+ * second stream uses a sample rate of 48 kHz, every other pair of streams
+ * uses 16-bit samples. For each round, one period worth of frames is
+ * submitted to every session and the time until the packets of the first
+ * session are played is measured. Furthermore, the CPU time needed to mix
+ * one period of all streams is compared between a plain sample-by-sample
+ * loop and the mixing function used by the mixer, and the CPU time for
+ * resampling one period of the 48-kHz streams is measured.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <audio_out_session/connection.h>
+#include <base/printf.h>
+#include <base/sleep.h>
+#include <os/config.h>
+#include <timer_session/connection.h>
+
+/* mixer includes */
+#include <mix.h>
+#include <resampler.h>
+
+using namespace Genode;
+
+enum {
+	STREAMS      = 16,
+	ROUNDS       = 200,  /* latency measurements */
+	MIX_ROUNDS   = 2000, /* mixing of all streams */
+	CHANNELS     = 2,
+	OTHER_RATE   = 48000,
+};
+
+
+static unsigned stream_rate(unsigned s) {
+	return s & 1 ? (unsigned)OTHER_RATE : (unsigned)Audio_out::SAMPLE_RATE; }
+
+
+static Audio_out::Format stream_format(unsigned s) {
+	return s & 2 ? Audio_out::FORMAT_S16 : Audio_out::FORMAT_F32; }
+
+
+static char const *channel_names[CHANNELS] = { "front left", "front right" };
+
+
+static Timer::Connection timer;
+
+
+/**
+ * Return period requested from the mixer as configured
+ */
+static unsigned config_period()
+{
+	unsigned long period = 256;
+	try {
+		config()->xml_node().attribute("period").value(&period);
+	} catch (...) { }
+
+	return max(min(period, (unsigned long)Audio_out::PERIOD),
+	           (unsigned long)Audio_out::MIN_PERIOD);
+}
+
+
+/**
+ * Reference implementation of the mixing of one packet
+ */
+static void mix_reference(float *out, float const *in, float gain,
+                          unsigned n, bool clear)
+{
+	for (unsigned i = 0; i < n; i++) {
+		float v = in[i]*gain + (clear ? 0 : out[i]);
+		out[i] = v > 1 ? 1 : (v < -1 ? -1 : v);
+	}
+}
+
+
+static void measure_mixing(unsigned period)
+{
+	static float in[STREAMS][Audio_out::PERIOD];
+	static float out[Audio_out::PERIOD];
+
+	for (unsigned s = 0; s < STREAMS; s++)
+		for (unsigned i = 0; i < period; i++)
+			in[s][i] = ((int)((i*(s + 1)) % 200) - 100)/200.0f;
+
+	unsigned long start = timer.elapsed_ms();
+	for (unsigned r = 0; r < MIX_ROUNDS; r++)
+		for (unsigned s = 0; s < STREAMS; s++)
+			mix_reference(out, in[s], 0.5f, period, s == 0);
+
+	unsigned long const reference_ms = timer.elapsed_ms() - start;
+	float const reference_sample = out[period - 1];
+
+	start = timer.elapsed_ms();
+	for (unsigned r = 0; r < MIX_ROUNDS; r++) {
+		Audio_out::mix<true>(out, in[0], 0.5f, period);
+		for (unsigned s = 1; s < STREAMS; s++)
+			Audio_out::mix<false>(out, in[s], 0.5f, period);
+	}
+	unsigned long const mix_ms = timer.elapsed_ms() - start;
+
+	if (out[period - 1] != reference_sample)
+		PERR("mixed samples differ from reference");
+
+	printf("mixing %u streams, %u frames: reference %lu us, mix %lu us per period\n",
+	       (unsigned)STREAMS, period,
+	       (reference_ms*1000)/MIX_ROUNDS, (mix_ms*1000)/MIX_ROUNDS);
+}
+
+
+static void measure_resampling(unsigned period)
+{
+	enum { RESAMPLED = STREAMS/2 };
+
+	static float in[Audio_out::PERIOD];
+	static float out[2*Audio_out::PERIOD];
+
+	for (unsigned i = 0; i < period; i++)
+		in[i] = ((int)(i % 200) - 100)/200.0f;
+
+	Audio_out::Resampler::Filter filter(env()->heap(), OTHER_RATE,
+	                                    Audio_out::SAMPLE_RATE);
+
+	Audio_out::Resampler *resampler[RESAMPLED];
+	for (unsigned s = 0; s < RESAMPLED; s++)
+		resampler[s] = new (env()->heap()) Audio_out::Resampler(filter);
+
+	unsigned long frames = 0;
+	unsigned long const start = timer.elapsed_ms();
+	for (unsigned r = 0; r < MIX_ROUNDS; r++)
+		for (unsigned s = 0; s < RESAMPLED; s++)
+			frames += resampler[s]->process(in, period, out);
+
+	unsigned long const ms = timer.elapsed_ms() - start;
+
+	printf("resampling %u streams, %u frames %u->%u Hz: %lu us per period "
+	       "(%lu output frames)\n", (unsigned)RESAMPLED, period,
+	       (unsigned)OTHER_RATE, (unsigned)Audio_out::SAMPLE_RATE,
+	       (ms*1000)/MIX_ROUNDS, frames/MIX_ROUNDS/RESAMPLED);
+
+	for (unsigned s = 0; s < RESAMPLED; s++)
+		destroy(env()->heap(), resampler[s]);
+}
+
+
+static void measure_latency(unsigned requested_period)
+{
+	Audio_out::Connection *audio_out[STREAMS][CHANNELS];
+
+	/* the progress signal of the first session is used to wait for playback */
+	for (unsigned s = 0; s < STREAMS; s++)
+		for (unsigned c = 0; c < CHANNELS; c++)
+			audio_out[s][c] = new (env()->heap())
+				Audio_out::Connection(channel_names[c], false,
+				                      s == 0 && c == 0, requested_period,
+				                      stream_rate(s), stream_format(s));
+
+	unsigned const period = audio_out[0][0]->stream()->period();
+	printf("requested period %u frames, granted %u frames\n",
+	       requested_period, period);
+
+	for (unsigned s = 0; s < STREAMS; s++) {
+		Audio_out::Stream *stream = audio_out[s][0]->stream();
+		if (stream->rate() != stream_rate(s) || stream->format() != stream_format(s))
+			printf("stream %u: requested %u Hz %s, granted %u Hz %s\n", s,
+			       stream_rate(s), Audio_out::format_name(stream_format(s)),
+			       stream->rate(), Audio_out::format_name(stream->format()));
+	}
+
+	for (unsigned s = 0; s < STREAMS; s++)
+		for (unsigned c = 0; c < CHANNELS; c++)
+			audio_out[s][c]->start();
+
+	unsigned long sum_ms = 0, max_ms = 0;
+
+	/* number of frames submitted per stream */
+	unsigned long submitted[STREAMS];
+	for (unsigned s = 0; s < STREAMS; s++)
+		submitted[s] = 0;
+
+	for (unsigned r = 0; r < ROUNDS; r++) {
+
+		/* last channel of the first stream, played last by the mixer */
+		Audio_out::Packet *first_packet = 0;
+
+		unsigned long const start = timer.elapsed_ms();
+
+		for (unsigned s = 0; s < STREAMS; s++) {
+			Audio_out::Stream *first = audio_out[s][0]->stream();
+
+			/*
+			 * Streams with a higher sample rate submit additional packets
+			 * to keep up with the output.
+			 */
+			unsigned long const due = (unsigned long)(r + 1)*period
+			                        * first->rate()/Audio_out::SAMPLE_RATE;
+
+			for (; submitted[s] < due; submitted[s] += period) {
+
+				Audio_out::Packet *p[CHANNELS];
+
+				try { p[0] = first->alloc(); }
+				catch (Audio_out::Stream::Alloc_failed) { break; }
+
+				unsigned const pos = first->packet_position(p[0]);
+
+				for (unsigned c = 1; c < CHANNELS; c++)
+					p[c] = audio_out[s][c]->stream()->get(pos);
+
+				size_t const sample_size = first->format() == Audio_out::FORMAT_S16
+				                         ? sizeof(short) : sizeof(float);
+
+				for (unsigned c = 0; c < CHANNELS; c++) {
+					memset(p[c]->content(), 0, period*sample_size);
+					audio_out[s][c]->submit(p[c]);
+				}
+
+				if (s == 0)
+					first_packet = p[CHANNELS - 1];
+			}
+		}
+
+		/* wait until the packet of the first stream is played */
+		while (first_packet && !first_packet->played())
+			audio_out[0][0]->wait_for_progress();
+
+		unsigned long const ms = timer.elapsed_ms() - start;
+		sum_ms += ms;
+		max_ms  = max(max_ms, ms);
+	}
+
+	printf("latency of %u rounds: average %lu ms, maximum %lu ms\n",
+	       (unsigned)ROUNDS, sum_ms/ROUNDS, max_ms);
+
+	for (unsigned s = 0; s < STREAMS; s++)
+		for (unsigned c = 0; c < CHANNELS; c++)
+			audio_out[s][c]->stop();
+}
+
+
+int main(int, char **)
+{
+	printf("--- mixer benchmark started ---\n");
+
+	unsigned const period = config_period();
+
+	measure_mixing(period);
+	measure_resampling(period);
+	measure_latency(period);
+
+	printf("--- mixer benchmark finished ---\n");
+	sleep_forever();
+	return 0;
+}
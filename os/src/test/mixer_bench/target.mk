@@ -0,0 +1,4 @@
+TARGET   = test-mixer_bench
+SRC_CC   = main.cc
+LIBS     = base
+INC_DIR += $(REP_DIR)/src/server/mixer
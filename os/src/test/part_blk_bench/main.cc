@@ -0,0 +1,103 @@
+/*
+ * \brief  Sequential read throughput of a block session
+ * \author Norman Feske
+ * \date   2013-03-16
+ *
+ * The client reads its block device from start to end, keeping a
+ * configurable number of requests in flight. Running several instances on
+ * different partitions of 'part_blk' at the same time shows how the
+ * throughput scales with concurrent clients.
+ *
+ * Config attributes: 'packet_size' (bytes per request, default 64K),
+ * 'in_flight' (number of requests in flight, default 8), and 'max_blocks'
+ * (upper bound of blocks to read, default whole device).
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/allocator_avl.h>
+#include <base/printf.h>
+#include <base/sleep.h>
+#include <block_session/connection.h>
+#include <os/config.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+
+template <typename T>
+static T config_value(char const *attr, T default_value)
+{
+	T value = default_value;
+	try { config()->xml_node().attribute(attr).value(&value); }
+	catch (...) { }
+	return value;
+}
+
+
+int main(int, char **)
+{
+	size_t        const packet_size = config_value<size_t>("packet_size", 64*1024);
+	unsigned      const in_flight   = config_value<unsigned>("in_flight", 8);
+	unsigned long const max_blocks  = config_value<unsigned long>("max_blocks", ~0UL);
+
+	static Allocator_avl     block_alloc(env()->heap());
+	static Block::Connection blk(&block_alloc, packet_size*in_flight + 4096);
+	static Timer::Connection timer;
+
+	size_t blk_count, blk_size;
+	Block::Session::Operations ops;
+	blk.info(&blk_count, &blk_size, &ops);
+
+	unsigned long const total   = min<unsigned long>(blk_count, max_blocks);
+	unsigned long const per_req = packet_size / blk_size;
+
+	printf("reading %lu blocks of %zu bytes, %u requests of %lu blocks in flight\n",
+	       total, blk_size, in_flight, per_req);
+
+	Block::Session::Tx::Source &tx = *blk.tx();
+
+	unsigned long const start = timer.elapsed_ms();
+
+	unsigned long next = 0, done = 0;
+	unsigned      pending = 0, errors = 0;
+
+	while (done < total) {
+
+		/* keep the pipeline filled */
+		while (pending < in_flight && next < total) {
+			unsigned long const count = min(per_req, total - next);
+			Block::Packet_descriptor p(blk.dma_alloc_packet(count*blk_size),
+			                           Block::Packet_descriptor::READ, next, count);
+			tx.submit_packet(p);
+			next += count;
+			pending++;
+		}
+
+		Block::Packet_descriptor p = tx.get_acked_packet();
+		if (!p.succeeded())
+			errors++;
+
+		done += p.block_count();
+		pending--;
+		tx.release_packet(p);
+	}
+
+	unsigned long const ms = max(timer.elapsed_ms() - start, 1UL);
+	unsigned long const kib = (total*blk_size) / 1024;
+
+	if (errors)
+		PERR("%u requests failed", errors);
+
+	printf("read %lu KiB in %lu ms (%lu KiB/s)\n", kib, ms, (kib*1000)/ms);
+	printf("--- part_blk benchmark finished ---\n");
+
+	sleep_forever();
+	return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * \brief  Pixel throughput of the nitpicker_gfx row operations and blit
+ * \author Norman Feske
+ * \date   2013-03-06
+ *
+ * Each vectorized row operation is checked against the scalar reference
+ * implementation and measured by processing full screens.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/printf.h>
+#include <util/string.h>
+#include <timer_session/connection.h>
+#include <blit/blit.h>
+#include <nitpicker_gfx/pixel_rgb565.h>
+#include <nitpicker_gfx/pixel_rgb888.h>
+
+using namespace Genode;
+
+enum {
+	SCR_W  = 1920,
+	SCR_H  = 1080,
+	FRAMES = 20,     /* number of full screens processed per measurement */
+};
+
+
+/**
+ * Pseudo-random numbers for filling the buffers
+ */
+static unsigned rnd()
+{
+	static unsigned seed = 93186752;
+	seed = seed*1103515245 + 12345;
+	return seed >> 8;
+}
+
+
+/**
+ * Buffers used for the validation and measurement
+ */
+template <typename PT>
+struct Buffers
+{
+	PT            *src;
+	PT            *dst;
+	PT            *ref;
+	unsigned char *alpha;
+
+	Buffers()
+	:
+		src((PT *)env()->heap()->alloc(SCR_W*SCR_H*sizeof(PT))),
+		dst((PT *)env()->heap()->alloc(SCR_W*SCR_H*sizeof(PT))),
+		ref((PT *)env()->heap()->alloc(SCR_W*SCR_H*sizeof(PT))),
+		alpha((unsigned char *)env()->heap()->alloc(SCR_W*SCR_H))
+	{
+		/* use fully transparent and opaque pixels as found in textures */
+		for (unsigned i = 0; i < SCR_W*SCR_H; i++) {
+			src[i].pixel = rnd();
+			dst[i].pixel = ref[i].pixel = rnd();
+
+			switch (rnd() % 4) {
+			case 0:  alpha[i] = 0;   break;
+			case 1:  alpha[i] = 255; break;
+			default: alpha[i] = rnd();
+			}
+
+			if (rnd() % 8 == 0)
+				src[i].pixel = 0;
+		}
+	}
+};
+
+
+enum Op { FILL, MIX, AVR, MASKED };
+
+static char const *op_name(Op op)
+{
+	switch (op) {
+	case FILL:   return "fill";
+	case MIX:    return "mix";
+	case AVR:    return "avr";
+	case MASKED: return "masked";
+	}
+	return "";
+}
+
+
+template <typename ROW, typename PT>
+static void apply(Op op, PT *dst, PT const *src, unsigned char const *alpha, int n)
+{
+	PT const pix(0x12, 0x34, 0x56);
+
+	switch (op) {
+	case FILL:   ROW::fill(dst, pix, n);        break;
+	case MIX:    ROW::mix(dst, src, alpha, n);  break;
+	case AVR:    ROW::avr(dst, src, pix, n);    break;
+	case MASKED: ROW::copy_masked(dst, src, n); break;
+	}
+}
+
+
+/**
+ * Compare vectorized operation with the reference for various alignments
+ */
+template <typename PT>
+static bool validate(Buffers<PT> &b, Op op)
+{
+	memcpy(b.ref, b.dst, 128*sizeof(PT));
+
+	for (int n = 0; n < 100; n++)
+		for (int off = 0; off < 8; off++) {
+
+			apply<Pixel_row_scalar<PT> >(op, b.ref + off, b.src + off + n, b.alpha + off, n);
+			apply<Pixel_row<PT> >       (op, b.dst + off, b.src + off + n, b.alpha + off, n);
+
+			if (memcmp(b.ref, b.dst, (n + 16)*sizeof(PT))) {
+				PERR("%s: mismatch for n=%d offset=%d", op_name(op), n, off);
+				return false;
+			}
+		}
+	return true;
+}
+
+
+static void print_rate(char const *fmt, char const *op, char const *impl,
+                       unsigned long ms)
+{
+	unsigned long const mpix = (unsigned long)SCR_W*SCR_H*FRAMES/1000;
+
+	if (ms == 0)
+		printf("  %s %s %s: too fast to measure\n", fmt, op, impl);
+	else
+		printf("  %s %s %s: %6lu MPixel/s\n", fmt, op, impl, mpix/ms);
+}
+
+
+template <typename ROW, typename PT>
+static unsigned long measure(Timer::Connection &timer, Buffers<PT> &b, Op op)
+{
+	unsigned long const start = timer.elapsed_ms();
+
+	for (unsigned f = 0; f < FRAMES; f++)
+		for (unsigned y = 0; y < SCR_H; y++) {
+			unsigned const offset = y*SCR_W;
+			apply<ROW>(op, b.dst + offset, b.src + offset, b.alpha + offset, SCR_W);
+		}
+
+	return timer.elapsed_ms() - start;
+}
+
+
+template <typename PT>
+static bool bench(Timer::Connection &timer, char const *fmt)
+{
+	Buffers<PT> b;
+
+	Op const ops[] = { FILL, MIX, AVR, MASKED };
+
+	for (unsigned i = 0; i < sizeof(ops)/sizeof(ops[0]); i++) {
+
+		if (!validate(b, ops[i]))
+			return false;
+
+		print_rate(fmt, op_name(ops[i]), "scalar",
+		           measure<Pixel_row_scalar<PT> >(timer, b, ops[i]));
+		print_rate(fmt, op_name(ops[i]), "vector",
+		           measure<Pixel_row<PT> >(timer, b, ops[i]));
+	}
+
+	/* copy of a window that starts at an odd pixel position */
+	unsigned long start = timer.elapsed_ms();
+	for (unsigned f = 0; f < FRAMES; f++)
+		for (unsigned y = 0; y < SCR_H; y++)
+			for (unsigned x = 1; x < SCR_W; x++)
+				b.dst[y*SCR_W + x] = b.src[y*SCR_W + x];
+	print_rate(fmt, "copy", "scalar", timer.elapsed_ms() - start);
+
+	start = timer.elapsed_ms();
+	for (unsigned f = 0; f < FRAMES; f++)
+		blit(b.src + 1, SCR_W*sizeof(PT), b.dst + 1, SCR_W*sizeof(PT),
+		     (SCR_W - 1)*sizeof(PT), SCR_H);
+	print_rate(fmt, "copy", "blit  ", timer.elapsed_ms() - start);
+
+	for (unsigned y = 0; y < SCR_H; y++)
+		if (memcmp(b.src + y*SCR_W + 1, b.dst + y*SCR_W + 1, (SCR_W - 1)*sizeof(PT))) {
+			PERR("copy: mismatch in line %u", y);
+			return false;
+		}
+
+	env()->heap()->free(b.src,   SCR_W*SCR_H*sizeof(PT));
+	env()->heap()->free(b.dst,   SCR_W*SCR_H*sizeof(PT));
+	env()->heap()->free(b.ref,   SCR_W*SCR_H*sizeof(PT));
+	env()->heap()->free(b.alpha, SCR_W*SCR_H);
+	return true;
+}
+
+
+int main(int, char **)
+{
+	printf("--- pixel benchmark started (%u bytes per vector) ---\n",
+	       (unsigned)Pixel_vector::SIZE);
+
+	static Timer::Connection timer;
+
+	if (!bench<Pixel_rgb565>(timer, "rgb565")
+	 || !bench<Pixel_rgb888>(timer, "rgb888")) {
+		PERR("validation failed");
+		return -1;
+	}
+
+	printf("--- pixel benchmark finished ---\n");
+	return 0;
+}
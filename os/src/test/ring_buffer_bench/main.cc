@@ -0,0 +1,195 @@
+/*
+ * \brief  Throughput of the ring buffers
+ * \author Norman Feske
+ * \date   2013-03-12
+ *
+ * Producer threads pass input events to the main thread, which checks that
+ * the events of each producer arrive in order. The locked 'Ring_buffer' is
+ * compared with the lock-free variants, with single and batch operations.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/printf.h>
+#include <base/thread.h>
+#include <timer_session/connection.h>
+#include <input/event.h>
+#include <os/ring_buffer.h>
+
+using namespace Genode;
+
+enum {
+	QUEUE_SIZE    = 512,
+	NUM_EVENTS    = 1000000,   /* number of events per measurement */
+	MAX_PRODUCERS = 2,
+	BATCH         = 32,
+};
+
+typedef Input::Event Event;
+
+typedef Ring_buffer<Event, QUEUE_SIZE>                            Locked_queue;
+typedef Blocking_ring_buffer<Spsc_ring_buffer<Event, QUEUE_SIZE> > Spsc_queue;
+typedef Blocking_ring_buffer<Mpsc_ring_buffer<Event, QUEUE_SIZE> > Mpsc_queue;
+
+
+/*
+ * Uniform interface for batch operations on all queue types
+ */
+
+template <typename Q>
+static unsigned add(Q &queue, Event const *src, unsigned n) {
+	return queue.add(src, n); }
+
+template <typename Q>
+static unsigned get(Q &queue, Event *dst, unsigned n) {
+	return queue.get(dst, n); }
+
+template <>
+unsigned add(Locked_queue &queue, Event const *src, unsigned)
+{
+	try {
+		queue.add(*src);
+		return 1;
+	} catch (Locked_queue::Overflow) {
+		return 0;
+	}
+}
+
+template <>
+unsigned get(Locked_queue &queue, Event *dst, unsigned)
+{
+	*dst = queue.get();
+	return 1;
+}
+
+
+/**
+ * Thread that adds a sequence of numbered events to a queue
+ */
+template <typename Q>
+class Producer : public Thread<8192>
+{
+	private:
+
+		Q              &_queue;
+		int      const  _id;
+		unsigned const  _num_events;
+		unsigned const  _batch;
+
+	public:
+
+		Producer(Q &queue, int id, unsigned num_events, unsigned batch)
+		:
+			Thread<8192>("producer"),
+			_queue(queue), _id(id), _num_events(num_events), _batch(batch)
+		{ }
+
+		void entry()
+		{
+			Event ev[BATCH];
+
+			for (unsigned i = 0; i < _num_events; ) {
+
+				unsigned const n = min(_batch, _num_events - i);
+				for (unsigned j = 0; j < n; j++)
+					ev[j] = Event(Event::MOTION, _id, i + j, 0, 0, 0);
+
+				/* retry if the queue is full */
+				for (unsigned added = 0; added < n; )
+					added += add(_queue, ev + added, n - added);
+
+				i += n;
+			}
+		}
+};
+
+
+/**
+ * Pass events from the producers to the main thread
+ *
+ * \return  false if the events arrived out of order
+ */
+template <typename Q>
+static bool measure(Timer::Session &timer, char const *name,
+                    unsigned num_producers, unsigned batch)
+{
+	static Q queue;
+
+	unsigned const num_events = NUM_EVENTS/num_producers;
+
+	Producer<Q> *producer[MAX_PRODUCERS];
+	for (unsigned i = 0; i < num_producers; i++)
+		producer[i] = new (env()->heap())
+			Producer<Q>(queue, i, num_events, batch);
+
+	unsigned long const start = timer.elapsed_ms();
+
+	for (unsigned i = 0; i < num_producers; i++)
+		producer[i]->start();
+
+	int  expected[MAX_PRODUCERS] = { 0 };
+	bool in_order = true;
+
+	Event ev[BATCH];
+	for (unsigned received = 0; received < num_events*num_producers; ) {
+
+		unsigned const n = get(queue, ev, batch);
+		for (unsigned i = 0; i < n; i++) {
+			int const id = ev[i].code();
+			if (ev[i].ax() != expected[id]++)
+				in_order = false;
+		}
+		received += n;
+	}
+
+	unsigned long const ms = timer.elapsed_ms() - start;
+
+	for (unsigned i = 0; i < num_producers; i++) {
+		producer[i]->join();
+		destroy(env()->heap(), producer[i]);
+	}
+
+	if (!in_order)
+		PERR("%s: events arrived out of order", name);
+
+	if (ms)
+		printf("  %-32s %8lu events/s\n", name,
+		       (unsigned long)num_events*num_producers*1000/ms);
+	else
+		printf("  %-32s too fast to measure\n", name);
+
+	return in_order;
+}
+
+
+int main(int, char **)
+{
+	printf("--- ring-buffer benchmark started ---\n");
+
+	static Timer::Connection timer;
+
+	bool ok = true;
+
+	ok &= measure<Locked_queue>(timer, "locked,    1 producer",          1, 1);
+	ok &= measure<Spsc_queue>  (timer, "spsc,      1 producer",          1, 1);
+	ok &= measure<Spsc_queue>  (timer, "spsc,      1 producer,  batch",  1, BATCH);
+	ok &= measure<Mpsc_queue>  (timer, "mpsc,      1 producer",          1, 1);
+	ok &= measure<Locked_queue>(timer, "locked,    2 producers",         2, 1);
+	ok &= measure<Mpsc_queue>  (timer, "mpsc,      2 producers",         2, 1);
+	ok &= measure<Mpsc_queue>  (timer, "mpsc,      2 producers, batch",  2, BATCH);
+
+	if (!ok) {
+		PERR("ring-buffer benchmark failed");
+		return -1;
+	}
+
+	printf("--- ring-buffer benchmark finished ---\n");
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-ring_buffer_bench
+SRC_CC = main.cc
+LIBS   = base
@@ -0,0 +1,166 @@
+/*
+ * \brief  Traversal of large configurations with and without index
+ * \author Norman Feske
+ * \date   2013-03-14
+ *
+ * The benchmark generates configurations with many 'start' and 'policy'
+ * nodes and measures the typical accesses of init and of servers, once
+ * for the plain XML data and once for an 'Xml_index' of the data.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/printf.h>
+#include <base/snprintf.h>
+#include <timer_session/connection.h>
+#include <util/xml_node.h>
+
+using namespace Genode;
+
+enum { ROUNDS = 10 };
+
+
+/**
+ * Generate configuration with 'num' start nodes and policies
+ *
+ * \return  length of the generated configuration
+ */
+static size_t generate_config(char *dst, size_t max_len, unsigned num)
+{
+	size_t len = snprintf(dst, max_len, "<config>\n");
+
+	for (unsigned i = 0; i < num; i++)
+		len += snprintf(dst + len, max_len - len,
+		                "\t<start name=\"child-%u\">\n"
+		                "\t\t<resource name=\"RAM\" quantum=\"%u\"/>\n"
+		                "\t\t<route>\n"
+		                "\t\t\t<service name=\"LOG\"> <parent/> </service>\n"
+		                "\t\t\t<any-service> <parent/> <any-child/> </any-service>\n"
+		                "\t\t</route>\n"
+		                "\t</start>\n", i, 1024*1024 + i);
+
+	for (unsigned i = 0; i < num; i++)
+		len += snprintf(dst + len, max_len - len,
+		                "\t<policy label=\"child-%u\" root=\"/%u\"/>\n", i, i);
+
+	len += snprintf(dst + len, max_len - len, "</config>\n");
+	return len;
+}
+
+
+/**
+ * Visit all start nodes like init does when starting the children
+ */
+static unsigned long visit_start_nodes(Xml_node config)
+{
+	unsigned long sum = 0;
+	try {
+		for (Xml_node start = config.sub_node("start"); ; start = start.next("start")) {
+
+			char name[64];
+			start.attribute("name").value(name, sizeof(name));
+
+			unsigned long quantum = 0;
+			start.sub_node("resource").attribute("quantum").value(&quantum);
+
+			sum += quantum + start.sub_node("route").num_sub_nodes();
+		}
+	} catch (Xml_node::Nonexistent_sub_node) { }
+	return sum;
+}
+
+
+/**
+ * Look up policy like 'Session_policy' does for a session request
+ */
+static int query_policy(Xml_node config, char const *label)
+{
+	int best_match = -1;
+	try {
+		size_t label_len = 0;
+		Xml_node policy = config.sub_node();
+
+		for (int i = 0;; i++, policy = policy.next()) {
+
+			if (!policy.has_type("policy"))
+				continue;
+
+			char policy_label[64];
+			policy.attribute("label").value(policy_label, sizeof(policy_label));
+
+			if (strcmp(label, policy_label, strlen(policy_label))
+			 || strlen(policy_label) < label_len)
+				continue;
+
+			label_len  = strlen(policy_label);
+			best_match = i;
+		}
+	} catch (...) { }
+
+	if (best_match != -1)
+		config.sub_node(best_match);
+
+	return best_match;
+}
+
+
+static void measure(Timer::Session &timer, char const *name, Xml_node config,
+                    unsigned num)
+{
+	unsigned long start = timer.elapsed_ms();
+	unsigned long sum = 0;
+	for (unsigned r = 0; r < ROUNDS; r++)
+		sum += visit_start_nodes(config);
+
+	unsigned long const visit_ms = timer.elapsed_ms() - start;
+
+	/* look up the policy of each child */
+	start = timer.elapsed_ms();
+	int found = 0;
+	for (unsigned i = 0; i < num; i++) {
+		char label[64];
+		snprintf(label, sizeof(label), "child-%u", i);
+		found += query_policy(config, label) >= 0;
+	}
+	unsigned long const policy_ms = timer.elapsed_ms() - start;
+
+	printf("  %-8s %5u nodes: start nodes %6lu us/pass, policy lookup %6lu us/session%s\n",
+	       name, num, visit_ms*1000/ROUNDS, policy_ms*1000/num,
+	       (sum && found == (int)num) ? "" : " (wrong result)");
+}
+
+
+int main(int, char **)
+{
+	printf("--- XML-node benchmark started ---\n");
+
+	static Timer::Connection timer;
+
+	enum { MAX_LEN = 1024*1024 };
+	char *config = (char *)env()->heap()->alloc(MAX_LEN);
+
+	unsigned const nums[] = { 50, 200, 500 };
+	for (unsigned i = 0; i < sizeof(nums)/sizeof(nums[0]); i++) {
+
+		size_t const len = generate_config(config, MAX_LEN, nums[i]);
+
+		measure(timer, "plain", Xml_node(config, len), nums[i]);
+
+		unsigned long const start = timer.elapsed_ms();
+		Xml_index index(*env()->heap(), config, len);
+		unsigned long const index_ms = timer.elapsed_ms() - start;
+
+		measure(timer, "indexed", Xml_node(index), nums[i]);
+		printf("  indexing %lu bytes took %lu ms\n", (unsigned long)len, index_ms);
+	}
+
+	printf("--- XML-node benchmark finished ---\n");
+	return 0;
+}
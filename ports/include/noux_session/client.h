@@ -32,6 +32,11 @@ namespace Noux {
 				return call<Rpc_sysio_dataspace>();
 			}
 
+			Dataspace_capability info_dataspace()
+			{
+				return call<Rpc_info_dataspace>();
+			}
+
 			bool syscall(Syscall sc)
 			{
 				static bool verbose = false;
@@ -0,0 +1,93 @@
+/*
+ * \brief  Per-process information page
+ * \author Norman Feske
+ * \date   2013-03-04
+ *
+ * The info page is provided by the Noux server to each process. It carries
+ * information that does not change during the lifetime of the process, and
+ * a clock maintained by the server. This way, the libc can answer calls
+ * like 'getpid' or 'gettimeofday' without issuing a system call.
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _INCLUDE__NOUX_SESSION__INFO_H_
+#define _INCLUDE__NOUX_SESSION__INFO_H_
+
+/* Noux includes */
+#include <noux_session/sysio.h>
+
+namespace Noux {
+
+	struct Info
+	{
+		/*
+		 * Identity of the process, written by the server at creation time
+		 */
+		int          pid;
+		unsigned int uid;
+		unsigned int gid;
+
+		Sysio::User  name;
+		Sysio::Shell shell;
+		Sysio::Home  home;
+
+		/**
+		 * Millisecond clock updated periodically by the server
+		 *
+		 * The sequence counter is odd while an update is in progress.
+		 * Readers retry until they observe the same even counter value
+		 * before and after reading the time.
+		 */
+		struct Clock
+		{
+			volatile unsigned      seq;
+			volatile unsigned long time_ms;
+
+			void update(unsigned long ms)
+			{
+				seq++;
+				__sync_synchronize();
+				time_ms = ms;
+				__sync_synchronize();
+				seq++;
+			}
+
+			unsigned long read() const
+			{
+				for (;;) {
+					unsigned const s = seq;
+					if (s & 1)
+						continue;
+
+					__sync_synchronize();
+					unsigned long const ms = time_ms;
+					__sync_synchronize();
+
+					if (seq == s)
+						return ms;
+				}
+			}
+		};
+
+		Clock clock;
+
+		/*
+		 * Syscall statistics
+		 *
+		 * 'rpc_count' is maintained by the server, 'local_count' by the
+		 * libc for calls answered without a system call.
+		 */
+		enum { MAX_SYSCALLS = 64 };
+
+		unsigned long rpc_count[MAX_SYSCALLS];
+		unsigned long local_count[MAX_SYSCALLS];
+	};
+}
+
+#endif /* _INCLUDE__NOUX_SESSION__INFO_H_ */
@@ -33,6 +33,13 @@ namespace Noux {
 
 		virtual Dataspace_capability sysio_dataspace() = 0;
 
+		/**
+		 * Return dataspace containing the process-information page
+		 *
+		 * The content of the page is described by 'Noux::Info'.
+		 */
+		virtual Dataspace_capability info_dataspace() = 0;
+
 		enum Syscall {
 			SYSCALL_WRITE,
 			SYSCALL_READ,
@@ -75,6 +82,9 @@ namespace Noux {
 			SYSCALL_GETTIMEOFDAY,
 			SYSCALL_CLOCK_GETTIME,
 			SYSCALL_UTIMES,
+			SYSCALL_SPLICE,
+			SYSCALL_RING,
+			SYSCALL_SPAWN,
 			SYSCALL_INVALID = -1
 		};
 
@@ -122,6 +132,9 @@ namespace Noux {
 			NOUX_DECL_SYSCALL_NAME(GETTIMEOFDAY)
 			NOUX_DECL_SYSCALL_NAME(CLOCK_GETTIME)
 			NOUX_DECL_SYSCALL_NAME(UTIMES)
+			NOUX_DECL_SYSCALL_NAME(SPLICE)
+			NOUX_DECL_SYSCALL_NAME(RING)
+			NOUX_DECL_SYSCALL_NAME(SPAWN)
 			case SYSCALL_INVALID: return 0;
 			}
 			return 0;
@@ -143,9 +156,10 @@ namespace Noux {
 		 *********************/
 
 		GENODE_RPC(Rpc_sysio_dataspace, Dataspace_capability, sysio_dataspace);
+		GENODE_RPC(Rpc_info_dataspace, Dataspace_capability, info_dataspace);
 		GENODE_RPC(Rpc_syscall, bool, syscall, Syscall);
 
-		GENODE_RPC_INTERFACE(Rpc_sysio_dataspace, Rpc_syscall);
+		GENODE_RPC_INTERFACE(Rpc_sysio_dataspace, Rpc_info_dataspace, Rpc_syscall);
 	};
 }
 
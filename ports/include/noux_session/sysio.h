@@ -349,11 +349,78 @@ namespace Noux {
 
 		enum Clock_error     { CLOCK_ERR_INVALID, CLOCK_ERR_FAULT, CLOCK_ERR_NO_PERM };
 
+		enum Splice_error    { SPLICE_ERR_INVALID = NUM_GENERAL_ERRORS,
+		                       SPLICE_ERR_AGAIN, SPLICE_ERR_IO };
+
+		/**
+		 * File-descriptor operation applied to a process created via spawn
+		 *
+		 * The operations are executed in order on the file descriptors
+		 * inherited by the new process.
+		 */
+		struct Spawn_fd_action
+		{
+			enum Type { DUP2, CLOSE };
+
+			Type type;
+			int  fd;
+			int  to_fd;   /* only used by 'DUP2' */
+		};
+
+		enum { MAX_SPAWN_FD_ACTIONS = 16 };
+
 		enum Utimes_error    { UTIMES_ERR_ACCESS, UTIMES_ERR_FAUL, UTIMES_ERR_EIO,
 		                       UTIMES_ERR_NAME_TOO_LONG, UTIMES_ERR_NO_ENTRY,
 		                       UTIMES_ERR_NOT_DIRECTORY, UTIMES_ERR_NO_PERM,
 		                       UTIMES_ERR_READ_ONLY };
 
+		/**
+		 * Ring of batched I/O operations
+		 *
+		 * The libc queues independent operations as submission entries and
+		 * lets the Noux server execute all of them with a single
+		 * 'SYSCALL_RING'. The server stores the result of each operation
+		 * in the entry and advances 'completed'. Payload data is carried
+		 * in 'data'. Operations still pending when the process exits are
+		 * executed by the server before the file descriptors are closed.
+		 *
+		 * The ring is located outside of the syscall-argument union.
+		 * Hence, submitting queued operations does not interfere with the
+		 * arguments of a regular syscall.
+		 */
+		struct Ring
+		{
+			enum { MAX_ENTRIES = 32, DATA_SIZE = 16*1024 };
+
+			enum Opcode { OP_WRITE, OP_READ };
+
+			struct Entry
+			{
+				/* submission */
+				Opcode opcode;
+				int    fd;
+				size_t offset;   /* payload position within 'data' */
+				size_t count;    /* payload size in bytes */
+
+				/* completion */
+				bool   ok;
+				size_t result;   /* number of bytes written or read */
+			};
+
+			unsigned submitted;  /* number of queued entries */
+			unsigned completed;  /* number of executed entries */
+			size_t   data_used;  /* allocated bytes of 'data' */
+
+			Entry entries[MAX_ENTRIES];
+			char  data[DATA_SIZE];
+
+			bool pending() const { return completed < submitted; }
+
+			void reset() { submitted = completed = 0; data_used = 0; }
+		};
+
+		Ring ring;
+
 		union {
 			General_error   general;
 			Stat_error      stat;
@@ -379,6 +446,7 @@ namespace Noux {
 			Socket_error    socket;
 			Clock_error     clock;
 			Utimes_error    utimes;
+			Splice_error    splice;
 		} error;
 
 		union {
@@ -416,6 +484,12 @@ namespace Noux {
 
 			SYSIO_DECL(execve,      { Path filename; Args args; Env env; }, { });
 
+			/* errors are reported via 'error.execve' */
+			SYSIO_DECL(spawn,       { Path filename; Args args; Env env;
+			                          unsigned num_fd_actions;
+			                          Spawn_fd_action fd_actions[MAX_SPAWN_FD_ACTIONS]; },
+			                        { int pid; });
+
 			SYSIO_DECL(select,      { Select_fds fds; Select_timeout timeout; },
 			                        { Select_fds fds; });
 
@@ -490,6 +564,9 @@ namespace Noux {
 
 			SYSIO_DECL(utimes,      { Path path; unsigned long sec; unsigned long usec; },
 			                        { });
+
+			SYSIO_DECL(splice,      { int fd_in; int fd_out; size_t count; },
+			                        { size_t count; });
 		};
 	};
 };
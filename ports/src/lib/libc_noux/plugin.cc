@@ -22,6 +22,7 @@
 /* noux includes */
 #include <noux_session/connection.h>
 #include <noux_session/sysio.h>
+#include <noux_session/info.h>
 
 /* libc plugin includes */
 #include <libc-plugin/plugin.h>
@@ -39,6 +40,10 @@
 #include <unistd.h>
 #include <termios.h>
 #include <pwd.h>
+#include <sched.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* libc-internal includes */
@@ -56,25 +61,34 @@ class Noux_connection
 
 		Noux::Connection _connection;
 		Noux::Sysio      *_sysio;
+		Noux::Info       *_info;
 
 		Noux::Sysio *_obtain_sysio()
 		{
 			return Genode::env()->rm_session()->attach(_connection.sysio_dataspace());
 		}
 
+		Noux::Info *_obtain_info()
+		{
+			return Genode::env()->rm_session()->attach(_connection.info_dataspace());
+		}
+
 	public:
 
-		Noux_connection() : _sysio(_obtain_sysio()) { }
+		Noux_connection() : _sysio(_obtain_sysio()), _info(_obtain_info()) { }
 
 		void reconnect()
 		{
 			new (&_connection) Noux_connection;
 			Genode::env()->rm_session()->detach(_sysio);
+			Genode::env()->rm_session()->detach(_info);
 			_sysio = _obtain_sysio();
+			_info  = _obtain_info();
 		}
 
 		Noux::Session *session() { return &_connection; }
 		Noux::Sysio   *sysio()   { return  _sysio; }
+		Noux::Info    *info()    { return  _info; }
 };
 
 
@@ -87,11 +101,320 @@ Noux_connection *noux_connection()
 
 Noux::Session *noux()  { return noux_connection()->session(); }
 Noux::Sysio   *sysio() { return noux_connection()->sysio();   }
+Noux::Info    *info()  { return noux_connection()->info();    }
+
+
+/**
+ * Account call that was answered via the process-information page
+ */
+static void count_local(Noux::Session::Syscall sc)
+{
+	if (sc >= 0 && (int)sc < Noux::Info::MAX_SYSCALLS)
+		info()->local_count[sc]++;
+}
 
 
 enum { FS_BLOCK_SIZE = 1024 };
 
 
+/*******************************
+ ** Batching of I/O operations **
+ *******************************/
+
+/*
+ * Reads and writes of regular files are queued in the ring of the sysio
+ * dataspace and executed by Noux in one go, either on demand or before the
+ * next regular system call. Batching is restricted to file descriptors that
+ * were opened by the process itself and never shared via 'dup' or 'fork'.
+ * Otherwise, deferred writes and read-ahead data would become visible to
+ * other users of the same file offset.
+ */
+
+enum {
+	MAX_FDS        = 64,                         /* size of Noux' fd table */
+	COALESCE_LIMIT = 1024,                       /* max size of deferred writes */
+	READAHEAD_SIZE = Noux::Sysio::CHUNK_SIZE,
+};
+
+
+struct Fd_state
+{
+	enum Kind {
+		OTHER = 0,     /* inherited, shared, or non-file fd */
+		CANDIDATE,     /* opened by this process, type not yet known */
+		REGULAR_FILE
+	};
+
+	Kind  kind;
+	bool  write_failed;   /* a deferred write failed */
+
+	/* read-ahead buffer, allocated on first use */
+	char          *ra_buf;
+	Genode::size_t ra_offset;
+	Genode::size_t ra_len;
+
+	Genode::size_t ra_avail() const { return ra_len - ra_offset; }
+};
+
+
+static Fd_state fd_states[MAX_FDS];
+
+
+static Fd_state *fd_state(int fd)
+{
+	return (fd >= 0 && fd < MAX_FDS) ? &fd_states[fd] : 0;
+}
+
+
+/**
+ * Execute all operations queued in the ring
+ *
+ * The entries and data of the ring stay intact until the next operation is
+ * queued. So the results of submitted reads can be picked up after calling
+ * this function.
+ */
+static void flush_ring()
+{
+	Noux::Sysio::Ring &ring = sysio()->ring;
+
+	if (!ring.submitted)
+		return;
+
+	noux()->syscall(Noux::Session::SYSCALL_RING);
+
+	/* remember failed deferred writes for reporting them via write or close */
+	for (unsigned i = 0; i < ring.submitted; i++) {
+		Noux::Sysio::Ring::Entry const &e = ring.entries[i];
+
+		if (e.opcode != Noux::Sysio::Ring::OP_WRITE || (e.ok && e.result == e.count))
+			continue;
+
+		Fd_state *state = fd_state(e.fd);
+		if (state)
+			state->write_failed = true;
+	}
+
+	ring.reset();
+}
+
+
+/**
+ * Perform system call after executing the operations queued in the ring
+ */
+static bool noux_syscall(Noux::Session::Syscall sc)
+{
+	flush_ring();
+	return noux()->syscall(sc);
+}
+
+
+/**
+ * Append operation to the ring, flush the ring if it is full
+ *
+ * \param count  payload size, must not exceed 'Ring::DATA_SIZE'
+ */
+static Noux::Sysio::Ring::Entry *queue_ring_entry(Noux::Sysio::Ring::Opcode op,
+                                                  int fd, Genode::size_t count)
+{
+	Noux::Sysio::Ring &ring = sysio()->ring;
+
+	if (ring.submitted == Noux::Sysio::Ring::MAX_ENTRIES
+	 || sizeof(ring.data) - ring.data_used < count)
+		flush_ring();
+
+	Noux::Sysio::Ring::Entry &e = ring.entries[ring.submitted];
+	e.opcode = op;
+	e.fd     = fd;
+	e.offset = ring.data_used;
+	e.count  = count;
+	e.ok     = false;
+	e.result = 0;
+
+	ring.data_used += count;
+	ring.submitted++;
+	return &e;
+}
+
+
+/**
+ * Return true if batching may be applied to the file descriptor
+ */
+static bool batching_enabled(int fd)
+{
+	Fd_state *state = fd_state(fd);
+	if (!state || state->kind == Fd_state::OTHER)
+		return false;
+
+	if (state->kind == Fd_state::CANDIDATE) {
+
+		/* pipes and terminals must not be delayed or read ahead */
+		sysio()->fstat_in.fd = fd;
+		bool const regular = noux_syscall(Noux::Session::SYSCALL_FSTAT)
+		                  && (sysio()->fstat_out.st.mode & S_IFMT)
+		                      == Noux::Sysio::STAT_MODE_FILE;
+
+		state->kind = regular ? Fd_state::REGULAR_FILE : Fd_state::OTHER;
+	}
+	return state->kind == Fd_state::REGULAR_FILE;
+}
+
+
+/**
+ * Reset batching state of file descriptor
+ */
+static void reset_fd_state(int fd, Fd_state::Kind kind)
+{
+	Fd_state *state = fd_state(fd);
+	if (!state)
+		return;
+
+	state->kind         = kind;
+	state->write_failed = false;
+	state->ra_offset    = state->ra_len = 0;
+}
+
+
+/**
+ * Drop read-ahead data and move the file offset back to the consumed position
+ */
+static void discard_readahead(int fd)
+{
+	Fd_state *state = fd_state(fd);
+	if (!state || !state->ra_avail())
+		return;
+
+	sysio()->lseek_in.fd     = fd;
+	sysio()->lseek_in.offset = -(off_t)state->ra_avail();
+	sysio()->lseek_in.whence = Noux::Sysio::LSEEK_CUR;
+
+	state->ra_offset = state->ra_len = 0;
+
+	noux_syscall(Noux::Session::SYSCALL_LSEEK);
+}
+
+
+/**
+ * Prepare file descriptors for being shared with another program
+ */
+static void share_all_fds()
+{
+	for (int fd = 0; fd < MAX_FDS; fd++) {
+		discard_readahead(fd);
+		fd_states[fd].kind = Fd_state::OTHER;
+	}
+	flush_ring();
+}
+
+
+/**
+ * Read from regular file using the ring, keep surplus data as read-ahead
+ *
+ * \return  number of bytes read, or -1 if no data could be read
+ */
+static ssize_t read_batched(int fd, char *dst, Genode::size_t count)
+{
+	Fd_state          &state = *fd_state(fd);
+	Noux::Sysio::Ring &ring  = sysio()->ring;
+
+	Genode::size_t sum = 0;
+	while (count > 0) {
+
+		Genode::size_t const request =
+			Genode::max((Genode::size_t)READAHEAD_SIZE,
+			            Genode::min(count, (Genode::size_t)Noux::Sysio::Ring::DATA_SIZE));
+
+		Noux::Sysio::Ring::Entry const &e =
+			*queue_ring_entry(Noux::Sysio::Ring::OP_READ, fd, request);
+		flush_ring();
+
+		if (!e.ok && !e.result) {
+			if (sum)
+				break;
+			errno = EIO;
+			return -1;
+		}
+
+		char const          *src = ring.data + e.offset;
+		Genode::size_t const n   = Genode::min(count, e.result);
+
+		Genode::memcpy(dst + sum, src, n);
+		sum   += n;
+		count -= n;
+
+		/* keep surplus for subsequent reads */
+		if (e.result > n) {
+			if (!state.ra_buf)
+				state.ra_buf = (char *)malloc(READAHEAD_SIZE);
+
+			if (!state.ra_buf) {
+				sysio()->lseek_in.fd     = fd;
+				sysio()->lseek_in.offset = -(off_t)(e.result - n);
+				sysio()->lseek_in.whence = Noux::Sysio::LSEEK_CUR;
+				noux_syscall(Noux::Session::SYSCALL_LSEEK);
+				break;
+			}
+
+			Genode::memcpy(state.ra_buf, src + n, e.result - n);
+			state.ra_offset = 0;
+			state.ra_len    = e.result - n;
+		}
+
+		if (e.result < request)
+			break; /* end of file */
+	}
+	return sum;
+}
+
+
+/**
+ * Write to regular file using the ring
+ *
+ * Small writes are deferred until the ring is flushed. Larger writes are
+ * executed immediately in pieces of the ring's data size.
+ */
+static ssize_t write_batched(int fd, char const *src, Genode::size_t count)
+{
+	Fd_state          &state = *fd_state(fd);
+	Noux::Sysio::Ring &ring  = sysio()->ring;
+
+	if (state.write_failed) {
+		state.write_failed = false;
+		errno = EIO;
+		return -1;
+	}
+
+	if (count <= COALESCE_LIMIT) {
+		Noux::Sysio::Ring::Entry const &e =
+			*queue_ring_entry(Noux::Sysio::Ring::OP_WRITE, fd, count);
+		Genode::memcpy(ring.data + e.offset, src, count);
+		return count;
+	}
+
+	Genode::size_t sum = 0;
+	while (sum < count) {
+
+		Genode::size_t const n =
+			Genode::min(count - sum, (Genode::size_t)Noux::Sysio::Ring::DATA_SIZE);
+
+		Noux::Sysio::Ring::Entry const &e =
+			*queue_ring_entry(Noux::Sysio::Ring::OP_WRITE, fd, n);
+		Genode::memcpy(ring.data + e.offset, src + sum, n);
+		flush_ring();
+
+		sum += e.result;
+
+		if (!e.ok || e.result != n) {
+			state.write_failed = false;
+			if (sum)
+				break;
+			errno = EIO;
+			return -1;
+		}
+	}
+	return sum;
+}
+
+
 /***********************************************
  ** Overrides of libc default implementations **
  ***********************************************/
@@ -121,20 +444,19 @@ extern "C" struct passwd *getpwuid(uid_t uid)
 		/* .pw_fields  = */ 0
 	};
 
-	sysio()->userinfo_in.uid = uid;
-	sysio()->userinfo_in.request = Noux::Sysio::USERINFO_GET_ALL;
+	count_local(Noux::Session::SYSCALL_USERINFO);
 
-	if (!noux()->syscall(Noux::Session::SYSCALL_USERINFO)) {
+	/* Noux supports exactly one user */
+	if (uid != info()->uid)
 		return (struct passwd *)0;
-	}
 
-	/* SYSCALL_USERINFO assures that strings are always '\0' terminated */
-	Genode::memcpy(name,  sysio()->userinfo_out.name,  sizeof (sysio()->userinfo_out.name));
-	Genode::memcpy(home,  sysio()->userinfo_out.home,  sizeof (sysio()->userinfo_out.home));
-	Genode::memcpy(shell, sysio()->userinfo_out.shell, sizeof (sysio()->userinfo_out.shell));
+	/* the info page contains '\0' terminated strings */
+	Genode::memcpy(name,  info()->name,  sizeof(name));
+	Genode::memcpy(home,  info()->home,  sizeof(home));
+	Genode::memcpy(shell, info()->shell, sizeof(shell));
 
-	pw.pw_uid = sysio()->userinfo_out.uid;
-	pw.pw_gid = sysio()->userinfo_out.gid;
+	pw.pw_uid = info()->uid;
+	pw.pw_gid = info()->gid;
 
 	return &pw;
 }
@@ -142,13 +464,8 @@ extern "C" struct passwd *getpwuid(uid_t uid)
 
 extern "C" uid_t getgid()
 {
-	sysio()->userinfo_in.request = Noux::Sysio::USERINFO_GET_GID;
-
-	if (!noux()->syscall(Noux::Session::SYSCALL_USERINFO))
-		return 0;
-
-	uid_t gid = sysio()->userinfo_out.gid;
-	return gid;
+	count_local(Noux::Session::SYSCALL_USERINFO);
+	return info()->gid;
 }
 
 
@@ -160,14 +477,8 @@ extern "C" uid_t getegid()
 
 extern "C" uid_t getuid()
 {
-	sysio()->userinfo_in.request = Noux::Sysio::USERINFO_GET_UID;
-
-	if (!noux()->syscall(Noux::Session::SYSCALL_USERINFO))
-		return 0;
-
-	uid_t uid = sysio()->userinfo_out.uid;
-
-	return uid;
+	count_local(Noux::Session::SYSCALL_USERINFO);
+	return info()->uid;
 }
 
 
@@ -221,6 +532,43 @@ static bool serialize_string_array(char const * const * array, char *dst, Genode
 }
 
 
+/**
+ * Marshal binary name, arguments, and environment for execve and spawn
+ *
+ * \return false if the arguments or environment exceed the buffers
+ */
+static bool marshal_exec_args(char const *filename,
+                              char *const argv[], char *const envp[],
+                              Noux::Sysio::Path &filename_buf,
+                              Noux::Sysio::Args &args_buf,
+                              Noux::Sysio::Env  &env_buf)
+{
+	Genode::strncpy(filename_buf, filename, sizeof(filename_buf));
+	if (!serialize_string_array(argv, args_buf, sizeof(args_buf))) {
+	    PERR("execve: argument buffer exceeded");
+	    return false;
+	}
+
+	/* communicate the current working directory as environment variable */
+
+	size_t noux_cwd_len = Genode::snprintf(env_buf, sizeof(env_buf), "NOUX_CWD=");
+
+	if (!getcwd(&env_buf[noux_cwd_len], sizeof(env_buf) - noux_cwd_len)) {
+	    PERR("execve: environment buffer exceeded");
+	    return false;
+	}
+
+	noux_cwd_len = strlen(env_buf) + 1;
+
+	if (!serialize_string_array(envp, &env_buf[noux_cwd_len],
+	                            sizeof(env_buf) - noux_cwd_len)) {
+	    PERR("execve: environment buffer exceeded");
+	    return false;
+	}
+	return true;
+}
+
+
 /**
  * Return number of marhalled file descriptors into select argument buffer
  *
@@ -325,7 +673,7 @@ extern "C" int select(int nfds, fd_set *readfds, fd_set *writefds,
 	/*
 	 * Perform syscall
 	 */
-	if (!noux()->syscall(Noux::Session::SYSCALL_SELECT)) {
+	if (!noux_syscall(Noux::Session::SYSCALL_SELECT)) {
 		PWRN("select syscall failed");
 //		switch (sysio()->error.select) {
 //		case Noux::Sysio::SELECT_NONEXISTENT: errno = ENOENT; break;
@@ -401,11 +749,15 @@ extern "C" pid_t fork(void)
 	} else {
 
 		/* got here during the normal control flow of the fork call */
+
+		/* parent and child share the file offsets from now on */
+		share_all_fds();
+
 		sysio()->fork_in.ip              = (Genode::addr_t)(&fork_trampoline);
 		sysio()->fork_in.sp              = (Genode::addr_t)(&stack[STACK_SIZE]);
 		sysio()->fork_in.parent_cap_addr = (Genode::addr_t)(&new_parent);
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_FORK)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_FORK)) {
 			PERR("fork error %d", sysio()->error.general);
 		}
 
@@ -417,10 +769,490 @@ extern "C" pid_t fork(void)
 extern "C" pid_t vfork(void) { return fork(); }
 
 
+/**********************
+ ** Process spawning **
+ **********************/
+
+/*
+ * In contrast to fork followed by execve, 'SYSCALL_SPAWN' lets Noux start
+ * the new process directly from the binary. So the address space of the
+ * caller does not need to be copied. File actions are passed to Noux as
+ * list of dup2 and close operations. Open actions are executed by the
+ * caller on a temporary file descriptor, which is then moved to the
+ * target descriptor of the new process.
+ *
+ * Spawn attributes are recorded but ignored because Noux supports neither
+ * signals nor process groups.
+ *
+ * The libc's own implementations of these functions are not built, so
+ * the definitions here are the only ones.
+ */
+
+/* pointer to environment, provided by libc */
+extern char **environ;
+
+
+struct Spawn_file_action
+{
+	enum Type { OPEN, DUP2, CLOSE };
+
+	Type   type;
+	int    fd;
+	int    to_fd;
+	char  *path;
+	int    oflag;
+	mode_t mode;
+};
+
+
+struct __posix_spawn_file_actions
+{
+	enum { MAX_ACTIONS = Noux::Sysio::MAX_SPAWN_FD_ACTIONS };
+
+	unsigned          num;
+	Spawn_file_action actions[MAX_ACTIONS];
+};
+
+
+static int add_spawn_file_action(posix_spawn_file_actions_t *fa,
+                                 Spawn_file_action const &action)
+{
+	if ((*fa)->num == __posix_spawn_file_actions::MAX_ACTIONS)
+		return ENOMEM;
+
+	(*fa)->actions[(*fa)->num++] = action;
+	return 0;
+}
+
+
+extern "C" int posix_spawn_file_actions_init(posix_spawn_file_actions_t *fa)
+{
+	*fa = (posix_spawn_file_actions_t)malloc(sizeof(**fa));
+	if (!*fa)
+		return ENOMEM;
+
+	(*fa)->num = 0;
+	return 0;
+}
+
+
+extern "C" int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t *fa)
+{
+	for (unsigned i = 0; i < (*fa)->num; i++)
+		free((*fa)->actions[i].path);
+
+	free(*fa);
+	return 0;
+}
+
+
+extern "C" int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t *fa,
+                                                int fd, const char *path,
+                                                int oflag, mode_t mode)
+{
+	if (fd < 0)
+		return EBADF;
+
+	Spawn_file_action action = { Spawn_file_action::OPEN, fd, fd,
+	                             strdup(path), oflag, mode };
+	if (!action.path)
+		return ENOMEM;
+
+	int const err = add_spawn_file_action(fa, action);
+	if (err)
+		free(action.path);
+
+	return err;
+}
+
+
+extern "C" int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t *fa,
+                                                int fd, int to_fd)
+{
+	if (fd < 0 || to_fd < 0)
+		return EBADF;
+
+	Spawn_file_action action = { Spawn_file_action::DUP2, fd, to_fd, 0, 0, 0 };
+	return add_spawn_file_action(fa, action);
+}
+
+
+extern "C" int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t *fa,
+                                                 int fd)
+{
+	if (fd < 0)
+		return EBADF;
+
+	Spawn_file_action action = { Spawn_file_action::CLOSE, fd, fd, 0, 0, 0 };
+	return add_spawn_file_action(fa, action);
+}
+
+
+struct __posix_spawnattr
+{
+	short              flags;
+	pid_t              pgroup;
+	struct sched_param schedparam;
+	int                schedpolicy;
+	sigset_t           sigdefault;
+	sigset_t           sigmask;
+};
+
+
+extern "C" int posix_spawnattr_init(posix_spawnattr_t *attr)
+{
+	*attr = (posix_spawnattr_t)calloc(1, sizeof(**attr));
+	return *attr ? 0 : ENOMEM;
+}
+
+
+extern "C" int posix_spawnattr_destroy(posix_spawnattr_t *attr)
+{
+	free(*attr);
+	*attr = 0;
+	return 0;
+}
+
+
+#define SPAWNATTR_ACCESSORS(type, name) \
+extern "C" int posix_spawnattr_get##name(const posix_spawnattr_t *attr, type *value) \
+{ \
+	*value = (*attr)->name; \
+	return 0; \
+} \
+\
+extern "C" int posix_spawnattr_set##name(posix_spawnattr_t *attr, type const *value) \
+{ \
+	(*attr)->name = *value; \
+	return 0; \
+}
+
+SPAWNATTR_ACCESSORS(struct sched_param, schedparam)
+SPAWNATTR_ACCESSORS(sigset_t,           sigdefault)
+SPAWNATTR_ACCESSORS(sigset_t,           sigmask)
+
+#undef SPAWNATTR_ACCESSORS
+
+
+extern "C" int posix_spawnattr_getflags(const posix_spawnattr_t *attr, short *flags)
+{
+	*flags = (*attr)->flags;
+	return 0;
+}
+
+
+extern "C" int posix_spawnattr_setflags(posix_spawnattr_t *attr, short flags)
+{
+	(*attr)->flags = flags;
+	return 0;
+}
+
+
+extern "C" int posix_spawnattr_getpgroup(const posix_spawnattr_t *attr, pid_t *pgroup)
+{
+	*pgroup = (*attr)->pgroup;
+	return 0;
+}
+
+
+extern "C" int posix_spawnattr_setpgroup(posix_spawnattr_t *attr, pid_t pgroup)
+{
+	(*attr)->pgroup = pgroup;
+	return 0;
+}
+
+
+extern "C" int posix_spawnattr_getschedpolicy(const posix_spawnattr_t *attr, int *policy)
+{
+	*policy = (*attr)->schedpolicy;
+	return 0;
+}
+
+
+extern "C" int posix_spawnattr_setschedpolicy(posix_spawnattr_t *attr, int policy)
+{
+	(*attr)->schedpolicy = policy;
+	return 0;
+}
+
+
+extern "C" int posix_spawn(pid_t *pid, const char *path,
+                           const posix_spawn_file_actions_t *fa,
+                           const posix_spawnattr_t *,
+                           char *const argv[], char *const envp[])
+{
+	unsigned const num_actions = fa ? (*fa)->num : 0;
+
+	/* the new process shares the file offsets with us */
+	share_all_fds();
+
+	/* execute open actions, an open action results in a dup2 and a close */
+	int      tmp_fds[__posix_spawn_file_actions::MAX_ACTIONS];
+	unsigned num_fd_actions = 0;
+	int      err = 0;
+
+	for (unsigned i = 0; i < num_actions; i++) {
+
+		Spawn_file_action const &action = (*fa)->actions[i];
+
+		tmp_fds[i] = -1;
+		num_fd_actions += (action.type == Spawn_file_action::OPEN) ? 2 : 1;
+
+		if (action.type != Spawn_file_action::OPEN || err)
+			continue;
+
+		tmp_fds[i] = open(action.path, action.oflag, action.mode);
+		if (tmp_fds[i] < 0)
+			err = errno;
+	}
+
+	if (!err && num_fd_actions > Noux::Sysio::MAX_SPAWN_FD_ACTIONS)
+		err = ENOMEM;
+
+	if (!err && !marshal_exec_args(path, argv, envp,
+	                               sysio()->spawn_in.filename,
+	                               sysio()->spawn_in.args,
+	                               sysio()->spawn_in.env))
+		err = E2BIG;
+
+	if (!err) {
+
+		Noux::Sysio::Spawn_fd_action *fd_actions = sysio()->spawn_in.fd_actions;
+		unsigned n = 0;
+
+		for (unsigned i = 0; i < num_actions; i++) {
+
+			Spawn_file_action const &action = (*fa)->actions[i];
+
+			switch (action.type) {
+
+			case Spawn_file_action::OPEN:
+				{
+					Noux::Sysio::Spawn_fd_action move_action  = { Noux::Sysio::Spawn_fd_action::DUP2,
+					                                              tmp_fds[i], action.fd };
+					Noux::Sysio::Spawn_fd_action close_action = { Noux::Sysio::Spawn_fd_action::CLOSE,
+					                                              tmp_fds[i], -1 };
+					fd_actions[n++] = move_action;
+					if (tmp_fds[i] != action.fd)
+						fd_actions[n++] = close_action;
+					break;
+				}
+
+			case Spawn_file_action::DUP2:
+				{
+					Noux::Sysio::Spawn_fd_action dup2_action = { Noux::Sysio::Spawn_fd_action::DUP2,
+					                                             action.fd, action.to_fd };
+					fd_actions[n++] = dup2_action;
+					break;
+				}
+
+			case Spawn_file_action::CLOSE:
+				{
+					Noux::Sysio::Spawn_fd_action close_action = { Noux::Sysio::Spawn_fd_action::CLOSE,
+					                                              action.fd, -1 };
+					fd_actions[n++] = close_action;
+					break;
+				}
+			}
+		}
+		sysio()->spawn_in.num_fd_actions = n;
+
+		if (noux_syscall(Noux::Session::SYSCALL_SPAWN)) {
+			if (pid)
+				*pid = sysio()->spawn_out.pid;
+		} else {
+			switch (sysio()->error.execve) {
+			case Noux::Sysio::EXECVE_NONEXISTENT: err = ENOENT; break;
+			default:                              err = EINVAL; break;
+			}
+		}
+	}
+
+	/* release temporary file descriptors */
+	for (unsigned i = 0; i < num_actions; i++)
+		if (tmp_fds[i] >= 0)
+			close(tmp_fds[i]);
+
+	return err;
+}
+
+
+extern "C" int posix_spawnp(pid_t *pid, const char *file,
+                            const posix_spawn_file_actions_t *fa,
+                            const posix_spawnattr_t *attr,
+                            char *const argv[], char *const envp[])
+{
+	if (strchr(file, '/'))
+		return posix_spawn(pid, file, fa, attr, argv, envp);
+
+	char const *search_path = getenv("PATH");
+	if (!search_path)
+		search_path = "/bin:/usr/bin";
+
+	/* try each directory of the search path */
+	for (char const *dir = search_path; ; ) {
+
+		char const *end = strchr(dir, ':');
+		size_t const dir_len = end ? (size_t)(end - dir) : strlen(dir);
+
+		/* an empty entry denotes the current directory */
+		char const  *prefix     = dir_len ? dir : ".";
+		size_t const prefix_len = dir_len ? dir_len : 1;
+
+		char path[Noux::Sysio::MAX_PATH_LEN];
+		if (prefix_len + strlen(file) + 2 <= sizeof(path)) {
+
+			Genode::memcpy(path, prefix, prefix_len);
+			path[prefix_len] = '/';
+			Genode::strncpy(path + prefix_len + 1, file,
+			                sizeof(path) - prefix_len - 1);
+
+			int const err = posix_spawn(pid, path, fa, attr, argv, envp);
+			if (err != ENOENT)
+				return err;
+		}
+
+		if (!end)
+			return ENOENT;
+
+		dir = end + 1;
+	}
+}
+
+
+extern "C" int system(const char *command)
+{
+	/* a shell is always available */
+	if (!command)
+		return 1;
+
+	char *const argv[] = { (char *)"sh", (char *)"-c", (char *)command, 0 };
+
+	pid_t pid = 0;
+	int const err = posix_spawn(&pid, "/bin/sh", 0, 0, argv, environ);
+	if (err) {
+		errno = err;
+		return -1;
+	}
+
+	int status = 0;
+	if (waitpid(pid, &status, 0) < 0)
+		return -1;
+
+	return status;
+}
+
+
+/*
+ * Processes started via 'popen', needed for 'pclose'
+ */
+struct Popen_process
+{
+	Popen_process *next;
+	FILE          *file;
+	pid_t          pid;
+};
+
+static Popen_process *popen_processes;
+
+
+extern "C" FILE *popen(const char *command, const char *type)
+{
+	if (!type || (type[0] != 'r' && type[0] != 'w') || type[1] != 0) {
+		errno = EINVAL;
+		return 0;
+	}
+
+	bool const reading = (type[0] == 'r');
+
+	Popen_process *process = (Popen_process *)malloc(sizeof(Popen_process));
+	if (!process) {
+		errno = ENOMEM;
+		return 0;
+	}
+
+	int fds[2];
+	if (pipe(fds) < 0) {
+		free(process);
+		return 0;
+	}
+
+	int const local_fd  = reading ? fds[0] : fds[1];
+	int const remote_fd = reading ? fds[1] : fds[0];
+	int const target_fd = reading ? 1 : 0;
+
+	posix_spawn_file_actions_t fa;
+	int err = posix_spawn_file_actions_init(&fa);
+
+	if (!err && remote_fd != target_fd) {
+		err = posix_spawn_file_actions_adddup2(&fa, remote_fd, target_fd);
+		if (!err)
+			err = posix_spawn_file_actions_addclose(&fa, remote_fd);
+	}
+	if (!err)
+		err = posix_spawn_file_actions_addclose(&fa, local_fd);
+
+	/* streams of former 'popen' calls must not be inherited */
+	for (Popen_process *p = popen_processes; p && !err; p = p->next)
+		err = posix_spawn_file_actions_addclose(&fa, fileno(p->file));
+
+	char *const argv[] = { (char *)"sh", (char *)"-c", (char *)command, 0 };
+
+	if (!err)
+		err = posix_spawn(&process->pid, "/bin/sh", &fa, 0, argv, environ);
+
+	posix_spawn_file_actions_destroy(&fa);
+	close(remote_fd);
+
+	if (err) {
+		close(local_fd);
+		free(process);
+		errno = err;
+		return 0;
+	}
+
+	process->file = fdopen(local_fd, type);
+	if (!process->file) {
+		close(local_fd);
+		waitpid(process->pid, 0, 0);
+		free(process);
+		return 0;
+	}
+
+	process->next = popen_processes;
+	popen_processes = process;
+
+	return process->file;
+}
+
+
+extern "C" int pclose(FILE *file)
+{
+	Popen_process **p = &popen_processes;
+	for (; *p && (*p)->file != file; p = &(*p)->next);
+
+	if (!*p) {
+		errno = ECHILD;
+		return -1;
+	}
+
+	Popen_process *process = *p;
+	*p = process->next;
+
+	fclose(file);
+
+	int status = 0;
+	pid_t const pid = waitpid(process->pid, &status, 0);
+	free(process);
+
+	return pid < 0 ? -1 : status;
+}
+
+
 extern "C" pid_t getpid(void)
 {
-	noux()->syscall(Noux::Session::SYSCALL_GETPID);
-	return sysio()->getpid_out.pid;
+	count_local(Noux::Session::SYSCALL_GETPID);
+	return info()->pid;
 }
 
 
@@ -451,7 +1283,7 @@ extern "C" pid_t _wait4(pid_t pid, int *status, int options,
 {
 	sysio()->wait4_in.pid    = pid;
 	sysio()->wait4_in.nohang = !!(options & WNOHANG);
-	if (!noux()->syscall(Noux::Session::SYSCALL_WAIT4)) {
+	if (!noux_syscall(Noux::Session::SYSCALL_WAIT4)) {
 		PERR("wait4 error %d", sysio()->error.general);
 		return -1;
 	}
@@ -478,7 +1310,6 @@ extern "C" int clock_gettime(clockid_t clk_id, struct timespec *tp)
 	/* we currently only support CLOCK_SECOND */
 	switch (clk_id) {
 	case CLOCK_SECOND:
-		sysio()->clock_gettime_in.clock_id = Noux::Sysio::CLOCK_ID_SECOND;
 		break;
 	default:
 		/* let's save the trip to noux and return directly */
@@ -486,17 +1317,11 @@ extern "C" int clock_gettime(clockid_t clk_id, struct timespec *tp)
 		return -1;
 	}
 
-	if (!noux()->syscall(Noux::Session::SYSCALL_CLOCK_GETTIME)) {
-		switch (sysio()->error.clock) {
-		case Noux::Sysio::CLOCK_ERR_INVALID: errno = EINVAL; break;
-		default:                             errno = 0;      break;
-		}
-
-		return -1;
-	}
+	count_local(Noux::Session::SYSCALL_CLOCK_GETTIME);
 
-	tp->tv_sec = sysio()->clock_gettime_out.sec;
-	tp->tv_nsec = sysio()->clock_gettime_out.nsec;
+	/* same clock as used by SYSCALL_CLOCK_GETTIME */
+	tp->tv_sec  = info()->clock.read() / 1000;
+	tp->tv_nsec = 0;
 
 	return 0;
 }
@@ -504,13 +1329,13 @@ extern "C" int clock_gettime(clockid_t clk_id, struct timespec *tp)
 
 extern "C" int gettimeofday(struct timeval *tv, struct timezone *tz)
 {
-	if (!noux()->syscall(Noux::Session::SYSCALL_GETTIMEOFDAY)) {
-		errno = EINVAL;
-		return -1;
-	}
+	count_local(Noux::Session::SYSCALL_GETTIMEOFDAY);
 
-	tv->tv_sec  = sysio()->gettimeofday_out.sec;
-	tv->tv_usec = sysio()->gettimeofday_out.usec;
+	/* same clock as used by SYSCALL_GETTIMEOFDAY */
+	unsigned long const time = info()->clock.read();
+
+	tv->tv_sec  = time / 1000;
+	tv->tv_usec = (time % 1000) * 1000;
 
 	return 0;
 }
@@ -518,7 +1343,7 @@ extern "C" int gettimeofday(struct timeval *tv, struct timezone *tz)
 
 extern "C" int utimes(const char* path, const struct timeval *times)
 {
-	if (!noux()->syscall(Noux::Session::SYSCALL_UTIMES)) {
+	if (!noux_syscall(Noux::Session::SYSCALL_UTIMES)) {
 		errno = EINVAL;
 		return -1;
 	}
@@ -597,6 +1422,8 @@ namespace {
 				_stderr(Libc::file_descriptor_allocator()->alloc(this, noux_context(2), 2))
 			{ }
 
+			char const *name() { return "noux"; }
+
 			bool supports_execve(char const *, char *const[],
 			                     char *const[])                  { return true; }
 			bool supports_open(char const *, int)                { return true; }
@@ -676,37 +1503,18 @@ namespace {
 				PDBG("envp[%d]='%s'", i, envp[i]);
 		}
 
-		Genode::strncpy(sysio()->execve_in.filename, filename, sizeof(sysio()->execve_in.filename));
-		if (!serialize_string_array(argv, sysio()->execve_in.args,
-		                            sizeof(sysio()->execve_in.args))) {
-		    PERR("execve: argument buffer exceeded");
-		    errno = E2BIG;
-		    return -1;
-		}
-
-		/* communicate the current working directory as environment variable */
-
-		size_t noux_cwd_len = Genode::snprintf(sysio()->execve_in.env,
-		                                       sizeof(sysio()->execve_in.env),
-		                                       "NOUX_CWD=");
+		/* the new program continues at the file offsets consumed so far */
+		share_all_fds();
 
-		if (!getcwd(&(sysio()->execve_in.env[noux_cwd_len]),
-		            sizeof(sysio()->execve_in.env) - noux_cwd_len)) {
-		    PERR("execve: environment buffer exceeded");
+		if (!marshal_exec_args(filename, argv, envp,
+		                       sysio()->execve_in.filename,
+		                       sysio()->execve_in.args,
+		                       sysio()->execve_in.env)) {
 		    errno = E2BIG;
 		    return -1;
 		}
 
-		noux_cwd_len = strlen(sysio()->execve_in.env) + 1;
-
-		if (!serialize_string_array(envp, &(sysio()->execve_in.env[noux_cwd_len]),
-                                   sizeof(sysio()->execve_in.env) - noux_cwd_len)) {
-		    PERR("execve: environment buffer exceeded");
-		    errno = E2BIG;
-		    return -1;
-		}
-
-		if (!noux()->syscall(Noux::Session::SYSCALL_EXECVE)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_EXECVE)) {
 			PWRN("exec syscall failed for path \"%s\"", filename);
 			switch (sysio()->error.execve) {
 			case Noux::Sysio::EXECVE_NONEXISTENT: errno = ENOENT; break;
@@ -735,7 +1543,7 @@ namespace {
 
 		Genode::strncpy(sysio()->stat_in.path, path, sizeof(sysio()->stat_in.path));
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_STAT)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_STAT)) {
 			if (verbose)
 				PWRN("stat syscall failed for path \"%s\"", path);
 			switch (sysio()->error.stat) {
@@ -761,7 +1569,7 @@ namespace {
 		while (!opened) {
 			Genode::strncpy(sysio()->open_in.path, pathname, sizeof(sysio()->open_in.path));
 			sysio()->open_in.mode = flags;
-			if (noux()->syscall(Noux::Session::SYSCALL_OPEN))
+			if (noux_syscall(Noux::Session::SYSCALL_OPEN))
 				opened = true;
 			else
 				switch (sysio()->error.open) {
@@ -773,7 +1581,7 @@ namespace {
 						/* O_CREAT is set, so try to create the file */
 						Genode::strncpy(sysio()->open_in.path, pathname, sizeof(sysio()->open_in.path));
 						sysio()->open_in.mode = flags | O_EXCL;
-						if (noux()->syscall(Noux::Session::SYSCALL_OPEN))
+						if (noux_syscall(Noux::Session::SYSCALL_OPEN))
 							opened = true;
 						else
 							switch (sysio()->error.open) {
@@ -790,6 +1598,8 @@ namespace {
 				}
 		}
 
+		reset_fd_state(sysio()->open_out.fd, Fd_state::CANDIDATE);
+
 		Libc::Plugin_context *context = noux_context(sysio()->open_out.fd);
 		Libc::File_descriptor *fd =
 		    Libc::file_descriptor_allocator()->alloc(this, context, sysio()->open_out.fd);
@@ -813,7 +1623,7 @@ namespace {
 
 		Genode::strncpy(sysio()->symlink_in.oldpath, oldpath, sizeof(sysio()->symlink_in.oldpath));
 		Genode::strncpy(sysio()->symlink_in.newpath, newpath, sizeof(sysio()->symlink_in.newpath));
-		if (!noux()->syscall(Noux::Session::SYSCALL_SYMLINK)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_SYMLINK)) {
 			PERR("symlink error");
 			/* XXX set errno */
 			return -1;
@@ -833,6 +1643,13 @@ namespace {
 	ssize_t Plugin::write(Libc::File_descriptor *fd, const void *buf,
 	                      ::size_t count)
 	{
+		int const nfd = noux_fd(fd->context);
+
+		discard_readahead(nfd);
+
+		if (batching_enabled(nfd))
+			return write_batched(nfd, (char const *)buf, count);
+
 		/* remember original len for the return value */
 		int const orig_count = count;
 
@@ -845,7 +1662,7 @@ namespace {
 			sysio()->write_in.count = curr_count;
 			Genode::memcpy(sysio()->write_in.chunk, src, curr_count);
 
-			if (!noux()->syscall(Noux::Session::SYSCALL_WRITE)) {
+			if (!noux_syscall(Noux::Session::SYSCALL_WRITE)) {
 				switch (sysio()->error.write) {
 				case Noux::Sysio::WRITE_ERR_AGAIN:       errno = EAGAIN;      break;
 				case Noux::Sysio::WRITE_ERR_WOULD_BLOCK: errno = EWOULDBLOCK; break;
@@ -869,8 +1686,34 @@ namespace {
 
 	ssize_t Plugin::read(Libc::File_descriptor *fd, void *buf, ::size_t count)
 	{
+		int const nfd = noux_fd(fd->context);
+
 		Genode::size_t sum_read_count = 0;
 
+		/* consume read-ahead data first */
+		Fd_state *state = fd_state(nfd);
+		if (state && state->ra_avail()) {
+
+			Genode::size_t const n = Genode::min(count, state->ra_avail());
+			Genode::memcpy(buf, state->ra_buf + state->ra_offset, n);
+			state->ra_offset += n;
+			sum_read_count   += n;
+			count            -= n;
+
+			if (!state->ra_avail())
+				state->ra_offset = state->ra_len = 0;
+
+			if (!count)
+				return sum_read_count;
+		}
+
+		if (batching_enabled(nfd)) {
+			ssize_t const n = read_batched(nfd, (char *)buf + sum_read_count, count);
+			if (n < 0)
+				return sum_read_count ? (ssize_t)sum_read_count : -1;
+			return sum_read_count + n;
+		}
+
 		while (count > 0) {
 
 			Genode::size_t curr_count =
@@ -879,7 +1722,7 @@ namespace {
 			sysio()->read_in.fd    = noux_fd(fd->context);
 			sysio()->read_in.count = curr_count;
 
-			if (!noux()->syscall(Noux::Session::SYSCALL_READ)) {
+			if (!noux_syscall(Noux::Session::SYSCALL_READ)) {
 				switch (sysio()->error.read) {
 				case Noux::Sysio::READ_ERR_AGAIN:       errno = EAGAIN;      break;
 				case Noux::Sysio::READ_ERR_WOULD_BLOCK: errno = EWOULDBLOCK; break;
@@ -916,13 +1759,26 @@ namespace {
 
 	int Plugin::close(Libc::File_descriptor *fd)
 	{
-		sysio()->close_in.fd = noux_fd(fd->context);
-		if (!noux()->syscall(Noux::Session::SYSCALL_CLOSE)) {
+		int const nfd = noux_fd(fd->context);
+
+		sysio()->close_in.fd = nfd;
+		if (!noux_syscall(Noux::Session::SYSCALL_CLOSE)) {
 			PERR("close error");
 			/* XXX set errno */
 			return -1;
 		}
+
+		/* report deferred writes that failed */
+		Fd_state *state = fd_state(nfd);
+		bool const write_failed = state && state->write_failed;
+		reset_fd_state(nfd, Fd_state::OTHER);
+
 		Libc::file_descriptor_allocator()->free(fd);
+
+		if (write_failed) {
+			errno = EIO;
+			return -1;
+		}
 		return 0;
 	}
 
@@ -1015,7 +1871,7 @@ namespace {
 		}
 
 		/* perform syscall */
-		if (!noux()->syscall(Noux::Session::SYSCALL_IOCTL)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_IOCTL)) {
 			switch (sysio()->error.ioctl) {
 			case Noux::Sysio::IOCTL_ERR_INVALID: errno = EINVAL; break;
 			case Noux::Sysio::IOCTL_ERR_NOTTY:   errno = ENOTTY; break;
@@ -1053,7 +1909,7 @@ namespace {
 	int Plugin::pipe(Libc::File_descriptor *pipefd[2])
 	{
 		/* perform syscall */
-		if (!noux()->syscall(Noux::Session::SYSCALL_PIPE)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_PIPE)) {
 			PERR("pipe error");
 			/* XXX set errno */
 			return -1;
@@ -1069,15 +1925,21 @@ namespace {
 
 	Libc::File_descriptor *Plugin::dup(Libc::File_descriptor* fd)
 	{
+		/* both descriptors share the file offset */
+		discard_readahead(noux_fd(fd->context));
+		reset_fd_state(noux_fd(fd->context), Fd_state::OTHER);
+
 		sysio()->dup2_in.fd    = noux_fd(fd->context);
 		sysio()->dup2_in.to_fd = -1;
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_DUP2)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_DUP2)) {
 			PERR("dup error");
 			/* XXX set errno */
 			return 0;
 		}
 
+		reset_fd_state(sysio()->dup2_out.fd, Fd_state::OTHER);
+
 		Libc::Plugin_context *context = noux_context(sysio()->dup2_out.fd);
 		return Libc::file_descriptor_allocator()->alloc(this, context,
 		                                                sysio()->dup2_out.fd);
@@ -1091,11 +1953,17 @@ namespace {
 		 */
 		new_fd->context = noux_context(new_fd->libc_fd);
 
+		/* both descriptors share the file offset */
+		discard_readahead(noux_fd(fd->context));
+		discard_readahead(noux_fd(new_fd->context));
+		reset_fd_state(noux_fd(fd->context),     Fd_state::OTHER);
+		reset_fd_state(noux_fd(new_fd->context), Fd_state::OTHER);
+
 		sysio()->dup2_in.fd    = noux_fd(fd->context);
 		sysio()->dup2_in.to_fd = noux_fd(new_fd->context);
 
 		/* perform syscall */
-		if (!noux()->syscall(Noux::Session::SYSCALL_DUP2)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_DUP2)) {
 			PERR("dup2 error");
 			/* XXX set errno */
 			return -1;
@@ -1108,7 +1976,7 @@ namespace {
 	int Plugin::fstat(Libc::File_descriptor *fd, struct stat *buf)
 	{
 		sysio()->fstat_in.fd = noux_fd(fd->context);
-		if (!noux()->syscall(Noux::Session::SYSCALL_FSTAT)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_FSTAT)) {
 			PERR("fstat error");
 			/* XXX set errno */
 			return -1;
@@ -1121,6 +1989,15 @@ namespace {
 
 	int Plugin::fsync(Libc::File_descriptor *fd)
 	{
+		flush_ring();
+
+		Fd_state *state = fd_state(noux_fd(fd->context));
+		if (state && state->write_failed) {
+			state->write_failed = false;
+			errno = EIO;
+			return -1;
+		}
+
 		if (verbose)
 			PDBG("not implemented");
 		return 0;
@@ -1129,9 +2006,11 @@ namespace {
 
 	int Plugin::ftruncate(Libc::File_descriptor *fd, ::off_t length)
 	{
+		discard_readahead(noux_fd(fd->context));
+
 		sysio()->ftruncate_in.fd = noux_fd(fd->context);
 		sysio()->ftruncate_in.length = length;
-		if (!noux()->syscall(Noux::Session::SYSCALL_FTRUNCATE)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_FTRUNCATE)) {
 			switch (sysio()->error.ftruncate) {
 				case Noux::Sysio::FTRUNCATE_ERR_NO_PERM: errno = EPERM; break;
 			}
@@ -1205,7 +2084,7 @@ namespace {
 		};
 
 		/* invoke system call */
-		if (!noux()->syscall(Noux::Session::SYSCALL_FCNTL)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_FCNTL)) {
 			PWRN("fcntl failed (libc_fd= %d, cmd=%x)", fd->libc_fd, cmd);
 			/* XXX read error code from sysio */
 			errno = EINVAL;
@@ -1230,7 +2109,7 @@ namespace {
 		struct dirent *dirent = (struct dirent *)buf;
 		Genode::memset(dirent, 0, sizeof(struct dirent));
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_DIRENT)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_DIRENT)) {
 			switch (sysio()->error.general) {
 
 			case Noux::Sysio::ERR_FD_INVALID:
@@ -1267,6 +2146,16 @@ namespace {
 	::off_t Plugin::lseek(Libc::File_descriptor *fd,
 	                      ::off_t offset, int whence)
 	{
+		/* account for read-ahead data not yet consumed */
+		Fd_state *state = fd_state(noux_fd(fd->context));
+		if (state && state->ra_avail()) {
+			if (whence == SEEK_CUR)
+				offset -= (::off_t)state->ra_avail();
+			else
+				discard_readahead(noux_fd(fd->context));
+			state->ra_offset = state->ra_len = 0;
+		}
+
 		sysio()->lseek_in.fd = noux_fd(fd->context);
 		sysio()->lseek_in.offset = offset;
 
@@ -1277,7 +2166,7 @@ namespace {
 		case SEEK_END: sysio()->lseek_in.whence = Noux::Sysio::LSEEK_END; break;
 		}
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_LSEEK)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_LSEEK)) {
 			switch (sysio()->error.general) {
 
 			case Noux::Sysio::ERR_FD_INVALID:
@@ -1297,7 +2186,7 @@ namespace {
 	{
 		Genode::strncpy(sysio()->unlink_in.path, path, sizeof(sysio()->unlink_in.path));
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_UNLINK)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_UNLINK)) {
 			PWRN("unlink syscall failed for path \"%s\"", path);
 			switch (sysio()->error.unlink) {
 			case Noux::Sysio::UNLINK_ERR_NO_ENTRY: errno = ENOENT; break;
@@ -1318,7 +2207,7 @@ namespace {
 		Genode::strncpy(sysio()->readlink_in.path, path, sizeof(sysio()->readlink_in.path));
 		sysio()->readlink_in.bufsiz = bufsiz;
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_READLINK)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_READLINK)) {
 			PWRN("readlink syscall failed for \"%s\"", path);
 			/* XXX set errno */
 			return -1;
@@ -1340,7 +2229,7 @@ namespace {
 		Genode::strncpy(sysio()->rename_in.from_path, from_path, sizeof(sysio()->rename_in.from_path));
 		Genode::strncpy(sysio()->rename_in.to_path,   to_path,   sizeof(sysio()->rename_in.to_path));
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_RENAME)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_RENAME)) {
 			PWRN("rename syscall failed for \"%s\" -> \"%s\"", from_path, to_path);
 			switch (sysio()->error.rename) {
 			case Noux::Sysio::RENAME_ERR_NO_ENTRY: errno = ENOENT; break;
@@ -1358,7 +2247,7 @@ namespace {
 	{
 		Genode::strncpy(sysio()->mkdir_in.path, path, sizeof(sysio()->mkdir_in.path));
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_MKDIR)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_MKDIR)) {
 			PWRN("mkdir syscall failed for \"%s\" mode=0x%x", path, (int)mode);
 			switch (sysio()->error.mkdir) {
 			case Noux::Sysio::MKDIR_ERR_EXISTS:        errno = EEXIST;       break;
@@ -1416,7 +2305,7 @@ namespace {
 		sysio()->socket_in.type = type;
 		sysio()->socket_in.protocol = protocol;
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_SOCKET))
+		if (!noux_syscall(Noux::Session::SYSCALL_SOCKET))
 			return 0;
 
 		Libc::Plugin_context *context = noux_context(sysio()->socket_out.fd);
@@ -1437,7 +2326,7 @@ namespace {
 		Genode::memset(sysio()->getsockopt_in.optval, 0,
 				sizeof (sysio()->getsockopt_in.optval));
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_GETSOCKOPT))
+		if (!noux_syscall(Noux::Session::SYSCALL_GETSOCKOPT))
 			return -1;
 
 		Genode::memcpy(optval, sysio()->setsockopt_in.optval,
@@ -1462,7 +2351,7 @@ namespace {
 
 		Genode::memcpy(sysio()->setsockopt_in.optval, optval, optlen);
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_SETSOCKOPT)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_SETSOCKOPT)) {
 			/* XXX */
 			return -1;
 		}
@@ -1485,7 +2374,7 @@ namespace {
 			sysio()->accept_in.addrlen = 0;
 		}
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_ACCEPT)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_ACCEPT)) {
 			switch (sysio()->error.accept) {
 			case Noux::Sysio::ACCEPT_ERR_AGAIN:         errno = EAGAIN;      break;
 			case Noux::Sysio::ACCEPT_ERR_NO_MEMORY:     errno = ENOMEM;      break;
@@ -1515,7 +2404,7 @@ namespace {
 		Genode::memcpy(&sysio()->bind_in.addr, addr, sizeof (struct sockaddr));
 		sysio()->bind_in.addrlen = addrlen;
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_BIND)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_BIND)) {
 			switch (sysio()->error.bind) {
 			case Noux::Sysio::BIND_ERR_ACCESS:      errno = EACCES;     break;
 			case Noux::Sysio::BIND_ERR_ADDR_IN_USE: errno = EADDRINUSE; break;
@@ -1538,7 +2427,7 @@ namespace {
 		Genode::memcpy(&sysio()->connect_in.addr, addr, sizeof (struct sockaddr));
 		sysio()->connect_in.addrlen = addrlen;
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_CONNECT)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_CONNECT)) {
 			switch (sysio()->error.connect) {
 			case Noux::Sysio::CONNECT_ERR_AGAIN:        errno = EAGAIN;      break;
 			case Noux::Sysio::CONNECT_ERR_ALREADY:      errno = EALREADY;    break;
@@ -1560,7 +2449,7 @@ namespace {
 		sysio()->getpeername_in.fd = noux_fd(fd->context);
 		sysio()->getpeername_in.addrlen = *addrlen;
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_GETPEERNAME)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_GETPEERNAME)) {
 			/* errno */
 			return -1;
 		}
@@ -1578,7 +2467,7 @@ namespace {
 		sysio()->listen_in.fd = noux_fd(fd->context);
 		sysio()->listen_in.backlog = backlog;
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_LISTEN)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_LISTEN)) {
 			switch (sysio()->error.listen) {
 			case Noux::Sysio::LISTEN_ERR_ADDR_IN_USE:   errno = EADDRINUSE; break;
 			case Noux::Sysio::LISTEN_ERR_NOT_SUPPORTED: errno = EOPNOTSUPP; break;
@@ -1602,7 +2491,7 @@ namespace {
 			sysio()->recv_in.fd = noux_fd(fd->context);
 			sysio()->recv_in.len = curr_len;
 
-			if (!noux()->syscall(Noux::Session::SYSCALL_RECV)) {
+			if (!noux_syscall(Noux::Session::SYSCALL_RECV)) {
 				switch (sysio()->error.recv) {
 				case Noux::Sysio::RECV_ERR_AGAIN:         errno = EAGAIN;      break;
 				case Noux::Sysio::RECV_ERR_WOULD_BLOCK:   errno = EWOULDBLOCK; break;
@@ -1647,7 +2536,7 @@ namespace {
 			else
 				sysio()->recvfrom_in.addrlen = *addrlen;
 
-			if (!noux()->syscall(Noux::Session::SYSCALL_RECVFROM)) {
+			if (!noux_syscall(Noux::Session::SYSCALL_RECVFROM)) {
 				switch (sysio()->error.recv) {
 				case Noux::Sysio::RECV_ERR_AGAIN:         errno = EAGAIN;      break;
 				case Noux::Sysio::RECV_ERR_WOULD_BLOCK:   errno = EWOULDBLOCK; break;
@@ -1695,7 +2584,7 @@ namespace {
 			sysio()->send_in.len = curr_len;
 			Genode::memcpy(sysio()->send_in.buf, src, curr_len);
 
-			if (!noux()->syscall(Noux::Session::SYSCALL_SEND)) {
+			if (!noux_syscall(Noux::Session::SYSCALL_SEND)) {
 				PERR("write error %d", sysio()->error.general);
 				switch (sysio()->error.send) {
 				case Noux::Sysio::SEND_ERR_AGAIN:            errno = EAGAIN;      break;
@@ -1746,7 +2635,7 @@ namespace {
 				Genode::memcpy(&sysio()->sendto_in.dest_addr, dest_addr, addrlen);
 			}
 
-			if (!noux()->syscall(Noux::Session::SYSCALL_SENDTO)) {
+			if (!noux_syscall(Noux::Session::SYSCALL_SENDTO)) {
 				switch (sysio()->error.send) {
 				case Noux::Sysio::SEND_ERR_AGAIN:            errno = EAGAIN;      break;
 				case Noux::Sysio::SEND_ERR_WOULD_BLOCK:      errno = EWOULDBLOCK; break;
@@ -1772,7 +2661,7 @@ namespace {
 		sysio()->shutdown_in.fd = noux_fd(fd->context);
 		sysio()->shutdown_in.how = how;
 
-		if (!noux()->syscall(Noux::Session::SYSCALL_SHUTDOWN)) {
+		if (!noux_syscall(Noux::Session::SYSCALL_SHUTDOWN)) {
 			switch (sysio()->error.shutdown) {
 			case Noux::Sysio::SHUTDOWN_ERR_NOT_CONNECTED: errno = ENOTCONN; break;
 			default:                                      errno = 0;        break;
@@ -1786,6 +2675,51 @@ namespace {
 } /* unnamed namespace */
 
 
+/************
+ ** Splice **
+ ************/
+
+/**
+ * Move up to 'count' bytes from 'fd_in' to 'fd_out'
+ *
+ * At least one of both file descriptors must refer to a pipe. The data is
+ * transferred within the Noux server and does not pass the sysio dataspace.
+ * Between two pipes, whole pages are handed over without copying.
+ *
+ * \return number of transferred bytes, 0 at the end of input, or -1 on error,
+ *         with 'errno' set to 'EAGAIN' if a non-blocking end is not ready
+ */
+extern "C" ssize_t splice(int fd_in, int fd_out, size_t count)
+{
+	Libc::File_descriptor *in  = Libc::file_descriptor_allocator()->find_by_libc_fd(fd_in);
+	Libc::File_descriptor *out = Libc::file_descriptor_allocator()->find_by_libc_fd(fd_out);
+
+	if (!in || !out) {
+		errno = EBADF;
+		return -1;
+	}
+
+	sysio()->splice_in.fd_in  = noux_fd(in->context);
+	sysio()->splice_in.fd_out = noux_fd(out->context);
+	sysio()->splice_in.count  = count;
+
+	if (!noux_syscall(Noux::Session::SYSCALL_SPLICE)) {
+		switch (sysio()->error.splice) {
+		case Noux::Sysio::SPLICE_ERR_AGAIN: errno = EAGAIN; break;
+		case Noux::Sysio::SPLICE_ERR_IO:    errno = EIO;    break;
+		default:
+			if (sysio()->error.general == Noux::Sysio::ERR_FD_INVALID)
+				errno = EBADF;
+			else
+				errno = EINVAL;
+		}
+		return -1;
+	}
+
+	return sysio()->splice_out.count;
+}
+
+
 /**************************************
  ** Obtaining command-line arguments **
  **************************************/
@@ -30,6 +30,8 @@
 #include <cpu_session_component.h>
 #include <child_policy.h>
 #include <io_receptor_registry.h>
+#include <clock_registry.h>
+#include <user_info.h>
 #include <destruct_queue.h>
 #include <destruct_dispatcher.h>
 
@@ -80,6 +82,11 @@ namespace Noux {
 	 */
 	Io_receptor_registry *io_receptor_registry();
 
+	/**
+	 * Return singleton instance of Clock_registry
+	 */
+	Clock_registry *clock_registry();
+
 	class Child;
 
 	bool is_init_process(Child *child);
@@ -173,6 +180,48 @@ namespace Noux {
 			Attached_ram_dataspace _sysio_ds;
 			Sysio * const          _sysio;
 
+			enum { INFO_DS_SIZE = PAGE_MASK & (sizeof(Info) + PAGE_SIZE - 1) };
+
+			/**
+			 * Process-information page shared with the child
+			 */
+			Attached_ram_dataspace _info_ds;
+			Info * const           _info;
+			Registered_clock       _info_clock;
+
+			void _init_info()
+			{
+				_info->pid = pid();
+				_info->uid = user_info()->uid;
+				_info->gid = user_info()->gid;
+
+				memcpy(_info->name,  user_info()->name,  sizeof(_info->name));
+				memcpy(_info->shell, user_info()->shell, sizeof(_info->shell));
+				memcpy(_info->home,  user_info()->home,  sizeof(_info->home));
+
+				clock_registry()->register_clock(&_info_clock);
+			}
+
+			/**
+			 * Print syscall statistics of the process
+			 */
+			void _dump_syscall_stats();
+
+			/**
+			 * Server-local syscall buffer used by 'splice' and the syscall
+			 * ring to drive I/O channels without touching the arguments
+			 * in the child's sysio
+			 */
+			Sysio *_scratch_sysio;
+
+			Sysio *_obtain_scratch_sysio()
+			{
+				if (!_scratch_sysio)
+					_scratch_sysio = new (Genode::env()->heap()) Sysio;
+
+				return _scratch_sysio;
+			}
+
 			Session_capability const _noux_session_cap;
 
 			Local_noux_service _local_noux_service;
@@ -223,6 +272,21 @@ namespace Noux {
 
 			bool _syscall_net(Syscall sc);
 
+			/**
+			 * Method for handling the splice system call
+			 */
+			bool _syscall_splice();
+
+			/**
+			 * Create new process directly from a binary, used by 'posix_spawn'
+			 */
+			bool _syscall_spawn();
+
+			/**
+			 * Execute operations queued in the syscall ring
+			 */
+			void _process_ring();
+
 		public:
 
 			struct Binary_does_not_exist : Exception { };
@@ -270,6 +334,10 @@ namespace Noux {
 				                  : root_dir->dataspace(name)),
 				_sysio_ds(Genode::env()->ram_session(), SYSIO_DS_SIZE),
 				_sysio(_sysio_ds.local_addr<Sysio>()),
+				_info_ds(Genode::env()->ram_session(), INFO_DS_SIZE),
+				_info(_info_ds.local_addr<Info>()),
+				_info_clock(_info->clock),
+				_scratch_sysio(0),
 				_noux_session_cap(Session_capability(_entrypoint.manage(this))),
 				_local_noux_service(_noux_session_cap),
 				_local_rm_service(_entrypoint, _resources.ds_registry),
@@ -287,15 +355,24 @@ namespace Noux {
 					PERR("Lookup of executable \"%s\" failed", name);
 					throw Binary_does_not_exist();
 				}
+
+				_init_info();
 			}
 
 			~Child()
 			{
+				_dump_syscall_stats();
+
+				clock_registry()->unregister_clock(&_info_clock);
+
 				_sig_rec->dissolve(&_destruct_dispatcher);
 
 				_entrypoint.dissolve(this);
 
 				_root_dir->release(_child_policy.name(), _binary_ds);
+
+				if (_scratch_sysio)
+					Genode::destroy(Genode::env()->heap(), _scratch_sysio);
 			}
 
 			void start() { _entrypoint.activate(); }
@@ -337,7 +414,29 @@ namespace Noux {
 				return _sysio_ds.cap();
 			}
 
+			Dataspace_capability info_dataspace()
+			{
+				return _info_ds.cap();
+			}
+
 			bool syscall(Syscall sc);
+
+
+			/**************************************
+			 ** File_descriptor_registry methods **
+			 **************************************/
+
+			/**
+			 * Close all file descriptors, called on exit
+			 *
+			 * Operations still queued in the syscall ring are executed
+			 * beforehand so that no buffered output gets lost.
+			 */
+			void flush()
+			{
+				_process_ring();
+				File_descriptor_registry::flush();
+			}
 	};
 };
 
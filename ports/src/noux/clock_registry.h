@@ -0,0 +1,76 @@
+/*
+ * \brief  Registry of clocks located in the process-information pages
+ * \author Norman Feske
+ * \date   2013-03-04
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _NOUX__CLOCK_REGISTRY_H_
+#define _NOUX__CLOCK_REGISTRY_H_
+
+/* Genode includes */
+#include <base/lock.h>
+#include <util/list.h>
+
+/* Noux includes */
+#include <noux_session/info.h>
+
+
+namespace Noux {
+
+	struct Registered_clock : List<Registered_clock>::Element
+	{
+		Info::Clock &clock;
+
+		Registered_clock(Info::Clock &clock) : clock(clock) { }
+	};
+
+	class Clock_registry
+	{
+		private:
+
+			List<Registered_clock> _clocks;
+			Lock                   _lock;
+			unsigned long          _curr_time;
+
+		public:
+
+			Clock_registry() : _curr_time(0) { }
+
+			void register_clock(Registered_clock *clock)
+			{
+				Lock::Guard guard(_lock);
+
+				clock->clock.update(_curr_time);
+				_clocks.insert(clock);
+			}
+
+			void unregister_clock(Registered_clock *clock)
+			{
+				Lock::Guard guard(_lock);
+
+				_clocks.remove(clock);
+			}
+
+			/**
+			 * Propagate current time to all registered clocks
+			 */
+			void update(unsigned long curr_time)
+			{
+				Lock::Guard guard(_lock);
+
+				_curr_time = curr_time;
+
+				for (Registered_clock *c = _clocks.first(); c; c = c->next())
+					c->clock.update(curr_time);
+			}
+	};
+}
+
+#endif /* _NOUX__CLOCK_REGISTRY_H_ */
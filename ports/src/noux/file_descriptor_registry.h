@@ -67,6 +67,8 @@ namespace Noux {
 				flush();
 			}
 
+			virtual ~File_descriptor_registry() { }
+
 			/**
 			 * Associate I/O channel with file descriptor
 			 *
@@ -110,7 +112,7 @@ namespace Noux {
 				return _fds[fd].io_channel;
 			}
 
-			void flush()
+			virtual void flush()
 			{
 				/* close all file descriptors */
 				for (unsigned i = 0; i < MAX_FILE_DESCRIPTORS; i++)
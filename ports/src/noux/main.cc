@@ -33,6 +33,7 @@
 
 static bool trace_syscalls = false;
 static bool verbose_quota  = false;
+static bool syscall_stats  = false;
 
 namespace Noux {
 
@@ -67,6 +68,7 @@ namespace Noux {
 					_timer.msleep(TIMER_GRANULARITY_MSEC);
 					Alarm_scheduler::handle(_curr_time);
 					_curr_time += TIMER_GRANULARITY_MSEC;
+					clock_registry()->update(_curr_time);
 				}
 			}
 
@@ -125,6 +127,9 @@ bool Noux::Child::syscall(Noux::Session::Syscall sc)
 		Genode::printf("PID %d -> SYSCALL %s\n",
 		               pid(), Noux::Session::syscall_name(sc));
 
+	if (sc >= 0 && (int)sc < Info::MAX_SYSCALLS)
+		_info->rpc_count[sc]++;
+
 	try {
 		switch (sc) {
 
@@ -512,6 +517,10 @@ bool Noux::Child::syscall(Noux::Session::Syscall sc)
 				return true;
 			}
 
+		case SYSCALL_SPAWN:
+
+			return _syscall_spawn();
+
 		case SYSCALL_GETPID:
 			{
 				_sysio->getpid_out.pid = pid();
@@ -675,6 +684,15 @@ bool Noux::Child::syscall(Noux::Session::Syscall sc)
 				return true;
 			}
 
+		case SYSCALL_SPLICE:
+
+			return _syscall_splice();
+
+		case SYSCALL_RING:
+
+			_process_ring();
+			return true;
+
 		case SYSCALL_SOCKET:
 		case SYSCALL_GETSOCKOPT:
 		case SYSCALL_SETSOCKOPT:
@@ -705,6 +723,368 @@ bool Noux::Child::syscall(Noux::Session::Syscall sc)
 }
 
 
+bool Noux::Child::_syscall_spawn()
+{
+	Dataspace_capability binary_ds =
+		_root_dir->dataspace(_sysio->spawn_in.filename);
+
+	if (!binary_ds.valid()) {
+		_sysio->error.execve = Sysio::EXECVE_NONEXISTENT;
+		return false;
+	}
+
+	Child_env<sizeof(_sysio->spawn_in.args)>
+		child_env(_sysio->spawn_in.filename, binary_ds,
+		          _sysio->spawn_in.args, _sysio->spawn_in.env);
+
+	_root_dir->release(_sysio->spawn_in.filename, binary_ds);
+
+	int const new_pid = pid_allocator()->alloc();
+
+	/*
+	 * In contrast to fork, the new process is not populated with a copy
+	 * of our address space but started from the binary like on execve.
+	 */
+	Child *child = 0;
+	try {
+		child = new Child(child_env.binary_name(),
+		                  this,
+		                  new_pid,
+		                  _sig_rec,
+		                  _root_dir,
+		                  child_env.args(),
+		                  child_env.env(),
+		                  _cap_session,
+		                  _parent_services,
+		                  _resources.ep,
+		                  false,
+		                  env()->heap(),
+		                  _destruct_queue);
+	}
+	catch (Child::Binary_does_not_exist) {
+		_sysio->error.execve = Sysio::EXECVE_NONEXISTENT;
+		return false;
+	}
+
+	Family_member::insert(child);
+
+	_assign_io_channels_to(child);
+
+	unsigned const num_actions = min(_sysio->spawn_in.num_fd_actions,
+	                                 (unsigned)Sysio::MAX_SPAWN_FD_ACTIONS);
+
+	for (unsigned i = 0; i < num_actions; i++) {
+
+		Sysio::Spawn_fd_action const &action = _sysio->spawn_in.fd_actions[i];
+
+		if (!child->fd_in_use(action.fd))
+			continue;
+
+		switch (action.type) {
+
+		case Sysio::Spawn_fd_action::DUP2:
+			if (action.fd != action.to_fd)
+				child->add_io_channel(child->io_channel_by_fd(action.fd),
+				                      action.to_fd);
+			break;
+
+		case Sysio::Spawn_fd_action::CLOSE:
+			child->remove_io_channel(action.fd);
+			break;
+		}
+	}
+
+	/* activate child entrypoint, thereby starting the new process */
+	child->start();
+
+	_sysio->spawn_out.pid = new_pid;
+	return true;
+}
+
+
+void Noux::Child::_dump_syscall_stats()
+{
+	if (!syscall_stats)
+		return;
+
+	unsigned long rpc_total = 0, local_total = 0;
+
+	Genode::printf("syscall statistics of PID %d (%s):\n",
+	               pid(), _child_policy.name());
+
+	for (int i = 0; i < Info::MAX_SYSCALLS; i++) {
+
+		unsigned long const rpcs  = _info->rpc_count[i];
+		unsigned long const local = _info->local_count[i];
+
+		if (!rpcs && !local)
+			continue;
+
+		Genode::printf("  %s: rpc=%lu local=%lu\n",
+		               Session::syscall_name((Session::Syscall)i), rpcs, local);
+
+		rpc_total   += rpcs;
+		local_total += local;
+	}
+
+	Genode::printf("  total: rpc=%lu local=%lu\n", rpc_total, local_total);
+}
+
+
+void Noux::Child::_process_ring()
+{
+	Sysio::Ring &ring  = _sysio->ring;
+	Sysio       *sysio = 0;
+
+	/*
+	 * The ring resides in memory shared with the child, which may modify
+	 * it at any time. Hence, each value is read once into a local variable
+	 * and only the local copy is validated and used.
+	 */
+	unsigned const submitted = min(ring.submitted, (unsigned)Sysio::Ring::MAX_ENTRIES);
+
+	unsigned i = ring.completed;
+	for (; i < submitted; i++) {
+
+		Sysio::Ring::Entry &e = ring.entries[i];
+
+		Sysio::Ring::Opcode const opcode = e.opcode;
+		int                 const fd     = e.fd;
+		size_t              const offset = e.offset;
+		size_t              const count  = e.count;
+
+		/* reject payloads outside of the ring's data area */
+		if (offset > sizeof(ring.data) || count > sizeof(ring.data) - offset
+		 || !fd_in_use(fd)) {
+			e.result = 0;
+			e.ok     = false;
+			continue;
+		}
+
+		if (!sysio)
+			sysio = _obtain_scratch_sysio();
+
+		Shared_pointer<Io_channel> io = io_channel_by_fd(fd);
+		char * const payload = ring.data + offset;
+		size_t       result  = 0;
+		bool         failed  = false;
+
+		switch (opcode) {
+
+		case Sysio::Ring::OP_WRITE:
+
+			while (!failed && result < count) {
+
+				size_t const len = min(count - result,
+				                       sizeof(sysio->write_in.chunk));
+
+				sysio->write_in.fd    = fd;
+				sysio->write_in.count = len;
+				memcpy(sysio->write_in.chunk, payload + result, len);
+
+				for (size_t written = 0; written != len; ) {
+
+					if (!io->is_nonblocking())
+						if (!io->check_unblock(false, true, false))
+							_block_for_io_channel(io);
+
+					if (!io->write(sysio, written)) {
+						failed = true;
+						break;
+					}
+				}
+
+				if (!failed)
+					result += len;
+			}
+			break;
+
+		case Sysio::Ring::OP_READ:
+
+			while (result < count) {
+
+				if (!io->is_nonblocking())
+					while (!io->check_unblock(true, false, false))
+						_block_for_io_channel(io);
+
+				size_t const len = min(count - result,
+				                       sizeof(sysio->read_out.chunk));
+
+				sysio->read_in.fd    = fd;
+				sysio->read_in.count = len;
+
+				if (!io->read(sysio)) {
+					failed = true;
+					break;
+				}
+
+				size_t const got = min(sysio->read_out.count, len);
+				memcpy(payload + result, sysio->read_out.chunk, got);
+				result += got;
+
+				/* end of file or no more data available right now */
+				if (got < len)
+					break;
+			}
+			break;
+
+		default:
+
+			PWRN("invalid opcode %u in syscall ring", (unsigned)opcode);
+			failed = true;
+			break;
+		}
+
+		e.result = result;
+		e.ok     = !failed;
+	}
+
+	ring.completed = i;
+}
+
+
+bool Noux::Child::_syscall_splice()
+{
+	int    const fd_in  = _sysio->splice_in.fd_in;
+	int    const fd_out = _sysio->splice_in.fd_out;
+	size_t const count  = _sysio->splice_in.count;
+
+	Shared_pointer<Io_channel> in  = _lookup_channel(fd_in);
+	Shared_pointer<Io_channel> out = _lookup_channel(fd_out);
+
+	Shared_pointer<Pipe_source_io_channel> source =
+		in.dynamic_pointer_cast<Pipe_source_io_channel>();
+	Shared_pointer<Pipe_sink_io_channel> sink =
+		out.dynamic_pointer_cast<Pipe_sink_io_channel>();
+
+	/* at least one end must be a pipe */
+	if (!source && !sink) {
+		_sysio->error.splice = Sysio::SPLICE_ERR_INVALID;
+		return false;
+	}
+
+	/*
+	 * Block until data is available and the output is ready. A
+	 * non-blocking channel that is not ready yields an error because a
+	 * result of zero bytes denotes the end of the input.
+	 */
+	while (!in->check_unblock(true, false, false)) {
+		if (in->is_nonblocking()) {
+			_sysio->error.splice = Sysio::SPLICE_ERR_AGAIN;
+			return false;
+		}
+		_block_for_io_channel(in);
+	}
+
+	while (!out->check_unblock(false, true, false)) {
+		if (out->is_nonblocking()) {
+			_sysio->error.splice = Sysio::SPLICE_ERR_AGAIN;
+			return false;
+		}
+		_block_for_io_channel(out);
+	}
+
+	size_t moved = 0;
+
+	/* pipe to pipe, pass pages without copying */
+	if (source && sink) {
+		moved = sink->pipe().splice_from(source->pipe(), count);
+
+	/* file to pipe, read directly into the pipe */
+	} else if (sink) {
+
+		Sysio *sysio = _obtain_scratch_sysio();
+		Pipe  &pipe  = sink->pipe();
+
+		size_t const limit = min(count, pipe.avail_buffer_space());
+		while (moved < limit) {
+
+			size_t const curr_count = min(limit - moved,
+			                              sizeof(sysio->read_out.chunk));
+
+			sysio->read_in.fd    = fd_in;
+			sysio->read_in.count = curr_count;
+
+			if (!in->read(sysio)) {
+				if (moved)
+					break;
+
+				Sysio::Read_error const e = sysio->error.read;
+				_sysio->error.splice = (e == Sysio::READ_ERR_AGAIN
+				                     || e == Sysio::READ_ERR_WOULD_BLOCK)
+				                     ? Sysio::SPLICE_ERR_AGAIN
+				                     : Sysio::SPLICE_ERR_IO;
+				return false;
+			}
+
+			size_t const len = sysio->read_out.count;
+			for (size_t written = 0; written < len; ) {
+				written += pipe.write(sysio->read_out.chunk + written,
+				                      len - written);
+				if (written < len)
+					_block_for_io_channel(out);
+			}
+
+			moved += len;
+
+			/* end of file */
+			if (len < curr_count)
+				break;
+		}
+
+	/* pipe to file */
+	} else {
+
+		Sysio *sysio = _obtain_scratch_sysio();
+		Pipe  &pipe  = source->pipe();
+
+		/*
+		 * The data is consumed from the pipe only after it was written, so
+		 * no data gets lost if writing fails.
+		 */
+		while (moved < count) {
+
+			size_t const len = pipe.peek(sysio->write_in.chunk,
+			                             min(count - moved,
+			                                 sizeof(sysio->write_in.chunk)));
+			if (!len)
+				break;
+
+			sysio->write_in.fd    = fd_out;
+			sysio->write_in.count = len;
+
+			size_t written = 0;
+			bool   failed  = false;
+			while (written != len)
+				if (!out->write(sysio, written)) {
+					failed = true;
+					break;
+				}
+
+			pipe.read(0, written);
+			moved += written;
+
+			if (failed) {
+
+				/* report the data transferred so far */
+				if (moved)
+					break;
+
+				Sysio::Write_error const e = sysio->error.write;
+				_sysio->error.splice = (e == Sysio::WRITE_ERR_AGAIN
+				                     || e == Sysio::WRITE_ERR_WOULD_BLOCK)
+				                     ? Sysio::SPLICE_ERR_AGAIN
+				                     : Sysio::SPLICE_ERR_IO;
+				return false;
+			}
+		}
+	}
+
+	_sysio->splice_out.count = moved;
+	return true;
+}
+
+
 /**
  * Return name of init process as specified in the config
  */
@@ -812,6 +1192,13 @@ Noux::Io_receptor_registry * Noux::io_receptor_registry()
 }
 
 
+Noux::Clock_registry *Noux::clock_registry()
+{
+	static Noux::Clock_registry inst;
+	return &inst;
+}
+
+
 Terminal::Connection *Noux::terminal()
 {
 	static Terminal::Connection _inst;
@@ -847,6 +1234,16 @@ int main(int argc, char **argv)
 		trace_syscalls = config()->xml_node().attribute("trace_syscalls").has_value("yes");
 	} catch (Xml_node::Nonexistent_attribute) { }
 
+	try {
+		syscall_stats = config()->xml_node().attribute("syscall_stats").has_value("yes");
+	} catch (Xml_node::Nonexistent_attribute) { }
+
+	try {
+		Number_of_bytes pipe_size = Pipe::default_capacity();
+		config()->xml_node().attribute("pipe_size").value(&pipe_size);
+		Pipe::default_capacity() = pipe_size;
+	} catch (Xml_node::Nonexistent_attribute) { }
+
 	/* initialize virtual file system */
 	static Dir_file_system
 		root_dir(config()->xml_node().sub_node("fstab"));
@@ -866,6 +1263,9 @@ int main(int argc, char **argv)
 	enum { STACK_SIZE = 1024*sizeof(long) };
 	static Genode::Rpc_entrypoint resources_ep(&cap, STACK_SIZE, "noux_rsc_ep");
 
+	/* start clock of the process-information pages */
+	timeout_scheduler();
+
 	/* create init process */
 	static Genode::Signal_receiver sig_rec;
 	static Destruct_queue destruct_queue;
@@ -21,34 +21,118 @@ namespace Noux {
 
 	class Pipe : public Reference_counter
 	{
+		public:
+
+			enum { PAGE_SIZE = 4096, DEFAULT_CAPACITY = 64*1024 };
+
+			/**
+			 * Return capacity used for newly created pipes
+			 *
+			 * The value can be changed via the 'pipe_size' attribute of the
+			 * Noux config.
+			 */
+			static size_t &default_capacity()
+			{
+				static size_t capacity = DEFAULT_CAPACITY;
+				return capacity;
+			}
+
 		private:
 
+			/**
+			 * Page-sized segment of the pipe buffer
+			 *
+			 * The buffer is a queue of pages. Pages are allocated on demand
+			 * and can be passed as a whole from one pipe to another.
+			 */
+			struct Page
+			{
+				Page     *next;
+				unsigned  offset;   /* start of unread data */
+				unsigned  len;      /* end of valid data */
+				char      data[PAGE_SIZE];
+
+				Page() : next(0), offset(0), len(0) { }
+
+				size_t avail()      const { return len - offset; }
+				size_t free_space() const { return PAGE_SIZE - len; }
+			};
+
 			Lock mutable _lock;
 
-			enum { BUFFER_SIZE = 4096 };
-			char _buffer[BUFFER_SIZE];
+			unsigned const _max_pages;
+
+			Page    *_head;        /* oldest page, read from here */
+			Page    *_tail;        /* newest page, write to here */
+			unsigned _num_pages;   /* number of pages in the queue */
+			size_t   _num_bytes;   /* number of unread bytes */
 
-			unsigned _read_offset;
-			unsigned _write_offset;
+			/*
+			 * Pages drained by the reader are kept for reuse by the writer
+			 * to avoid heap operations in the steady state of a pipeline.
+			 */
+			Page    *_spare;
 
 			Signal_context_capability _read_ready_sigh;
 			Signal_context_capability _write_ready_sigh;
 
 			bool _writer_is_gone;
 
+			Page *_alloc_page()
+			{
+				Page *page = _spare;
+				if (page) {
+					_spare       = page->next;
+					page->next   = 0;
+					page->offset = 0;
+					page->len    = 0;
+					return page;
+				}
+				return new (env()->heap()) Page;
+			}
+
+			void _release_page(Page *page)
+			{
+				page->next = _spare;
+				_spare     = page;
+			}
+
+			void _enqueue(Page *page)
+			{
+				page->next = 0;
+				if (_tail)
+					_tail->next = page;
+				else
+					_head = page;
+				_tail = page;
+
+				_num_pages++;
+				_num_bytes += page->avail();
+			}
+
+			Page *_dequeue()
+			{
+				Page *page = _head;
+				if (!page)
+					return 0;
+
+				_head = page->next;
+				if (!_head)
+					_tail = 0;
+
+				page->next = 0;
+				_num_pages--;
+				_num_bytes -= page->avail();
+				return page;
+			}
+
 			/**
 			 * Return space available in the buffer for writing, in bytes
 			 */
 			size_t _avail_buffer_space() const
 			{
-				if (_read_offset < _write_offset)
-					return (BUFFER_SIZE - _write_offset) + _read_offset - 1;
-
-				if (_read_offset > _write_offset)
-					return _read_offset - _write_offset - 1;
-
-				/* _read_offset == _write_offset */
-				return BUFFER_SIZE - 1;
+				size_t const tail_space = _tail ? _tail->free_space() : 0;
+				return tail_space + (_max_pages - _num_pages)*PAGE_SIZE;
 			}
 
 			bool _any_space_avail_for_writing() const
@@ -70,12 +154,29 @@ namespace Noux {
 
 		public:
 
-			Pipe()
-			: _read_offset(0), _write_offset(0), _writer_is_gone(false) { }
+			/**
+			 * Constructor
+			 *
+			 * \param capacity  buffer size in bytes, rounded up to pages
+			 */
+			Pipe(size_t capacity = default_capacity())
+			:
+				_max_pages(max((size_t)1, (capacity + PAGE_SIZE - 1)/PAGE_SIZE)),
+				_head(0), _tail(0), _num_pages(0), _num_bytes(0), _spare(0),
+				_writer_is_gone(false)
+			{ }
 
 			~Pipe()
 			{
 				Lock::Guard guard(_lock);
+
+				while (Page *page = _dequeue())
+					_release_page(page);
+
+				while (Page *page = _spare) {
+					_spare = page->next;
+					destroy(env()->heap(), page);
+				}
 			}
 
 			void writer_close()
@@ -109,40 +210,74 @@ namespace Noux {
 			{
 				Lock::Guard guard(_lock);
 
-				return _read_offset != _write_offset;
+				return _num_bytes > 0;
 			}
 
+			/**
+			 * Return space available for writing, in bytes
+			 */
+			size_t avail_buffer_space() const
+			{
+				Lock::Guard guard(_lock);
+				return _avail_buffer_space();
+			}
+
+			/**
+			 * Read from pipe buffer
+			 *
+			 * \param dst  destination buffer, or 0 to discard the data
+			 *
+			 * \return number of read bytes
+			 */
 			size_t read(char *dst, size_t dst_len)
 			{
 				Lock::Guard guard(_lock);
 
-				if (_read_offset < _write_offset) {
+				size_t read_len = 0;
+				while (_head && read_len < dst_len) {
 
-					size_t len = min(dst_len, _write_offset - _read_offset);
-					memcpy(dst, &_buffer[_read_offset], len);
+					if (!_head->avail()) {
 
-					_read_offset += len;
-					_wake_up_writer();
+						/* keep the drained tail page for subsequent writes */
+						if (_head == _tail) {
+							_head->offset = _head->len = 0;
+							break;
+						}
+						_release_page(_dequeue());
+						continue;
+					}
 
-					return len;
-				}
+					size_t const len = min(dst_len - read_len, _head->avail());
+					if (dst)
+						memcpy(dst + read_len, _head->data + _head->offset, len);
 
-				if (_read_offset > _write_offset) {
+					_head->offset += len;
+					_num_bytes    -= len;
+					read_len      += len;
+				}
 
-					size_t const upper_len = min(dst_len, BUFFER_SIZE - _read_offset);
-					memcpy(dst, &_buffer[_read_offset], upper_len);
+				if (read_len)
+					_wake_up_writer();
 
-					size_t const lower_len = min(dst_len - upper_len, _write_offset);
-					memcpy(dst + upper_len, &_buffer[0], lower_len);
+				return read_len;
+			}
 
-					_read_offset = lower_len;
-					_wake_up_writer();
+			/**
+			 * Copy data from the pipe buffer without consuming it
+			 *
+			 * \return number of copied bytes
+			 */
+			size_t peek(char *dst, size_t dst_len) const
+			{
+				Lock::Guard guard(_lock);
 
-					return upper_len + lower_len;
+				size_t len = 0;
+				for (Page const *page = _head; page && len < dst_len; page = page->next) {
+					size_t const n = min(dst_len - len, page->avail());
+					memcpy(dst + len, page->data + page->offset, n);
+					len += n;
 				}
-
-				/* _read_offset == _write_offset */
-				return 0;
+				return len;
 			}
 
 			/**
@@ -154,43 +289,111 @@ namespace Noux {
 			{
 				Lock::Guard guard(_lock);
 
-				/* trim write request to the available buffer space */
-				size_t const trimmed_len = min(len, _avail_buffer_space());
-
 				/*
 				 * Remember pipe state prior writing to see whether a reader
 				 * must be unblocked after writing.
 				 */
-				bool const pipe_was_empty = (_read_offset == _write_offset);
+				bool const pipe_was_empty = (_num_bytes == 0);
 
-				/* write data up to the upper boundary of the pipe buffer */
-				size_t const upper_len = min(BUFFER_SIZE - _write_offset, trimmed_len);
-				memcpy(&_buffer[_write_offset], src, upper_len);
+				size_t written = 0;
+				while (written < len) {
 
-				_write_offset += upper_len;
-
-				/*
-				 * Determine number of remaining bytes beyond the buffer boundary.
-				 * The buffer wraps. So this data will end up in the lower part
-				 * of the pipe buffer.
-				 */
-				size_t const lower_len = trimmed_len - upper_len;
+					/* start a new page if the tail page is full */
+					if (!_tail || !_tail->free_space()) {
+						if (_num_pages >= _max_pages)
+							break;
+						_enqueue(_alloc_page());
+					}
 
-				if (lower_len > 0) {
+					size_t const curr = min(len - written, _tail->free_space());
+					memcpy(_tail->data + _tail->len, src + written, curr);
 
-					/* pipe buffer wrap-around, write remaining data to the lower part */
-					memcpy(&_buffer[0], src + upper_len, lower_len);
-					_write_offset = lower_len;
+					_tail->len += curr;
+					_num_bytes += curr;
+					written    += curr;
 				}
 
 				/*
 				 * Wake up reader who may block for incoming data.
 				 */
-				if (pipe_was_empty || !_any_space_avail_for_writing())
+				if (written && (pipe_was_empty || !_any_space_avail_for_writing()))
 					_wake_up_reader();
 
 				/* return number of written bytes */
-				return trimmed_len;
+				return written;
+			}
+
+			/**
+			 * Move up to 'count' bytes from pipe 'src' to this pipe
+			 *
+			 * Whole pages are handed over without copying their content.
+			 * Only the data of partially consumed or partially filled pages
+			 * at the boundaries is copied.
+			 *
+			 * \return number of transferred bytes
+			 */
+			size_t splice_from(Pipe &src, size_t count)
+			{
+				if (&src == this)
+					return 0;
+
+				/* acquire both locks in a globally consistent order */
+				Lock &first  = (this < &src) ? _lock : src._lock;
+				Lock &second = (this < &src) ? src._lock : _lock;
+				Lock::Guard first_guard(first);
+				Lock::Guard second_guard(second);
+
+				bool const was_empty = (_num_bytes == 0);
+
+				size_t moved = 0;
+				while (moved < count && src._head) {
+
+					Page *page = src._head;
+
+					if (!page->avail()) {
+						if (page == src._tail)
+							break;
+						src._release_page(src._dequeue());
+						continue;
+					}
+
+					/* pass the complete page if it fits the request */
+					if (page->avail() <= count - moved
+					 && page != src._tail
+					 && _num_pages < _max_pages) {
+
+						moved += page->avail();
+						_enqueue(src._dequeue());
+						continue;
+					}
+
+					/* copy partial page content */
+					if (!_tail || !_tail->free_space()) {
+						if (_num_pages >= _max_pages)
+							break;
+						_enqueue(_alloc_page());
+					}
+
+					size_t const len = min(min(count - moved, page->avail()),
+					                       _tail->free_space());
+					if (!len)
+						break;
+
+					memcpy(_tail->data + _tail->len, page->data + page->offset, len);
+					_tail->len     += len;
+					_num_bytes     += len;
+					page->offset   += len;
+					src._num_bytes -= len;
+					moved          += len;
+				}
+
+				if (moved) {
+					src._wake_up_writer();
+					if (was_empty || !_any_space_avail_for_writing())
+						_wake_up_reader();
+				}
+
+				return moved;
 			}
 
 			void register_write_ready_sigh(Signal_context_capability sigh)
@@ -229,6 +432,8 @@ namespace Noux {
 				_pipe->writer_close();
 			}
 
+			Pipe &pipe() { return *_pipe.operator->(); }
+
 			bool check_unblock(bool rd, bool wr, bool ex) const
 			{
 				return wr && _pipe->any_space_avail_for_writing();
@@ -293,6 +498,8 @@ namespace Noux {
 				_pipe->reader_close();
 			}
 
+			Pipe &pipe() { return *_pipe.operator->(); }
+
 			bool check_unblock(bool rd, bool wr, bool ex) const
 			{
 				/* unblock if the writer has already closed its pipe end */
@@ -0,0 +1,97 @@
+/*
+ * \brief  Compare process creation via fork/execve with posix_spawn
+ * \author Norman Feske
+ * \date   2013-03-05
+ */
+
+/*
+ * Copyright (C) 2013 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <spawn.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+enum { ROUNDS = 50 };
+
+static char const *binary = "/test-noux_spawn";
+
+extern char **environ;
+
+
+static unsigned long now_ms()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec*1000 + tv.tv_usec/1000;
+}
+
+
+static bool fork_exec()
+{
+	char *argv[] = { (char *)binary, (char *)"child", 0 };
+
+	pid_t pid = fork();
+	if (pid < 0)
+		return false;
+
+	if (pid == 0) {
+		execve(binary, argv, environ);
+		_exit(1);
+	}
+
+	int status = 0;
+	return waitpid(pid, &status, 0) == pid;
+}
+
+
+static bool spawn()
+{
+	char *argv[] = { (char *)binary, (char *)"child", 0 };
+
+	pid_t pid = 0;
+	if (posix_spawn(&pid, binary, 0, 0, argv, environ))
+		return false;
+
+	int status = 0;
+	return waitpid(pid, &status, 0) == pid;
+}
+
+
+static void measure(char const *name, bool (*create)())
+{
+	unsigned long const start = now_ms();
+
+	for (unsigned i = 0; i < ROUNDS; i++)
+		if (!create()) {
+			printf("%s: process creation failed in round %u\n", name, i);
+			return;
+		}
+
+	unsigned long const duration = now_ms() - start;
+
+	printf("%-12s %u processes in %lu ms (%lu us per process)\n",
+	       name, (unsigned)ROUNDS, duration, duration*1000/ROUNDS);
+}
+
+
+int main(int argc, char **argv)
+{
+	/* invoked as child, exit immediately */
+	if (argc > 1 && strcmp(argv[1], "child") == 0)
+		return 0;
+
+	printf("--- noux spawn benchmark started ---\n");
+
+	measure("fork/execve", fork_exec);
+	measure("posix_spawn", spawn);
+
+	printf("--- noux spawn benchmark finished ---\n");
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-noux_spawn
+SRC_CC = main.cc
+LIBS   = libc libc_noux